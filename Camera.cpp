@@ -15,33 +15,52 @@ void SimpleCamera::MoveRight(float Scale)
 
 void SimpleCamera::MouseMove(float X, float Y)
 {
-	if (bEnableMouseMovement)
-	{
-		glm::vec2 CurrentCursor{ X, Y };
-		glm::vec2 Delta = (CurrentCursor - PreviousCursor) / 10.0f;
+	Rotate(ConsumeCursor(X, Y));
+}
 
-		if (glm::length(Delta) < 5.0f)
-		{
-			glm::vec3 Right = glm::cross(Direction, Up);
+glm::vec2 SimpleCamera::ConsumeCursor(float X, float Y)
+{
+	if (!bEnableMouseMovement)
+	{
+		return glm::vec2{ 0.0f };
+	}
 
-			glm::mat4 RotationRight = glm::rotate(glm::identity<glm::mat4>(), glm::radians(-Delta.y), Right);
-			glm::mat4 RotationUp = glm::rotate(glm::identity<glm::mat4>(), glm::radians(-Delta.x), Up);
-			glm::mat4 Rotation = RotationRight * RotationUp;
+	glm::vec2 CurrentCursor{ X, Y };
+	glm::vec2 Delta = (CurrentCursor - PreviousCursor) / 10.0f;
+	PreviousCursor = CurrentCursor;
 
-			Up = Rotation * glm::vec4{ Up, 0.0f };
-			Direction = Rotation * glm::vec4{ Direction, 0.0f };
-		}
+	return glm::length(Delta) < 5.0f ? Delta : glm::vec2{ 0.0f };
+}
 
-		PreviousCursor = CurrentCursor;
+void SimpleCamera::Rotate(const glm::vec2& Degrees)
+{
+	if (Degrees.x == 0.0f && Degrees.y == 0.0f)
+	{
+		return;
 	}
+
+	glm::vec3 Right = glm::normalize(glm::cross(Direction, Up));
+
+	glm::quat Pitch = glm::angleAxis(glm::radians(-Degrees.y), Right);
+	glm::quat Yaw = glm::angleAxis(glm::radians(-Degrees.x), Up);
+	glm::quat Rotation = glm::normalize(Pitch * Yaw);
+
+	// Os erros de arredondamento de muitas rotaes acumuladas no podem encolher ou entortar os eixos
+	Direction = glm::normalize(Rotation * Direction);
+	Up = glm::normalize(Rotation * Up);
+	Up = glm::normalize(Up - Direction * glm::dot(Up, Direction));
 }
 
 void SimpleCamera::Update(float DeltaTime)
+{
+	Location += GetVelocity() * DeltaTime;
+}
+
+glm::vec3 SimpleCamera::GetVelocity() const
 {
 	glm::vec3 Right = glm::cross(Direction, Up);
 
-	Location += Direction * ForwardScale * DeltaTime;
-	Location += Right * RightScale * DeltaTime;
+	return Direction * ForwardScale + Right * RightScale;
 }
 
 glm::mat4 SimpleCamera::GetView()
@@ -8,7 +8,15 @@ public:
 	void MoveForward(float Scale);
 	void MoveRight(float Scale);
 	void MouseMove(float X, float Y);
+
+	// Deslocamento do cursor desde a posio anterior em graus (Yaw, Pitch), descartando saltos (cursor recapturado).
+	//	No gira a cmera: os deslocamentos de vrios eventos podem ser somados e aplicados de uma vez com Rotate
+	glm::vec2 ConsumeCursor(float X, float Y);
+
+	// Aplica uma rotao (graus) como um nico quaternion e renormaliza Direction e Up, que seguem ortogonais
+	void Rotate(const glm::vec2& Degrees);
 	void Update(float DeltaTime);
+	glm::vec3 GetVelocity() const;
 	glm::mat4 GetView();
 	glm::mat4 GetViewProjection();
 
@@ -0,0 +1,507 @@
+#include "CommandList.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+#include "DrawStatistics.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+namespace
+{
+	// Cabealho de cada comando: o tamanho total permite pular comandos sem conhecer o tipo
+	struct CommandHeader
+	{
+		ECommandType Type;
+		uint8_t Reserved;
+		uint16_t Size;
+	};
+
+	static_assert(sizeof(CommandHeader) == 4, "O cabealho dos comandos deve ocupar 4 bytes");
+
+	struct BindTextureArgs
+	{
+		GLuint Unit;
+		GLenum Target;
+		GLuint TextureId;
+	};
+
+	template <typename ValueType, size_t Count>
+	struct UniformArgs
+	{
+		GLint Location;
+		ValueType Value[Count];
+	};
+
+	constexpr size_t AlignTo4(size_t Size)
+	{
+		return (Size + 3) & ~size_t{ 3 };
+	}
+
+	template <typename PayloadType>
+	const PayloadType& ReadPayload(const uint8_t* Command)
+	{
+		return *reinterpret_cast<const PayloadType*>(Command + sizeof(CommandHeader));
+	}
+}
+
+CommandArena::CommandArena(size_t InBlockSize)
+	: BlockSize(InBlockSize)
+{
+}
+
+uint8_t* CommandArena::Allocate(size_t Size)
+{
+	Size = AlignTo4(Size);
+
+	// Procura espao no bloco atual e nos seguintes (j alocados em frames anteriores) antes de criar um novo
+	while (CurrentBlock < Blocks.size() && Blocks[CurrentBlock].Used + Size > Blocks[CurrentBlock].Size)
+	{
+		CurrentBlock++;
+	}
+	if (CurrentBlock == Blocks.size())
+	{
+		Block NewBlock;
+		NewBlock.Size = std::max(BlockSize, Size);
+		NewBlock.Data = std::make_unique<uint8_t[]>(NewBlock.Size);
+		Blocks.push_back(std::move(NewBlock));
+	}
+
+	Block& Current = Blocks[CurrentBlock];
+	uint8_t* Memory = Current.Data.get() + Current.Used;
+	Current.Used += Size;
+	return Memory;
+}
+
+void CommandArena::Reset()
+{
+	for (Block& Current : Blocks)
+	{
+		Current.Used = 0;
+	}
+	CurrentBlock = 0;
+}
+
+size_t CommandArena::GetBlockCount() const
+{
+	return Blocks.size();
+}
+
+const uint8_t* CommandArena::GetBlockData(size_t BlockIndex) const
+{
+	return Blocks[BlockIndex].Data.get();
+}
+
+size_t CommandArena::GetBlockUsed(size_t BlockIndex) const
+{
+	return Blocks[BlockIndex].Used;
+}
+
+size_t CommandArena::GetUsedBytes() const
+{
+	size_t Used = 0;
+	for (const Block& Current : Blocks)
+	{
+		Used += Current.Used;
+	}
+	return Used;
+}
+
+size_t CommandArena::GetReservedBytes() const
+{
+	size_t Reserved = 0;
+	for (const Block& Current : Blocks)
+	{
+		Reserved += Current.Size;
+	}
+	return Reserved;
+}
+
+void GLCommandBackend::BindProgram(GLuint ProgramId)
+{
+	GetGLStateCache().UseProgram(ProgramId);
+}
+
+void GLCommandBackend::BindVertexArray(GLuint VertexArrayId)
+{
+	GetGLStateCache().BindVertexArray(VertexArrayId);
+}
+
+void GLCommandBackend::BindTexture(GLuint Unit, GLenum Target, GLuint TextureId)
+{
+	GetGLStateCache().BindTexture(Unit, Target, TextureId);
+}
+
+void GLCommandBackend::SetUniform1i(GLint Location, GLint Value)
+{
+	glUniform1i(Location, Value);
+}
+
+void GLCommandBackend::SetUniform1f(GLint Location, GLfloat Value)
+{
+	glUniform1f(Location, Value);
+}
+
+void GLCommandBackend::SetUniform4f(GLint Location, const GLfloat* Value)
+{
+	glUniform4fv(Location, 1, Value);
+}
+
+void GLCommandBackend::SetUniformMatrix4f(GLint Location, const GLfloat* Value)
+{
+	glUniformMatrix4fv(Location, 1, GL_FALSE, Value);
+}
+
+void GLCommandBackend::DrawElements(const DrawElementsArgs& Args)
+{
+	const void* Offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(Args.FirstIndex) * sizeof(GLuint));
+	if (Args.InstanceCount == 1)
+	{
+		glDrawElementsBaseVertex(Args.Mode, Args.Count, GL_UNSIGNED_INT, const_cast<void*>(Offset), Args.BaseVertex);
+	}
+	else
+	{
+		glDrawElementsInstancedBaseVertex(Args.Mode, Args.Count, GL_UNSIGNED_INT, Offset, Args.InstanceCount, Args.BaseVertex);
+	}
+	CountDraw(Args.Mode, Args.Count, Args.InstanceCount);
+}
+
+void NullCommandBackend::Accumulate(ECommandType Type, const void* Data, size_t Size)
+{
+	Counts[static_cast<size_t>(Type)]++;
+
+	const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+	Checksum = (Checksum ^ static_cast<uint8_t>(Type)) * 1099511628211ull;
+	for (size_t Index = 0; Index < Size; ++Index)
+	{
+		Checksum = (Checksum ^ Bytes[Index]) * 1099511628211ull;
+	}
+}
+
+void NullCommandBackend::BindProgram(GLuint ProgramId)
+{
+	Accumulate(ECommandType::BindProgram, &ProgramId, sizeof(ProgramId));
+}
+
+void NullCommandBackend::BindVertexArray(GLuint VertexArrayId)
+{
+	Accumulate(ECommandType::BindVertexArray, &VertexArrayId, sizeof(VertexArrayId));
+}
+
+void NullCommandBackend::BindTexture(GLuint Unit, GLenum Target, GLuint TextureId)
+{
+	const BindTextureArgs Args{ Unit, Target, TextureId };
+	Accumulate(ECommandType::BindTexture, &Args, sizeof(Args));
+}
+
+void NullCommandBackend::SetUniform1i(GLint Location, GLint Value)
+{
+	const UniformArgs<GLint, 1> Args{ Location, { Value } };
+	Accumulate(ECommandType::Uniform1i, &Args, sizeof(Args));
+}
+
+void NullCommandBackend::SetUniform1f(GLint Location, GLfloat Value)
+{
+	const UniformArgs<GLfloat, 1> Args{ Location, { Value } };
+	Accumulate(ECommandType::Uniform1f, &Args, sizeof(Args));
+}
+
+void NullCommandBackend::SetUniform4f(GLint Location, const GLfloat* Value)
+{
+	UniformArgs<GLfloat, 4> Args{ Location, {} };
+	std::memcpy(Args.Value, Value, sizeof(Args.Value));
+	Accumulate(ECommandType::Uniform4f, &Args, sizeof(Args));
+}
+
+void NullCommandBackend::SetUniformMatrix4f(GLint Location, const GLfloat* Value)
+{
+	UniformArgs<GLfloat, 16> Args{ Location, {} };
+	std::memcpy(Args.Value, Value, sizeof(Args.Value));
+	Accumulate(ECommandType::UniformMatrix4f, &Args, sizeof(Args));
+}
+
+void NullCommandBackend::DrawElements(const DrawElementsArgs& Args)
+{
+	Accumulate(ECommandType::DrawElements, &Args, sizeof(Args));
+}
+
+uint64_t NullCommandBackend::GetCommandCount(ECommandType Type) const
+{
+	return Counts[static_cast<size_t>(Type)];
+}
+
+uint64_t NullCommandBackend::GetTotalCommands() const
+{
+	uint64_t Total = 0;
+	for (uint64_t Count : Counts)
+	{
+		Total += Count;
+	}
+	return Total;
+}
+
+uint64_t NullCommandBackend::GetChecksum() const
+{
+	return Checksum;
+}
+
+template <typename PayloadType>
+void CommandList::Record(ECommandType Type, const PayloadType& Payload)
+{
+	const size_t Size = AlignTo4(sizeof(CommandHeader) + sizeof(PayloadType));
+	uint8_t* Command = Arena.Allocate(Size);
+
+	const CommandHeader Header{ Type, 0, static_cast<uint16_t>(Size) };
+	std::memcpy(Command, &Header, sizeof(Header));
+	std::memcpy(Command + sizeof(Header), &Payload, sizeof(Payload));
+	CommandCount++;
+}
+
+void CommandList::BindProgram(GLuint ProgramId)
+{
+	Record(ECommandType::BindProgram, ProgramId);
+}
+
+void CommandList::BindVertexArray(GLuint VertexArrayId)
+{
+	Record(ECommandType::BindVertexArray, VertexArrayId);
+}
+
+void CommandList::BindTexture(GLuint Unit, GLenum Target, GLuint TextureId)
+{
+	Record(ECommandType::BindTexture, BindTextureArgs{ Unit, Target, TextureId });
+}
+
+void CommandList::SetUniform1i(GLint Location, GLint Value)
+{
+	Record(ECommandType::Uniform1i, UniformArgs<GLint, 1>{ Location, { Value } });
+}
+
+void CommandList::SetUniform1f(GLint Location, GLfloat Value)
+{
+	Record(ECommandType::Uniform1f, UniformArgs<GLfloat, 1>{ Location, { Value } });
+}
+
+void CommandList::SetUniform4f(GLint Location, const GLfloat* Value)
+{
+	UniformArgs<GLfloat, 4> Args{ Location, {} };
+	std::memcpy(Args.Value, Value, sizeof(Args.Value));
+	Record(ECommandType::Uniform4f, Args);
+}
+
+void CommandList::SetUniformMatrix4f(GLint Location, const GLfloat* Value)
+{
+	UniformArgs<GLfloat, 16> Args{ Location, {} };
+	std::memcpy(Args.Value, Value, sizeof(Args.Value));
+	Record(ECommandType::UniformMatrix4f, Args);
+}
+
+void CommandList::DrawElements(const DrawElementsArgs& Args)
+{
+	Record(ECommandType::DrawElements, Args);
+}
+
+void CommandList::Reset()
+{
+	Arena.Reset();
+	CommandCount = 0;
+}
+
+void CommandList::Execute(CommandBackend& Backend) const
+{
+	for (size_t Block = 0; Block < Arena.GetBlockCount(); ++Block)
+	{
+		const uint8_t* Command = Arena.GetBlockData(Block);
+		const uint8_t* End = Command + Arena.GetBlockUsed(Block);
+		while (Command < End)
+		{
+			CommandHeader Header;
+			std::memcpy(&Header, Command, sizeof(Header));
+
+			switch (Header.Type)
+			{
+				case ECommandType::BindProgram:
+					Backend.BindProgram(ReadPayload<GLuint>(Command));
+					break;
+
+				case ECommandType::BindVertexArray:
+					Backend.BindVertexArray(ReadPayload<GLuint>(Command));
+					break;
+
+				case ECommandType::BindTexture:
+				{
+					const BindTextureArgs& Args = ReadPayload<BindTextureArgs>(Command);
+					Backend.BindTexture(Args.Unit, Args.Target, Args.TextureId);
+					break;
+				}
+
+				case ECommandType::Uniform1i:
+				{
+					const auto& Args = ReadPayload<UniformArgs<GLint, 1>>(Command);
+					Backend.SetUniform1i(Args.Location, Args.Value[0]);
+					break;
+				}
+
+				case ECommandType::Uniform1f:
+				{
+					const auto& Args = ReadPayload<UniformArgs<GLfloat, 1>>(Command);
+					Backend.SetUniform1f(Args.Location, Args.Value[0]);
+					break;
+				}
+
+				case ECommandType::Uniform4f:
+				{
+					const auto& Args = ReadPayload<UniformArgs<GLfloat, 4>>(Command);
+					Backend.SetUniform4f(Args.Location, Args.Value);
+					break;
+				}
+
+				case ECommandType::UniformMatrix4f:
+				{
+					const auto& Args = ReadPayload<UniformArgs<GLfloat, 16>>(Command);
+					Backend.SetUniformMatrix4f(Args.Location, Args.Value);
+					break;
+				}
+
+				case ECommandType::DrawElements:
+					Backend.DrawElements(ReadPayload<DrawElementsArgs>(Command));
+					break;
+
+				default:
+					break;
+			}
+
+			Command += Header.Size;
+		}
+	}
+}
+
+size_t CommandList::GetCommandCount() const
+{
+	return CommandCount;
+}
+
+size_t CommandList::GetSizeBytes() const
+{
+	return Arena.GetUsedBytes();
+}
+
+void RecordCommandListsInParallel(std::vector<CommandList>& Lists, const std::function<void(size_t, CommandList&)>& Record,
+	WorkerPool& Pool)
+{
+	for (CommandList& List : Lists)
+	{
+		List.Reset();
+	}
+
+	Pool.ParallelFor(Lists.size(), [&Record, &Lists](size_t ListIndex)
+	{
+		PROFILE_SCOPE("RecordCommandList");
+		Record(ListIndex, Lists[ListIndex]);
+	});
+}
+
+void ExecuteCommandLists(const std::vector<CommandList>& Lists, CommandBackend& Backend)
+{
+	PROFILE_SCOPE("ExecuteCommandLists");
+
+	for (const CommandList& List : Lists)
+	{
+		List.Execute(Backend);
+	}
+}
+
+void RunCommandListBenchmark(int DrawCount, std::ostream& Output)
+{
+	using Clock = std::chrono::steady_clock;
+	constexpr int Repetitions = 20;
+	constexpr int DrawsPerMaterial = 64;
+
+	DrawCount = std::max(1, DrawCount);
+	// Ao menos 4 listas, mesmo com poucos ncleos: o checksum confirma que a reproduo independe da diviso
+	const int MaxThreads = static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+
+	Output << "Benchmark de listas de comandos: " << DrawCount << " draws por frame, " << Repetitions << " repeties" << std::endl;
+	Output << "  threads   gravao (ms)   Mcmd/s   reproduo nula (ms)   bytes/cmd   maior lista (KB)   checksum" << std::endl;
+
+	for (int NumThreads = 1; NumThreads <= MaxThreads; NumThreads *= 2)
+	{
+		// Threads criadas fora da medio, como o pool persistente do renderizador
+		WorkerPool Pool{ NumThreads };
+		std::vector<CommandList> Lists(NumThreads);
+
+		// Cada lista recebe um intervalo contguo de draws: o contedo concatenado  o mesmo com qualquer nmero de threads
+		auto RecordDraws = [DrawCount, NumThreads](size_t ListIndex, CommandList& List)
+		{
+			const int FirstDraw = static_cast<int>(static_cast<int64_t>(DrawCount) * ListIndex / NumThreads);
+			const int LastDraw = static_cast<int>(static_cast<int64_t>(DrawCount) * (ListIndex + 1) / NumThreads);
+			for (int Draw = FirstDraw; Draw < LastDraw; ++Draw)
+			{
+				if (Draw % DrawsPerMaterial == 0)
+				{
+					const GLuint Material = static_cast<GLuint>(Draw / DrawsPerMaterial);
+					List.BindProgram(1 + Material % 4);
+					List.BindTexture(0, GL_TEXTURE_2D, 10 + Material % 8);
+				}
+
+				GLfloat ModelMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+				ModelMatrix[12] = static_cast<GLfloat>(Draw);
+				const GLfloat Tint[4] = { static_cast<GLfloat>(Draw % 7) / 7.0f, 1.0f, 1.0f, 1.0f };
+				List.SetUniformMatrix4f(0, ModelMatrix);
+				List.SetUniform4f(1, Tint);
+
+				DrawElementsArgs Args;
+				Args.Count = 384;
+				Args.FirstIndex = static_cast<GLuint>(Draw) * 384;
+				List.DrawElements(Args);
+			}
+		};
+
+		double RecordSeconds = 0.0;
+		double PlaybackSeconds = 0.0;
+		uint64_t Checksum = 0;
+		uint64_t Commands = 0;
+		// A repetio 0 no  medida: as arenas das listas crescem at o tamanho final e as threads do pool acordam
+		for (int Repetition = 0; Repetition <= Repetitions; ++Repetition)
+		{
+			NullCommandBackend Backend;
+
+			const Clock::time_point RecordStart = Clock::now();
+			RecordCommandListsInParallel(Lists, RecordDraws, Pool);
+			const Clock::time_point PlaybackStart = Clock::now();
+			ExecuteCommandLists(Lists, Backend);
+			const Clock::time_point PlaybackEnd = Clock::now();
+
+			if (Repetition > 0)
+			{
+				RecordSeconds += std::chrono::duration<double>(PlaybackStart - RecordStart).count();
+				PlaybackSeconds += std::chrono::duration<double>(PlaybackEnd - PlaybackStart).count();
+			}
+			Checksum = Backend.GetChecksum();
+			Commands = Backend.GetTotalCommands();
+		}
+
+		size_t TotalBytes = 0;
+		size_t LargestList = 0;
+		for (const CommandList& List : Lists)
+		{
+			TotalBytes += List.GetSizeBytes();
+			LargestList = std::max(LargestList, List.GetSizeBytes());
+		}
+
+		const double RecordMilliseconds = 1000.0 * RecordSeconds / Repetitions;
+		Output << std::fixed << std::setprecision(3)
+			   << "  " << std::setw(7) << NumThreads
+			   << "   " << std::setw(13) << RecordMilliseconds
+			   << "   " << std::setw(6) << std::setprecision(1) << Commands / (RecordMilliseconds * 1000.0)
+			   << "   " << std::setw(20) << std::setprecision(3) << 1000.0 * PlaybackSeconds / Repetitions
+			   << "   " << std::setw(9) << std::setprecision(1) << static_cast<double>(TotalBytes) / std::max<uint64_t>(1, Commands)
+			   << "   " << std::setw(16) << LargestList / 1024.0
+			   << "   " << std::hex << Checksum << std::dec
+			   << std::defaultfloat << std::endl;
+	}
+}
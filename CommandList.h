@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "WorkerPool.h"
+
+// Memria linear em blocos de tamanho fixo: alocar  avanar um ponteiro e Reset devolve tudo de uma vez, mantendo os
+//	blocos para o prximo frame (sem new/delete por comando)
+class CommandArena
+{
+public:
+	explicit CommandArena(size_t InBlockSize = 64 * 1024);
+
+	// Reserva Size bytes contguos alinhados a 4 bytes
+	uint8_t* Allocate(size_t Size);
+
+	void Reset();
+
+	// Bytes usados em cada bloco, na ordem de alocao (blocos vazios ficam de fora)
+	size_t GetBlockCount() const;
+	const uint8_t* GetBlockData(size_t Block) const;
+	size_t GetBlockUsed(size_t Block) const;
+
+	size_t GetUsedBytes() const;
+	size_t GetReservedBytes() const;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<uint8_t[]> Data;
+		size_t Size = 0;
+		size_t Used = 0;
+	};
+
+	std::vector<Block> Blocks;
+	size_t CurrentBlock = 0;
+	size_t BlockSize = 0;
+};
+
+enum class ECommandType : uint8_t
+{
+	BindProgram,
+	BindVertexArray,
+	BindTexture,
+	Uniform1i,
+	Uniform1f,
+	Uniform4f,
+	UniformMatrix4f,
+	DrawElements,
+
+	Count
+};
+
+// Parmetros de um draw indexado (GL_UNSIGNED_INT), com deslocamento no index buffer e no vertex buffer
+struct DrawElementsArgs
+{
+	GLenum Mode = GL_TRIANGLES;
+	GLsizei Count = 0;
+	GLuint FirstIndex = 0;
+	GLint BaseVertex = 0;
+	GLsizei InstanceCount = 1;
+};
+
+// Destino da reproduo de uma lista: o OpenGL (GLCommandBackend) ou um backend que s conta (NullCommandBackend)
+class CommandBackend
+{
+public:
+	virtual ~CommandBackend() = default;
+
+	virtual void BindProgram(GLuint ProgramId) = 0;
+	virtual void BindVertexArray(GLuint VertexArrayId) = 0;
+	virtual void BindTexture(GLuint Unit, GLenum Target, GLuint TextureId) = 0;
+	virtual void SetUniform1i(GLint Location, GLint Value) = 0;
+	virtual void SetUniform1f(GLint Location, GLfloat Value) = 0;
+	virtual void SetUniform4f(GLint Location, const GLfloat* Value) = 0;
+	virtual void SetUniformMatrix4f(GLint Location, const GLfloat* Value) = 0;
+	virtual void DrawElements(const DrawElementsArgs& Args) = 0;
+};
+
+// Executa os comandos no contexto atual, com os binds passando pelo cache de estados
+class GLCommandBackend : public CommandBackend
+{
+public:
+	void BindProgram(GLuint ProgramId) override;
+	void BindVertexArray(GLuint VertexArrayId) override;
+	void BindTexture(GLuint Unit, GLenum Target, GLuint TextureId) override;
+	void SetUniform1i(GLint Location, GLint Value) override;
+	void SetUniform1f(GLint Location, GLfloat Value) override;
+	void SetUniform4f(GLint Location, const GLfloat* Value) override;
+	void SetUniformMatrix4f(GLint Location, const GLfloat* Value) override;
+	void DrawElements(const DrawElementsArgs& Args) override;
+};
+
+// No chama o OpenGL: conta os comandos por tipo e acumula um checksum dos parmetros, para medir a gravao e a
+//	reproduo sem GPU e verificar que a ordem reproduzida  sempre a mesma
+class NullCommandBackend : public CommandBackend
+{
+public:
+	void BindProgram(GLuint ProgramId) override;
+	void BindVertexArray(GLuint VertexArrayId) override;
+	void BindTexture(GLuint Unit, GLenum Target, GLuint TextureId) override;
+	void SetUniform1i(GLint Location, GLint Value) override;
+	void SetUniform1f(GLint Location, GLfloat Value) override;
+	void SetUniform4f(GLint Location, const GLfloat* Value) override;
+	void SetUniformMatrix4f(GLint Location, const GLfloat* Value) override;
+	void DrawElements(const DrawElementsArgs& Args) override;
+
+	uint64_t GetCommandCount(ECommandType Type) const;
+	uint64_t GetTotalCommands() const;
+	uint64_t GetChecksum() const;
+
+private:
+	void Accumulate(ECommandType Type, const void* Data, size_t Size);
+
+	uint64_t Counts[static_cast<size_t>(ECommandType::Count)] = {};
+	uint64_t Checksum = 14695981039346656037ull; // FNV-1a
+};
+
+// Sequncia binria compacta de comandos (cabealho de 4 bytes + parmetros) gravada em uma arena prpria.
+// Cada lista  gravada por uma nica thread; vrias listas podem ser gravadas em paralelo e depois reproduzidas, na
+//	thread do contexto, na ordem em que foram passadas para ExecuteCommandLists
+class CommandList
+{
+public:
+	void BindProgram(GLuint ProgramId);
+	void BindVertexArray(GLuint VertexArrayId);
+	void BindTexture(GLuint Unit, GLenum Target, GLuint TextureId);
+	void SetUniform1i(GLint Location, GLint Value);
+	void SetUniform1f(GLint Location, GLfloat Value);
+	void SetUniform4f(GLint Location, const GLfloat* Value);
+	void SetUniformMatrix4f(GLint Location, const GLfloat* Value);
+	void DrawElements(const DrawElementsArgs& Args);
+
+	// Descarta os comandos gravados, mantendo a memria da arena
+	void Reset();
+
+	void Execute(CommandBackend& Backend) const;
+
+	size_t GetCommandCount() const;
+	size_t GetSizeBytes() const;
+
+private:
+	template <typename PayloadType>
+	void Record(ECommandType Type, const PayloadType& Payload);
+
+	CommandArena Arena;
+	size_t CommandCount = 0;
+};
+
+// Grava Lists.size() listas em paralelo nas threads do Pool (a thread atual tambm grava). Record recebe o ndice e a
+//	lista, que chega vazia
+void RecordCommandListsInParallel(std::vector<CommandList>& Lists, const std::function<void(size_t, CommandList&)>& Record,
+	WorkerPool& Pool = GetWorkerPool());
+
+// Reproduz as listas em ordem: o resultado no depende de qual thread terminou de gravar primeiro
+void ExecuteCommandLists(const std::vector<CommandList>& Lists, CommandBackend& Backend);
+
+// --command-list-benchmark: grava DrawCount draws (uniforms + draw, com troca de programa e texturas a cada 64) em 1, 2, 4...
+//	threads e reproduz no NullCommandBackend, imprimindo a vazo e o tamanho das listas. No precisa de janela nem de GPU
+void RunCommandListBenchmark(int DrawCount, std::ostream& Output);
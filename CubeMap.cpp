@@ -0,0 +1,396 @@
+#include "CubeMap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLUEMARBLE_CUBEMAP_SSE2 1
+#include <emmintrin.h>
+#else
+#define BLUEMARBLE_CUBEMAP_SSE2 0
+#endif
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "TextureResidency.h"
+
+namespace
+{
+	// Direo (espao do objeto) do texel (S, T) de uma face, seguindo a tabela de seleo de faces da especificao
+	//	do OpenGL. S e T esto em [0, 1]
+	glm::vec3 GetCubeFaceDirection(int Face, float S, float T)
+	{
+		const float SC = 2.0f * S - 1.0f;
+		const float TC = 2.0f * T - 1.0f;
+
+		switch (Face)
+		{
+			case 0: return { 1.0f, -TC, -SC };
+			case 1: return { -1.0f, -TC, SC };
+			case 2: return { SC, 1.0f, TC };
+			case 3: return { SC, -1.0f, -TC };
+			case 4: return { SC, -TC, 1.0f };
+			default: return { -SC, -TC, -1.0f };
+		}
+	}
+
+	// Converte a direo para coordenadas (em texels) da imagem equiretangular, usando a mesma parametrizao do
+	//	GenerateSphere: Theta = atan2(y, x), Phi = acos(z), UV = (1 - Theta / 2Pi, 1 - Phi / Pi)
+	void DirectionToEquirect(const glm::vec3& Direction, int Width, int Height, float& X, float& Y)
+	{
+		const glm::vec3 Normalized = glm::normalize(Direction);
+
+		float Theta = std::atan2(Normalized.y, Normalized.x);
+		if (Theta < 0.0f)
+		{
+			Theta += glm::two_pi<float>();
+		}
+		const float Phi = std::acos(std::clamp(Normalized.z, -1.0f, 1.0f));
+
+		const float U = 1.0f - Theta / glm::two_pi<float>();
+		const float V = 1.0f - Phi / glm::pi<float>();
+
+		// Centro do texel em (0.5, 0.5)
+		X = U * Width - 0.5f;
+		Y = V * Height - 0.5f;
+	}
+
+	// Longitude se repete (wrap), latitude fica presa s bordas (clamp)
+	int WrapX(int X, int Width)
+	{
+		X %= Width;
+		return X < 0 ? X + Width : X;
+	}
+
+	int ClampY(int Y, int Height)
+	{
+		return std::clamp(Y, 0, Height - 1);
+	}
+
+	void SampleNearest(const TextureImage& Source, float X, float Y, unsigned char* Texel)
+	{
+		const int N = Source.NumberOfComponents;
+		const int SourceX = WrapX(static_cast<int>(std::floor(X + 0.5f)), Source.Width);
+		const int SourceY = ClampY(static_cast<int>(std::floor(Y + 0.5f)), Source.Height);
+		const unsigned char* Sample = &Source.Pixels[(static_cast<size_t>(SourceY) * Source.Width + SourceX) * N];
+		std::copy(Sample, Sample + N, Texel);
+	}
+
+	void SampleBilinear(const TextureImage& Source, float X, float Y, unsigned char* Texel)
+	{
+		const int N = Source.NumberOfComponents;
+		const int X0 = static_cast<int>(std::floor(X));
+		const int Y0 = static_cast<int>(std::floor(Y));
+		const float WeightX = X - X0;
+		const float WeightY = Y - Y0;
+
+		const size_t Row0 = static_cast<size_t>(ClampY(Y0, Source.Height)) * Source.Width;
+		const size_t Row1 = static_cast<size_t>(ClampY(Y0 + 1, Source.Height)) * Source.Width;
+		const int Column0 = WrapX(X0, Source.Width);
+		const int Column1 = WrapX(X0 + 1, Source.Width);
+
+		for (int Component = 0; Component < N; ++Component)
+		{
+			float T00 = Source.Pixels[(Row0 + Column0) * N + Component];
+			float T10 = Source.Pixels[(Row0 + Column1) * N + Component];
+			float T01 = Source.Pixels[(Row1 + Column0) * N + Component];
+			float T11 = Source.Pixels[(Row1 + Column1) * N + Component];
+
+			float Top = T00 + WeightX * (T10 - T00);
+			float Bottom = T01 + WeightX * (T11 - T01);
+			Texel[Component] = static_cast<unsigned char>(Top + WeightY * (Bottom - Top) + 0.5f);
+		}
+	}
+
+#if BLUEMARBLE_CUBEMAP_SSE2
+	// Filtro bilinear de quatro pixels de destino por vez: a busca dos texels  escalar, a interpolao usa SSE2
+	void SampleBilinear4(const TextureImage& Source, const float* X, const float* Y, unsigned char* Texels)
+	{
+		const int N = Source.NumberOfComponents;
+
+		alignas(16) float WeightX[4];
+		alignas(16) float WeightY[4];
+		size_t Index00[4];
+		size_t Index10[4];
+		size_t Index01[4];
+		size_t Index11[4];
+
+		for (int Lane = 0; Lane < 4; ++Lane)
+		{
+			const int X0 = static_cast<int>(std::floor(X[Lane]));
+			const int Y0 = static_cast<int>(std::floor(Y[Lane]));
+			WeightX[Lane] = X[Lane] - X0;
+			WeightY[Lane] = Y[Lane] - Y0;
+
+			const size_t Row0 = static_cast<size_t>(ClampY(Y0, Source.Height)) * Source.Width;
+			const size_t Row1 = static_cast<size_t>(ClampY(Y0 + 1, Source.Height)) * Source.Width;
+			const int Column0 = WrapX(X0, Source.Width);
+			const int Column1 = WrapX(X0 + 1, Source.Width);
+
+			Index00[Lane] = (Row0 + Column0) * N;
+			Index10[Lane] = (Row0 + Column1) * N;
+			Index01[Lane] = (Row1 + Column0) * N;
+			Index11[Lane] = (Row1 + Column1) * N;
+		}
+
+		const __m128 VectorWeightX = _mm_load_ps(WeightX);
+		const __m128 VectorWeightY = _mm_load_ps(WeightY);
+		const __m128 Half = _mm_set1_ps(0.5f);
+		const unsigned char* Pixels = Source.Pixels.data();
+
+		for (int Component = 0; Component < N; ++Component)
+		{
+			const __m128 T00 = _mm_set_ps(Pixels[Index00[3] + Component], Pixels[Index00[2] + Component], Pixels[Index00[1] + Component], Pixels[Index00[0] + Component]);
+			const __m128 T10 = _mm_set_ps(Pixels[Index10[3] + Component], Pixels[Index10[2] + Component], Pixels[Index10[1] + Component], Pixels[Index10[0] + Component]);
+			const __m128 T01 = _mm_set_ps(Pixels[Index01[3] + Component], Pixels[Index01[2] + Component], Pixels[Index01[1] + Component], Pixels[Index01[0] + Component]);
+			const __m128 T11 = _mm_set_ps(Pixels[Index11[3] + Component], Pixels[Index11[2] + Component], Pixels[Index11[1] + Component], Pixels[Index11[0] + Component]);
+
+			const __m128 Top = _mm_add_ps(T00, _mm_mul_ps(VectorWeightX, _mm_sub_ps(T10, T00)));
+			const __m128 Bottom = _mm_add_ps(T01, _mm_mul_ps(VectorWeightX, _mm_sub_ps(T11, T01)));
+			const __m128 Result = _mm_add_ps(_mm_add_ps(Top, _mm_mul_ps(VectorWeightY, _mm_sub_ps(Bottom, Top))), Half);
+
+			alignas(16) int Values[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(Values), _mm_cvttps_epi32(Result));
+
+			for (int Lane = 0; Lane < 4; ++Lane)
+			{
+				Texels[Lane * N + Component] = static_cast<unsigned char>(Values[Lane]);
+			}
+		}
+	}
+#endif
+
+	void ReprojectRows(const TextureImage& Equirect, ECubeMapFilter Filter, CubeMapImage& Cube, int FirstRow, int LastRow)
+	{
+		const int FaceSize = Cube.FaceSize;
+		const int N = Equirect.NumberOfComponents;
+		const float InvFaceSize = 1.0f / FaceSize;
+
+		for (int Row = FirstRow; Row < LastRow; ++Row)
+		{
+			const int Face = Row / FaceSize;
+			const int Y = Row % FaceSize;
+			const float T = (Y + 0.5f) * InvFaceSize;
+			unsigned char* Destination = &Cube.Faces[Face].Pixels[static_cast<size_t>(Y) * FaceSize * N];
+
+			int X = 0;
+#if BLUEMARBLE_CUBEMAP_SSE2
+			if (Filter == ECubeMapFilter::Bilinear)
+			{
+				for (; X + 4 <= FaceSize; X += 4)
+				{
+					float SourceX[4];
+					float SourceY[4];
+					for (int Lane = 0; Lane < 4; ++Lane)
+					{
+						const float S = (X + Lane + 0.5f) * InvFaceSize;
+						DirectionToEquirect(GetCubeFaceDirection(Face, S, T), Equirect.Width, Equirect.Height, SourceX[Lane], SourceY[Lane]);
+					}
+					SampleBilinear4(Equirect, SourceX, SourceY, Destination + static_cast<size_t>(X) * N);
+				}
+			}
+#endif
+			for (; X < FaceSize; ++X)
+			{
+				const float S = (X + 0.5f) * InvFaceSize;
+
+				float SourceX = 0.0f;
+				float SourceY = 0.0f;
+				DirectionToEquirect(GetCubeFaceDirection(Face, S, T), Equirect.Width, Equirect.Height, SourceX, SourceY);
+
+				if (Filter == ECubeMapFilter::Nearest)
+				{
+					SampleNearest(Equirect, SourceX, SourceY, Destination + static_cast<size_t>(X) * N);
+				}
+				else
+				{
+					SampleBilinear(Equirect, SourceX, SourceY, Destination + static_cast<size_t>(X) * N);
+				}
+			}
+		}
+	}
+}
+
+int ComputeCubeFaceSize(int EquirectWidth, int EquirectHeight, float TexelRatio)
+{
+	const double Texels = static_cast<double>(EquirectWidth) * EquirectHeight * TexelRatio;
+	const int FaceSize = static_cast<int>(std::sqrt(Texels / 6.0));
+
+	// Mltiplo de 4 para que as faces tambm possam ser comprimidas em blocos sem bordas parciais
+	return std::max(4, FaceSize & ~3);
+}
+
+void ReprojectToCubeMap(const TextureImage& Equirect, int FaceSize, ECubeMapFilter Filter, CubeMapImage& Cube, int NumThreads)
+{
+	assert(!Equirect.Format.bCompressed && !Equirect.Pixels.empty());
+
+	Cube.FaceSize = FaceSize;
+	Cube.SourceWidth = Equirect.Width;
+	Cube.SourceHeight = Equirect.Height;
+	Cube.Name = Equirect.Name;
+
+	for (TextureImage& Face : Cube.Faces)
+	{
+		Face.Width = FaceSize;
+		Face.Height = FaceSize;
+		Face.NumberOfComponents = Equirect.NumberOfComponents;
+		Face.Format = Equirect.Format;
+		Face.Name = Equirect.Name;
+		Face.Pixels.resize(static_cast<size_t>(FaceSize) * FaceSize * Equirect.NumberOfComponents);
+	}
+
+	if (NumThreads <= 0)
+	{
+		NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// As linhas das seis faces so divididas em faixas contguas, uma por thread (cada thread escreve em linhas distintas)
+	const int TotalRows = FaceSize * 6;
+	NumThreads = std::min(NumThreads, TotalRows);
+
+	std::vector<std::thread> Workers;
+	for (int ThreadIndex = 1; ThreadIndex < NumThreads; ++ThreadIndex)
+	{
+		const int FirstRow = TotalRows * ThreadIndex / NumThreads;
+		const int LastRow = TotalRows * (ThreadIndex + 1) / NumThreads;
+		Workers.emplace_back(ReprojectRows, std::cref(Equirect), Filter, std::ref(Cube), FirstRow, LastRow);
+	}
+
+	// A thread atual processa a primeira faixa
+	ReprojectRows(Equirect, Filter, Cube, 0, TotalRows / NumThreads);
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+}
+
+bool DecodeCubeMap(const char* TextureFile, const TextureFormatOptions& Options, ECubeMapFilter Filter, CubeMapImage& Cube)
+{
+	// A reprojeo precisa dos pixels descomprimidos; a compresso (se habilitada)  feita em cada face depois
+	TextureFormatOptions UncompressedOptions = Options;
+	UncompressedOptions.bAllowCompression = false;
+
+	TextureImage Equirect;
+	if (!DecodeTexture(TextureFile, UncompressedOptions, Equirect))
+	{
+		return false;
+	}
+
+	ReprojectToCubeMap(Equirect, ComputeCubeFaceSize(Equirect.Width, Equirect.Height), Filter, Cube);
+
+	if (Options.bAllowCompression)
+	{
+		TextureFormat CompressedFormat = SelectTextureFormat(AnalyzeTextureChannels(Equirect), Options);
+		for (TextureImage& Face : Cube.Faces)
+		{
+			ConvertTextureImage(Face, CompressedFormat, Options.Usage);
+		}
+	}
+
+	return true;
+}
+
+GLuint CreateCubeMapStorage(const CubeMapImage& Cube)
+{
+	GLuint TextureId;
+	glGenTextures(1, &TextureId);
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_CUBE_MAP, TextureId);
+
+	const TextureFormat& Format = Cube.Faces[0].Format;
+	const int FaceSize = Cube.FaceSize;
+
+	for (int Face = 0; Face < 6; ++Face)
+	{
+		const GLenum FaceTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face;
+
+		if (Format.bCompressed)
+		{
+			// Como nas texturas 2D, os blocos de todos os nveis so copiados de uma vez
+			int Level = 0;
+			int LevelSize = FaceSize;
+			for (const std::vector<unsigned char>& Blocks : Cube.Faces[Face].CompressedLevels)
+			{
+				glCompressedTexImage2D(FaceTarget, Level, Format.InternalFormat, LevelSize, LevelSize, 0,
+									   static_cast<GLsizei>(Blocks.size()), Blocks.data());
+				LevelSize = std::max(1, LevelSize / 2);
+				++Level;
+			}
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, Level - 1);
+		}
+		else
+		{
+			glTexImage2D(FaceTarget, 0, Format.InternalFormat, FaceSize, FaceSize, 0, Format.PixelFormat, GL_UNSIGNED_BYTE, nullptr);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+		}
+	}
+
+	// A referncia de economia  a textura equiretangular RGB8 que o cube map substitui
+	std::string Description = std::string(Format.Name) + " cube map";
+	TrackTextureMemory(TextureId, Description.c_str(), FaceSize, FaceSize, 6 * ComputeTextureMemory(Format, FaceSize, FaceSize),
+					   ComputeTextureMemory(TextureFormat{}, Cube.SourceWidth, Cube.SourceHeight));
+
+	return TextureId;
+}
+
+void UploadCubeMapFace(GLuint TextureId, const CubeMapImage& Cube, int Face)
+{
+	const TextureImage& Image = Cube.Faces[Face];
+	if (Image.Format.bCompressed)
+	{
+		return;
+	}
+
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_CUBE_MAP, TextureId);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, 0, 0, 0, Image.Width, Image.Height, Image.Format.PixelFormat,
+					GL_UNSIGNED_BYTE, Image.Pixels.data());
+}
+
+void FinalizeCubeMap(GLuint TextureId, const CubeMapImage& Cube)
+{
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_CUBE_MAP, TextureId);
+
+	// Sem wrapping nas faces: com GL_TEXTURE_CUBE_MAP_SEAMLESS a filtragem atravessa as arestas entre faces
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+	if (!Cube.Faces[0].Format.bCompressed)
+	{
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 1000);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	}
+
+	GetTextureResidency().Register(TextureId, Cube.Name, Cube.FaceSize, Cube.FaceSize, Cube.Faces[0].Format, 6);
+}
+
+GLuint LoadCubeMap(const char* TextureFile, const TextureFormatOptions& Options, ECubeMapFilter Filter)
+{
+	PROFILE_SCOPE("LoadCubeMap");
+
+	std::cout << "Carregando Textura " << TextureFile << " como cube map" << std::endl;
+
+	CubeMapImage Cube;
+	bool bLoaded = DecodeCubeMap(TextureFile, Options, Filter, Cube);
+
+	assert(bLoaded);
+
+	GLuint TextureId = CreateCubeMapStorage(Cube);
+	for (int Face = 0; Face < 6; ++Face)
+	{
+		UploadCubeMapFace(TextureId, Cube, Face);
+	}
+	FinalizeCubeMap(TextureId, Cube);
+
+	return TextureId;
+}
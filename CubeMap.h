@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <GL/glew.h>
+
+#include "Texture.h"
+
+// Filtro usado ao reamostrar a imagem equiretangular nas faces do cube map
+enum class ECubeMapFilter
+{
+	Nearest,
+	Bilinear
+};
+
+// Seis faces na ordem do OpenGL (+X, -X, +Y, -Y, +Z, -Z), cada uma uma imagem quadrada de FaceSize pixels
+struct CubeMapImage
+{
+	int FaceSize = 0;
+	int SourceWidth = 0; // Dimenses da imagem equiretangular de origem, para o relatrio de memria
+	int SourceHeight = 0;
+	std::string Name;
+	std::array<TextureImage, 6> Faces;
+};
+
+// Lado de cada face para que as seis faces somem TexelRatio vezes os texels da imagem equiretangular.
+// A projeo equiretangular gasta ~36% dos texels perto dos polos; com 0.7 o cube map mantm a densidade no equador
+int ComputeCubeFaceSize(int EquirectWidth, int EquirectHeight, float TexelRatio = 0.7f);
+
+// Reamostra a imagem equiretangular (no comprimida) nas seis faces, dividindo as linhas entre NumThreads threads
+// (0 = uma por ncleo). O filtro bilinear processa quatro pixels de destino por vez com SSE2 quando disponvel
+void ReprojectToCubeMap(const TextureImage& Equirect, int FaceSize, ECubeMapFilter Filter, CubeMapImage& Cube, int NumThreads = 0);
+
+// Decodifica, reprojeta e converte as faces para o formato escolhido pela anlise dos canais.
+// No utiliza o OpenGL, podendo ser chamada da thread de streaming
+bool DecodeCubeMap(const char* TextureFile, const TextureFormatOptions& Options, ECubeMapFilter Filter, CubeMapImage& Cube);
+
+// Cria o cube map na GPU. Faces no comprimidas so copiadas depois, uma por chamada de UploadCubeMapFace
+GLuint CreateCubeMapStorage(const CubeMapImage& Cube);
+void UploadCubeMapFace(GLuint TextureId, const CubeMapImage& Cube, int Face);
+void FinalizeCubeMap(GLuint TextureId, const CubeMapImage& Cube);
+
+GLuint LoadCubeMap(const char* TextureFile, const TextureFormatOptions& Options, ECubeMapFilter Filter);
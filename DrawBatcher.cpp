@@ -0,0 +1,261 @@
+#include "DrawBatcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+#include <glm/ext.hpp>
+
+#include "DrawStatistics.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+
+DrawBatchView DrawBatchView::FromMatrices(const glm::mat4& ModelViewProjection, const glm::mat4& ModelView)
+{
+	DrawBatchView View;
+
+	// Planos extrados da MVP (Gribb e Hartmann): combinaes da quarta linha com as trs primeiras
+	const glm::vec4 Row0 = glm::row(ModelViewProjection, 0);
+	const glm::vec4 Row1 = glm::row(ModelViewProjection, 1);
+	const glm::vec4 Row2 = glm::row(ModelViewProjection, 2);
+	const glm::vec4 Row3 = glm::row(ModelViewProjection, 3);
+
+	View.FrustumPlanes[0] = Row3 + Row0; // Esquerda
+	View.FrustumPlanes[1] = Row3 - Row0; // Direita
+	View.FrustumPlanes[2] = Row3 + Row1; // Baixo
+	View.FrustumPlanes[3] = Row3 - Row1; // Cima
+	View.FrustumPlanes[4] = Row3 + Row2; // Perto
+	View.FrustumPlanes[5] = Row3 - Row2; // Longe
+
+	for (glm::vec4& Plane : View.FrustumPlanes)
+	{
+		Plane /= glm::length(glm::vec3{ Plane });
+	}
+
+	// A origem da cmera levada de volta ao espao do objeto
+	View.CameraLocation = glm::vec3{ glm::inverse(ModelView) * glm::vec4{ 0.0f, 0.0f, 0.0f, 1.0f } };
+
+	return View;
+}
+
+DrawCommandBuilder::DrawCommandBuilder(WorkerPool& InPool)
+	: Pool(&InPool)
+{
+}
+
+int DrawCommandBuilder::GetNumThreads() const
+{
+	return Pool->GetNumThreads();
+}
+
+bool DrawCommandBuilder::IsVisible(const DrawBatchItem& Item, const DrawBatchView& View)
+{
+	for (const glm::vec4& Plane : View.FrustumPlanes)
+	{
+		if (glm::dot(glm::vec3{ Plane }, Item.Center) + Plane.w < -Item.Radius)
+		{
+			return false;
+		}
+	}
+
+	// De costas: para toda normal n do cone e todo ponto p da esfera, dot(n, p - cmera) > 0.
+	//	O menor dot(n, D) entre as normais do cone  |D| * cos(Theta + Alpha), onde Theta  o ngulo entre D e o eixo
+	const glm::vec3 ToCenter = Item.Center - View.CameraLocation;
+	const float Distance = glm::length(ToCenter);
+	if (Distance <= Item.Radius || Item.ConeSin >= 1.0f)
+	{
+		return true;
+	}
+
+	const float CosTheta = glm::dot(ToCenter, Item.ConeAxis) / Distance;
+	const float SinTheta = std::sqrt(std::max(0.0f, 1.0f - CosTheta * CosTheta));
+	const float ConeCos = std::sqrt(std::max(0.0f, 1.0f - Item.ConeSin * Item.ConeSin));
+	const float MinFacing = CosTheta * ConeCos - SinTheta * Item.ConeSin;
+
+	return Distance * MinFacing <= Item.Radius;
+}
+
+void DrawCommandBuilder::BuildRange(const std::vector<DrawBatchItem>& Items, const DrawBatchView& View, size_t Begin, size_t End, std::vector<DrawElementsIndirectCommand>& Commands) const
+{
+	for (size_t Index = Begin; Index < End; ++Index)
+	{
+		const DrawBatchItem& Item = Items[Index];
+		if (!IsVisible(Item, View))
+		{
+			continue;
+		}
+
+		DrawElementsIndirectCommand Command;
+		Command.Count = Item.IndexCount;
+		Command.InstanceCount = 1;
+		Command.FirstIndex = Item.FirstIndex;
+		Command.BaseVertex = Item.BaseVertex;
+		Command.BaseInstance = static_cast<GLuint>(Index);
+		Commands.push_back(Command);
+	}
+}
+
+void DrawCommandBuilder::Build(const std::vector<DrawBatchItem>& Items, const DrawBatchView& View, std::vector<DrawElementsIndirectCommand>& Commands)
+{
+	Commands.clear();
+
+	const size_t ItemCount = Items.size();
+	const size_t NumChunks = std::clamp<size_t>(ItemCount / std::max(1, MinItemsPerThread), 1, Pool->GetNumThreads());
+	if (NumChunks == 1)
+	{
+		BuildRange(Items, View, 0, ItemCount, Commands);
+		return;
+	}
+
+	// Cada thread descarta um bloco contguo em sua prpria lista (o primeiro vai direto para Commands); a concatenao
+	//	na ordem dos blocos mantm a ordem dos itens
+	ChunkCommands.resize(NumChunks);
+	Pool->ParallelFor(NumChunks, [&](size_t ChunkIndex)
+	{
+		std::vector<DrawElementsIndirectCommand>& Chunk = ChunkIndex == 0 ? Commands : ChunkCommands[ChunkIndex];
+		Chunk.clear();
+		BuildRange(Items, View, ItemCount * ChunkIndex / NumChunks, ItemCount * (ChunkIndex + 1) / NumChunks, Chunk);
+	});
+
+	for (size_t ChunkIndex = 1; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		Commands.insert(Commands.end(), ChunkCommands[ChunkIndex].begin(), ChunkCommands[ChunkIndex].end());
+	}
+}
+
+bool DrawBatcher::IsMultiDrawIndirectSupported()
+{
+	// O BaseInstance dos comandos s  respeitado com ARB_base_instance; a interface de recursos liga o bloco de storage
+	return GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_base_instance && GLEW_ARB_program_interface_query;
+}
+
+void DrawBatcher::Create(const std::vector<BatchDrawData>& InDrawData, bool bAllowMultiDrawIndirect)
+{
+	DrawData = InDrawData;
+	bUseMultiDrawIndirect = bAllowMultiDrawIndirect && IsMultiDrawIndirectSupported();
+	if (!bUseMultiDrawIndirect)
+	{
+		return;
+	}
+
+	GLStateCache& StateCache = GetGLStateCache();
+
+	glGenBuffers(1, &IndirectBuffer);
+	StateCache.BindBuffer(GL_DRAW_INDIRECT_BUFFER, IndirectBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, DrawData.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+
+	glGenBuffers(1, &DrawDataBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, DrawDataBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, DrawData.size() * sizeof(BatchDrawData), DrawData.data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PatchDrawDataBinding, DrawDataBuffer);
+
+	// ndices 0..N-1: com divisor 1 o atributo vale BaseInstance no draw, ou seja, o ndice dos dados do item
+	std::vector<GLuint> DrawIndices(DrawData.size());
+	for (size_t Index = 0; Index < DrawIndices.size(); ++Index)
+	{
+		DrawIndices[Index] = static_cast<GLuint>(Index);
+	}
+	glGenBuffers(1, &DrawIndexBuffer);
+	StateCache.BindBuffer(GL_ARRAY_BUFFER, DrawIndexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, DrawIndices.size() * sizeof(GLuint), DrawIndices.data(), GL_STATIC_DRAW);
+}
+
+bool DrawBatcher::IsUsingMultiDrawIndirect() const
+{
+	return bUseMultiDrawIndirect;
+}
+
+void DrawBatcher::SetupDrawIndexAttribute()
+{
+	if (!bUseMultiDrawIndirect)
+	{
+		return;
+	}
+
+	GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, DrawIndexBuffer);
+	glEnableVertexAttribArray(9);
+	glVertexAttribIPointer(9, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+	glVertexAttribDivisor(9, 1);
+}
+
+void DrawBatcher::Submit(const std::vector<DrawElementsIndirectCommand>& Commands, GLint DrawTintLocation)
+{
+	PROFILE_SCOPE("DrawBatcher::Submit");
+
+	if (Commands.empty())
+	{
+		return;
+	}
+
+	SubmittedBatches++;
+	SubmittedDraws += Commands.size();
+
+	if (bUseMultiDrawIndirect)
+	{
+		// Orphaning, como no buffer de instncias: os comandos do frame anterior podem ainda estar sendo lidos
+		GetGLStateCache().BindBuffer(GL_DRAW_INDIRECT_BUFFER, IndirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, DrawData.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, Commands.size() * sizeof(DrawElementsIndirectCommand), Commands.data());
+
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(Commands.size()), 0);
+		IssuedDrawCalls++;
+		for (const DrawElementsIndirectCommand& Command : Commands)
+		{
+			CountDraw(GL_TRIANGLES, static_cast<GLsizei>(Command.Count), static_cast<GLsizei>(Command.InstanceCount));
+		}
+		return;
+	}
+
+	// Os uniforms e draws de cada bloco contguo de comandos so gravados em paralelo e reproduzidos aqui, em ordem
+	const size_t MaxLists = static_cast<size_t>(GetWorkerPool().GetNumThreads());
+	const size_t NumLists = std::clamp(Commands.size() / static_cast<size_t>(std::max(1, MinDrawsPerList)), size_t(1), MaxLists);
+	CommandLists.resize(NumLists);
+
+	RecordCommandListsInParallel(CommandLists, [&](size_t List, CommandList& Output)
+	{
+		const size_t Begin = Commands.size() * List / NumLists;
+		const size_t End = Commands.size() * (List + 1) / NumLists;
+		for (size_t CommandIndex = Begin; CommandIndex < End; ++CommandIndex)
+		{
+			const DrawElementsIndirectCommand& Command = Commands[CommandIndex];
+			if (DrawTintLocation >= 0)
+			{
+				Output.SetUniform4f(DrawTintLocation, glm::value_ptr(DrawData[Command.BaseInstance].Tint));
+			}
+
+			DrawElementsArgs Args;
+			Args.Count = static_cast<GLsizei>(Command.Count);
+			Args.FirstIndex = Command.FirstIndex;
+			Args.BaseVertex = Command.BaseVertex;
+			Output.DrawElements(Args);
+		}
+	});
+
+	GLCommandBackend Backend;
+	ExecuteCommandLists(CommandLists, Backend);
+	IssuedDrawCalls += Commands.size();
+}
+
+void DrawBatcher::Release()
+{
+	GLStateCache& StateCache = GetGLStateCache();
+	for (GLuint* Buffer : { &IndirectBuffer, &DrawDataBuffer, &DrawIndexBuffer })
+	{
+		if (*Buffer != 0)
+		{
+			StateCache.OnBufferDeleted(*Buffer);
+			glDeleteBuffers(1, Buffer);
+			*Buffer = 0;
+		}
+	}
+}
+
+void DrawBatcher::PrintReport(std::ostream& Output) const
+{
+	const double DrawsPerBatch = SubmittedBatches > 0 ? static_cast<double>(SubmittedDraws) / SubmittedBatches : 0.0;
+
+	Output << "Lotes de desenho (" << (bUseMultiDrawIndirect ? "glMultiDrawElementsIndirect" : "glDrawElementsBaseVertex") << "): "
+		   << SubmittedBatches << " lotes, " << std::fixed << std::setprecision(1) << DrawsPerBatch << " draws visveis por lote de "
+		   << DrawData.size() << ", " << IssuedDrawCalls << " chamadas de desenho" << std::endl;
+}
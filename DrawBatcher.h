@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "CommandList.h"
+#include "WorkerPool.h"
+
+// Ponto de ligao do bloco de shader storage PatchDrawBuffer (dados de cada draw do lote)
+constexpr GLuint PatchDrawDataBinding = 2;
+
+// Comando de desenho no formato lido pelo glMultiDrawElementsIndirect (5 x uint32, sem padding)
+struct DrawElementsIndirectCommand
+{
+	GLuint Count = 0;
+	GLuint InstanceCount = 0;
+	GLuint FirstIndex = 0;
+	GLint BaseVertex = 0;
+	GLuint BaseInstance = 0; // ndice dos dados do draw: o atributo DrawIndex (divisor 1) comea nele
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "Layout do comando indireto diferente do esperado pelo OpenGL");
+
+// Trecho de malha que pode ser desenhado sozinho (um patch do globo ou qualquer malha do mesmo vertex/index buffer),
+//	com os volumes usados no descarte. Tudo no espao do objeto
+struct DrawBatchItem
+{
+	GLuint FirstIndex = 0;
+	GLuint IndexCount = 0;
+	GLint BaseVertex = 0; // Malhas diferentes no mesmo vertex buffer comeam em vrtices diferentes
+
+	glm::vec3 Center{ 0.0f }; // Esfera envolvente
+	float Radius = 0.0f;
+
+	glm::vec3 ConeAxis{ 0.0f, 0.0f, 1.0f }; // Cone que contm todas as normais do trecho
+	float ConeSin = 1.0f; // Seno do meio ngulo do cone (1 = normais em todas as direes, nunca descartado por estar de costas)
+};
+
+// Dados por draw no layout std430 do bloco PatchDrawBuffer (ou enviados como uniform no caminho sem draw indireto)
+struct BatchDrawData
+{
+	glm::vec4 Tint{ 1.0f };
+};
+
+// Cmera vista do espao do objeto: planos do frustum (normalizados, apontando para dentro) e posio do observador
+struct DrawBatchView
+{
+	glm::vec4 FrustumPlanes[6];
+	glm::vec3 CameraLocation{ 0.0f };
+
+	static DrawBatchView FromMatrices(const glm::mat4& ModelViewProjection, const glm::mat4& ModelView);
+};
+
+// Descarta os itens fora do frustum ou inteiramente de costas para a cmera e monta os comandos dos visveis, na ordem
+//	dos itens. No usa o OpenGL: pode ser chamado de qualquer thread e testado sem contexto.
+// Listas grandes so divididas em blocos contguos processados em paralelo nas threads do pool; o resultado  o mesmo
+//	com qualquer nmero de threads
+class DrawCommandBuilder
+{
+public:
+	explicit DrawCommandBuilder(WorkerPool& InPool = GetWorkerPool());
+
+	void Build(const std::vector<DrawBatchItem>& Items, const DrawBatchView& View, std::vector<DrawElementsIndirectCommand>& Commands);
+
+	static bool IsVisible(const DrawBatchItem& Item, const DrawBatchView& View);
+
+	int GetNumThreads() const;
+
+	// Abaixo disso por thread, acordar a thread do pool custa mais do que o descarte que ela faria
+	int MinItemsPerThread = 256;
+
+private:
+	void BuildRange(const std::vector<DrawBatchItem>& Items, const DrawBatchView& View, size_t Begin, size_t End, std::vector<DrawElementsIndirectCommand>& Commands) const;
+
+	WorkerPool* Pool = nullptr;
+	std::vector<std::vector<DrawElementsIndirectCommand>> ChunkCommands; // Reaproveitados entre frames
+};
+
+// Envia os comandos de um lote. Com ARB_multi_draw_indirect (e SSBOs) todo o lote  um nico glMultiDrawElementsIndirect,
+//	com os dados por draw em um shader storage buffer indexado pelo atributo DrawIndex (localizao 9).
+//	Em contextos sem as extenses, cada comando vira um glDrawElementsBaseVertex com os dados do draw em um uniform,
+//	gravados em listas de comandos (em paralelo quando o lote  grande) e reproduzidos na thread do contexto
+class DrawBatcher
+{
+public:
+	static bool IsMultiDrawIndirectSupported();
+
+	// Cria os buffers para at DrawData.size() draws por lote. bAllowMultiDrawIndirect = false fora o caminho alternativo
+	void Create(const std::vector<BatchDrawData>& InDrawData, bool bAllowMultiDrawIndirect);
+
+	bool IsUsingMultiDrawIndirect() const;
+
+	// Liga o buffer de ndices dos draws ao VAO ativo (localizao 9, divisor 1). S necessrio no caminho indireto
+	void SetupDrawIndexAttribute();
+
+	// Desenha os comandos com a malha do VAO ativo. DrawTintLocation  o uniform DrawTint, usado s no caminho alternativo
+	void Submit(const std::vector<DrawElementsIndirectCommand>& Commands, GLint DrawTintLocation);
+
+	void Release();
+
+	void PrintReport(std::ostream& Output) const;
+
+	// No caminho alternativo, abaixo disso por lista a gravao em paralelo no compensa criar a thread
+	int MinDrawsPerList = 512;
+
+private:
+	std::vector<BatchDrawData> DrawData;
+	std::vector<CommandList> CommandLists; // Caminho alternativo; reaproveitadas entre frames
+	bool bUseMultiDrawIndirect = false;
+
+	GLuint IndirectBuffer = 0;
+	GLuint DrawDataBuffer = 0;
+	GLuint DrawIndexBuffer = 0;
+
+	uint64_t SubmittedBatches = 0;
+	uint64_t SubmittedDraws = 0;
+	uint64_t IssuedDrawCalls = 0;
+};
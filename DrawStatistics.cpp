@@ -0,0 +1,22 @@
+#include "DrawStatistics.h"
+
+namespace
+{
+	DrawStatistics Accumulated;
+}
+
+void CountDraw(GLenum Mode, GLsizei Count, GLsizei InstanceCount)
+{
+	Accumulated.DrawCalls++;
+	if (Mode == GL_TRIANGLES && Count > 0 && InstanceCount > 0)
+	{
+		Accumulated.Triangles += static_cast<uint64_t>(Count / 3) * static_cast<uint64_t>(InstanceCount);
+	}
+}
+
+DrawStatistics TakeDrawStatistics()
+{
+	const DrawStatistics Statistics = Accumulated;
+	Accumulated = DrawStatistics{};
+	return Statistics;
+}
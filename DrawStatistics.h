@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GL/glew.h>
+
+// Draws e tringulos enviados ao OpenGL desde a ltima chamada a TakeDrawStatistics, somados por todos os pontos de
+//	desenho (globo, patches, corpos instanciados, listas de comandos, HUD). S a thread dona do contexto desenha, ento
+//	os contadores no so sincronizados
+struct DrawStatistics
+{
+	uint64_t DrawCalls = 0;
+	uint64_t Triangles = 0;
+};
+
+// Um draw de Count ndices ou vrtices com InstanceCount instncias. S GL_TRIANGLES soma tringulos
+void CountDraw(GLenum Mode, GLsizei Count, GLsizei InstanceCount = 1);
+
+// Retorna os contadores acumulados e os zera (uma vez por frame)
+DrawStatistics TakeDrawStatistics();
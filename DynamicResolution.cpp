@@ -0,0 +1,183 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSettings& InSettings)
+	: Settings{ InSettings }
+	, Scale{ InSettings.MaxScale }
+{
+}
+
+float DynamicResolutionController::Update(double GpuSeconds)
+{
+	Frames++;
+	ScaleSum += Scale;
+	if (GpuSeconds > Settings.TargetSeconds)
+	{
+		OverBudgetFrames++;
+	}
+
+	SmoothedSeconds = bHasSample ? SmoothedSeconds + (GpuSeconds - SmoothedSeconds) * Settings.Smoothing : GpuSeconds;
+	bHasSample = true;
+
+	if (++FramesSinceChange < Settings.CooldownFrames || SmoothedSeconds <= 0.0)
+	{
+		return Scale;
+	}
+
+	// Fora da faixa, a escala vai para onde o tempo estimado (proporcional  rea) cai no meio dela
+	const double GoalSeconds = Settings.TargetSeconds * (Settings.LowerThreshold + Settings.UpperThreshold) * 0.5;
+	const float IdealScale = Scale * static_cast<float>(std::sqrt(GoalSeconds / SmoothedSeconds));
+
+	float NewScale = Scale;
+	if (SmoothedSeconds > Settings.TargetSeconds * Settings.UpperThreshold)
+	{
+		NewScale = std::max(IdealScale, Scale - Settings.MaxStepDown);
+	}
+	else if (SmoothedSeconds < Settings.TargetSeconds * Settings.LowerThreshold)
+	{
+		NewScale = std::min(IdealScale, Scale + Settings.MaxStepUp);
+	}
+
+	// Passos de 1%: mudanas menores no aparecem na imagem e s gastariam o intervalo entre ajustes
+	NewScale = std::round(std::clamp(NewScale, Settings.MinScale, Settings.MaxScale) * 100.0f) / 100.0f;
+	if (std::abs(NewScale - Scale) < 0.005f)
+	{
+		return Scale;
+	}
+
+	// At as medidas da nova escala chegarem, a mdia  a estimativa para a nova rea
+	SmoothedSeconds *= (NewScale / Scale) * (NewScale / Scale);
+	NewScale > Scale ? Increases++ : Decreases++;
+	Scale = NewScale;
+	FramesSinceChange = 0;
+	return Scale;
+}
+
+float DynamicResolutionController::GetScale() const
+{
+	return Scale;
+}
+
+double DynamicResolutionController::GetSmoothedSeconds() const
+{
+	return SmoothedSeconds;
+}
+
+const DynamicResolutionSettings& DynamicResolutionController::GetSettings() const
+{
+	return Settings;
+}
+
+void DynamicResolutionController::PrintReport(std::ostream& Output) const
+{
+	const double AverageScale = Frames > 0 ? ScaleSum / Frames : Scale;
+	const double OverBudget = Frames > 0 ? OverBudgetFrames * 100.0 / Frames : 0.0;
+	Output << "Resoluo dinmica (oramento de " << std::fixed << std::setprecision(1) << Settings.TargetSeconds * 1000.0
+		   << " ms): " << Frames << " frames medidos, escala mdia " << std::setprecision(2) << AverageScale << ", atual "
+		   << Scale << ", " << std::setprecision(1) << OverBudget << "% acima do oramento, " << Decreases << " redues e "
+		   << Increases << " aumentos" << std::defaultfloat << std::endl;
+}
+
+void GpuTimer::Create(int NumQueries)
+{
+	Queries.resize(std::max(NumQueries, 1));
+	glGenQueries(static_cast<GLsizei>(Queries.size()), Queries.data());
+}
+
+void GpuTimer::Begin()
+{
+	bActive = Pending < Queries.size();
+	if (bActive)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, Queries[(Oldest + Pending) % Queries.size()]);
+	}
+}
+
+void GpuTimer::End()
+{
+	if (bActive)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		Pending++;
+		bActive = false;
+	}
+}
+
+bool GpuTimer::ReadResult(double& OutSeconds)
+{
+	bool bHasResult = false;
+	while (Pending > 0)
+	{
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(Queries[Oldest], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (!bAvailable)
+		{
+			break;
+		}
+
+		GLuint64 Nanoseconds = 0;
+		glGetQueryObjectui64v(Queries[Oldest], GL_QUERY_RESULT, &Nanoseconds);
+		OutSeconds = Nanoseconds * 1.0e-9;
+		bHasResult = true;
+
+		Oldest = (Oldest + 1) % Queries.size();
+		Pending--;
+	}
+	return bHasResult;
+}
+
+void GpuTimer::Release()
+{
+	if (!Queries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(Queries.size()), Queries.data());
+		Queries.clear();
+	}
+	Oldest = 0;
+	Pending = 0;
+}
+
+bool ReplayResolutionTrace(std::istream& Trace, const DynamicResolutionSettings& Settings, std::ostream& Report)
+{
+	DynamicResolutionController Controller{ Settings };
+
+	size_t Frame = 0;
+	for (std::string Line; std::getline(Trace, Line);)
+	{
+		Line = Line.substr(0, Line.find('#'));
+
+		std::istringstream Stream(Line);
+		double FullMilliseconds = 0.0;
+		if (!(Stream >> FullMilliseconds))
+		{
+			continue;
+		}
+
+		const float Scale = Controller.GetScale();
+		const double GpuSeconds = FullMilliseconds * 1.0e-3 * Scale * Scale;
+		const float NewScale = Controller.Update(GpuSeconds);
+		if (NewScale != Scale)
+		{
+			Report << "  frame " << Frame << ": " << std::fixed << std::setprecision(2) << GpuSeconds * 1000.0 << " ms (mdia "
+				   << Controller.GetSmoothedSeconds() * 1000.0 << " ms), escala " << Scale << " -> " << NewScale
+				   << std::defaultfloat << std::endl;
+		}
+		Frame++;
+	}
+
+	if (Frame == 0)
+	{
+		Report << "Trace sem nenhum tempo de frame" << std::endl;
+		return false;
+	}
+
+	Controller.PrintReport(Report);
+	return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include <GL/glew.h>
+
+struct DynamicResolutionSettings
+{
+	double TargetSeconds = 0.014; // Oramento de GPU da cena; o restante do frame fica para a ampliao e o HUD
+
+	float MinScale = 0.5f;
+	float MaxScale = 1.0f;
+
+	// Histerese: a escala s diminui acima de UpperThreshold x oramento e s aumenta abaixo de LowerThreshold x
+	//	oramento. Cada mudana mira o meio da faixa, ento uma variao pequena do tempo no a desfaz
+	double LowerThreshold = 0.8;
+	double UpperThreshold = 1.0;
+
+	// Reduzir rpido e aumentar devagar: um frame lento  pior que alguns frames com resoluo menor que o possvel
+	float MaxStepUp = 0.05f;
+	float MaxStepDown = 0.2f;
+
+	// Frames sem mudana depois de cada ajuste (os tempos medidos chegam com alguns frames de atraso)
+	int CooldownFrames = 10;
+
+	// Peso da amostra nova na mdia mvel exponencial do tempo de GPU
+	double Smoothing = 0.25;
+};
+
+// Escolhe a escala da resoluo da cena a partir dos tempos de GPU medidos, supondo custo proporcional  rea
+//	(escala ao quadrado). No usa o OpenGL: pode ser alimentado por traces sintticos (ReplayResolutionTrace)
+class DynamicResolutionController
+{
+public:
+	explicit DynamicResolutionController(const DynamicResolutionSettings& InSettings = {});
+
+	// Recebe o tempo de GPU de um frame desenhado com a escala atual e retorna a escala dos prximos frames
+	float Update(double GpuSeconds);
+
+	float GetScale() const;
+	double GetSmoothedSeconds() const;
+	const DynamicResolutionSettings& GetSettings() const;
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	DynamicResolutionSettings Settings;
+
+	float Scale = 1.0f;
+	double SmoothedSeconds = 0.0;
+	bool bHasSample = false;
+	int FramesSinceChange = 0;
+
+	uint64_t Frames = 0;
+	uint64_t OverBudgetFrames = 0;
+	uint64_t Increases = 0;
+	uint64_t Decreases = 0;
+	double ScaleSum = 0.0;
+};
+
+// Mede o tempo de GPU entre Begin e End com GL_TIME_ELAPSED. As consultas ficam em um anel e o resultado  lido
+//	alguns frames depois, quando j est disponvel: ler na hora faria a CPU esperar a GPU terminar o frame
+class GpuTimer
+{
+public:
+	void Create(int NumQueries = 4);
+
+	// Com todas as consultas ainda em andamento, o frame no  medido
+	void Begin();
+	void End();
+
+	// Tempo da medida mais recente j disponvel, se alguma terminou desde a chamada anterior
+	bool ReadResult(double& OutSeconds);
+
+	void Release();
+
+private:
+	std::vector<GLuint> Queries;
+	size_t Oldest = 0;
+	size_t Pending = 0;
+	bool bActive = false;
+};
+
+// Reproduz um trace sinttico sem GPU: cada linha  o tempo de GPU da cena em milissegundos na escala 1 ('#' inicia
+//	comentrio). O tempo medido em cada frame  o do trace multiplicado pela rea da escala escolhida pelo controlador
+bool ReplayResolutionTrace(std::istream& Trace, const DynamicResolutionSettings& Settings, std::ostream& Report);
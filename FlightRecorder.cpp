@@ -0,0 +1,155 @@
+#include "FlightRecorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "Profiler.h"
+
+namespace
+{
+	// Trilha do trace com um evento por frame (fora da faixa das trilhas do profiler)
+	constexpr int FramesTrackId = 100000;
+}
+
+FlightRecorder::FlightRecorder(const FlightRecorderSettings& InSettings)
+	: Settings(InSettings)
+{
+	Settings.FramesAfterHitch = std::max(0, Settings.FramesAfterHitch);
+}
+
+void FlightRecorder::SetSnapshotWriter(const std::function<void(std::ostream&)>& InWriteSnapshot)
+{
+	WriteSnapshot = InWriteSnapshot;
+}
+
+void FlightRecorder::EndFrame(const FlightRecorderFrame& Frame)
+{
+	const uint64_t Now = GetProfiler().Now();
+
+	GetProfiler().ConsumeEvents([this](int TrackId, const char* Name, uint64_t StartNanoseconds, uint64_t DurationNanoseconds)
+	{
+		Events.push_back({ TrackId, Name, StartNanoseconds, DurationNanoseconds });
+	});
+
+	StoredFrame Stored;
+	Stored.Frame = Frame;
+	Stored.EndNanoseconds = Now;
+	Frames.push_back(Stored);
+
+	// Os eventos chegam em ordem por trilha, mas no entre trilhas (os da GPU chegam frames depois): a frente da fila 
+	//	descartada enquanto for mais velha que a janela, e o resto sai nas prximas chamadas
+	const uint64_t WindowNanoseconds = static_cast<uint64_t>(Settings.WindowSeconds * 1e9);
+	const uint64_t Oldest = Now > WindowNanoseconds ? Now - WindowNanoseconds : 0;
+	while (!Events.empty() && Events.front().StartNanoseconds + Events.front().DurationNanoseconds < Oldest)
+	{
+		Events.pop_front();
+	}
+	while (!Frames.empty() && Frames.front().EndNanoseconds < Oldest)
+	{
+		Frames.pop_front();
+	}
+	MaxStoredEvents = std::max(MaxStoredEvents, Events.size());
+
+	if (Frame.FrameSeconds > Settings.HitchSeconds)
+	{
+		Hitches++;
+		WorstHitchSeconds = std::max(WorstHitchSeconds, Frame.FrameSeconds);
+
+		const bool bCoolingDown = bHasDumped && (Now - LastDumpNanoseconds) * 1e-9 < Settings.CooldownSeconds;
+		if (bDumpPending || bCoolingDown)
+		{
+			SuppressedHitches++;
+		}
+		else
+		{
+			// O estado da memria  o do frame do engasgo, no o do momento da gravao
+			bDumpPending = true;
+			FramesUntilDump = Settings.FramesAfterHitch;
+			HitchFrame = Stored;
+			std::ostringstream Snapshot;
+			if (WriteSnapshot)
+			{
+				WriteSnapshot(Snapshot);
+			}
+			HitchSnapshot = Snapshot.str();
+		}
+	}
+
+	if (bDumpPending && FramesUntilDump-- <= 0)
+	{
+		Dump();
+		bDumpPending = false;
+		bHasDumped = true;
+		LastDumpNanoseconds = Now;
+	}
+}
+
+void FlightRecorder::Dump()
+{
+	PROFILE_SCOPE("FlightRecorder::Dump");
+
+	const std::string BaseName = Settings.OutputPrefix + "_" + std::to_string(HitchFrame.Frame.Index);
+	const double HitchMilliseconds = HitchFrame.Frame.FrameSeconds * 1000.0;
+
+	std::ofstream Trace{ BaseName + ".json" };
+	if (!Trace)
+	{
+		std::cout << "Erro ao criar " << BaseName << ".json" << std::endl;
+		return;
+	}
+
+	const std::vector<ProfileTrackInfo> Tracks = GetProfiler().GetTracks();
+
+	Trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+	bool bFirst = true;
+	for (const ProfileTrackInfo& Track : Tracks)
+	{
+		WriteChromeTraceThreadName(Trace, Track.Id, Track.Name, bFirst);
+		bFirst = false;
+	}
+	WriteChromeTraceThreadName(Trace, FramesTrackId, "Frames", bFirst);
+
+	for (const StoredEvent& Event : Events)
+	{
+		const bool bGpu = Event.TrackId < static_cast<int>(Tracks.size()) && !Tracks[Event.TrackId].bThreadTrack;
+		WriteChromeTraceEvent(Trace, Event.Name, bGpu ? "gpu" : "cpu", Event.TrackId, Event.StartNanoseconds, Event.DurationNanoseconds);
+	}
+
+	// Cada frame vira um intervalo na trilha "Frames" (terminando na apresentao) e uma amostra dos contadores
+	Trace << std::fixed << std::setprecision(3);
+	for (const StoredFrame& Stored : Frames)
+	{
+		const FlightRecorderFrame& Frame = Stored.Frame;
+		const uint64_t Duration = static_cast<uint64_t>(Frame.FrameSeconds * 1e9);
+		const std::string Name = "Frame " + std::to_string(Frame.Index) + (Frame.Index == HitchFrame.Frame.Index ? " (engasgo)" : "");
+		WriteChromeTraceEvent(Trace, Name.c_str(), "frame", FramesTrackId, Stored.EndNanoseconds - std::min(Duration, Stored.EndNanoseconds), Duration);
+
+		Trace << std::fixed << std::setprecision(3) << ",\n{\"name\":\"Contadores\",\"ph\":\"C\",\"pid\":1,\"ts\":" << Stored.EndNanoseconds / 1000.0
+			  << ",\"args\":{\"frame_ms\":" << Frame.FrameSeconds * 1000.0 << ",\"cpu_ms\":" << Frame.CpuSeconds * 1000.0
+			  << ",\"draw_calls\":" << Frame.DrawCalls << ",\"triangles\":" << Frame.Triangles << ",\"gl_state_calls\":" << Frame.GLStateCalls
+			  << ",\"resident_mb\":" << Frame.ResidentBytes / (1024.0 * 1024.0) << "}}";
+	}
+	Trace << ",\n{\"name\":\"Engasgo\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":" << FramesTrackId << ",\"ts\":" << HitchFrame.EndNanoseconds / 1000.0
+		  << ",\"args\":{\"frame_ms\":" << HitchMilliseconds << "}}" << std::endl << "]}" << std::endl;
+
+	std::ofstream Snapshot{ BaseName + ".txt" };
+	Snapshot << "Engasgo de " << std::fixed << std::setprecision(2) << HitchMilliseconds << " ms no frame " << HitchFrame.Frame.Index
+			 << " (limite " << Settings.HitchSeconds * 1000.0 << " ms)" << std::defaultfloat << std::endl << HitchSnapshot;
+
+	Dumps++;
+	std::cout << "Engasgo de " << std::fixed << std::setprecision(1) << HitchMilliseconds << " ms no frame " << HitchFrame.Frame.Index
+			  << ": " << Events.size() << " eventos e " << Frames.size() << " frames gravados em " << BaseName << ".json e .txt"
+			  << std::defaultfloat << std::endl;
+}
+
+void FlightRecorder::PrintReport(std::ostream& Output) const
+{
+	Output << "Gravador de engasgos: " << Hitches << " frames acima de " << Settings.HitchSeconds * 1000.0 << " ms (pior "
+		   << std::fixed << std::setprecision(1) << WorstHitchSeconds * 1000.0 << " ms), " << Dumps << " gravaes, "
+		   << SuppressedHitches << " ignorados no intervalo de " << std::setprecision(0) << Settings.CooldownSeconds
+		   << " s entre gravaes, at " << MaxStoredEvents << " eventos em memria (janela de " << std::setprecision(1)
+		   << Settings.WindowSeconds << " s)" << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+struct FlightRecorderSettings
+{
+	double WindowSeconds = 5.0; // Quanto do passado fica em memria e vai para o arquivo
+	double HitchSeconds = 0.05; // Frame mais longo que isso  um engasgo
+	double CooldownSeconds = 30.0; // Sem novas gravaes depois de uma, para que uma sequncia de engasgos no vire uma enxurrada de arquivos
+	int FramesAfterHitch = 3; // A gravao espera alguns frames: os tempos de GPU chegam atrasados e o frame seguinte mostra a recuperao
+	std::string OutputPrefix = "hitch";
+};
+
+// Medidas de um frame guardadas pelo gravador, alm dos eventos do profiler
+struct FlightRecorderFrame
+{
+	uint64_t Index = 0;
+	double FrameSeconds = 0.0;
+	double CpuSeconds = 0.0;
+	uint64_t DrawCalls = 0;
+	uint64_t Triangles = 0;
+	uint64_t GLStateCalls = 0; // Chamadas de estado enviadas ao driver pelo GLStateCache neste frame
+	size_t ResidentBytes = 0;
+};
+
+// Gravador contnuo ("caixa-preta") para engasgos raros: com o profiler sempre gravando, mantm os eventos dos ltimos
+//	WindowSeconds e os contadores de cada frame. Um frame acima de HitchSeconds grava <prefixo>_<frame>.json (trace do
+//	Chrome com os eventos, os contadores e o frame marcado) e <prefixo>_<frame>.txt com o estado da memria no momento
+//	do engasgo. Deve ser chamado sempre da mesma thread (a que apresenta os frames)
+class FlightRecorder
+{
+public:
+	explicit FlightRecorder(const FlightRecorderSettings& InSettings = {});
+
+	// Escreve o estado da memria e da residncia das texturas; chamado no frame do engasgo
+	void SetSnapshotWriter(const std::function<void(std::ostream&)>& InWriteSnapshot);
+
+	// Uma vez por frame, depois da apresentao: recolhe os eventos novos do profiler, descarta o que saiu da janela e
+	//	grava os arquivos quando chega a hora
+	void EndFrame(const FlightRecorderFrame& Frame);
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	struct StoredEvent
+	{
+		int TrackId = 0;
+		const char* Name = nullptr;
+		uint64_t StartNanoseconds = 0;
+		uint64_t DurationNanoseconds = 0;
+	};
+
+	struct StoredFrame
+	{
+		FlightRecorderFrame Frame;
+		uint64_t EndNanoseconds = 0;
+	};
+
+	void Dump();
+
+	FlightRecorderSettings Settings;
+	std::function<void(std::ostream&)> WriteSnapshot;
+
+	std::deque<StoredEvent> Events;
+	std::deque<StoredFrame> Frames;
+
+	// Engasgo aguardando a gravao
+	bool bDumpPending = false;
+	int FramesUntilDump = 0;
+	StoredFrame HitchFrame;
+	std::string HitchSnapshot;
+
+	bool bHasDumped = false;
+	uint64_t LastDumpNanoseconds = 0;
+
+	uint64_t Hitches = 0;
+	uint64_t Dumps = 0;
+	uint64_t SuppressedHitches = 0;
+	double WorstHitchSeconds = 0.0;
+	size_t MaxStoredEvents = 0;
+};
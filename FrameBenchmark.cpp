@@ -0,0 +1,346 @@
+#include "FrameBenchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+#include <glm/ext.hpp>
+
+namespace
+{
+	glm::vec3 CatmullRom(const glm::vec3& P0, const glm::vec3& P1, const glm::vec3& P2, const glm::vec3& P3, float U)
+	{
+		const float U2 = U * U;
+		const float U3 = U2 * U;
+		return 0.5f * (2.0f * P1 + (P2 - P0) * U + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * U2 + (3.0f * P1 - P0 - 3.0f * P2 + P3) * U3);
+	}
+
+	// Mesmo critrio de LatencyHistogram: a amostra na posio Percentile% da lista ordenada
+	double GetPercentile(std::vector<double> Samples, double Percentile)
+	{
+		if (Samples.empty())
+		{
+			return 0.0;
+		}
+
+		const size_t Index = std::min(Samples.size() - 1, static_cast<size_t>(Percentile / 100.0 * Samples.size()));
+		std::nth_element(Samples.begin(), Samples.begin() + Index, Samples.end());
+		return Samples[Index];
+	}
+}
+
+bool CameraPath::Load(std::istream& Input)
+{
+	Keyframes.clear();
+
+	std::string Line;
+	int LineNumber = 0;
+	while (std::getline(Input, Line))
+	{
+		LineNumber++;
+		Line = Line.substr(0, Line.find('#'));
+		if (Line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::istringstream Fields{ Line };
+		CameraKeyframe Keyframe;
+		if (!(Fields >> Keyframe.Time
+			  >> Keyframe.Location.x >> Keyframe.Location.y >> Keyframe.Location.z
+			  >> Keyframe.Direction.x >> Keyframe.Direction.y >> Keyframe.Direction.z
+			  >> Keyframe.Up.x >> Keyframe.Up.y >> Keyframe.Up.z))
+		{
+			std::cout << "Caminho da cmera: linha " << LineNumber << " invlida (esperado: tempo lx ly lz dx dy dz ux uy uz)" << std::endl;
+			return false;
+		}
+		if (!Keyframes.empty() && Keyframe.Time <= Keyframes.back().Time)
+		{
+			std::cout << "Caminho da cmera: o tempo da linha " << LineNumber << " no  maior que o do keyframe anterior" << std::endl;
+			return false;
+		}
+		if (glm::length(Keyframe.Direction) == 0.0f || glm::length(glm::cross(Keyframe.Direction, Keyframe.Up)) == 0.0f)
+		{
+			std::cout << "Caminho da cmera: direo nula ou paralela ao up na linha " << LineNumber << std::endl;
+			return false;
+		}
+
+		AddKeyframe(Keyframe);
+	}
+
+	if (Keyframes.empty())
+	{
+		std::cout << "Caminho da cmera sem keyframes" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+CameraPath CameraPath::MakeDefaultOrbit()
+{
+	// Uma volta completa em 24 s, descendo de 3.5 para 1.8 raios do centro no meio do caminho e oscilando em latitude
+	CameraPath Orbit;
+	constexpr int NumKeyframes = 13;
+	for (int Index = 0; Index < NumKeyframes; ++Index)
+	{
+		const float Fraction = static_cast<float>(Index) / (NumKeyframes - 1);
+		const float Angle = glm::two_pi<float>() * Fraction;
+		const float Distance = 3.5f - 1.7f * glm::sin(glm::pi<float>() * Fraction);
+
+		CameraKeyframe Keyframe;
+		Keyframe.Time = 2.0 * Index;
+		Keyframe.Location = glm::vec3{ glm::sin(Angle), 0.4f * glm::sin(2.0f * Angle), glm::cos(Angle) } * Distance;
+		Keyframe.Direction = glm::normalize(-Keyframe.Location);
+		Keyframe.Up = glm::vec3{ 0.0f, 1.0f, 0.0f };
+		Orbit.AddKeyframe(Keyframe);
+	}
+	return Orbit;
+}
+
+void CameraPath::AddKeyframe(const CameraKeyframe& Keyframe)
+{
+	Keyframes.push_back(Keyframe);
+}
+
+size_t CameraPath::GetNumKeyframes() const
+{
+	return Keyframes.size();
+}
+
+double CameraPath::GetDuration() const
+{
+	return Keyframes.empty() ? 0.0 : Keyframes.back().Time - Keyframes.front().Time;
+}
+
+void CameraPath::Evaluate(double Time, SimpleCamera& Camera) const
+{
+	if (Keyframes.empty())
+	{
+		return;
+	}
+
+	// Trecho entre os keyframes Segment e Segment + 1; nas pontas o keyframe vizinho que falta  repetido
+	const double PathTime = Keyframes.front().Time + std::clamp(Time, 0.0, GetDuration());
+	const size_t Last = Keyframes.size() - 1;
+	size_t Segment = 0;
+	while (Segment + 1 < Last && Keyframes[Segment + 1].Time <= PathTime)
+	{
+		Segment++;
+	}
+
+	const CameraKeyframe& K0 = Keyframes[Segment > 0 ? Segment - 1 : 0];
+	const CameraKeyframe& K1 = Keyframes[Segment];
+	const CameraKeyframe& K2 = Keyframes[std::min(Segment + 1, Last)];
+	const CameraKeyframe& K3 = Keyframes[std::min(Segment + 2, Last)];
+
+	const double SegmentSeconds = K2.Time - K1.Time;
+	const float U = SegmentSeconds > 0.0 ? static_cast<float>(std::clamp((PathTime - K1.Time) / SegmentSeconds, 0.0, 1.0)) : 0.0f;
+
+	Camera.Location = CatmullRom(K0.Location, K1.Location, K2.Location, K3.Location, U);
+
+	const glm::vec3 Direction = CatmullRom(K0.Direction, K1.Direction, K2.Direction, K3.Direction, U);
+	const glm::vec3 Up = CatmullRom(K0.Up, K1.Up, K2.Up, K3.Up, U);
+	Camera.Direction = glm::length(Direction) > 0.0f ? glm::normalize(Direction) : K1.Direction;
+	Camera.Up = glm::normalize(Up - Camera.Direction * glm::dot(Up, Camera.Direction));
+}
+
+FrameBenchmark::FrameBenchmark(const CameraPath& InPath, const FrameBenchmarkSettings& InSettings)
+	: Path(InPath)
+	, Settings(InSettings)
+{
+	Settings.WarmupFrames = std::max(0, Settings.WarmupFrames);
+	Settings.MeasuredFrames = std::max(1, Settings.MeasuredFrames);
+}
+
+bool FrameBenchmark::IsWarmingUp() const
+{
+	return Frame < Settings.WarmupFrames;
+}
+
+bool FrameBenchmark::IsFinished() const
+{
+	return Frame >= Settings.WarmupFrames + Settings.MeasuredFrames;
+}
+
+double FrameBenchmark::GetPathTime() const
+{
+	if (IsWarmingUp() || Settings.MeasuredFrames < 2)
+	{
+		return 0.0;
+	}
+
+	const int MeasuredFrame = std::min(Frame - Settings.WarmupFrames, Settings.MeasuredFrames - 1);
+	return Path.GetDuration() * MeasuredFrame / (Settings.MeasuredFrames - 1);
+}
+
+const CameraPath& FrameBenchmark::GetPath() const
+{
+	return Path;
+}
+
+void FrameBenchmark::RecordFrame(const FrameBenchmarkSample& Sample)
+{
+	if (IsFinished())
+	{
+		return;
+	}
+
+	if (!IsWarmingUp())
+	{
+		CpuMilliseconds.push_back(Sample.CpuSeconds * 1000.0);
+		FrameMilliseconds.push_back(Sample.FrameSeconds * 1000.0);
+		if (Sample.GpuSeconds >= 0.0)
+		{
+			GpuMilliseconds.push_back(Sample.GpuSeconds * 1000.0);
+		}
+		DrawCalls.push_back(static_cast<double>(Sample.DrawCalls));
+		Triangles.push_back(static_cast<double>(Sample.Triangles));
+	}
+	Frame++;
+}
+
+std::vector<FrameBenchmark::MetricSummary> FrameBenchmark::Summarize() const
+{
+	const std::pair<const char*, const std::vector<double>*> Metrics[] =
+	{
+		{ "cpu_ms", &CpuMilliseconds },
+		{ "frame_ms", &FrameMilliseconds },
+		{ "gpu_ms", &GpuMilliseconds },
+		{ "draw_calls", &DrawCalls },
+		{ "triangles", &Triangles },
+	};
+
+	std::vector<MetricSummary> Summaries;
+	for (const auto& [Name, Samples] : Metrics)
+	{
+		MetricSummary Summary;
+		Summary.Name = Name;
+		Summary.Count = Samples->size();
+		if (!Samples->empty())
+		{
+			Summary.P50 = GetPercentile(*Samples, 50.0);
+			Summary.P95 = GetPercentile(*Samples, 95.0);
+			Summary.P99 = GetPercentile(*Samples, 99.0);
+			Summary.Max = *std::max_element(Samples->begin(), Samples->end());
+			Summary.Mean = std::accumulate(Samples->begin(), Samples->end(), 0.0) / Samples->size();
+		}
+		Summaries.push_back(Summary);
+	}
+	return Summaries;
+}
+
+bool FrameBenchmark::WriteCsv(const std::string& FileName) const
+{
+	std::ofstream Output{ FileName };
+	if (!Output)
+	{
+		std::cout << "Erro ao criar " << FileName << std::endl;
+		return false;
+	}
+
+	Output << "metric,count,p50,p95,p99,max,mean" << std::endl;
+	Output << std::fixed << std::setprecision(4);
+	for (const MetricSummary& Summary : Summarize())
+	{
+		Output << Summary.Name << "," << Summary.Count << "," << Summary.P50 << "," << Summary.P95 << "," << Summary.P99 << ","
+			   << Summary.Max << "," << Summary.Mean << std::endl;
+	}
+	return true;
+}
+
+bool FrameBenchmark::WriteJson(const std::string& FileName) const
+{
+	std::ofstream Output{ FileName };
+	if (!Output)
+	{
+		std::cout << "Erro ao criar " << FileName << std::endl;
+		return false;
+	}
+
+	Output << "{" << std::endl
+		   << "  \"warmup_frames\": " << Settings.WarmupFrames << "," << std::endl
+		   << "  \"measured_frames\": " << Settings.MeasuredFrames << "," << std::endl
+		   << "  \"path_keyframes\": " << Path.GetNumKeyframes() << "," << std::endl
+		   << "  \"path_seconds\": " << Path.GetDuration() << "," << std::endl
+		   << "  \"metrics\": {" << std::endl;
+
+	Output << std::fixed << std::setprecision(4);
+	const std::vector<MetricSummary> Summaries = Summarize();
+	for (size_t Index = 0; Index < Summaries.size(); ++Index)
+	{
+		const MetricSummary& Summary = Summaries[Index];
+		Output << "    \"" << Summary.Name << "\": { \"count\": " << Summary.Count << ", \"p50\": " << Summary.P50
+			   << ", \"p95\": " << Summary.P95 << ", \"p99\": " << Summary.P99 << ", \"max\": " << Summary.Max
+			   << ", \"mean\": " << Summary.Mean << " }" << (Index + 1 < Summaries.size() ? "," : "") << std::endl;
+	}
+
+	Output << "  }" << std::endl << "}" << std::endl;
+	return true;
+}
+
+bool FrameBenchmark::CompareWithBaseline(std::istream& Baseline, std::ostream& Report) const
+{
+	// p50 e p95 de cada mtrica do baseline, pelo nome
+	std::map<std::string, std::pair<double, double>> BaselineValues;
+	std::string Line;
+	while (std::getline(Baseline, Line))
+	{
+		std::istringstream Fields{ Line };
+		std::string Name, Count, P50, P95;
+		if (std::getline(Fields, Name, ',') && std::getline(Fields, Count, ',') && std::getline(Fields, P50, ',') &&
+			std::getline(Fields, P95, ',') && Name != "metric")
+		{
+			BaselineValues[Name] = { std::atof(P50.c_str()), std::atof(P95.c_str()) };
+		}
+	}
+
+	bool bPassed = true;
+	Report << "Comparao com o baseline (limite +" << std::fixed << std::setprecision(1) << Settings.RegressionThreshold * 100.0 << "%)" << std::endl;
+	for (const MetricSummary& Summary : Summarize())
+	{
+		const auto Found = BaselineValues.find(Summary.Name);
+		if (Summary.Count == 0 || Found == BaselineValues.end())
+		{
+			Report << "  " << Summary.Name << ": sem " << (Summary.Count == 0 ? "amostras" : "baseline") << std::endl;
+			continue;
+		}
+
+		Report << "  " << std::left << std::setw(12) << Summary.Name << std::right;
+		const std::pair<double, double> Current{ Summary.P50, Summary.P95 };
+		const std::pair<double, double> Reference = Found->second;
+		bool bRegressed = false;
+		for (int Percentile = 0; Percentile < 2; ++Percentile)
+		{
+			const double Value = Percentile == 0 ? Current.first : Current.second;
+			const double BaselineValue = Percentile == 0 ? Reference.first : Reference.second;
+			const double Change = BaselineValue > 0.0 ? Value / BaselineValue - 1.0 : 0.0;
+			bRegressed = bRegressed || Change > Settings.RegressionThreshold;
+
+			Report << (Percentile == 0 ? "  p50 " : "  p95 ") << std::setprecision(3) << Value << " (baseline " << BaselineValue
+				   << ", " << std::showpos << std::setprecision(1) << Change * 100.0 << "%" << std::noshowpos << ")";
+		}
+		Report << (bRegressed ? "  REGRESSO" : "") << std::endl;
+		bPassed = bPassed && !bRegressed;
+	}
+	Report << std::defaultfloat;
+	return bPassed;
+}
+
+void FrameBenchmark::PrintReport(std::ostream& Output) const
+{
+	Output << "Benchmark de frames: " << Settings.MeasuredFrames << " frames medidos depois de " << Settings.WarmupFrames
+		   << " de aquecimento, caminho da cmera de " << Path.GetNumKeyframes() << " keyframes (" << Path.GetDuration() << " s)" << std::endl;
+	Output << "  mtrica      amostras        p50        p95        p99        mx      mdia" << std::endl;
+	for (const MetricSummary& Summary : Summarize())
+	{
+		Output << std::fixed << std::setprecision(3) << "  " << std::left << std::setw(10) << Summary.Name << std::right
+			   << "  " << std::setw(10) << Summary.Count << " " << std::setw(10) << Summary.P50 << " " << std::setw(10) << Summary.P95
+			   << " " << std::setw(10) << Summary.P99 << " " << std::setw(10) << Summary.Max << " " << std::setw(10) << Summary.Mean
+			   << std::defaultfloat << std::endl;
+	}
+}
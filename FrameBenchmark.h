@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+
+struct CameraKeyframe
+{
+	double Time = 0.0; // Segundos desde o incio do caminho
+	glm::vec3 Location{ 0.0f };
+	glm::vec3 Direction{ 0.0f, 0.0f, -1.0f };
+	glm::vec3 Up{ 0.0f, 1.0f, 0.0f };
+};
+
+// Caminho da cmera por keyframes de SimpleCamera (posio, direo e up), interpolado por splines de Catmull-Rom: a
+//	cmera passa por todos os keyframes sem mudanas bruscas de velocidade entre um trecho e outro
+class CameraPath
+{
+public:
+	// Formato texto, um keyframe por linha: "tempo lx ly lz dx dy dz ux uy uz", com tempos crescentes em segundos.
+	//	'#' inicia comentrio
+	bool Load(std::istream& Input);
+
+	// Volta em torno do globo com uma aproximao, usada quando o benchmark no recebe um caminho
+	static CameraPath MakeDefaultOrbit();
+
+	void AddKeyframe(const CameraKeyframe& Keyframe);
+
+	size_t GetNumKeyframes() const;
+	double GetDuration() const;
+
+	// Posiciona a cmera no instante Time (limitado  durao). Direction e Up saem normalizados e ortogonais
+	void Evaluate(double Time, SimpleCamera& Camera) const;
+
+private:
+	std::vector<CameraKeyframe> Keyframes;
+};
+
+struct FrameBenchmarkSettings
+{
+	int WarmupFrames = 120; // Cmera parada no incio do caminho: compilao de shaders, streaming de texturas, caches
+	int MeasuredFrames = 1000; // O caminho inteiro  percorrido nesses frames, qualquer que seja o nmero
+
+	// Frao acima do baseline (p50 ou p95) a partir da qual uma mtrica  considerada uma regresso
+	double RegressionThreshold = 0.10;
+};
+
+// Medidas de um frame. GpuSeconds negativo = sem medida neste frame (os timer queries chegam com atraso)
+struct FrameBenchmarkSample
+{
+	double CpuSeconds = 0.0;
+	double FrameSeconds = 0.0;
+	double GpuSeconds = -1.0;
+	uint64_t DrawCalls = 0;
+	uint64_t Triangles = 0;
+};
+
+// Modo de benchmark (--benchmark): a cmera segue um CameraPath com o mesmo nmero de frames em toda execuo e cada
+//	frame medido entra nas distribuies de tempo de CPU, intervalo entre frames, tempo de GPU, draws e tringulos.
+//	Os percentis vo para CSV e JSON; o CSV tambm serve de baseline para as execues seguintes
+class FrameBenchmark
+{
+public:
+	FrameBenchmark(const CameraPath& InPath, const FrameBenchmarkSettings& InSettings);
+
+	bool IsWarmingUp() const;
+	bool IsFinished() const;
+
+	// Instante do caminho para o frame atual: o incio durante o aquecimento, depois de 0  durao nos frames medidos
+	double GetPathTime() const;
+	const CameraPath& GetPath() const;
+
+	void RecordFrame(const FrameBenchmarkSample& Sample);
+
+	bool WriteCsv(const std::string& FileName) const;
+	bool WriteJson(const std::string& FileName) const;
+
+	// Compara com um CSV gravado por WriteCsv. Retorna false se o p50 ou o p95 de alguma mtrica passou do baseline
+	//	mais RegressionThreshold
+	bool CompareWithBaseline(std::istream& Baseline, std::ostream& Report) const;
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	struct MetricSummary
+	{
+		std::string Name;
+		size_t Count = 0;
+		double P50 = 0.0;
+		double P95 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+		double Mean = 0.0;
+	};
+
+	std::vector<MetricSummary> Summarize() const;
+
+	CameraPath Path;
+	FrameBenchmarkSettings Settings;
+	int Frame = 0;
+
+	// Tempos em milissegundos, contagens por frame
+	std::vector<double> CpuMilliseconds;
+	std::vector<double> FrameMilliseconds;
+	std::vector<double> GpuMilliseconds;
+	std::vector<double> DrawCalls;
+	std::vector<double> Triangles;
+};
@@ -0,0 +1,580 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "Texture.h"
+
+namespace
+{
+	bool HasStencil(GLenum InternalFormat)
+	{
+		return InternalFormat == GL_DEPTH24_STENCIL8 || InternalFormat == GL_DEPTH32F_STENCIL8;
+	}
+
+	size_t GetBytesPerPixel(GLenum InternalFormat)
+	{
+		switch (InternalFormat)
+		{
+			case GL_R8:
+				return 1;
+			case GL_DEPTH_COMPONENT16:
+				return 2;
+			case GL_RGBA16F:
+			case GL_DEPTH32F_STENCIL8:
+				return 8;
+			case GL_RGBA32F:
+				return 16;
+			default:
+				return 4; // RGBA8, SRGB8_ALPHA8, R11F_G11F_B10F, DEPTH24, DEPTH24_STENCIL8, DEPTH32F
+		}
+	}
+}
+
+FrameGraphTextureDesc FrameGraphTextureDesc::Resolve(int BackbufferWidth, int BackbufferHeight) const
+{
+	FrameGraphTextureDesc Resolved = *this;
+	if (Width <= 0 || Height <= 0)
+	{
+		Resolved.Width = static_cast<int>(std::lround(BackbufferWidth * Scale));
+		Resolved.Height = static_cast<int>(std::lround(BackbufferHeight * Scale));
+	}
+	Resolved.Width = std::max(1, Resolved.Width);
+	Resolved.Height = std::max(1, Resolved.Height);
+	Resolved.Scale = 1.0f;
+	return Resolved;
+}
+
+bool FrameGraphTextureDesc::IsDepth() const
+{
+	switch (InternalFormat)
+	{
+		case GL_DEPTH_COMPONENT16:
+		case GL_DEPTH_COMPONENT24:
+		case GL_DEPTH_COMPONENT32:
+		case GL_DEPTH_COMPONENT32F:
+		case GL_DEPTH24_STENCIL8:
+		case GL_DEPTH32F_STENCIL8:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool FrameGraphTextureDesc::operator==(const FrameGraphTextureDesc& Other) const
+{
+	return InternalFormat == Other.InternalFormat && Width == Other.Width && Height == Other.Height && Scale == Other.Scale &&
+		   bDynamicScale == Other.bDynamicScale;
+}
+
+GLuint FrameGraphPassContext::GetTexture(FrameGraphResource Resource) const
+{
+	const int Physical = Graph->Plan.ResourceToPhysical[Resource];
+	return Physical >= 0 ? Graph->PhysicalTextureIds[Physical] : 0;
+}
+
+void FrameGraphPassContext::GetRenderArea(FrameGraphResource Resource, int& OutWidth, int& OutHeight) const
+{
+	OutWidth = 0;
+	OutHeight = 0;
+
+	const int Physical = Graph->Plan.ResourceToPhysical[Resource];
+	if (Physical >= 0)
+	{
+		Graph->GetScaledSize(Graph->Plan.PhysicalTextures[Physical], OutWidth, OutHeight);
+	}
+}
+
+void FrameGraphPassContext::Blit(FrameGraphResource Source) const
+{
+	Graph->BlitToTarget(Source, *this);
+}
+
+GLuint TransientTexturePool::Acquire(const FrameGraphTextureDesc& Desc)
+{
+	std::vector<GLuint>& Free = FreeTextures[Key{ Desc.InternalFormat, Desc.Width, Desc.Height }];
+	if (!Free.empty())
+	{
+		const GLuint TextureId = Free.back();
+		Free.pop_back();
+		ReusedTextures++;
+		return TextureId;
+	}
+
+	GLenum Format = GL_RGBA;
+	GLenum Type = GL_UNSIGNED_BYTE;
+	if (Desc.IsDepth())
+	{
+		Format = HasStencil(Desc.InternalFormat) ? GL_DEPTH_STENCIL : GL_DEPTH_COMPONENT;
+		Type = HasStencil(Desc.InternalFormat) ? GL_UNSIGNED_INT_24_8 : GL_FLOAT;
+	}
+
+	GLuint TextureId = 0;
+	glGenTextures(1, &TextureId);
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D, TextureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, Desc.InternalFormat, Desc.Width, Desc.Height, 0, Format, Type, nullptr);
+
+	// Render targets tm um nico nvel: o filtro linear serve para ampliar na apresentao
+	const GLint Filter = Desc.IsDepth() ? GL_NEAREST : GL_LINEAR;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, Filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, Filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	const size_t Bytes = static_cast<size_t>(Desc.Width) * Desc.Height * GetBytesPerPixel(Desc.InternalFormat);
+	TrackTextureMemory(TextureId, "render target", Desc.Width, Desc.Height, Bytes, Bytes);
+	AllocatedTextures++;
+
+	return TextureId;
+}
+
+void TransientTexturePool::Release(const FrameGraphTextureDesc& Desc, GLuint TextureId)
+{
+	if (TextureId != 0)
+	{
+		FreeTextures[Key{ Desc.InternalFormat, Desc.Width, Desc.Height }].push_back(TextureId);
+	}
+}
+
+void TransientTexturePool::Trim()
+{
+	for (auto& Entry : FreeTextures)
+	{
+		for (GLuint TextureId : Entry.second)
+		{
+			ReleaseTexture(TextureId);
+			TrimmedTextures++;
+		}
+	}
+	FreeTextures.clear();
+}
+
+void TransientTexturePool::PrintReport(std::ostream& Output) const
+{
+	Output << "Pool de render targets: " << AllocatedTextures << " texturas alocadas, " << ReusedTextures
+		   << " reaproveitadas, " << TrimmedTextures << " liberadas" << std::endl;
+}
+
+FrameGraphResource FrameGraph::AddResource(const char* Name, EResourceKind Kind, const FrameGraphTextureDesc& Desc)
+{
+	Resource NewResource;
+	NewResource.Name = Name;
+	NewResource.Kind = Kind;
+	NewResource.Desc = Desc;
+	Resources.push_back(NewResource);
+	bDirty = true;
+	return static_cast<FrameGraphResource>(Resources.size() - 1);
+}
+
+FrameGraphResource FrameGraph::CreateTexture(const char* Name, const FrameGraphTextureDesc& Desc)
+{
+	return AddResource(Name, EResourceKind::Transient, Desc);
+}
+
+FrameGraphResource FrameGraph::ImportBackbuffer(const char* Name)
+{
+	return AddResource(Name, EResourceKind::Backbuffer, FrameGraphTextureDesc{});
+}
+
+FrameGraphResource FrameGraph::ImportExternal(const char* Name)
+{
+	return AddResource(Name, EResourceKind::External, FrameGraphTextureDesc{});
+}
+
+int FrameGraph::AddPass(const char* Name, const std::vector<FrameGraphResource>& Reads, const std::vector<FrameGraphResource>& Writes, PassFunction Execute)
+{
+	Pass NewPass;
+	NewPass.Name = Name;
+	NewPass.Reads = Reads;
+	NewPass.Writes = Writes;
+	NewPass.Execute = std::move(Execute);
+	Passes.push_back(std::move(NewPass));
+	bDirty = true;
+	return static_cast<int>(Passes.size() - 1);
+}
+
+void FrameGraph::SetPassEnabled(int PassIndex, bool bEnabled)
+{
+	if (Passes[PassIndex].bEnabled != bEnabled)
+	{
+		Passes[PassIndex].bEnabled = bEnabled;
+		bDirty = true;
+	}
+}
+
+void FrameGraph::SetOutput(FrameGraphResource ResourceIndex, bool bIsOutput)
+{
+	if (Resources[ResourceIndex].bIsOutput != bIsOutput)
+	{
+		Resources[ResourceIndex].bIsOutput = bIsOutput;
+		bDirty = true;
+	}
+}
+
+void FrameGraph::SetBackbufferSize(int Width, int Height)
+{
+	Width = std::max(1, Width);
+	Height = std::max(1, Height);
+	if (Width != BackbufferWidth || Height != BackbufferHeight)
+	{
+		BackbufferWidth = Width;
+		BackbufferHeight = Height;
+		bDirty = true;
+	}
+}
+
+void FrameGraph::SetRenderScale(float Scale)
+{
+	RenderScale = std::clamp(Scale, 0.01f, 1.0f);
+}
+
+float FrameGraph::GetRenderScale() const
+{
+	return RenderScale;
+}
+
+bool FrameGraph::Compile()
+{
+	if (!bDirty)
+	{
+		return false;
+	}
+	bDirty = false;
+	Compilations++;
+
+	Plan = FrameGraphPlan{};
+	Plan.ResourceToPhysical.assign(Resources.size(), -1);
+
+	// Um passe que l um recurso transiente ainda no escrito por nenhum passe anterior no tem como executar
+	std::vector<bool> bWritten(Resources.size(), false);
+	std::vector<bool> bRunnable(Passes.size(), false);
+	for (size_t PassIndex = 0; PassIndex < Passes.size(); ++PassIndex)
+	{
+		const Pass& CurrentPass = Passes[PassIndex];
+		if (!CurrentPass.bEnabled)
+		{
+			continue;
+		}
+
+		bRunnable[PassIndex] = true;
+		for (FrameGraphResource Read : CurrentPass.Reads)
+		{
+			if (Resources[Read].Kind == EResourceKind::Transient && !bWritten[Read])
+			{
+				std::cout << "Passe " << CurrentPass.Name << " l " << Resources[Read].Name << " antes de algum passe escrev-lo" << std::endl;
+				bRunnable[PassIndex] = false;
+			}
+		}
+		if (bRunnable[PassIndex])
+		{
+			for (FrameGraphResource Write : CurrentPass.Writes)
+			{
+				bWritten[Write] = true;
+			}
+		}
+	}
+
+	// Descarte: percorrendo de trs para frente, um passe  mantido se escreve algo que chega a uma sada; ento os
+	//	recursos que ele l tambm passam a ser necessrios
+	std::vector<bool> bNeeded(Resources.size(), false);
+	for (size_t ResourceIndex = 0; ResourceIndex < Resources.size(); ++ResourceIndex)
+	{
+		bNeeded[ResourceIndex] = Resources[ResourceIndex].bIsOutput;
+	}
+
+	std::vector<bool> bLive(Passes.size(), false);
+	for (size_t PassIndex = Passes.size(); PassIndex-- > 0;)
+	{
+		const Pass& CurrentPass = Passes[PassIndex];
+		if (!bRunnable[PassIndex])
+		{
+			continue;
+		}
+
+		bLive[PassIndex] = std::any_of(CurrentPass.Writes.begin(), CurrentPass.Writes.end(), [&bNeeded](FrameGraphResource Write) { return bNeeded[Write]; });
+		if (bLive[PassIndex])
+		{
+			for (FrameGraphResource Read : CurrentPass.Reads)
+			{
+				bNeeded[Read] = true;
+			}
+		}
+		else
+		{
+			Plan.CulledPasses++;
+		}
+	}
+
+	for (size_t PassIndex = 0; PassIndex < Passes.size(); ++PassIndex)
+	{
+		if (bLive[PassIndex])
+		{
+			Plan.Passes.push_back(static_cast<int>(PassIndex));
+		}
+	}
+
+	// Tempo de vida de cada recurso transiente: do primeiro ao ltimo passe executado que o usa
+	std::vector<int> FirstUse(Resources.size(), -1);
+	std::vector<int> LastUse(Resources.size(), -1);
+	for (int Position = 0; Position < static_cast<int>(Plan.Passes.size()); ++Position)
+	{
+		const Pass& CurrentPass = Passes[Plan.Passes[Position]];
+		for (const std::vector<FrameGraphResource>* Used : { &CurrentPass.Reads, &CurrentPass.Writes })
+		{
+			for (FrameGraphResource ResourceIndex : *Used)
+			{
+				if (Resources[ResourceIndex].Kind != EResourceKind::Transient)
+				{
+					continue;
+				}
+				if (FirstUse[ResourceIndex] < 0)
+				{
+					FirstUse[ResourceIndex] = Position;
+				}
+				LastUse[ResourceIndex] = Position;
+			}
+		}
+	}
+
+	// Aliasing: um recurso ocupa a primeira textura fsica de mesma descrio cujo ltimo uso j passou
+	std::vector<int> PhysicalLastUse;
+	for (int Position = 0; Position < static_cast<int>(Plan.Passes.size()); ++Position)
+	{
+		for (size_t ResourceIndex = 0; ResourceIndex < Resources.size(); ++ResourceIndex)
+		{
+			if (FirstUse[ResourceIndex] != Position)
+			{
+				continue;
+			}
+
+			const FrameGraphTextureDesc Desc = Resources[ResourceIndex].Desc.Resolve(BackbufferWidth, BackbufferHeight);
+			int Physical = -1;
+			for (size_t Candidate = 0; Candidate < Plan.PhysicalTextures.size(); ++Candidate)
+			{
+				if (PhysicalLastUse[Candidate] < Position && Plan.PhysicalTextures[Candidate] == Desc)
+				{
+					Physical = static_cast<int>(Candidate);
+					break;
+				}
+			}
+			if (Physical < 0)
+			{
+				Physical = static_cast<int>(Plan.PhysicalTextures.size());
+				Plan.PhysicalTextures.push_back(Desc);
+				PhysicalLastUse.push_back(-1);
+			}
+
+			PhysicalLastUse[Physical] = LastUse[ResourceIndex];
+			Plan.ResourceToPhysical[ResourceIndex] = Physical;
+		}
+	}
+
+	return true;
+}
+
+const FrameGraphPlan& FrameGraph::GetPlan() const
+{
+	return Plan;
+}
+
+const std::string& FrameGraph::GetPassName(int PassIndex) const
+{
+	return Passes[PassIndex].Name;
+}
+
+const std::string& FrameGraph::GetResourceName(FrameGraphResource ResourceIndex) const
+{
+	return Resources[ResourceIndex].Name;
+}
+
+void FrameGraph::ReleaseFramebuffers()
+{
+	for (Pass& CurrentPass : Passes)
+	{
+		if (CurrentPass.Framebuffer != 0)
+		{
+			glDeleteFramebuffers(1, &CurrentPass.Framebuffer);
+			CurrentPass.Framebuffer = 0;
+		}
+	}
+}
+
+void FrameGraph::BindPassTargets(Pass& CurrentPass, FrameGraphPassContext& Context)
+{
+	Context.Width = BackbufferWidth;
+	Context.Height = BackbufferHeight;
+
+	const bool bWritesBackbuffer = std::any_of(CurrentPass.Writes.begin(), CurrentPass.Writes.end(), [this](FrameGraphResource Write) { return Resources[Write].Kind == EResourceKind::Backbuffer; });
+	if (bWritesBackbuffer)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, Context.Width, Context.Height);
+		return;
+	}
+
+	std::vector<FrameGraphResource> Targets;
+	for (FrameGraphResource Write : CurrentPass.Writes)
+	{
+		if (Resources[Write].Kind == EResourceKind::Transient)
+		{
+			Targets.push_back(Write);
+		}
+	}
+	if (Targets.empty())
+	{
+		// O passe s escreve recursos externos (ex.: l uma textura e grava um arquivo): nenhum framebuffer  ligado
+		return;
+	}
+
+	const FrameGraphTextureDesc& TargetDesc = Plan.PhysicalTextures[Plan.ResourceToPhysical[Targets.front()]];
+	GetScaledSize(TargetDesc, Context.Width, Context.Height);
+
+	if (CurrentPass.Framebuffer == 0)
+	{
+		glGenFramebuffers(1, &CurrentPass.Framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, CurrentPass.Framebuffer);
+
+		std::vector<GLenum> DrawBuffers;
+		for (FrameGraphResource Target : Targets)
+		{
+			const FrameGraphTextureDesc& Desc = Plan.PhysicalTextures[Plan.ResourceToPhysical[Target]];
+			GLenum Attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(DrawBuffers.size());
+			if (Desc.IsDepth())
+			{
+				Attachment = HasStencil(Desc.InternalFormat) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+			}
+			else
+			{
+				DrawBuffers.push_back(Attachment);
+			}
+			glFramebufferTexture2D(GL_FRAMEBUFFER, Attachment, GL_TEXTURE_2D, Context.GetTexture(Target), 0);
+		}
+
+		if (DrawBuffers.empty())
+		{
+			glDrawBuffer(GL_NONE);
+		}
+		else
+		{
+			glDrawBuffers(static_cast<GLsizei>(DrawBuffers.size()), DrawBuffers.data());
+		}
+
+		const GLenum Status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		if (Status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Framebuffer do passe " << CurrentPass.Name << " incompleto (0x" << std::hex << Status << std::dec << ")" << std::endl;
+		}
+	}
+	else
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, CurrentPass.Framebuffer);
+	}
+
+	Context.Framebuffer = CurrentPass.Framebuffer;
+	glViewport(0, 0, Context.Width, Context.Height);
+}
+
+void FrameGraph::GetScaledSize(const FrameGraphTextureDesc& Desc, int& OutWidth, int& OutHeight) const
+{
+	OutWidth = Desc.Width;
+	OutHeight = Desc.Height;
+	if (Desc.bDynamicScale)
+	{
+		OutWidth = std::max(1, static_cast<int>(std::lround(Desc.Width * RenderScale)));
+		OutHeight = std::max(1, static_cast<int>(std::lround(Desc.Height * RenderScale)));
+	}
+}
+
+void FrameGraph::BlitToTarget(FrameGraphResource Source, const FrameGraphPassContext& Context)
+{
+	const int Physical = Plan.ResourceToPhysical[Source];
+	if (Physical < 0)
+	{
+		return;
+	}
+
+	if (BlitFramebuffer == 0)
+	{
+		glGenFramebuffers(1, &BlitFramebuffer);
+	}
+
+	int SourceWidth = 0;
+	int SourceHeight = 0;
+	GetScaledSize(Plan.PhysicalTextures[Physical], SourceWidth, SourceHeight);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, BlitFramebuffer);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, PhysicalTextureIds[Physical], 0);
+	glBlitFramebuffer(0, 0, SourceWidth, SourceHeight, 0, 0, Context.Width, Context.Height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, Context.Framebuffer);
+}
+
+void FrameGraph::Execute(TransientTexturePool& Pool)
+{
+	const std::vector<FrameGraphTextureDesc> PreviousTextures = bDirty ? Plan.PhysicalTextures : std::vector<FrameGraphTextureDesc>{};
+	if (Compile())
+	{
+		// As texturas voltam ao pool antes de o novo plano pedir as suas: as de mesma descrio so reaproveitadas
+		ReleaseFramebuffers();
+		for (size_t Physical = 0; Physical < PhysicalTextureIds.size(); ++Physical)
+		{
+			Pool.Release(PreviousTextures[Physical], PhysicalTextureIds[Physical]);
+		}
+
+		PhysicalTextureIds.clear();
+		for (const FrameGraphTextureDesc& Desc : Plan.PhysicalTextures)
+		{
+			PhysicalTextureIds.push_back(Pool.Acquire(Desc));
+		}
+		Pool.Trim();
+	}
+
+	for (int PassIndex : Plan.Passes)
+	{
+		Pass& CurrentPass = Passes[PassIndex];
+		PROFILE_SCOPE(CurrentPass.Name.c_str());
+		PROFILE_GPU_SCOPE(CurrentPass.Name.c_str());
+
+		FrameGraphPassContext Context;
+		Context.Graph = this;
+		BindPassTargets(CurrentPass, Context);
+
+		CurrentPass.Execute(Context);
+	}
+
+	ExecutedFrames++;
+}
+
+void FrameGraph::Release(TransientTexturePool& Pool)
+{
+	ReleaseFramebuffers();
+	if (BlitFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &BlitFramebuffer);
+		BlitFramebuffer = 0;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	for (size_t Physical = 0; Physical < PhysicalTextureIds.size(); ++Physical)
+	{
+		Pool.Release(Plan.PhysicalTextures[Physical], PhysicalTextureIds[Physical]);
+	}
+	PhysicalTextureIds.clear();
+	bDirty = true;
+}
+
+void FrameGraph::PrintReport(std::ostream& Output) const
+{
+	Output << "Grafo de renderizao: " << Passes.size() << " passes declarados, " << Plan.Passes.size() << " executados ("
+		   << Plan.CulledPasses << " descartados), " << Plan.PhysicalTextures.size() << " texturas fsicas para "
+		   << std::count_if(Plan.ResourceToPhysical.begin(), Plan.ResourceToPhysical.end(), [](int Physical) { return Physical >= 0; })
+		   << " recursos transientes, " << Compilations << " compilaes em " << ExecutedFrames << " frames" << std::endl;
+
+	for (int PassIndex : Plan.Passes)
+	{
+		Output << "  " << Passes[PassIndex].Name << std::endl;
+	}
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Identificador de um recurso do grafo (ndice na lista de recursos)
+using FrameGraphResource = int;
+constexpr FrameGraphResource InvalidFrameGraphResource = -1;
+
+// Descrio de uma textura transiente. Com Width ou Height iguais a 0 o tamanho acompanha o backbuffer, multiplicado
+//	por Scale (ex.: 0.5 = metade da resoluo da janela)
+struct FrameGraphTextureDesc
+{
+	GLenum InternalFormat = GL_RGBA8;
+	int Width = 0;
+	int Height = 0;
+	float Scale = 1.0f;
+
+	// Escala dinmica de resoluo: a textura  alocada no tamanho inteiro, mas os passes desenham (e as cpias leem)
+	//	s o retngulo de RenderScale (FrameGraph::SetRenderScale) no canto inferior esquerdo. Mudar a escala no
+	//	realoca nada
+	bool bDynamicScale = false;
+
+	// Tamanho final para um backbuffer de BackbufferWidth x BackbufferHeight (nunca menor que 1x1)
+	FrameGraphTextureDesc Resolve(int BackbufferWidth, int BackbufferHeight) const;
+
+	bool IsDepth() const;
+	bool operator==(const FrameGraphTextureDesc& Other) const;
+};
+
+class FrameGraph;
+
+// O que um passe recebe ao executar: o framebuffer j ligado (0 para o backbuffer) e o tamanho dos seus alvos
+struct FrameGraphPassContext
+{
+	FrameGraph* Graph = nullptr;
+	GLuint Framebuffer = 0;
+	int Width = 0;
+	int Height = 0;
+
+	// Textura fsica atribuda a um recurso transiente neste frame
+	GLuint GetTexture(FrameGraphResource Resource) const;
+
+	// rea da textura com contedo neste frame: o tamanho inteiro ou, nas texturas de escala dinmica, a frao
+	//	RenderScale dele
+	void GetRenderArea(FrameGraphResource Resource, int& OutWidth, int& OutHeight) const;
+
+	// Copia uma textura de cor transiente para os alvos do passe, ampliando ou reduzindo com filtro linear
+	void Blit(FrameGraphResource Source) const;
+};
+
+// Resultado da compilao, sem nenhum objeto do OpenGL: quais passes executam e em que ordem e qual textura fsica
+//	(ndice em PhysicalTextures) cada recurso transiente ocupa. Recursos com tempos de vida disjuntos e a mesma descrio
+//	dividem a mesma textura
+struct FrameGraphPlan
+{
+	std::vector<int> Passes;
+	std::vector<int> ResourceToPhysical; // -1 para recursos importados ou no usados
+	std::vector<FrameGraphTextureDesc> PhysicalTextures;
+	int CulledPasses = 0;
+};
+
+// Texturas de render target reaproveitadas entre compilaes do grafo, indexadas por formato e tamanho: mudar o grafo
+//	(ou ligar um passe) no realoca as texturas que continuam com a mesma descrio
+class TransientTexturePool
+{
+public:
+	GLuint Acquire(const FrameGraphTextureDesc& Desc);
+	void Release(const FrameGraphTextureDesc& Desc, GLuint TextureId);
+
+	// Apaga as texturas livres (ex.: de um tamanho de janela que no existe mais)
+	void Trim();
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	using Key = std::tuple<GLenum, int, int>;
+	std::map<Key, std::vector<GLuint>> FreeTextures;
+
+	uint64_t AllocatedTextures = 0;
+	uint64_t ReusedTextures = 0;
+	uint64_t TrimmedTextures = 0;
+};
+
+// Grafo de passes de renderizao declarativo. Cada passe declara os recursos que l e escreve; na compilao os passes
+//	que no contribuem para nenhuma sada so descartados e as texturas transientes recebem texturas fsicas do pool,
+//	com aliasing entre recursos que no vivem ao mesmo tempo.
+// O grafo s  recompilado quando muda (passes, sadas ou tamanho do backbuffer); os passes executam na ordem em que
+//	foram declarados, ento quem produz um recurso deve ser declarado antes de quem o l
+class FrameGraph
+{
+public:
+	FrameGraphResource CreateTexture(const char* Name, const FrameGraphTextureDesc& Desc);
+
+	// O framebuffer padro da janela: um passe que o escreve desenha direto na tela
+	FrameGraphResource ImportBackbuffer(const char* Name);
+
+	// Recurso fora do OpenGL (ex.: um arquivo de captura): s existe para ligar passes a sadas
+	FrameGraphResource ImportExternal(const char* Name);
+
+	using PassFunction = std::function<void(const FrameGraphPassContext&)>;
+	int AddPass(const char* Name, const std::vector<FrameGraphResource>& Reads, const std::vector<FrameGraphResource>& Writes, PassFunction Execute);
+
+	void SetPassEnabled(int Pass, bool bEnabled);
+
+	// Sadas do grafo: os passes so mantidos apenas se algum recurso escrito por eles chegar a uma sada
+	void SetOutput(FrameGraphResource Resource, bool bIsOutput);
+
+	void SetBackbufferSize(int Width, int Height);
+
+	// Frao do tamanho das texturas de escala dinmica usada neste frame, em (0, 1]. No recompila o grafo
+	void SetRenderScale(float Scale);
+	float GetRenderScale() const;
+
+	// Recompila o plano se algo mudou desde a ltima compilao. No usa o OpenGL. Retorna true se recompilou
+	bool Compile();
+
+	const FrameGraphPlan& GetPlan() const;
+	const std::string& GetPassName(int Pass) const;
+	const std::string& GetResourceName(FrameGraphResource Resource) const;
+
+	// Compila se necessrio, troca as texturas fsicas pelo pool e executa os passes do plano
+	void Execute(TransientTexturePool& Pool);
+
+	// Devolve as texturas ao pool e apaga os framebuffers
+	void Release(TransientTexturePool& Pool);
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	friend struct FrameGraphPassContext;
+
+	enum class EResourceKind
+	{
+		Transient,
+		Backbuffer,
+		External
+	};
+
+	struct Resource
+	{
+		std::string Name;
+		EResourceKind Kind = EResourceKind::Transient;
+		FrameGraphTextureDesc Desc;
+		bool bIsOutput = false;
+	};
+
+	struct Pass
+	{
+		std::string Name;
+		std::vector<FrameGraphResource> Reads;
+		std::vector<FrameGraphResource> Writes;
+		PassFunction Execute;
+		bool bEnabled = true;
+		GLuint Framebuffer = 0; // Criado na primeira execuo depois de cada compilao
+	};
+
+	FrameGraphResource AddResource(const char* Name, EResourceKind Kind, const FrameGraphTextureDesc& Desc);
+	void BindPassTargets(Pass& CurrentPass, FrameGraphPassContext& Context);
+	void GetScaledSize(const FrameGraphTextureDesc& Desc, int& OutWidth, int& OutHeight) const;
+	void BlitToTarget(FrameGraphResource Source, const FrameGraphPassContext& Context);
+	void ReleaseFramebuffers();
+
+	std::vector<Resource> Resources;
+	std::vector<Pass> Passes;
+	FrameGraphPlan Plan;
+	bool bDirty = true;
+
+	int BackbufferWidth = 1;
+	int BackbufferHeight = 1;
+	float RenderScale = 1.0f;
+
+	// Texturas fsicas do plano atual, na ordem de Plan.PhysicalTextures
+	std::vector<GLuint> PhysicalTextureIds;
+	GLuint BlitFramebuffer = 0;
+
+	uint64_t Compilations = 0;
+	uint64_t ExecutedFrames = 0;
+};
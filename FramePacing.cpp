@@ -0,0 +1,196 @@
+#include "FramePacing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+namespace
+{
+	// Margem antes do prazo em que o FramePacer para de dormir e passa a esperar ativamente
+	constexpr std::chrono::microseconds SpinMargin{ 1500 };
+}
+
+FixedStepClock::FixedStepClock(double InStepSeconds, int InMaxStepsPerFrame)
+	: StepSeconds{ std::max(InStepSeconds, 1e-4) }
+	, MaxStepsPerFrame{ std::max(InMaxStepsPerFrame, 1) }
+{
+}
+
+void FixedStepClock::Reset(double Now)
+{
+	PreviousTime = Now;
+	SimulationTime = Now;
+	Accumulator = 0.0;
+}
+
+int FixedStepClock::Advance(double Now)
+{
+	Accumulator += std::max(0.0, Now - PreviousTime);
+	PreviousTime = Now;
+	Frames++;
+
+	int NumSteps = static_cast<int>(Accumulator / StepSeconds);
+	if (NumSteps > MaxStepsPerFrame)
+	{
+		// Descarta os passos que no cabem neste frame, mantendo a frao do passo seguinte para a interpolao
+		DroppedSeconds += (NumSteps - MaxStepsPerFrame) * StepSeconds;
+		ClampedFrames++;
+		NumSteps = MaxStepsPerFrame;
+		Accumulator = std::fmod(Accumulator, StepSeconds);
+	}
+	else
+	{
+		Accumulator -= NumSteps * StepSeconds;
+	}
+
+	SimulationTime += NumSteps * StepSeconds;
+	Steps += NumSteps;
+	return NumSteps;
+}
+
+double FixedStepClock::GetStepSeconds() const
+{
+	return StepSeconds;
+}
+
+double FixedStepClock::GetAlpha() const
+{
+	return Accumulator / StepSeconds;
+}
+
+double FixedStepClock::GetSimulationTime() const
+{
+	return SimulationTime;
+}
+
+double FixedStepClock::GetInterpolatedTime() const
+{
+	return SimulationTime - StepSeconds + Accumulator;
+}
+
+void FixedStepClock::PrintReport(std::ostream& Output) const
+{
+	const double StepsPerFrame = Frames > 0 ? static_cast<double>(Steps) / Frames : 0.0;
+	Output << "Simulao com passo fixo de " << std::fixed << std::setprecision(2) << StepSeconds * 1000.0 << " ms: "
+		   << Steps << " passos em " << Frames << " frames (" << StepsPerFrame << " por frame), "
+		   << ClampedFrames << " frames no limite de " << MaxStepsPerFrame << " passos, "
+		   << DroppedSeconds * 1000.0 << " ms descartados" << std::defaultfloat << std::endl;
+}
+
+void FramePacer::SetTargetFrameRate(double FramesPerSecond)
+{
+	Interval = FramesPerSecond > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / FramesPerSecond)) : Clock::duration{ 0 };
+	bStarted = false;
+}
+
+double FramePacer::GetTargetFrameRate() const
+{
+	return Interval.count() > 0 ? 1.0 / std::chrono::duration<double>(Interval).count() : 0.0;
+}
+
+void FramePacer::Wait()
+{
+	if (Interval.count() <= 0)
+	{
+		return;
+	}
+
+	const Clock::time_point WaitStart = Clock::now();
+	if (!bStarted)
+	{
+		NextFrameTime = WaitStart + Interval;
+		bStarted = true;
+		return;
+	}
+
+	PacedFrames++;
+	if (WaitStart > NextFrameTime)
+	{
+		MissedDeadlines++;
+		if (WaitStart - NextFrameTime > Interval)
+		{
+			// Atraso de mais de um frame (ex.: a janela ficou minimizada): recomea o ritmo em vez de correr atrs
+			NextFrameTime = WaitStart;
+		}
+		NextFrameTime += Interval;
+		return;
+	}
+
+	if (NextFrameTime - WaitStart > SpinMargin)
+	{
+		std::this_thread::sleep_until(NextFrameTime - SpinMargin);
+	}
+	while (Clock::now() < NextFrameTime)
+	{
+		std::this_thread::yield();
+	}
+
+	WaitedSeconds += std::chrono::duration<double>(Clock::now() - WaitStart).count();
+	NextFrameTime += Interval;
+}
+
+void FramePacer::PrintReport(std::ostream& Output) const
+{
+	if (Interval.count() <= 0)
+	{
+		return;
+	}
+
+	const double AverageWait = PacedFrames > 0 ? WaitedSeconds / PacedFrames : 0.0;
+	Output << "Limite de " << std::fixed << std::setprecision(1) << GetTargetFrameRate() << " fps: " << PacedFrames
+		   << " frames, " << MissedDeadlines << " prazos perdidos, espera mdia de " << std::setprecision(2)
+		   << AverageWait * 1000.0 << " ms" << std::defaultfloat << std::endl;
+}
+
+void FrameTimeStats::Record(double Seconds)
+{
+	Count++;
+	if (Count == 1)
+	{
+		Min = Max = Seconds;
+	}
+	Min = std::min(Min, Seconds);
+	Max = std::max(Max, Seconds);
+
+	const double Delta = Seconds - Mean;
+	Mean += Delta / static_cast<double>(Count);
+	SquaredDeviations += Delta * (Seconds - Mean);
+}
+
+uint64_t FrameTimeStats::GetCount() const
+{
+	return Count;
+}
+
+double FrameTimeStats::GetMean() const
+{
+	return Mean;
+}
+
+double FrameTimeStats::GetVariance() const
+{
+	return Count > 1 ? SquaredDeviations / static_cast<double>(Count - 1) : 0.0;
+}
+
+double FrameTimeStats::GetStandardDeviation() const
+{
+	return std::sqrt(GetVariance());
+}
+
+void FrameTimeStats::PrintReport(std::ostream& Output, const char* Title) const
+{
+	Output << Title << ": " << Count << " amostras";
+	if (Count > 0)
+	{
+		// Varincia em ms para ficar na mesma escala da mdia
+		Output << std::fixed << std::setprecision(3)
+			   << ", mdia " << Mean * 1000.0 << " ms"
+			   << ", desvio padro " << GetStandardDeviation() * 1000.0 << " ms"
+			   << ", varincia " << GetVariance() * 1.0e6 << " ms"
+			   << ", mn " << Min * 1000.0 << " ms"
+			   << ", mx " << Max * 1000.0 << " ms" << std::defaultfloat;
+	}
+	Output << std::endl;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+// Relgio de simulao com passo fixo: o tempo real se acumula e  consumido em passos de StepSeconds, de modo que a
+//	simulao avana sempre com o mesmo Delta Time, independente da taxa de frames. O que sobra no acumulador (Alpha)
+//	 a frao do passo seguinte usada para interpolar o estado desenhado entre os dois ltimos passos
+class FixedStepClock
+{
+public:
+	explicit FixedStepClock(double InStepSeconds = 1.0 / 120.0, int InMaxStepsPerFrame = 8);
+
+	void Reset(double Now);
+
+	// Acumula o tempo desde a chamada anterior e retorna quantos passos devem ser executados agora. Depois de uma pausa
+	//	longa (ou de frames mais lentos que a simulao), no mximo MaxStepsPerFrame passos so executados e o restante 
+	//	descartado: a simulao desacelera em vez de entrar em uma espiral de passos cada vez mais atrasados
+	int Advance(double Now);
+
+	double GetStepSeconds() const;
+
+	// Frao do prximo passo j decorrida, em [0, 1)
+	double GetAlpha() const;
+
+	// Instante do ltimo passo executado e instante interpolado que o frame deve mostrar (um passo atrs, mais Alpha)
+	double GetSimulationTime() const;
+	double GetInterpolatedTime() const;
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	double StepSeconds = 1.0 / 120.0;
+	int MaxStepsPerFrame = 8;
+
+	double PreviousTime = 0.0;
+	double Accumulator = 0.0;
+	double SimulationTime = 0.0;
+
+	uint64_t Frames = 0;
+	uint64_t Steps = 0;
+	uint64_t ClampedFrames = 0;
+	double DroppedSeconds = 0.0;
+};
+
+// Limita a taxa de frames a um alvo abaixo do V-Sync (ex.: 30 fps em um monitor de 60 Hz). Os prazos avanam em
+//	intervalos fixos a partir do primeiro frame, ento um frame atrasado no empurra os seguintes; se o atraso passar de
+//	um intervalo inteiro, o ritmo  reiniciado a partir de agora
+class FramePacer
+{
+public:
+	// 0 desliga o limite
+	void SetTargetFrameRate(double FramesPerSecond);
+	double GetTargetFrameRate() const;
+
+	// Bloqueia at o prazo do prximo frame: dorme at perto dele e termina com espera ativa, porque a granularidade do
+	//	sleep do sistema (1 ms ou mais)  grande demais para um ritmo regular
+	void Wait();
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::duration Interval{ 0 };
+	Clock::time_point NextFrameTime{};
+	bool bStarted = false;
+
+	uint64_t PacedFrames = 0;
+	uint64_t MissedDeadlines = 0;
+	double WaitedSeconds = 0.0;
+};
+
+// Mdia, varincia e extremos de uma srie de tempos (ex.: intervalo entre frames), acumulados sem guardar as amostras
+class FrameTimeStats
+{
+public:
+	void Record(double Seconds);
+
+	uint64_t GetCount() const;
+	double GetMean() const;
+	double GetVariance() const;
+	double GetStandardDeviation() const;
+
+	void PrintReport(std::ostream& Output, const char* Title) const;
+
+private:
+	// Algoritmo de Welford: numericamente estvel mesmo com milhes de amostras prximas da mdia
+	uint64_t Count = 0;
+	double Mean = 0.0;
+	double SquaredDeviations = 0.0;
+	double Min = 0.0;
+	double Max = 0.0;
+};
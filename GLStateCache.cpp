@@ -0,0 +1,308 @@
+#include "GLStateCache.h"
+
+#include <ostream>
+
+GLStateFunctions GetDefaultGLStateFunctions()
+{
+	// As funes do GLEW so ponteiros preenchidos em glewInit: cada entrada os l no momento da chamada
+	GLStateFunctions Functions;
+	Functions.UseProgram = [](GLuint ProgramId) { glUseProgram(ProgramId); };
+	Functions.BindVertexArray = [](GLuint VertexArrayId) { glBindVertexArray(VertexArrayId); };
+	Functions.ActiveTexture = [](GLenum TextureUnit) { glActiveTexture(TextureUnit); };
+	Functions.BindTexture = [](GLenum Target, GLuint TextureId) { glBindTexture(Target, TextureId); };
+	Functions.BindBuffer = [](GLenum Target, GLuint BufferId) { glBindBuffer(Target, BufferId); };
+	Functions.Enable = [](GLenum Capability) { glEnable(Capability); };
+	Functions.Disable = [](GLenum Capability) { glDisable(Capability); };
+	Functions.BlendFunc = [](GLenum SourceFactor, GLenum DestinationFactor) { glBlendFunc(SourceFactor, DestinationFactor); };
+	Functions.DepthFunc = [](GLenum Function) { glDepthFunc(Function); };
+	Functions.DepthMask = [](GLboolean bWrite) { glDepthMask(bWrite); };
+	Functions.CullFace = [](GLenum Face) { glCullFace(Face); };
+	Functions.PolygonMode = [](GLenum Face, GLenum Mode) { glPolygonMode(Face, Mode); };
+	return Functions;
+}
+
+GLStateCache::GLStateCache(const GLStateFunctions& InFunctions)
+	: Functions(InFunctions)
+{
+	Invalidate();
+}
+
+int GLStateCache::GetTextureTargetIndex(GLenum Target)
+{
+	switch (Target)
+	{
+		case GL_TEXTURE_2D: return Texture2D;
+		case GL_TEXTURE_CUBE_MAP: return TextureCubeMap;
+		case GL_TEXTURE_2D_ARRAY: return Texture2DArray;
+		default: return -1;
+	}
+}
+
+int GLStateCache::GetBufferTargetIndex(GLenum Target)
+{
+	switch (Target)
+	{
+		case GL_ARRAY_BUFFER: return ArrayBuffer;
+		case GL_ELEMENT_ARRAY_BUFFER: return ElementArrayBuffer;
+		case GL_UNIFORM_BUFFER: return UniformBuffer;
+		case GL_DRAW_INDIRECT_BUFFER: return DrawIndirectBuffer;
+		default: return -1;
+	}
+}
+
+int GLStateCache::GetCapabilityIndex(GLenum Capability)
+{
+	switch (Capability)
+	{
+		case GL_BLEND: return Blend;
+		case GL_DEPTH_TEST: return DepthTest;
+		case GL_CULL_FACE: return CullFace;
+		case GL_FRAMEBUFFER_SRGB: return FramebufferSrgb;
+		case GL_TEXTURE_CUBE_MAP_SEAMLESS: return TextureCubeMapSeamless;
+		default: return -1;
+	}
+}
+
+void GLStateCache::UseProgram(GLuint ProgramId)
+{
+	if (Track(Program, ProgramId))
+	{
+		Functions.UseProgram(ProgramId);
+	}
+}
+
+void GLStateCache::BindVertexArray(GLuint VertexArrayId)
+{
+	if (Track(VertexArray, VertexArrayId))
+	{
+		Functions.BindVertexArray(VertexArrayId);
+
+		// O buffer de ndices faz parte do estado do VAO
+		Buffers[ElementArrayBuffer] = Unknown;
+	}
+}
+
+void GLStateCache::SetActiveTexture(GLuint Unit)
+{
+	if (Track(ActiveUnit, Unit))
+	{
+		Functions.ActiveTexture(GL_TEXTURE0 + Unit);
+	}
+}
+
+void GLStateCache::BindTexture(GLuint Unit, GLenum Target, GLuint TextureId)
+{
+	const int TargetIndex = GetTextureTargetIndex(Target);
+	if (TargetIndex < 0 || Unit >= MaxTextureUnits)
+	{
+		SetActiveTexture(Unit);
+		++IssuedCalls;
+		Functions.BindTexture(Target, TextureId);
+		return;
+	}
+
+	GLuint& Known = Textures[Unit][TargetIndex];
+	if (Known == TextureId)
+	{
+		++ElidedCalls;
+		return;
+	}
+
+	SetActiveTexture(Unit);
+	Known = TextureId;
+	++IssuedCalls;
+	Functions.BindTexture(Target, TextureId);
+}
+
+void GLStateCache::BindTextureForUpdate(GLenum Target, GLuint TextureId)
+{
+	BindTexture(UpdateTextureUnit, Target, TextureId);
+	SetActiveTexture(UpdateTextureUnit);
+}
+
+void GLStateCache::BindBuffer(GLenum Target, GLuint BufferId)
+{
+	const int TargetIndex = GetBufferTargetIndex(Target);
+	if (TargetIndex < 0)
+	{
+		++IssuedCalls;
+		Functions.BindBuffer(Target, BufferId);
+		return;
+	}
+
+	if (Track(Buffers[TargetIndex], BufferId))
+	{
+		Functions.BindBuffer(Target, BufferId);
+	}
+}
+
+void GLStateCache::SetCapability(GLenum Capability, bool bEnabled)
+{
+	const int CapabilityIndex = GetCapabilityIndex(Capability);
+	if (CapabilityIndex >= 0 && !Track(Capabilities[CapabilityIndex], static_cast<GLuint>(bEnabled)))
+	{
+		return;
+	}
+
+	if (CapabilityIndex < 0)
+	{
+		++IssuedCalls;
+	}
+
+	if (bEnabled)
+	{
+		Functions.Enable(Capability);
+	}
+	else
+	{
+		Functions.Disable(Capability);
+	}
+}
+
+void GLStateCache::SetBlendFunc(GLenum SourceFactor, GLenum DestinationFactor)
+{
+	if (BlendSource == SourceFactor && BlendDestination == DestinationFactor)
+	{
+		++ElidedCalls;
+		return;
+	}
+
+	BlendSource = SourceFactor;
+	BlendDestination = DestinationFactor;
+	++IssuedCalls;
+	Functions.BlendFunc(SourceFactor, DestinationFactor);
+}
+
+void GLStateCache::SetDepthFunc(GLenum Function)
+{
+	if (Track(DepthFunction, static_cast<GLuint>(Function)))
+	{
+		Functions.DepthFunc(Function);
+	}
+}
+
+void GLStateCache::SetDepthMask(bool bWrite)
+{
+	if (Track(DepthWrite, static_cast<GLuint>(bWrite)))
+	{
+		Functions.DepthMask(bWrite ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLStateCache::SetCullFace(GLenum Face)
+{
+	if (Track(CulledFace, static_cast<GLuint>(Face)))
+	{
+		Functions.CullFace(Face);
+	}
+}
+
+void GLStateCache::SetPolygonMode(GLenum Mode)
+{
+	if (Track(PolygonFillMode, static_cast<GLuint>(Mode)))
+	{
+		Functions.PolygonMode(GL_FRONT_AND_BACK, Mode);
+	}
+}
+
+GLuint GLStateCache::GetProgram() const
+{
+	return Program == Unknown ? 0 : Program;
+}
+
+void GLStateCache::OnProgramDeleted(GLuint ProgramId)
+{
+	// O programa em uso s  apagado de fato quando deixa de ser usado: o estado continua vlido, mas o identificador
+	//	pode ser reutilizado, ento o prximo UseProgram  sempre enviado
+	if (Program == ProgramId)
+	{
+		Program = Unknown;
+	}
+}
+
+void GLStateCache::OnTextureDeleted(GLuint TextureId)
+{
+	// Apagar uma textura ligada a liga de volta  textura 0 em todas as unidades
+	for (std::array<GLuint, TextureTargetCount>& Unit : Textures)
+	{
+		for (GLuint& Known : Unit)
+		{
+			if (Known == TextureId)
+			{
+				Known = 0;
+			}
+		}
+	}
+}
+
+void GLStateCache::OnBufferDeleted(GLuint BufferId)
+{
+	for (GLuint& Known : Buffers)
+	{
+		if (Known == BufferId)
+		{
+			Known = 0;
+		}
+	}
+}
+
+void GLStateCache::OnVertexArrayDeleted(GLuint VertexArrayId)
+{
+	if (VertexArray == VertexArrayId)
+	{
+		VertexArray = 0;
+		Buffers[ElementArrayBuffer] = Unknown;
+	}
+}
+
+void GLStateCache::Invalidate()
+{
+	Program = Unknown;
+	VertexArray = Unknown;
+	ActiveUnit = Unknown;
+	for (std::array<GLuint, TextureTargetCount>& Unit : Textures)
+	{
+		Unit.fill(Unknown);
+	}
+	Buffers.fill(Unknown);
+	Capabilities.fill(Unknown);
+	BlendSource = Unknown;
+	BlendDestination = Unknown;
+	DepthFunction = Unknown;
+	DepthWrite = Unknown;
+	CulledFace = Unknown;
+	PolygonFillMode = Unknown;
+}
+
+uint64_t GLStateCache::GetIssuedCalls() const
+{
+	return IssuedCalls;
+}
+
+uint64_t GLStateCache::GetElidedCalls() const
+{
+	return ElidedCalls;
+}
+
+void GLStateCache::ResetCounters()
+{
+	IssuedCalls = 0;
+	ElidedCalls = 0;
+}
+
+void GLStateCache::PrintReport(std::ostream& Output) const
+{
+	const uint64_t TotalCalls = IssuedCalls + ElidedCalls;
+	Output << "Cache de estados do OpenGL: " << IssuedCalls << " chamadas enviadas, " << ElidedCalls << " evitadas";
+	if (TotalCalls > 0)
+	{
+		Output << " (" << (100 * ElidedCalls) / TotalCalls << "%)";
+	}
+	Output << std::endl;
+}
+
+GLStateCache& GetGLStateCache()
+{
+	static GLStateCache Cache;
+	return Cache;
+}
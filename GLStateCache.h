@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+
+#include <GL/glew.h>
+
+// Funes do OpenGL usadas pelo cache de estados. A tabela padro chama o GLEW; uma tabela com funes falsas permite
+//	verificar o cache (quais chamadas chegam ao driver) sem contexto OpenGL nem GPU
+struct GLStateFunctions
+{
+	void (*UseProgram)(GLuint ProgramId);
+	void (*BindVertexArray)(GLuint VertexArrayId);
+	void (*ActiveTexture)(GLenum TextureUnit);
+	void (*BindTexture)(GLenum Target, GLuint TextureId);
+	void (*BindBuffer)(GLenum Target, GLuint BufferId);
+	void (*Enable)(GLenum Capability);
+	void (*Disable)(GLenum Capability);
+	void (*BlendFunc)(GLenum SourceFactor, GLenum DestinationFactor);
+	void (*DepthFunc)(GLenum Function);
+	void (*DepthMask)(GLboolean bWrite);
+	void (*CullFace)(GLenum Face);
+	void (*PolygonMode)(GLenum Face, GLenum Mode);
+};
+
+GLStateFunctions GetDefaultGLStateFunctions();
+
+// Cpia do estado do OpenGL mantida na CPU: chamadas que no mudariam nada no chegam ao driver.
+// Todo cdigo que altera os estados acompanhados deve passar por aqui (ou chamar Invalidate depois de alter-los
+//	diretamente). Objetos apagados devem ser informados, pois o OpenGL desfaz as ligaes deles e o identificador pode
+//	ser reutilizado por um objeto novo
+class GLStateCache
+{
+public:
+	// Unidade reservada para criar e modificar texturas: as ligaes usadas pelo desenho nunca so alteradas pelos uploads
+	static constexpr GLuint UpdateTextureUnit = 15;
+	static constexpr GLuint MaxTextureUnits = 16;
+
+	explicit GLStateCache(const GLStateFunctions& InFunctions = GetDefaultGLStateFunctions());
+
+	void UseProgram(GLuint ProgramId);
+	void BindVertexArray(GLuint VertexArrayId);
+
+	// Liga a textura na unidade para amostragem; a unidade ativa pode continuar sendo outra
+	void BindTexture(GLuint Unit, GLenum Target, GLuint TextureId);
+
+	// Liga a textura na UpdateTextureUnit e a deixa ativa, para os glTexImage/glTexParameter seguintes
+	void BindTextureForUpdate(GLenum Target, GLuint TextureId);
+
+	void BindBuffer(GLenum Target, GLuint BufferId);
+
+	// GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_FRAMEBUFFER_SRGB, ... (outras capacidades so repassadas sem cache)
+	void SetCapability(GLenum Capability, bool bEnabled);
+	void SetBlendFunc(GLenum SourceFactor, GLenum DestinationFactor);
+	void SetDepthFunc(GLenum Function);
+	void SetDepthMask(bool bWrite);
+	void SetCullFace(GLenum Face);
+	void SetPolygonMode(GLenum Mode); // Sempre GL_FRONT_AND_BACK (o nico aceito no perfil core)
+
+	GLuint GetProgram() const;
+
+	void OnProgramDeleted(GLuint ProgramId);
+	void OnTextureDeleted(GLuint TextureId);
+	void OnBufferDeleted(GLuint BufferId);
+	void OnVertexArrayDeleted(GLuint VertexArrayId);
+
+	// Esquece todo o estado conhecido: a prxima chamada de cada tipo  sempre enviada
+	void Invalidate();
+
+	uint64_t GetIssuedCalls() const;
+	uint64_t GetElidedCalls() const;
+	void ResetCounters();
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	// Alvos de textura acompanhados por unidade
+	enum ETextureTarget
+	{
+		Texture2D,
+		TextureCubeMap,
+		Texture2DArray,
+		TextureTargetCount
+	};
+
+	enum EBufferTarget
+	{
+		ArrayBuffer,
+		ElementArrayBuffer,
+		UniformBuffer,
+		DrawIndirectBuffer,
+		BufferTargetCount
+	};
+
+	enum ECapability
+	{
+		Blend,
+		DepthTest,
+		CullFace,
+		FramebufferSrgb,
+		TextureCubeMapSeamless,
+		CapabilityCount
+	};
+
+	static int GetTextureTargetIndex(GLenum Target);
+	static int GetBufferTargetIndex(GLenum Target);
+	static int GetCapabilityIndex(GLenum Capability);
+
+	void SetActiveTexture(GLuint Unit);
+
+	// Conta a chamada e retorna true se ela precisa ser enviada (o valor conhecido  diferente do novo)
+	template <typename T>
+	bool Track(T& Known, T Value)
+	{
+		if (Known == Value)
+		{
+			++ElidedCalls;
+			return false;
+		}
+		Known = Value;
+		++IssuedCalls;
+		return true;
+	}
+
+	// Valor que no corresponde a nenhum objeto ou enumerao: estado desconhecido
+	static constexpr GLuint Unknown = 0xFFFFFFFFu;
+
+	GLStateFunctions Functions;
+
+	GLuint Program = Unknown;
+	GLuint VertexArray = Unknown;
+	GLuint ActiveUnit = Unknown;
+	std::array<std::array<GLuint, TextureTargetCount>, MaxTextureUnits> Textures;
+	std::array<GLuint, BufferTargetCount> Buffers;
+	std::array<GLuint, CapabilityCount> Capabilities;
+	GLuint BlendSource = Unknown;
+	GLuint BlendDestination = Unknown;
+	GLuint DepthFunction = Unknown;
+	GLuint DepthWrite = Unknown;
+	GLuint CulledFace = Unknown;
+	GLuint PolygonFillMode = Unknown;
+
+	uint64_t IssuedCalls = 0;
+	uint64_t ElidedCalls = 0;
+};
+
+// Cache de estados do contexto principal (acessado apenas pela thread do contexto OpenGL)
+GLStateCache& GetGLStateCache();
@@ -0,0 +1,115 @@
+#include "GlobePatches.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+	const glm::vec4 PatchTints[] =
+	{
+		{ 1.00f, 0.45f, 0.45f, 1.0f },
+		{ 0.45f, 1.00f, 0.45f, 1.0f },
+		{ 0.45f, 0.45f, 1.00f, 1.0f },
+		{ 1.00f, 1.00f, 0.40f, 1.0f },
+		{ 0.40f, 1.00f, 1.00f, 1.0f },
+		{ 1.00f, 0.40f, 1.00f, 1.0f },
+		{ 1.00f, 0.70f, 0.30f, 1.0f },
+	};
+
+	// Esfera envolvente (centro da caixa alinhada) e cone das normais. Na esfera de raio 1 a normal  a prpria posio
+	void ComputePatchBounds(const std::vector<glm::vec3>& Positions, const std::vector<GLuint>& Indices, size_t FirstIndex, DrawBatchItem& Patch)
+	{
+		glm::vec3 Min{ std::numeric_limits<float>::max() };
+		glm::vec3 Max{ -std::numeric_limits<float>::max() };
+		glm::vec3 NormalSum{ 0.0f };
+		for (size_t Index = FirstIndex; Index < FirstIndex + Patch.IndexCount; ++Index)
+		{
+			const glm::vec3& Position = Positions[Indices[Index]];
+			Min = glm::min(Min, Position);
+			Max = glm::max(Max, Position);
+			NormalSum += glm::normalize(Position);
+		}
+
+		Patch.Center = (Min + Max) * 0.5f;
+		Patch.Radius = 0.0f;
+		for (size_t Index = FirstIndex; Index < FirstIndex + Patch.IndexCount; ++Index)
+		{
+			Patch.Radius = std::max(Patch.Radius, glm::length(Positions[Indices[Index]] - Patch.Center));
+		}
+
+		// Patches nos polos abrangem normais em quase todas as direes: sem cone til, nunca so descartados por estarem de costas
+		Patch.ConeSin = 1.0f;
+		if (glm::length(NormalSum) > 1e-4f)
+		{
+			Patch.ConeAxis = glm::normalize(NormalSum);
+
+			float MinCos = 1.0f;
+			for (size_t Index = FirstIndex; Index < FirstIndex + Patch.IndexCount; ++Index)
+			{
+				MinCos = std::min(MinCos, glm::dot(Patch.ConeAxis, glm::normalize(Positions[Indices[Index]])));
+			}
+			if (MinCos > 0.0f)
+			{
+				Patch.ConeSin = std::sqrt(1.0f - MinCos * MinCos);
+			}
+		}
+	}
+}
+
+void BuildSpherePatches(const std::vector<glm::vec3>& Positions, GLuint Resolution, int PatchesPerSide, std::vector<GLuint>& Indices, std::vector<DrawBatchItem>& Patches)
+{
+	Indices.clear();
+	Patches.clear();
+
+	const GLuint QuadsPerSide = Resolution - 1;
+	PatchesPerSide = std::clamp(PatchesPerSide, 1, static_cast<int>(QuadsPerSide));
+
+	for (int PatchV = 0; PatchV < PatchesPerSide; ++PatchV)
+	{
+		const GLuint FirstV = QuadsPerSide * PatchV / PatchesPerSide;
+		const GLuint LastV = QuadsPerSide * (PatchV + 1) / PatchesPerSide;
+
+		for (int PatchU = 0; PatchU < PatchesPerSide; ++PatchU)
+		{
+			const GLuint FirstU = QuadsPerSide * PatchU / PatchesPerSide;
+			const GLuint LastU = QuadsPerSide * (PatchU + 1) / PatchesPerSide;
+
+			DrawBatchItem Patch;
+			Patch.FirstIndex = static_cast<GLuint>(Indices.size());
+
+			// Mesmos quads e mesma diviso em tringulos de GenerateSphere
+			for (GLuint U = FirstU; U < LastU; ++U)
+			{
+				for (GLuint V = FirstV; V < LastV; ++V)
+				{
+					GLuint P0 = U + V * Resolution;
+					GLuint P1 = U + 1 + V * Resolution;
+					GLuint P2 = U + (V + 1) * Resolution;
+					GLuint P3 = U + 1 + (V + 1) * Resolution;
+
+					Indices.insert(Indices.end(), { P3, P2, P0 });
+					Indices.insert(Indices.end(), { P1, P3, P0 });
+				}
+			}
+
+			Patch.IndexCount = static_cast<GLuint>(Indices.size()) - Patch.FirstIndex;
+			ComputePatchBounds(Positions, Indices, Patch.FirstIndex, Patch);
+			Patches.push_back(Patch);
+		}
+	}
+}
+
+std::vector<BatchDrawData> MakePatchDrawData(size_t PatchCount, bool bShowPatches)
+{
+	std::vector<BatchDrawData> DrawData(PatchCount);
+	if (bShowPatches)
+	{
+		for (size_t Index = 0; Index < PatchCount; ++Index)
+		{
+			DrawData[Index].Tint = PatchTints[Index % std::size(PatchTints)];
+		}
+	}
+	return DrawData;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "DrawBatcher.h"
+
+// Divide a malha da esfera de GenerateSphere (grade de Resolution x Resolution vrtices) em PatchesPerSide x PatchesPerSide
+//	patches. Indices recebe os mesmos tringulos de GenerateSphere, reordenados para que cada patch ocupe um intervalo
+//	contguo do index buffer, e Patches, o intervalo e os volumes de descarte de cada um
+void BuildSpherePatches(const std::vector<glm::vec3>& Positions, GLuint Resolution, int PatchesPerSide, std::vector<GLuint>& Indices, std::vector<DrawBatchItem>& Patches);
+
+// Dados por draw dos patches: todos brancos ou, com bShowPatches, uma cor por patch para visualizar o descarte
+std::vector<BatchDrawData> MakePatchDrawData(size_t PatchCount, bool bShowPatches);
@@ -0,0 +1,161 @@
+#include "HudOverlay.h"
+
+#include <cstdint>
+#include <iostream>
+
+#include <stb_easy_font.h>
+
+#include "DrawStatistics.h"
+#include "GLStateCache.h"
+#include "Shader.h"
+
+namespace
+{
+	constexpr size_t BytesPerVertex = 16;
+	constexpr size_t BytesPerQuad = 4 * BytesPerVertex;
+
+	// O stb_easy_font usa em mdia ~270 bytes de vrtices por caractere
+	constexpr size_t BytesPerCharacter = 270;
+
+	constexpr float Margin = 4.0f; // Em pixels da fonte
+	constexpr float LineHeight = 10.0f;
+}
+
+bool HudOverlay::Create()
+{
+	ProgramId = LoadShaders("shaders/hud_vert.glsl", "shaders/hud_frag.glsl");
+	if (ProgramId == 0)
+	{
+		std::cout << "Erro ao carregar os shaders do HUD" << std::endl;
+		return false;
+	}
+
+	ViewportSizeLocation = glGetUniformLocation(ProgramId, "ViewportSize");
+	TextScaleLocation = glGetUniformLocation(ProgramId, "TextScale");
+	OffsetLocation = glGetUniformLocation(ProgramId, "Offset");
+	TintLocation = glGetUniformLocation(ProgramId, "Tint");
+
+	GLStateCache& StateCache = GetGLStateCache();
+
+	glGenVertexArrays(1, &VertexArray);
+	StateCache.BindVertexArray(VertexArray);
+
+	glGenBuffers(1, &VertexBuffer);
+	StateCache.BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, BytesPerVertex, nullptr);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, BytesPerVertex, reinterpret_cast<void*>(3 * sizeof(float)));
+
+	glGenBuffers(1, &IndexBuffer);
+
+	StateCache.BindVertexArray(0);
+	return true;
+}
+
+void HudOverlay::AddLine(const std::string& Text)
+{
+	Lines.push_back(Text);
+}
+
+void HudOverlay::Draw(int Width, int Height)
+{
+	if (ProgramId == 0 || Lines.empty())
+	{
+		Lines.clear();
+		return;
+	}
+
+	Vertices.clear();
+	size_t NumQuads = 0;
+	float Y = Margin;
+	for (std::string& Line : Lines)
+	{
+		const size_t Offset = NumQuads * BytesPerQuad;
+		Vertices.resize(Offset + (Line.size() + 1) * BytesPerCharacter);
+		NumQuads += stb_easy_font_print(Margin, Y, &Line[0], nullptr, Vertices.data() + Offset, static_cast<int>(Vertices.size() - Offset));
+		Y += LineHeight;
+	}
+	Lines.clear();
+
+	if (NumQuads == 0)
+	{
+		return;
+	}
+
+	GLStateCache& StateCache = GetGLStateCache();
+	StateCache.BindVertexArray(VertexArray);
+
+	// Os quads compartilham um nico buffer de ndices (dois tringulos por quad), que s cresce
+	if (NumQuads > IndexedQuads)
+	{
+		std::vector<GLuint> Indices;
+		Indices.reserve(NumQuads * 6);
+		for (GLuint Quad = 0; Quad < NumQuads; ++Quad)
+		{
+			const GLuint First = Quad * 4;
+			for (GLuint Corner : { 0u, 1u, 2u, 0u, 2u, 3u })
+			{
+				Indices.push_back(First + Corner);
+			}
+		}
+		StateCache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(GLuint), Indices.data(), GL_STATIC_DRAW);
+		IndexedQuads = NumQuads;
+	}
+
+	// Orphaning: o texto muda a cada frame
+	StateCache.BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, NumQuads * BytesPerQuad, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, NumQuads * BytesPerQuad, Vertices.data());
+
+	StateCache.SetCapability(GL_DEPTH_TEST, false);
+	StateCache.SetCapability(GL_CULL_FACE, false);
+	StateCache.SetPolygonMode(GL_FILL);
+	StateCache.UseProgram(ProgramId);
+
+	glUniform2f(ViewportSizeLocation, static_cast<float>(Width), static_cast<float>(Height));
+	glUniform1f(TextScaleLocation, TextScale);
+
+	// Sombra deslocada de um pixel da fonte, para o texto ser legvel sobre as nuvens
+	const GLsizei IndexCount = static_cast<GLsizei>(NumQuads * 6);
+	glUniform2f(OffsetLocation, TextScale, TextScale);
+	glUniform4f(TintLocation, 0.0f, 0.0f, 0.0f, 1.0f);
+	glDrawElements(GL_TRIANGLES, IndexCount, GL_UNSIGNED_INT, nullptr);
+	CountDraw(GL_TRIANGLES, IndexCount);
+
+	glUniform2f(OffsetLocation, 0.0f, 0.0f);
+	glUniform4f(TintLocation, 1.0f, 1.0f, 1.0f, 1.0f);
+	glDrawElements(GL_TRIANGLES, IndexCount, GL_UNSIGNED_INT, nullptr);
+	CountDraw(GL_TRIANGLES, IndexCount);
+
+	StateCache.SetCapability(GL_DEPTH_TEST, true);
+	StateCache.SetCapability(GL_CULL_FACE, true);
+}
+
+void HudOverlay::Release()
+{
+	GLStateCache& StateCache = GetGLStateCache();
+	if (ProgramId != 0)
+	{
+		StateCache.OnProgramDeleted(ProgramId);
+		glDeleteProgram(ProgramId);
+		ProgramId = 0;
+	}
+	for (GLuint* Buffer : { &VertexBuffer, &IndexBuffer })
+	{
+		if (*Buffer != 0)
+		{
+			StateCache.OnBufferDeleted(*Buffer);
+			glDeleteBuffers(1, Buffer);
+			*Buffer = 0;
+		}
+	}
+	if (VertexArray != 0)
+	{
+		StateCache.OnVertexArrayDeleted(VertexArray);
+		glDeleteVertexArrays(1, &VertexArray);
+		VertexArray = 0;
+	}
+	IndexedQuads = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Texto sobreposto  imagem final (fps, tempos, escala da resoluo), desenhado na resoluo nativa da janela depois
+//	da ampliao da cena. As letras so quads sem textura gerados pelo stb_easy_font
+class HudOverlay
+{
+public:
+	bool Create();
+
+	// Acrescenta uma linha abaixo das anteriores
+	void AddLine(const std::string& Text);
+
+	// Desenha as linhas acumuladas no framebuffer ligado (Width x Height pixels) e as descarta.
+	//	Deixa o teste de profundidade e o descarte de faces ligados, como o resto do programa espera
+	void Draw(int Width, int Height);
+
+	void Release();
+
+	// Pixels da janela por pixel da fonte (a fonte tem ~7 pixels de altura)
+	float TextScale = 2.0f;
+
+private:
+	std::vector<std::string> Lines;
+	std::vector<char> Vertices; // Formato do stb_easy_font: x, y, z (float) e cor (4 x uint8) por vrtice
+
+	GLuint ProgramId = 0;
+	GLuint VertexArray = 0;
+	GLuint VertexBuffer = 0;
+	GLuint IndexBuffer = 0;
+	size_t IndexedQuads = 0;
+
+	GLint ViewportSizeLocation = -1;
+	GLint TextScaleLocation = -1;
+	GLint OffsetLocation = -1;
+	GLint TintLocation = -1;
+};
@@ -0,0 +1,230 @@
+#include "InputQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+
+namespace
+{
+	struct InputRecordingHeader
+	{
+		char Magic[4] = { 'B', 'M', 'I', 'R' };
+		uint32_t Version = 1;
+		uint32_t NumEvents = 0;
+		uint32_t Reserved = 0;
+		double Duration = 0.0; // Segundos
+	};
+
+	// Evento como fica no arquivo. O cursor em float  o que a cmera usa (SimpleCamera::ConsumeCursor), ento a
+	//	reproduo no perde nada; o instante em microssegundos cobre mais de uma hora de gravao
+	struct RecordedInputEvent
+	{
+		uint32_t TimeMicroseconds = 0;
+		float X = 0.0f;
+		float Y = 0.0f;
+		int16_t Code = 0;
+		uint8_t Type = 0;
+		uint8_t Action = 0;
+	};
+
+	static_assert(sizeof(RecordedInputEvent) == 16, "Registro da gravao de entrada com tamanho inesperado");
+}
+
+InputQueue::InputQueue(size_t Capacity)
+	: Events(std::max<size_t>(Capacity, 1))
+	, StartTime{ std::chrono::steady_clock::now() }
+{
+}
+
+void InputQueue::Push(const InputEvent& Event)
+{
+	TotalEvents++;
+	EventsByType[static_cast<size_t>(Event.Type)]++;
+
+	if (Count == Events.size())
+	{
+		DroppedEvents++;
+		return;
+	}
+
+	Events[(Head + Count) % Events.size()] = Event;
+	Count++;
+}
+
+size_t InputQueue::Drain(const std::function<void(const InputEvent&)>& Visit)
+{
+	const size_t Batch = Count;
+	for (; Count > 0; --Count)
+	{
+		Visit(Events[Head]);
+		Head = (Head + 1) % Events.size();
+	}
+
+	Drains++;
+	if (Batch > 0)
+	{
+		NonEmptyDrains++;
+		MaxBatch = std::max(MaxBatch, Batch);
+	}
+	return Batch;
+}
+
+double InputQueue::GetEventRate() const
+{
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	return Seconds > 0.0 ? TotalEvents / Seconds : 0.0;
+}
+
+void InputQueue::PrintReport(std::ostream& Output) const
+{
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	const double CursorRate = Seconds > 0.0 ? EventsByType[static_cast<size_t>(EInputEventType::CursorMove)] / Seconds : 0.0;
+	const double AverageBatch = NonEmptyDrains > 0 ? static_cast<double>(TotalEvents - DroppedEvents) / NonEmptyDrains : 0.0;
+
+	Output << "Fila de entrada: " << TotalEvents << " eventos (" << std::fixed << std::setprecision(1) << GetEventRate()
+		   << " por segundo, cursor " << CursorRate << " por segundo), " << EventsByType[static_cast<size_t>(EInputEventType::Key)]
+		   << " de teclado, " << EventsByType[static_cast<size_t>(EInputEventType::MouseButton)] << " de botes, "
+		   << AverageBatch << " em mdia e " << MaxBatch << " no mximo por processamento (" << Drains << "), "
+		   << DroppedEvents << " descartados com a fila cheia" << std::defaultfloat << std::endl;
+}
+
+bool InputRecorder::Open(const char* FileName, double InStartTime)
+{
+	File.open(FileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!File)
+	{
+		std::cout << "Erro ao criar a gravao da entrada " << FileName << std::endl;
+		return false;
+	}
+
+	// O cabealho  reescrito em Close, com o nmero de eventos e a durao
+	const InputRecordingHeader Header;
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+
+	StartTime = InStartTime;
+	RecordedEvents = 0;
+	return true;
+}
+
+bool InputRecorder::IsOpen() const
+{
+	return File.is_open();
+}
+
+void InputRecorder::Record(const InputEvent& Event)
+{
+	if (!File.is_open())
+	{
+		return;
+	}
+
+	RecordedInputEvent Recorded;
+	Recorded.TimeMicroseconds = static_cast<uint32_t>(std::llround(std::max(0.0, Event.Time - StartTime) * 1e6));
+	Recorded.X = static_cast<float>(Event.X);
+	Recorded.Y = static_cast<float>(Event.Y);
+	Recorded.Code = static_cast<int16_t>(Event.Code);
+	Recorded.Type = static_cast<uint8_t>(Event.Type);
+	Recorded.Action = static_cast<uint8_t>(Event.Action);
+
+	File.write(reinterpret_cast<const char*>(&Recorded), sizeof(Recorded));
+	RecordedEvents++;
+}
+
+void InputRecorder::Close(double EndTime)
+{
+	if (!File.is_open())
+	{
+		return;
+	}
+
+	InputRecordingHeader Header;
+	Header.NumEvents = RecordedEvents;
+	Header.Duration = std::max(0.0, EndTime - StartTime);
+
+	File.seekp(0);
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	File.close();
+}
+
+uint32_t InputRecorder::GetRecordedEvents() const
+{
+	return RecordedEvents;
+}
+
+bool InputPlayback::Open(const char* FileName)
+{
+	std::ifstream File{ FileName, std::ios::in | std::ios::binary };
+	if (!File)
+	{
+		std::cout << "Erro ao abrir a gravao da entrada " << FileName << std::endl;
+		return false;
+	}
+
+	InputRecordingHeader Header;
+	const InputRecordingHeader Expected;
+	if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header)) ||
+		std::memcmp(Header.Magic, Expected.Magic, sizeof(Header.Magic)) != 0 || Header.Version != Expected.Version)
+	{
+		std::cout << "Gravao da entrada invlida: " << FileName << std::endl;
+		return false;
+	}
+
+	Events.clear();
+	Events.reserve(Header.NumEvents);
+	for (uint32_t Index = 0; Index < Header.NumEvents; ++Index)
+	{
+		RecordedInputEvent Recorded;
+		if (!File.read(reinterpret_cast<char*>(&Recorded), sizeof(Recorded)) || Recorded.Type >= static_cast<uint8_t>(EInputEventType::Count))
+		{
+			std::cout << "Gravao da entrada truncada: " << FileName << " (" << Index << " de " << Header.NumEvents << " eventos)" << std::endl;
+			break;
+		}
+
+		InputEvent Event;
+		Event.Type = static_cast<EInputEventType>(Recorded.Type);
+		Event.Code = Recorded.Code;
+		Event.Action = Recorded.Action;
+		Event.X = Recorded.X;
+		Event.Y = Recorded.Y;
+		Event.Time = Recorded.TimeMicroseconds * 1e-6;
+		Events.push_back(Event);
+	}
+
+	NextEvent = 0;
+	Duration = std::max(Header.Duration, Events.empty() ? 0.0 : Events.back().Time);
+	bOpen = true;
+	return true;
+}
+
+bool InputPlayback::IsOpen() const
+{
+	return bOpen;
+}
+
+size_t InputPlayback::Feed(double Time, const std::function<void(const InputEvent&)>& Deliver)
+{
+	const size_t FirstEvent = NextEvent;
+	for (; NextEvent < Events.size() && Events[NextEvent].Time <= Time; ++NextEvent)
+	{
+		Deliver(Events[NextEvent]);
+	}
+	return NextEvent - FirstEvent;
+}
+
+bool InputPlayback::IsFinished(double Time) const
+{
+	return NextEvent == Events.size() && Time >= Duration;
+}
+
+size_t InputPlayback::GetNumEvents() const
+{
+	return Events.size();
+}
+
+double InputPlayback::GetDuration() const
+{
+	return Duration;
+}
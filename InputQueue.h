@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+enum class EInputEventType : uint8_t
+{
+	CursorMove,
+	MouseButton,
+	Key,
+
+	Count
+};
+
+// Evento de entrada como chegou do GLFW, com o instante e o nmero dados pelo InputLatencyTracker
+struct InputEvent
+{
+	EInputEventType Type = EInputEventType::CursorMove;
+	int Code = 0; // Tecla ou boto
+	int Action = 0; // GLFW_PRESS, GLFW_RELEASE ou GLFW_REPEAT
+	double X = 0.0; // Posio do cursor (no clique, a posio no momento do clique)
+	double Y = 0.0;
+	double Time = 0.0;
+	uint64_t Number = 0;
+};
+
+// Anel de tamanho fixo entre os callbacks do GLFW e a simulao: os callbacks s copiam o evento e, uma vez por passo
+//	da simulao, Drain entrega todos em ordem para serem reduzidos (ex.: todos os movimentos do cursor viram uma nica
+//	rotao da cmera). Com o anel cheio, os eventos novos so descartados e contados.
+// Sem sincronizao: os callbacks e a simulao rodam na thread principal, a nica em que o GLFW processa eventos
+class InputQueue
+{
+public:
+	explicit InputQueue(size_t Capacity = 1024);
+
+	void Push(const InputEvent& Event);
+
+	// Entrega os eventos pendentes, do mais antigo ao mais novo, e esvazia o anel. Retorna quantos foram entregues
+	size_t Drain(const std::function<void(const InputEvent&)>& Visit);
+
+	// Eventos por segundo desde a criao da fila
+	double GetEventRate() const;
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	std::vector<InputEvent> Events;
+	size_t Head = 0;
+	size_t Count = 0;
+
+	std::chrono::steady_clock::time_point StartTime;
+	uint64_t TotalEvents = 0;
+	uint64_t EventsByType[static_cast<size_t>(EInputEventType::Count)] = {};
+	uint64_t DroppedEvents = 0;
+	uint64_t Drains = 0;
+	uint64_t NonEmptyDrains = 0;
+	size_t MaxBatch = 0;
+};
+
+// Grava os eventos de entrada em um arquivo binrio compacto (16 bytes por evento), com o instante relativo ao incio da
+//	gravao. Reproduzido por InputPlayback, o arquivo repete a mesma sesso sem ningum na frente da janela
+class InputRecorder
+{
+public:
+	bool Open(const char* FileName, double InStartTime);
+	bool IsOpen() const;
+
+	void Record(const InputEvent& Event);
+
+	// Grava a durao da sesso no cabealho: a reproduo continua at esse instante, mesmo sem eventos no final
+	void Close(double EndTime);
+
+	uint32_t GetRecordedEvents() const;
+
+private:
+	std::ofstream File;
+	double StartTime = 0.0;
+	uint32_t RecordedEvents = 0;
+};
+
+// L uma gravao de InputRecorder e entrega os eventos conforme o relgio da reproduo avana. Com o relgio avanando
+//	em passos fixos (e no pelo tempo real), cada execuo aplica os mesmos eventos nos mesmos passos da simulao
+class InputPlayback
+{
+public:
+	bool Open(const char* FileName);
+	bool IsOpen() const;
+
+	// Entrega os eventos com instante at Time (segundos desde o incio da gravao) ainda no entregues
+	size_t Feed(double Time, const std::function<void(const InputEvent&)>& Deliver);
+
+	// Todos os eventos foram entregues e a durao da gravao foi alcanada
+	bool IsFinished(double Time) const;
+
+	size_t GetNumEvents() const;
+	double GetDuration() const;
+
+private:
+	std::vector<InputEvent> Events;
+	size_t NextEvent = 0;
+	double Duration = 0.0;
+	bool bOpen = false;
+};
@@ -0,0 +1,208 @@
+#include "InstancedBodies.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <random>
+
+#include <glm/ext.hpp>
+
+#include "DrawStatistics.h"
+#include "GLStateCache.h"
+
+namespace
+{
+	// Material 0  o globo sem alterao; os demais tingem a mesma textura (luas, planetas e marcadores)
+	const glm::vec4 DefaultTints[] =
+	{
+		{ 1.00f, 1.00f, 1.00f, 1.0f },
+		{ 0.55f, 0.55f, 0.55f, 1.0f },
+		{ 0.90f, 0.45f, 0.25f, 1.0f },
+		{ 0.95f, 0.80f, 0.45f, 1.0f },
+		{ 0.40f, 0.60f, 1.00f, 1.0f },
+		{ 0.60f, 1.00f, 0.60f, 1.0f },
+		{ 1.00f, 0.30f, 0.30f, 1.0f },
+		{ 1.00f, 1.00f, 0.20f, 1.0f },
+	};
+}
+
+void InstancedBodies::Create(int MaxCount)
+{
+	MaxCount = std::max(1, MaxCount);
+
+	// Semente fixa: as mesmas rbitas em todas as execues, para que os benchmarks sejam comparveis
+	std::mt19937 Random{ 42 };
+	std::uniform_real_distribution<float> Unit{ 0.0f, 1.0f };
+
+	Orbits.resize(MaxCount);
+	Instances.resize(MaxCount);
+	for (int Index = 1; Index < MaxCount; ++Index)
+	{
+		Orbit& Body = Orbits[Index];
+		Body.Radius = glm::mix(1.6f, 8.0f, Unit(Random));
+		Body.Inclination = glm::mix(-0.5f, 0.5f, Unit(Random));
+		Body.Phase = glm::two_pi<float>() * Unit(Random);
+		Body.AngularSpeed = 0.6f / Body.Radius; // rbitas externas so mais lentas
+		Body.Scale = glm::mix(0.03f, 0.25f, Unit(Random) * Unit(Random));
+		Body.SpinSpeed = glm::mix(-1.0f, 1.0f, Unit(Random));
+
+		Instances[Index].MaterialIndex = 1 + static_cast<uint32_t>(Index % (std::size(DefaultTints) - 1));
+	}
+	Instances[0].MaterialIndex = 0;
+	Count = MaxCount;
+
+	glGenBuffers(1, &InstanceBuffer);
+	GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, Instances.size() * sizeof(BodyInstance), nullptr, GL_STREAM_DRAW);
+
+	MaterialPaletteData Palette = {};
+	for (int Material = 0; Material < MaxBodyMaterials; ++Material)
+	{
+		Palette.Tints[Material] = DefaultTints[Material % std::size(DefaultTints)];
+	}
+	glGenBuffers(1, &PaletteBuffer);
+	GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, PaletteBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Palette), &Palette, GL_STATIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, MaterialPaletteBinding, PaletteBuffer);
+}
+
+void InstancedBodies::SetCount(int InCount)
+{
+	Count = std::clamp(InCount, 1, static_cast<int>(Instances.size()));
+}
+
+int InstancedBodies::GetCount() const
+{
+	return Count;
+}
+
+void InstancedBodies::SetupInstanceAttributes()
+{
+	GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+
+	// Uma mat4 ocupa quatro localizaes consecutivas, uma coluna (vec4) em cada
+	for (GLuint Column = 0; Column < 4; ++Column)
+	{
+		const GLuint Location = 4 + Column;
+		glEnableVertexAttribArray(Location);
+		glVertexAttribPointer(Location, 4, GL_FLOAT, GL_FALSE, sizeof(BodyInstance),
+							  reinterpret_cast<void*>(offsetof(BodyInstance, ModelMatrix) + Column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(Location, 1); // Avana uma vez por instncia, no por vrtice
+	}
+
+	glEnableVertexAttribArray(8);
+	glVertexAttribIPointer(8, 1, GL_UNSIGNED_INT, sizeof(BodyInstance), reinterpret_cast<void*>(offsetof(BodyInstance, MaterialIndex)));
+	glVertexAttribDivisor(8, 1);
+}
+
+void InstancedBodies::Update(float Time, const glm::mat4& GlobeModelMatrix)
+{
+	Instances[0].ModelMatrix = GlobeModelMatrix;
+
+	for (int Index = 1; Index < Count; ++Index)
+	{
+		const Orbit& Body = Orbits[Index];
+		const float Angle = Body.Phase + Time * Body.AngularSpeed;
+
+		// rbita circular no plano xz inclinada em torno de x, com rotao prpria do corpo
+		glm::vec3 Position{ Body.Radius * glm::cos(Angle), 0.0f, Body.Radius * glm::sin(Angle) };
+		Position = glm::vec3{ glm::rotate(glm::identity<glm::mat4>(), Body.Inclination, glm::vec3{ 1.0f, 0.0f, 0.0f }) * glm::vec4{ Position, 1.0f } };
+
+		glm::mat4 ModelMatrix = glm::translate(glm::identity<glm::mat4>(), Position);
+		ModelMatrix = glm::rotate(ModelMatrix, Time * Body.SpinSpeed, glm::vec3{ 0.0f, 1.0f, 0.0f });
+		ModelMatrix = glm::scale(ModelMatrix, glm::vec3{ Body.Scale });
+		Instances[Index].ModelMatrix = ModelMatrix * GlobeModelMatrix;
+	}
+
+	// Orphaning: o driver entrega memria nova em vez de esperar a GPU terminar de ler as instncias do frame anterior
+	GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, Instances.size() * sizeof(BodyInstance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, Count * sizeof(BodyInstance), Instances.data());
+}
+
+void InstancedBodies::Draw(GLsizei IndexCount) const
+{
+	glDrawElementsInstanced(GL_TRIANGLES, IndexCount, GL_UNSIGNED_INT, nullptr, Count);
+	CountDraw(GL_TRIANGLES, IndexCount, Count);
+}
+
+void InstancedBodies::Release()
+{
+	GLStateCache& StateCache = GetGLStateCache();
+	if (InstanceBuffer != 0)
+	{
+		StateCache.OnBufferDeleted(InstanceBuffer);
+		glDeleteBuffers(1, &InstanceBuffer);
+		InstanceBuffer = 0;
+	}
+	if (PaletteBuffer != 0)
+	{
+		StateCache.OnBufferDeleted(PaletteBuffer);
+		glDeleteBuffers(1, &PaletteBuffer);
+		PaletteBuffer = 0;
+	}
+}
+
+InstanceBenchmark::InstanceBenchmark(const std::vector<int>& InCounts, int InFramesPerCount)
+	: Counts(InCounts)
+	, Samples(InCounts.size())
+	, FramesPerCount(std::max(1, InFramesPerCount))
+{
+}
+
+bool InstanceBenchmark::IsFinished() const
+{
+	return CurrentIndex >= Counts.size();
+}
+
+int InstanceBenchmark::GetInstanceCount() const
+{
+	return IsFinished() ? Counts.back() : Counts[CurrentIndex];
+}
+
+void InstanceBenchmark::RecordFrame(double SubmitSeconds, double FrameSeconds)
+{
+	if (IsFinished())
+	{
+		return;
+	}
+
+	if (CurrentFrame++ >= WarmupFrames)
+	{
+		Sample& Current = Samples[CurrentIndex];
+		Current.SubmitSeconds += SubmitSeconds;
+		Current.FrameSeconds += FrameSeconds;
+		Current.Frames++;
+	}
+
+	if (CurrentFrame >= WarmupFrames + FramesPerCount)
+	{
+		CurrentFrame = 0;
+		CurrentIndex++;
+	}
+}
+
+void InstanceBenchmark::PrintReport(std::ostream& Output) const
+{
+	Output << "Benchmark de instncias (" << FramesPerCount << " frames por quantidade)" << std::endl;
+	Output << "  instncias   envio CPU (ms)   por instncia (us)   frame (ms)" << std::endl;
+
+	for (size_t Index = 0; Index < Counts.size(); ++Index)
+	{
+		const Sample& Current = Samples[Index];
+		if (Current.Frames == 0)
+		{
+			continue;
+		}
+
+		const double SubmitMilliseconds = 1000.0 * Current.SubmitSeconds / Current.Frames;
+		const double FrameMilliseconds = 1000.0 * Current.FrameSeconds / Current.Frames;
+		Output << std::fixed << std::setprecision(3)
+			   << "  " << std::setw(10) << Counts[Index]
+			   << "   " << std::setw(14) << SubmitMilliseconds
+			   << "   " << std::setw(18) << 1000.0 * SubmitMilliseconds / Counts[Index]
+			   << "   " << std::setw(10) << FrameMilliseconds
+			   << std::defaultfloat << std::endl;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Ponto de ligao do bloco MaterialPalette (cores por material dos corpos instanciados)
+constexpr GLuint MaterialPaletteBinding = 1;
+constexpr int MaxBodyMaterials = 16;
+
+// Dados de cada instncia no buffer de instncias: a matriz ocupa as localizaes 4 a 7 do vertex shader e o material,
+//	a localizao 8 (atributo inteiro). A matriz normal no  enviada: o shader a deriva da ModelView da instncia
+struct BodyInstance
+{
+	glm::mat4 ModelMatrix;
+	uint32_t MaterialIndex;
+};
+
+// Cor multiplicada pela superfcie de cada material, no layout std140 do bloco MaterialPalette
+struct MaterialPaletteData
+{
+	glm::vec4 Tints[MaxBodyMaterials];
+};
+
+// Corpos (planetas, luas, marcadores) que compartilham a malha da esfera, desenhados com um nico
+//	glDrawElementsInstanced. A instncia 0  o prprio globo; as demais orbitam em torno dele
+class InstancedBodies
+{
+public:
+	// Gera as rbitas (determinsticas) de at MaxCount corpos e cria o buffer de instncias e a paleta de materiais
+	void Create(int MaxCount);
+
+	// Quantidade de instncias desenhadas (no mximo a informada em Create)
+	void SetCount(int InCount);
+	int GetCount() const;
+
+	// Liga o buffer de instncias ao VAO atualmente ativo (atributos 4 a 8, com divisor 1)
+	void SetupInstanceAttributes();
+
+	// Recalcula as matrizes de todas as instncias no instante Time e as copia para o buffer (uma cpia por frame)
+	void Update(float Time, const glm::mat4& GlobeModelMatrix);
+
+	// Desenha todas as instncias com a malha do VAO ativo
+	void Draw(GLsizei IndexCount) const;
+
+	void Release();
+
+private:
+	struct Orbit
+	{
+		float Radius = 0.0f;
+		float Inclination = 0.0f;
+		float Phase = 0.0f;
+		float AngularSpeed = 0.0f;
+		float Scale = 1.0f;
+		float SpinSpeed = 0.0f;
+	};
+
+	std::vector<Orbit> Orbits;
+	std::vector<BodyInstance> Instances;
+
+	int Count = 0;
+	GLuint InstanceBuffer = 0;
+	GLuint PaletteBuffer = 0;
+};
+
+// Modo de benchmark (--instance-benchmark): percorre quantidades crescentes de instncias, FramesPerCount frames cada,
+//	medindo o tempo de CPU para montar e enviar as instncias (Update + Draw) e o tempo total do frame
+class InstanceBenchmark
+{
+public:
+	InstanceBenchmark(const std::vector<int>& InCounts, int InFramesPerCount);
+
+	bool IsFinished() const;
+	int GetInstanceCount() const;
+
+	void RecordFrame(double SubmitSeconds, double FrameSeconds);
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	struct Sample
+	{
+		double SubmitSeconds = 0.0;
+		double FrameSeconds = 0.0;
+		int Frames = 0;
+	};
+
+	std::vector<int> Counts;
+	std::vector<Sample> Samples;
+	int FramesPerCount = 0;
+	int WarmupFrames = 5; // Frames descartados a cada troca de quantidade (realocao do buffer, caches frios)
+	size_t CurrentIndex = 0;
+	int CurrentFrame = 0;
+};
@@ -0,0 +1,119 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+namespace
+{
+	// Limites superiores das faixas, em milissegundos; a ltima faixa recebe tudo acima de 100 ms
+	const double BucketLimits[] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 50.0, 100.0 };
+
+	constexpr int BarWidth = 40;
+}
+
+void LatencyHistogram::Record(double Seconds)
+{
+	Samples.push_back(std::max(0.0, Seconds));
+}
+
+size_t LatencyHistogram::GetCount() const
+{
+	return Samples.size();
+}
+
+double LatencyHistogram::GetPercentile(double Percentile) const
+{
+	if (Samples.empty())
+	{
+		return 0.0;
+	}
+
+	std::vector<double> Sorted = Samples;
+	const size_t Index = std::min(Sorted.size() - 1, static_cast<size_t>(Percentile / 100.0 * Sorted.size()));
+	std::nth_element(Sorted.begin(), Sorted.begin() + Index, Sorted.end());
+	return Sorted[Index];
+}
+
+void LatencyHistogram::PrintReport(std::ostream& Output, const char* Title) const
+{
+	Output << Title << ": " << Samples.size() << " amostras";
+	if (Samples.empty())
+	{
+		Output << std::endl;
+		return;
+	}
+
+	Output << std::fixed << std::setprecision(2)
+		   << ", p50 " << GetPercentile(50.0) * 1000.0 << " ms"
+		   << ", p95 " << GetPercentile(95.0) * 1000.0 << " ms"
+		   << ", p99 " << GetPercentile(99.0) * 1000.0 << " ms"
+		   << ", mx " << *std::max_element(Samples.begin(), Samples.end()) * 1000.0 << " ms" << std::endl;
+
+	size_t Counts[std::size(BucketLimits) + 1] = {};
+	for (double Seconds : Samples)
+	{
+		const double Milliseconds = Seconds * 1000.0;
+		const size_t Bucket = std::upper_bound(std::begin(BucketLimits), std::end(BucketLimits), Milliseconds) - std::begin(BucketLimits);
+		Counts[Bucket]++;
+	}
+
+	const size_t MaxCount = *std::max_element(std::begin(Counts), std::end(Counts));
+	for (size_t Bucket = 0; Bucket < std::size(Counts); ++Bucket)
+	{
+		const double Lower = Bucket == 0 ? 0.0 : BucketLimits[Bucket - 1];
+		Output << "  " << std::setw(6) << std::setprecision(1) << Lower << " - ";
+		if (Bucket < std::size(BucketLimits))
+		{
+			Output << std::setw(6) << BucketLimits[Bucket] << " ms ";
+		}
+		else
+		{
+			Output << "   ... ms ";
+		}
+
+		const int Bar = MaxCount > 0 ? static_cast<int>(Counts[Bucket] * BarWidth / MaxCount) : 0;
+		Output << std::string(Bar, '#') << std::string(BarWidth - Bar, ' ') << " " << Counts[Bucket] << std::endl;
+	}
+	Output << std::defaultfloat;
+}
+
+uint64_t InputLatencyTracker::RecordEvent(double Time)
+{
+	std::lock_guard<std::mutex> Lock{ Mutex };
+	Pending.push_back(PendingEvent{ ++LatestEvent, Time });
+	if (Pending.size() > MaxPendingEvents)
+	{
+		Pending.pop_front();
+		DroppedEvents++;
+	}
+	return LatestEvent;
+}
+
+uint64_t InputLatencyTracker::GetLatestEvent() const
+{
+	std::lock_guard<std::mutex> Lock{ Mutex };
+	return LatestEvent;
+}
+
+void InputLatencyTracker::OnFramePresented(uint64_t LastEvent, double PresentTime)
+{
+	std::lock_guard<std::mutex> Lock{ Mutex };
+	while (!Pending.empty() && Pending.front().Number <= LastEvent)
+	{
+		Latencies.Record(PresentTime - Pending.front().Time);
+		Pending.pop_front();
+	}
+}
+
+void InputLatencyTracker::PrintReport(std::ostream& Output, const char* Title) const
+{
+	std::lock_guard<std::mutex> Lock{ Mutex };
+	Latencies.PrintReport(Output, Title);
+	if (DroppedEvents > 0)
+	{
+		Output << "  " << DroppedEvents << " eventos descartados sem nenhum frame apresentado" << std::endl;
+	}
+}
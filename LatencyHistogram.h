@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+
+// Distribuio de latncias (ex.: do evento de entrada at o frame que o mostra ser apresentado), impressa em faixas
+//	de milissegundos com os percentis
+class LatencyHistogram
+{
+public:
+	void Record(double Seconds);
+
+	size_t GetCount() const;
+	double GetPercentile(double Percentile) const;
+
+	void PrintReport(std::ostream& Output, const char* Title) const;
+
+private:
+	std::vector<double> Samples;
+};
+
+// Acompanha cada evento de entrada, do callback do GLFW at a volta do glfwSwapBuffers do primeiro frame que o inclui.
+//	Os eventos so numerados em ordem; o frame informa o nmero do ltimo evento que ele usou e todos os pendentes at
+//	ele entram no histograma. Pode ser usado de threads diferentes (eventos na principal, frames na de renderizao)
+class InputLatencyTracker
+{
+public:
+	// Registra um evento ocorrido em Time e retorna o seu nmero (o primeiro  1)
+	uint64_t RecordEvent(double Time);
+
+	// Nmero do evento mais recente (0 se nenhum)
+	uint64_t GetLatestEvent() const;
+
+	// Um frame que inclui os eventos at LastEvent terminou de ser apresentado em PresentTime
+	void OnFramePresented(uint64_t LastEvent, double PresentTime);
+
+	void PrintReport(std::ostream& Output, const char* Title) const;
+
+	// Eventos guardados sem nenhum frame apresentado (ex.: janela minimizada); os mais antigos so descartados
+	size_t MaxPendingEvents = 4096;
+
+private:
+	struct PendingEvent
+	{
+		uint64_t Number = 0;
+		double Time = 0.0;
+	};
+
+	mutable std::mutex Mutex;
+	std::deque<PendingEvent> Pending;
+	uint64_t LatestEvent = 0;
+	uint64_t DroppedEvents = 0;
+	LatencyHistogram Latencies;
+};
@@ -0,0 +1,63 @@
+#include "PrefetchScheduler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "Camera.h"
+
+namespace
+{
+	double ToMegabytes(size_t Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+}
+
+void PrefetchScheduler::Register(StreamedTexture& Texture)
+{
+	Textures.push_back(&Texture);
+}
+
+void PrefetchScheduler::Update(TextureStreamer& Streamer, const SimpleCamera& Camera, const glm::vec3& GlobeCenter, float GlobeRadius, int ViewportHeight)
+{
+	const float RequiredWidth = ComputeRequiredTextureWidth(ComputeProjectedDiameter(Camera, GlobeCenter, GlobeRadius, ViewportHeight));
+
+	// Maior largura exigida ao longo da trajetria prevista (a cmera pode passar perto do globo e se afastar de novo)
+	float PredictedWidth = 0.0f;
+	if (glm::length(Camera.GetVelocity()) > 0.0f)
+	{
+		SimpleCamera PredictedCamera = Camera;
+		for (int Step = 1; Step <= PredictionSteps; ++Step)
+		{
+			PredictedCamera.Location = PredictCameraLocation(Camera, Horizon * Step / PredictionSteps);
+			float Diameter = ComputeProjectedDiameter(PredictedCamera, GlobeCenter, GlobeRadius, ViewportHeight);
+			PredictedWidth = std::max(PredictedWidth, ComputeRequiredTextureWidth(Diameter));
+		}
+	}
+
+	for (StreamedTexture* Texture : Textures)
+	{
+		Texture->Update(Streamer, RequiredWidth, PredictedWidth);
+	}
+}
+
+void PrefetchScheduler::PrintReport(std::ostream& Output) const
+{
+	for (const StreamedTexture* Texture : Textures)
+	{
+		const TextureStreamStats& Stats = Texture->GetStats();
+		const double HitRate = Stats.PrefetchRequests > 0 ? 100.0 * Stats.PrefetchHits / Stats.PrefetchRequests : 0.0;
+
+		Output << std::fixed << std::setprecision(1)
+			   << "Prefetch " << Texture->GetName() << ": " << Stats.PrefetchRequests << " pedidos, " << Stats.PrefetchHits
+			   << " acertos (" << HitRate << "%), " << Stats.PrefetchLate << " atrasados, " << ToMegabytes(Stats.WastedBytes)
+			   << " MB desperdiados, " << Stats.MissFrames << " frames abaixo da resoluo necessria"
+			   << std::defaultfloat << std::endl;
+	}
+}
+
+glm::vec3 PredictCameraLocation(const SimpleCamera& Camera, float Seconds)
+{
+	return Camera.Location + Camera.GetVelocity() * Seconds;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TextureLod.h"
+
+class SimpleCamera;
+
+// Antecipa a trajetria da cmera para carregar os nveis de resoluo antes de eles aparecerem na tela.
+// A cmera se move com velocidade constante entre os eventos de teclado (SimpleCamera::GetVelocity), ento a posio
+//	alguns centsimos de segundo  frente  previsvel; os nveis exigidos nessa posio so pedidos com baixa
+//	prioridade, atrs do que falta para o frame atual
+class PrefetchScheduler
+{
+public:
+	void Register(StreamedTexture& Texture);
+
+	// Substitui as chamadas de StreamedTexture::Update: calcula a largura exigida agora e no horizonte de previso
+	void Update(TextureStreamer& Streamer, const SimpleCamera& Camera, const glm::vec3& GlobeCenter, float GlobeRadius, int ViewportHeight);
+
+	// Taxa de acerto (nveis prontos quando passaram a ser necessrios), bytes desperdiados e frames sem a resoluo necessria
+	void PrintReport(std::ostream& Output) const;
+
+	// Quanto  frente (segundos) a posio da cmera  extrapolada, avaliada em PredictionSteps pontos da trajetria
+	float Horizon = 0.5f;
+	int PredictionSteps = 3;
+
+private:
+	std::vector<StreamedTexture*> Textures;
+};
+
+// Posio da cmera daqui a Seconds segundos, mantendo a velocidade atual
+glm::vec3 PredictCameraLocation(const SimpleCamera& Camera, float Seconds);
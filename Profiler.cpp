@@ -0,0 +1,482 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	constexpr size_t EventsPerChunk = 1024;
+
+	// Limite por trilha (~32 MB): uma gravao esquecida ligada descarta eventos em vez de esgotar a memria
+	constexpr uint64_t MaxEventsPerTrack = 1u << 20;
+
+	struct ProfileEvent
+	{
+		const char* Name = nullptr;
+		uint64_t StartNanoseconds = 0;
+		uint64_t DurationNanoseconds = 0;
+	};
+
+	// Bloco de eventos de uma trilha. S a thread dona escreve; Count e Next so publicados com release para que a
+	//	exportao leia apenas eventos completos
+	struct ProfileChunk
+	{
+		ProfileEvent Events[EventsPerChunk];
+		std::atomic<size_t> Count{ 0 };
+		std::atomic<ProfileChunk*> Next{ nullptr };
+	};
+
+	void WriteJsonString(std::ostream& Output, const char* Text)
+	{
+		Output << '"';
+		for (const char* Character = Text; *Character != '\0'; ++Character)
+		{
+			const unsigned char Code = static_cast<unsigned char>(*Character);
+			if (Code == '"' || Code == '\\')
+			{
+				Output << '\\' << *Character;
+			}
+			else if (Code < 0x20)
+			{
+				Output << ' ';
+			}
+			else
+			{
+				Output << *Character;
+			}
+		}
+		Output << '"';
+	}
+
+	// Devolve a trilha da thread ao profiler quando a thread termina
+	struct ThreadTrackHandle
+	{
+		ProfileTrack* Track = nullptr;
+
+		~ThreadTrackHandle()
+		{
+			if (Track)
+			{
+				GetProfiler().ReleaseThreadTrack(Track);
+			}
+		}
+	};
+
+	thread_local ThreadTrackHandle CurrentThread;
+}
+
+struct ProfileTrack
+{
+	int Id = 0;
+	std::string Name;
+	bool bThreadTrack = true;
+	bool bInUse = false;
+
+	ProfileChunk* First = nullptr; // S o consumidor avana (ConsumeEvents), com TracksMutex
+	ProfileChunk* Last = nullptr; // S a dona usa
+	uint64_t NumEvents = 0; // S a dona escreve; lido depois da gravao
+	uint64_t DroppedEvents = 0;
+
+	// Posio de leitura de ConsumeEvents
+	size_t ReadIndex = 0;
+	std::atomic<uint64_t> ConsumedEvents{ 0 };
+
+	~ProfileTrack()
+	{
+		for (ProfileChunk* Chunk = First; Chunk;)
+		{
+			ProfileChunk* Next = Chunk->Next.load(std::memory_order_relaxed);
+			delete Chunk;
+			Chunk = Next;
+		}
+	}
+};
+
+Profiler::Profiler()
+	: Epoch{ std::chrono::steady_clock::now() }
+{
+}
+
+Profiler::~Profiler() = default;
+
+void Profiler::Start()
+{
+#if BLUEMARBLE_PROFILER
+	// Custo de um marcador: duas leituras do relgio e uma escrita na trilha, medido em uma trilha temporria
+	{
+		std::unique_ptr<ProfileTrack> Calibration = std::make_unique<ProfileTrack>();
+		Calibration->First = Calibration->Last = new ProfileChunk;
+		constexpr int Iterations = 4096;
+		const uint64_t CalibrationStart = Now();
+		for (int Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const uint64_t ScopeStart = Now();
+			Append(Calibration.get(), "Calibration", ScopeStart, Now());
+		}
+		ScopeCostNanoseconds = static_cast<double>(Now() - CalibrationStart) / Iterations;
+	}
+
+	RecordingStart = Now();
+	bRecording.store(true, std::memory_order_release);
+#else
+	std::cout << "Profiler removido na compilao (BLUEMARBLE_PROFILER=0): nenhum marcador ser gravado" << std::endl;
+#endif
+}
+
+void Profiler::Stop()
+{
+	if (bRecording.exchange(false, std::memory_order_acq_rel))
+	{
+		RecordingEnd = Now();
+	}
+}
+
+void Profiler::SetThreadName(const char* Name)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	ProfileTrack* Track = GetThreadTrack();
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+	Track->Name = Name;
+}
+
+void Profiler::Record(const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds)
+{
+	Append(GetThreadTrack(), Name, StartNanoseconds, EndNanoseconds);
+}
+
+ProfileTrack* Profiler::CreateTrack(const char* Name)
+{
+	return AcquireTrack(Name, false);
+}
+
+void Profiler::RecordOnTrack(ProfileTrack* Track, const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds)
+{
+	if (Track && IsRecording())
+	{
+		Append(Track, Name, StartNanoseconds, EndNanoseconds);
+	}
+}
+
+ProfileTrack* Profiler::GetThreadTrack()
+{
+	if (!CurrentThread.Track)
+	{
+		CurrentThread.Track = AcquireTrack(nullptr, true);
+	}
+	return CurrentThread.Track;
+}
+
+ProfileTrack* Profiler::AcquireTrack(const char* Name, bool bThreadTrack)
+{
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+
+	// Trilhas devolvidas por threads que terminaram continuam no trace, com os eventos da thread seguinte depois
+	if (bThreadTrack)
+	{
+		for (const std::unique_ptr<ProfileTrack>& Track : Tracks)
+		{
+			if (Track->bThreadTrack && !Track->bInUse)
+			{
+				Track->bInUse = true;
+				return Track.get();
+			}
+		}
+	}
+
+	std::unique_ptr<ProfileTrack> Track = std::make_unique<ProfileTrack>();
+	Track->Id = static_cast<int>(Tracks.size());
+	Track->Name = Name ? Name : "Thread " + std::to_string(Track->Id);
+	Track->bThreadTrack = bThreadTrack;
+	Track->bInUse = true;
+	Track->First = Track->Last = new ProfileChunk;
+	Tracks.push_back(std::move(Track));
+	return Tracks.back().get();
+}
+
+void Profiler::ReleaseThreadTrack(ProfileTrack* Track)
+{
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+	Track->bInUse = false;
+}
+
+void Profiler::Append(ProfileTrack* Track, const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds)
+{
+	ProfileChunk* Chunk = Track->Last;
+	size_t Count = Chunk->Count.load(std::memory_order_relaxed);
+	if (Count == EventsPerChunk)
+	{
+		if (Track->NumEvents - Track->ConsumedEvents.load(std::memory_order_relaxed) >= MaxEventsPerTrack)
+		{
+			Track->DroppedEvents++;
+			return;
+		}
+
+		ProfileChunk* NewChunk = new ProfileChunk;
+		Chunk->Next.store(NewChunk, std::memory_order_release);
+		Track->Last = Chunk = NewChunk;
+		Count = 0;
+	}
+
+	ProfileEvent& Event = Chunk->Events[Count];
+	Event.Name = Name;
+	Event.StartNanoseconds = StartNanoseconds;
+	Event.DurationNanoseconds = EndNanoseconds > StartNanoseconds ? EndNanoseconds - StartNanoseconds : 0;
+	Chunk->Count.store(Count + 1, std::memory_order_release);
+	Track->NumEvents++;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& FileName) const
+{
+	std::ofstream Output{ FileName };
+	if (!Output)
+	{
+		std::cout << "Erro ao criar o trace " << FileName << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+
+	Output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+	bool bFirst = true;
+	for (const std::unique_ptr<ProfileTrack>& Track : Tracks)
+	{
+		WriteChromeTraceThreadName(Output, Track->Id, Track->Name, bFirst);
+		bFirst = false;
+
+		const char* Category = Track->bThreadTrack ? "cpu" : "gpu";
+		for (const ProfileChunk* Chunk = Track->First; Chunk; Chunk = Chunk->Next.load(std::memory_order_acquire))
+		{
+			const size_t Count = Chunk->Count.load(std::memory_order_acquire);
+			for (size_t Index = 0; Index < Count; ++Index)
+			{
+				const ProfileEvent& Event = Chunk->Events[Index];
+				WriteChromeTraceEvent(Output, Event.Name, Category, Track->Id, Event.StartNanoseconds, Event.DurationNanoseconds);
+			}
+		}
+	}
+	Output << std::endl << "]}" << std::endl;
+	return static_cast<bool>(Output);
+}
+
+void Profiler::ConsumeEvents(const std::function<void(int TrackId, const char* Name, uint64_t StartNanoseconds, uint64_t DurationNanoseconds)>& Visit)
+{
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+
+	for (const std::unique_ptr<ProfileTrack>& Track : Tracks)
+	{
+		uint64_t Consumed = Track->ConsumedEvents.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			ProfileChunk* Chunk = Track->First;
+			const size_t Count = Chunk->Count.load(std::memory_order_acquire);
+			for (; Track->ReadIndex < Count; ++Track->ReadIndex, ++Consumed)
+			{
+				const ProfileEvent& Event = Chunk->Events[Track->ReadIndex];
+				Visit(Track->Id, Event.Name, Event.StartNanoseconds, Event.DurationNanoseconds);
+			}
+
+			// Um bloco com sucessor nunca mais  escrito pela dona: depois de lido por inteiro, pode ser liberado
+			ProfileChunk* Next = Chunk->Next.load(std::memory_order_acquire);
+			if (!Next || Track->ReadIndex < EventsPerChunk)
+			{
+				break;
+			}
+			Track->First = Next;
+			Track->ReadIndex = 0;
+			delete Chunk;
+		}
+		Track->ConsumedEvents.store(Consumed, std::memory_order_relaxed);
+	}
+}
+
+std::vector<ProfileTrackInfo> Profiler::GetTracks() const
+{
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+
+	std::vector<ProfileTrackInfo> Infos;
+	for (const std::unique_ptr<ProfileTrack>& Track : Tracks)
+	{
+		ProfileTrackInfo Info;
+		Info.Id = Track->Id;
+		Info.Name = Track->Name;
+		Info.bThreadTrack = Track->bThreadTrack;
+		Infos.push_back(Info);
+	}
+	return Infos;
+}
+
+void Profiler::PrintReport(std::ostream& Output) const
+{
+	std::lock_guard<std::mutex> Lock{ TracksMutex };
+
+	const uint64_t End = bRecording.load(std::memory_order_acquire) ? Now() : RecordingEnd;
+	const double RecordedSeconds = (End - RecordingStart) * 1e-9;
+
+	uint64_t TotalEvents = 0;
+	uint64_t DroppedEvents = 0;
+	uint64_t BusiestThreadEvents = 0;
+	for (const std::unique_ptr<ProfileTrack>& Track : Tracks)
+	{
+		TotalEvents += Track->NumEvents;
+		DroppedEvents += Track->DroppedEvents;
+		if (Track->bThreadTrack)
+		{
+			BusiestThreadEvents = std::max(BusiestThreadEvents, Track->NumEvents);
+		}
+	}
+
+	// A estimativa vale para a thread com mais marcadores, a que mais paga por eles
+	const double Overhead = RecordedSeconds > 0.0 ? BusiestThreadEvents * ScopeCostNanoseconds * 1e-9 / RecordedSeconds : 0.0;
+	Output << "Profiler: " << TotalEvents << " eventos em " << Tracks.size() << " trilhas, " << std::fixed << std::setprecision(2)
+		   << RecordedSeconds << " s gravados, " << std::setprecision(1) << ScopeCostNanoseconds << " ns por marcador (~"
+		   << std::setprecision(3) << Overhead * 100.0 << "% da thread mais marcada), " << DroppedEvents << " descartados"
+		   << std::defaultfloat << std::endl;
+}
+
+Profiler& GetProfiler()
+{
+	static Profiler Instance;
+	return Instance;
+}
+
+void WriteChromeTraceThreadName(std::ostream& Output, int TrackId, const std::string& Name, bool bFirst)
+{
+	Output << (bFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << TrackId << ",\"args\":{\"name\":";
+	WriteJsonString(Output, Name.c_str());
+	Output << "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << TrackId << ",\"args\":{\"sort_index\":" << TrackId << "}}";
+}
+
+void WriteChromeTraceEvent(std::ostream& Output, const char* Name, const char* Category, int TrackId, uint64_t StartNanoseconds, uint64_t DurationNanoseconds)
+{
+	Output << ",\n{\"name\":";
+	WriteJsonString(Output, Name);
+	Output << ",\"cat\":\"" << Category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << TrackId << std::fixed << std::setprecision(3)
+		   << ",\"ts\":" << StartNanoseconds / 1000.0 << ",\"dur\":" << DurationNanoseconds / 1000.0 << "}" << std::defaultfloat;
+}
+
+void GpuProfiler::Create()
+{
+	Track = GetProfiler().CreateTrack("GPU");
+	bCreated = true;
+}
+
+GLuint GpuProfiler::AcquireQuery()
+{
+	if (FreeQueries.empty())
+	{
+		GLuint Query = 0;
+		glGenQueries(1, &Query);
+		AllQueries.push_back(Query);
+		return Query;
+	}
+
+	const GLuint Query = FreeQueries.back();
+	FreeQueries.pop_back();
+	return Query;
+}
+
+void GpuProfiler::Begin(const char* Name)
+{
+	// Com a GPU muito atrasada (ou os resultados nunca lidos), novos intervalos so descartados
+	constexpr size_t MaxPendingSpans = 4096;
+	if (!bCreated || !GetProfiler().IsRecording() || Pending.size() >= MaxPendingSpans)
+	{
+		OpenSpans.push_back(~0ull);
+		return;
+	}
+
+	Span NewSpan;
+	NewSpan.Name = Name;
+	NewSpan.StartQuery = AcquireQuery();
+	NewSpan.EndQuery = AcquireQuery();
+	glQueryCounter(NewSpan.StartQuery, GL_TIMESTAMP);
+
+	OpenSpans.push_back(CollectedSpans + Pending.size());
+	Pending.push_back(NewSpan);
+}
+
+void GpuProfiler::End()
+{
+	if (OpenSpans.empty())
+	{
+		return;
+	}
+
+	const uint64_t SpanIndex = OpenSpans.back();
+	OpenSpans.pop_back();
+	if (SpanIndex == ~0ull)
+	{
+		return;
+	}
+
+	Span& Current = Pending[static_cast<size_t>(SpanIndex - CollectedSpans)];
+	glQueryCounter(Current.EndQuery, GL_TIMESTAMP);
+	Current.bEnded = true;
+}
+
+void GpuProfiler::Collect()
+{
+	if (!bCreated)
+	{
+		return;
+	}
+
+	// O relgio da GPU  convertido para o do profiler a cada leitura, ento o desvio entre os dois no se acumula
+	GLint64 GpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &GpuNow);
+	GpuToCpuOffset = static_cast<int64_t>(GetProfiler().Now()) - GpuNow;
+
+	// Os intervalos terminam na ordem em que foram abertos s no nvel de cima; um aberto na frente segura os seguintes
+	while (!Pending.empty() && Pending.front().bEnded)
+	{
+		const Span& Front = Pending.front();
+		GLint Available = 0;
+		glGetQueryObjectiv(Front.EndQuery, GL_QUERY_RESULT_AVAILABLE, &Available);
+		if (!Available)
+		{
+			break;
+		}
+
+		GLuint64 StartTime = 0;
+		GLuint64 EndTime = 0;
+		glGetQueryObjectui64v(Front.StartQuery, GL_QUERY_RESULT, &StartTime);
+		glGetQueryObjectui64v(Front.EndQuery, GL_QUERY_RESULT, &EndTime);
+
+		const int64_t Start = static_cast<int64_t>(StartTime) + GpuToCpuOffset;
+		const int64_t End = static_cast<int64_t>(EndTime) + GpuToCpuOffset;
+		if (Start >= 0)
+		{
+			GetProfiler().RecordOnTrack(Track, Front.Name, static_cast<uint64_t>(Start), static_cast<uint64_t>(std::max(Start, End)));
+		}
+
+		FreeQueries.push_back(Front.StartQuery);
+		FreeQueries.push_back(Front.EndQuery);
+		Pending.pop_front();
+		CollectedSpans++;
+	}
+}
+
+void GpuProfiler::Release()
+{
+	if (!AllQueries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(AllQueries.size()), AllQueries.data());
+	}
+	AllQueries.clear();
+	FreeQueries.clear();
+	Pending.clear();
+	OpenSpans.clear();
+	bCreated = false;
+}
+
+GpuProfiler& GetGpuProfiler()
+{
+	static GpuProfiler Instance;
+	return Instance;
+}
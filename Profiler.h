@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+// 0 remove todos os marcadores PROFILE_SCOPE e PROFILE_GPU_SCOPE na compilao (opo BLUEMARBLE_PROFILER do CMake)
+#ifndef BLUEMARBLE_PROFILER
+#define BLUEMARBLE_PROFILER 1
+#endif
+
+struct ProfileTrack;
+
+struct ProfileTrackInfo
+{
+	int Id = 0;
+	std::string Name;
+	bool bThreadTrack = true; // Falso para trilhas que no so de uma thread (GPU)
+};
+
+// Profiler hierrquico: cada marcador vira um evento completo (incio e durao) na trilha da thread que o gravou, e a
+//	hierarquia sai do aninhamento dos intervalos. Cada thread escreve s na sua trilha, em blocos encadeados, sem
+//	travas; o mutex s  usado quando uma thread pega ou devolve a trilha (uma vez por thread). Threads que terminam
+//	(ex.: os pools de cada linha do --command-list-benchmark) devolvem a trilha para ser reutilizada, ento a memria
+//	no cresce com elas. Sem gravao ativa, um marcador custa uma leitura atmica
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler();
+
+	// Inicia a gravao (todas as threads) e mede o custo de um marcador para a estimativa do relatrio
+	void Start();
+	void Stop();
+
+	bool IsRecording() const
+	{
+		return bRecording.load(std::memory_order_relaxed);
+	}
+
+	// Nanossegundos desde a criao do profiler (steady_clock)
+	uint64_t Now() const
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count());
+	}
+
+	// Nome da trilha da thread atual no trace (apenas ASCII). S tem efeito com a gravao ativa
+	void SetThreadName(const char* Name);
+
+	// Grava um intervalo na trilha da thread atual. Name deve existir at a exportao (literais, nomes dos passes)
+	void Record(const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds);
+
+	// Trilha que no pertence a uma thread (ex.: a da GPU), gravada por RecordOnTrack de uma nica thread
+	ProfileTrack* CreateTrack(const char* Name);
+	void RecordOnTrack(ProfileTrack* Track, const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds);
+
+	// Formato JSON de eventos do Chrome (about:tracing, ui.perfetto.dev): eventos "X" em microssegundos e os nomes das
+	//	trilhas como metadados. Deve ser chamado com a gravao parada
+	bool ExportChromeTrace(const std::string& FileName) const;
+
+	// Entrega os eventos gravados desde a chamada anterior e libera os blocos j lidos, para gravaes contnuas em que
+	//	s os ltimos segundos interessam (FlightRecorder). Um nico consumidor; ExportChromeTrace no v o que j foi
+	//	consumido
+	void ConsumeEvents(const std::function<void(int TrackId, const char* Name, uint64_t StartNanoseconds, uint64_t DurationNanoseconds)>& Visit);
+
+	std::vector<ProfileTrackInfo> GetTracks() const;
+
+	void PrintReport(std::ostream& Output) const;
+
+	// Devolve a trilha de uma thread que terminou (chamado pelo destrutor thread_local)
+	void ReleaseThreadTrack(ProfileTrack* Track);
+
+private:
+	ProfileTrack* GetThreadTrack();
+	ProfileTrack* AcquireTrack(const char* Name, bool bThreadTrack);
+	void Append(ProfileTrack* Track, const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds);
+
+	std::atomic<bool> bRecording{ false };
+	std::chrono::steady_clock::time_point Epoch;
+	uint64_t RecordingStart = 0;
+	uint64_t RecordingEnd = 0;
+	double ScopeCostNanoseconds = 0.0;
+
+	mutable std::mutex TracksMutex;
+	std::vector<std::unique_ptr<ProfileTrack>> Tracks;
+};
+
+Profiler& GetProfiler();
+
+// Escrita de eventos no formato JSON do Chrome (cada um precedido de vrgula, exceto com bFirst)
+void WriteChromeTraceThreadName(std::ostream& Output, int TrackId, const std::string& Name, bool bFirst = false);
+void WriteChromeTraceEvent(std::ostream& Output, const char* Name, const char* Category, int TrackId, uint64_t StartNanoseconds, uint64_t DurationNanoseconds);
+
+// Intervalos de GPU medidos com GL_TIMESTAMP (glQueryCounter), que, ao contrrio de GL_TIME_ELAPSED, podem se aninhar.
+//	Os resultados so lidos alguns frames depois, quando disponveis, e convertidos para o relgio do profiler na
+//	trilha "GPU". S pode ser usado na thread dona do contexto
+class GpuProfiler
+{
+public:
+	void Create();
+
+	void Begin(const char* Name);
+	void End();
+
+	// Grava os intervalos j terminados pela GPU (uma vez por frame)
+	void Collect();
+
+	void Release();
+
+private:
+	struct Span
+	{
+		const char* Name = nullptr;
+		GLuint StartQuery = 0;
+		GLuint EndQuery = 0;
+		bool bEnded = false;
+	};
+
+	GLuint AcquireQuery();
+
+	ProfileTrack* Track = nullptr;
+	std::vector<GLuint> FreeQueries;
+	std::vector<GLuint> AllQueries;
+	std::deque<Span> Pending;
+	uint64_t CollectedSpans = 0; // Spans j retirados da frente de Pending
+	std::vector<uint64_t> OpenSpans; // ndices absolutos (CollectedSpans + posio em Pending); ~0 = no gravado
+	int64_t GpuToCpuOffset = 0;
+	bool bCreated = false;
+};
+
+GpuProfiler& GetGpuProfiler();
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* InName)
+		: Name(InName)
+		, bActive(GetProfiler().IsRecording())
+	{
+		if (bActive)
+		{
+			StartNanoseconds = GetProfiler().Now();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (bActive)
+		{
+			GetProfiler().Record(Name, StartNanoseconds, GetProfiler().Now());
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* Name;
+	bool bActive;
+	uint64_t StartNanoseconds = 0;
+};
+
+class GpuProfileScope
+{
+public:
+	explicit GpuProfileScope(const char* Name)
+	{
+		GetGpuProfiler().Begin(Name);
+	}
+
+	~GpuProfileScope()
+	{
+		GetGpuProfiler().End();
+	}
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+#if BLUEMARBLE_PROFILER
+#define PROFILE_SCOPE(Name) ProfileScope PROFILE_CONCAT(ProfileScope_, __LINE__){ Name }
+#define PROFILE_GPU_SCOPE(Name) GpuProfileScope PROFILE_CONCAT(GpuProfileScope_, __LINE__){ Name }
+#else
+#define PROFILE_SCOPE(Name)
+#define PROFILE_GPU_SCOPE(Name)
+#endif
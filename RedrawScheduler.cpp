@@ -0,0 +1,175 @@
+#include "RedrawScheduler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace
+{
+	const char* const ReasonNames[] = { "nenhum", "primeiro frame", "entrada", "cmera", "janela", "trabalho pendente", "animao" };
+
+	static_assert(std::size(ReasonNames) == static_cast<size_t>(ERedrawReason::Count), "Falta o nome de algum motivo de redesenho");
+
+	// Tempo de CPU do processo (todas as threads, em modo usurio e do sistema). O std::clock do MSVC mede o tempo de
+	//	parede desde o incio do processo e no serviria para ver se a espera por eventos realmente deixa a CPU livre
+	double GetProcessCpuSeconds()
+	{
+#ifdef _WIN32
+		FILETIME CreationTime;
+		FILETIME ExitTime;
+		FILETIME KernelTime;
+		FILETIME UserTime;
+		if (!GetProcessTimes(GetCurrentProcess(), &CreationTime, &ExitTime, &KernelTime, &UserTime))
+		{
+			return 0.0;
+		}
+
+		// FILETIME conta intervalos de 100 ns
+		auto ToSeconds = [](const FILETIME& Time) { return ((static_cast<uint64_t>(Time.dwHighDateTime) << 32) | Time.dwLowDateTime) * 1e-7; };
+		return ToSeconds(KernelTime) + ToSeconds(UserTime);
+#else
+		timespec Time;
+		if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &Time) != 0)
+		{
+			return 0.0;
+		}
+		return static_cast<double>(Time.tv_sec) + Time.tv_nsec * 1e-9;
+#endif
+	}
+}
+
+RedrawScheduler::RedrawScheduler()
+	: StartTime{ std::chrono::steady_clock::now() }
+	, StartCpuTime{ GetProcessCpuSeconds() }
+{
+}
+
+void RedrawScheduler::SetAnimationInterval(double Seconds)
+{
+	AnimationInterval = std::max(0.0, Seconds);
+}
+
+void RedrawScheduler::SetWindowState(bool bInFocused, bool bInIconified)
+{
+	bFocused = bInFocused;
+	bIconified = bInIconified;
+}
+
+ERedrawReason RedrawScheduler::ShouldRedraw(const RedrawState& State, double Now) const
+{
+	if (bIconified)
+	{
+		return ERedrawReason::None;
+	}
+	if (!bHasRendered)
+	{
+		return ERedrawReason::FirstFrame;
+	}
+
+	// Um framebuffer de outro tamanho no tem imagem vlida, e a captura precisa de um frame para acontecer
+	if (State.FramebufferWidth != LastState.FramebufferWidth || State.FramebufferHeight != LastState.FramebufferHeight ||
+		State.CaptureRequests != LastState.CaptureRequests)
+	{
+		return ERedrawReason::Window;
+	}
+
+	const double Elapsed = Now - LastRedrawTime;
+	if (Elapsed < GetMinInterval())
+	{
+		return ERedrawReason::None;
+	}
+
+	if (State.InputTime != LastState.InputTime)
+	{
+		return ERedrawReason::Input;
+	}
+	if (State.CameraLocation != LastState.CameraLocation || State.CameraDirection != LastState.CameraDirection ||
+		State.CameraUp != LastState.CameraUp)
+	{
+		return ERedrawReason::Camera;
+	}
+	if (State.bPendingWork)
+	{
+		return ERedrawReason::PendingWork;
+	}
+	if (Elapsed >= AnimationInterval)
+	{
+		return ERedrawReason::Animation;
+	}
+	return ERedrawReason::None;
+}
+
+void RedrawScheduler::OnFrameRendered(const RedrawState& State, double Now, ERedrawReason Reason)
+{
+	LastState = State;
+	LastRedrawTime = Now;
+	bHasRendered = true;
+	Redraws[static_cast<size_t>(Reason)]++;
+}
+
+double RedrawScheduler::GetWaitTimeout(double Now) const
+{
+	if (bIconified)
+	{
+		return IconifiedPollInterval;
+	}
+
+	// Eventos acordam a espera antes disso; sem eventos, o prximo redesenho possvel  o da animao
+	const double NextRedrawTime = LastRedrawTime + std::max(AnimationInterval, GetMinInterval());
+	return std::clamp(NextRedrawTime - Now, 0.0, MaxWaitTimeout);
+}
+
+void RedrawScheduler::BeginIdle()
+{
+	IdleStartTime = std::chrono::steady_clock::now();
+	IdleStartCpuTime = GetProcessCpuSeconds();
+}
+
+void RedrawScheduler::EndIdle()
+{
+	IdleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - IdleStartTime).count();
+	IdleCpuSeconds += GetProcessCpuSeconds() - IdleStartCpuTime;
+	IdleWaits++;
+}
+
+double RedrawScheduler::GetMinInterval() const
+{
+	return bFocused ? 0.0 : UnfocusedInterval;
+}
+
+void RedrawScheduler::PrintReport(std::ostream& Output) const
+{
+	const double TotalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	const double TotalCpuSeconds = GetProcessCpuSeconds() - StartCpuTime;
+
+	uint64_t TotalRedraws = 0;
+	for (uint64_t Count : Redraws)
+	{
+		TotalRedraws += Count;
+	}
+
+	// CPU como porcentagem de um ncleo (o tempo de CPU do processo soma todas as threads, inclusive as de streaming)
+	const double FramesPerMinute = TotalSeconds > 0.0 ? TotalRedraws * 60.0 / TotalSeconds : 0.0;
+	const double CpuUsage = TotalSeconds > 0.0 ? TotalCpuSeconds / TotalSeconds * 100.0 : 0.0;
+	const double IdleCpuUsage = IdleSeconds > 0.0 ? IdleCpuSeconds / IdleSeconds * 100.0 : 0.0;
+
+	Output << "Redesenho sob demanda: " << TotalRedraws << " frames em " << std::fixed << std::setprecision(1) << TotalSeconds
+		   << " s (" << FramesPerMinute << " por minuto), CPU " << CpuUsage << "% no total e " << IdleCpuUsage << "% em "
+		   << IdleSeconds << " s de espera (" << IdleWaits << " esperas)" << std::defaultfloat << std::endl;
+
+	Output << "  Motivos:";
+	for (size_t Reason = 1; Reason < std::size(Redraws); ++Reason)
+	{
+		Output << " " << ReasonNames[Reason] << " " << Redraws[Reason] << (Reason + 1 < std::size(Redraws) ? "," : "");
+	}
+	Output << std::endl;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+#include <glm/glm.hpp>
+
+// O que o prximo frame mostraria: se nada mudou desde o ltimo frame desenhado, desenhar de novo produziria a mesma imagem
+struct RedrawState
+{
+	double InputTime = -1.0;
+	glm::vec3 CameraLocation{ 0.0f };
+	glm::vec3 CameraDirection{ 0.0f };
+	glm::vec3 CameraUp{ 0.0f };
+	int FramebufferWidth = 0;
+	int FramebufferHeight = 0;
+	uint32_t CaptureRequests = 0;
+	bool bPendingWork = false; // Ex.: um nvel de textura ainda sendo copiado para a GPU, uma faixa por frame
+};
+
+enum class ERedrawReason
+{
+	None,
+	FirstFrame,
+	Input,
+	Camera,
+	Window, // Tamanho do framebuffer ou captura pedida
+	PendingWork,
+	Animation,
+
+	Count
+};
+
+// Decide, a cada volta do loop, se vale a pena desenhar um frame (modo --on-demand). Redesenha quando chega entrada,
+//	quando a cmera se move, quando h trabalho pendente ou quando as animaes lentas (nuvens) andaram o suficiente
+//	(AnimationInterval); no resto do tempo o loop dorme em glfwWaitEventsTimeout pelo tempo de GetWaitTimeout.
+// Com a janela sem foco os redesenhos ficam limitados a um a cada UnfocusedInterval; minimizada, no h redesenhos
+class RedrawScheduler
+{
+public:
+	RedrawScheduler();
+
+	// Tempo para as animaes mudarem o bastante para aparecer na tela. 0 = animao contnua (todo frame),
+	//	infinito = cena esttica
+	void SetAnimationInterval(double Seconds);
+	void SetWindowState(bool bFocused, bool bIconified);
+
+	// Now no mesmo relgio usado em OnFrameRendered (ex.: glfwGetTime)
+	ERedrawReason ShouldRedraw(const RedrawState& State, double Now) const;
+	void OnFrameRendered(const RedrawState& State, double Now, ERedrawReason Reason);
+
+	// Quanto o loop pode esperar por eventos antes de reavaliar ShouldRedraw
+	double GetWaitTimeout(double Now) const;
+
+	// Delimitam a espera por eventos, para medir o uso de CPU do processo enquanto nada  desenhado
+	void BeginIdle();
+	void EndIdle();
+
+	void PrintReport(std::ostream& Output) const;
+
+	double UnfocusedInterval = 0.25;
+	double IconifiedPollInterval = 0.5;
+	double MaxWaitTimeout = 0.5;
+
+private:
+	double GetMinInterval() const;
+
+	RedrawState LastState;
+	double LastRedrawTime = 0.0;
+	bool bHasRendered = false;
+
+	double AnimationInterval = 0.0;
+	bool bFocused = true;
+	bool bIconified = false;
+
+	uint64_t Redraws[static_cast<size_t>(ERedrawReason::Count)] = {};
+
+	std::chrono::steady_clock::time_point StartTime;
+	double StartCpuTime = 0.0;
+
+	std::chrono::steady_clock::time_point IdleStartTime;
+	double IdleStartCpuTime = 0.0;
+	double IdleSeconds = 0.0;
+	double IdleCpuSeconds = 0.0;
+	uint64_t IdleWaits = 0;
+};
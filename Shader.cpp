@@ -0,0 +1,307 @@
+#include "Shader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Diretivas #line no formato do GLSL (nmeros no lugar de nomes de arquivo)
+#define STB_INCLUDE_LINE_GLSL
+#define STB_INCLUDE_IMPLEMENTATION
+#include <stb_include.h>
+
+#include "Profiler.h"
+#include "ShaderCache.h"
+
+// Funo para leitura de arquivos
+std::string ReadFile(const char* FilePath)
+{
+	std::string FileContents;
+	if (std::ifstream FileStream{ FilePath, std::ios::in }) // Se entrar no if, foi possvel criar a stream de leitura
+	{
+		FileContents.assign((std::istreambuf_iterator<char>(FileStream)), std::istreambuf_iterator<char>());
+	}
+	return FileContents;
+}
+
+// Funo para verificao do log de compilao do shader (recebe o identificador de um shader compilado como parmetro)
+bool CheckShader(GLuint ShaderId)
+{
+	// Verificar se o shader foi compilado
+	GLint Result = GL_TRUE;
+	glGetShaderiv(ShaderId, GL_COMPILE_STATUS, &Result);
+
+	if (Result == GL_FALSE)
+	{
+		// Erro ao compilar o shader, imprimir o log para saber o que est errado
+		GLint InfoLogLength = 0; // Obter tamanho do log
+		glGetShaderiv(ShaderId, GL_INFO_LOG_LENGTH, &InfoLogLength); // Quantidade em bytes a ser alocado na string
+
+		std::string ShaderInfoLog(InfoLogLength, '\0'); // Inicializar string de tamanho InfoLogLength com todos 
+													    // os char = '0'
+		glGetShaderInfoLog(ShaderId, InfoLogLength, nullptr, &ShaderInfoLog[0]); // Recupera o log armazenando em 
+																				 // ShaderInfoLog
+		std::cout << "Erro ao compilar o shader: " << std::endl;
+		if (InfoLogLength > 0)
+		{
+			std::cout << ShaderInfoLog << std::endl;
+		}
+
+		// O erro  apenas relatado: quem chamou decide se continua com o programa anterior
+		return false;
+	}
+
+	return true;
+}
+
+bool PreprocessShader(const char* ShaderFile, const std::string& Header, std::string& Source)
+{
+	std::string FileContents = ReadFile(ShaderFile);
+	if (FileContents.empty())
+	{
+		std::cout << "Erro ao ler o shader " << ShaderFile << std::endl;
+		return false;
+	}
+
+	// O stb_include recebe strings modificveis
+	std::string IncludeDirectory = std::filesystem::path{ ShaderFile }.parent_path().string();
+	if (IncludeDirectory.empty())
+	{
+		IncludeDirectory = ".";
+	}
+	std::vector<char> Text(FileContents.begin(), FileContents.end());
+	Text.push_back('\0');
+	std::vector<char> Inject(Header.begin(), Header.end());
+	Inject.push_back('\0');
+	std::vector<char> Directory(IncludeDirectory.begin(), IncludeDirectory.end());
+	Directory.push_back('\0');
+	std::vector<char> FileName(ShaderFile, ShaderFile + std::strlen(ShaderFile) + 1);
+
+	char Error[256] = {};
+	char* Preprocessed = stb_include_string(Text.data(), Inject.data(), Directory.data(), FileName.data(), Error);
+
+	if (!Preprocessed)
+	{
+		std::cout << "Erro ao pr-processar " << ShaderFile << ": " << Error << std::endl;
+		return false;
+	}
+
+	Source = Preprocessed;
+	std::free(Preprocessed);
+	return true;
+}
+
+namespace
+{
+	// Cria o programa com os dois shaders j compilados (ou com a compilao j disparada) e dispara o link
+	void LinkShaderProgram(ShaderProgramBuild& Build)
+	{
+		// Feita a compilao dos shaders,  necessrio confeccionar o programa a ser carregado na pipeline.
+		std::cout << "Linkando Programa" << std::endl;
+		Build.ProgramId = glCreateProgram(); // Elencar abaixo todos os shaders que fazem parte desse programa
+		glAttachShader(Build.ProgramId, Build.VertShaderId);
+		glAttachShader(Build.ProgramId, Build.FragShaderId);
+
+		// Pede ao driver que mantenha o binrio do programa disponvel para o glGetProgramBinary
+		if (GetShaderProgramCache().IsEnabled())
+		{
+			glProgramParameteri(Build.ProgramId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		// Conclui o link entre os shaders compilados acima relacionados. O resultado s  consultado em
+		//	FinishShaderProgram: at l o driver pode compilar vrios programas em paralelo
+		glLinkProgram(Build.ProgramId);
+	}
+
+	// Compila um shader de uma construo em etapas e espera o resultado (o log  impresso em FinishShaderProgram)
+	void CompileStagedShader(GLuint ShaderId, std::string& Source)
+	{
+		const char* SourcePtr = Source.c_str();
+		glShaderSource(ShaderId, 1, &SourcePtr, nullptr);
+		glCompileShader(ShaderId);
+
+		GLint Status = GL_FALSE;
+		glGetShaderiv(ShaderId, GL_COMPILE_STATUS, &Status);
+		Source.clear();
+		Source.shrink_to_fit();
+	}
+}
+
+bool BeginShaderProgram(const char* VertexShaderFile, const char* FragmentShaderFile, const std::string& Defines, ShaderProgramBuild& Build,
+	bool bStaged)
+{
+	// A linha #inject no incio de cada shader recebe a verso do GLSL e os defines da variante
+	const std::string Header = std::string("#version 330 core\n") + Defines;
+
+	std::string VertexShaderSource;
+	std::string FragmentShaderSource;
+	if (!PreprocessShader(VertexShaderFile, Header, VertexShaderSource) || !PreprocessShader(FragmentShaderFile, Header, FragmentShaderSource))
+	{
+		return false;
+	}
+
+	Build = ShaderProgramBuild{};
+	Build.Label = std::string(VertexShaderFile) + " + " + FragmentShaderFile;
+
+	// Um programa j linkado com os mesmos fontes e o mesmo driver  carregado do cache em disco, sem compilar
+	ShaderProgramCache& Cache = GetShaderProgramCache();
+	Build.CacheKey = Cache.ComputeKey(VertexShaderSource, FragmentShaderSource, Defines);
+	Build.ProgramId = Cache.Load(Build.CacheKey, Build.Label.c_str());
+	if (Build.ProgramId != 0)
+	{
+		Build.bFromCache = true;
+		return true;
+	}
+
+	// Criar os identificadores do Vertex e do Fragment Shaders
+	Build.VertShaderId = glCreateShader(GL_VERTEX_SHADER);
+	Build.FragShaderId = glCreateShader(GL_FRAGMENT_SHADER);
+
+	if (bStaged)
+	{
+		Build.VertexSource = std::move(VertexShaderSource);
+		Build.FragmentSource = std::move(FragmentShaderSource);
+		Build.PendingStages = 3;
+		return true;
+	}
+
+	// Utilizar o OpenGL para compilar os shaders
+	std::cout << "Compilando " << VertexShaderFile << std::endl;
+	const char* VertexShaderSourcePtr = VertexShaderSource.c_str(); // Ponteiro para o fonte do Vertex Shader
+	glShaderSource(Build.VertShaderId, 1, &VertexShaderSourcePtr, nullptr); // Chamada a funo que determina os parmetros
+		// dos fontes que sero compilados, recebendo o Id, a quantidade de fontes a serem compilados (neste exemplo apenas 1),
+		// os endereos dos ponteiros e o comprimento da leitura (como utilizamos a funes c_str() ser uma string com 
+		// ponteiro nulo de terminao)
+	glCompileShader(Build.VertShaderId); // Compila todos os Vertex Shaders parametrizados acima
+
+	std::cout << "Compilando " << FragmentShaderFile << std::endl;
+	const char* FragmentShaderSourcePtr = FragmentShaderSource.c_str();
+	glShaderSource(Build.FragShaderId, 1, &FragmentShaderSourcePtr, nullptr);
+	glCompileShader(Build.FragShaderId);
+
+	LinkShaderProgram(Build);
+
+	return true;
+}
+
+bool AdvanceShaderProgram(ShaderProgramBuild& Build)
+{
+	switch (Build.PendingStages)
+	{
+		case 3:
+			std::cout << "Compilando em etapas " << Build.Label << std::endl;
+			CompileStagedShader(Build.VertShaderId, Build.VertexSource);
+			break;
+
+		case 2:
+			CompileStagedShader(Build.FragShaderId, Build.FragmentSource);
+			break;
+
+		case 1:
+			LinkShaderProgram(Build);
+			break;
+
+		default:
+			return false;
+	}
+
+	Build.PendingStages--;
+	return true;
+}
+
+bool IsShaderProgramReady(const ShaderProgramBuild& Build)
+{
+	if (Build.PendingStages > 0)
+	{
+		return false;
+	}
+	if (Build.bFromCache || !GLEW_KHR_parallel_shader_compile)
+	{
+		// Sem a extenso no h como perguntar sem bloquear: a consulta do status espera a compilao terminar
+		return true;
+	}
+
+	GLint bCompleted = GL_FALSE;
+	glGetProgramiv(Build.ProgramId, GL_COMPLETION_STATUS_KHR, &bCompleted);
+	return bCompleted == GL_TRUE;
+}
+
+void DiscardShaderProgram(ShaderProgramBuild& Build)
+{
+	if (!Build.bFromCache)
+	{
+		glDeleteShader(Build.VertShaderId);
+		glDeleteShader(Build.FragShaderId);
+	}
+	glDeleteProgram(Build.ProgramId);
+	Build = ShaderProgramBuild{};
+}
+
+GLuint FinishShaderProgram(ShaderProgramBuild& Build)
+{
+	if (Build.bFromCache)
+	{
+		return Build.ProgramId;
+	}
+
+	bool bCompiled = CheckShader(Build.VertShaderId);
+	bCompiled = CheckShader(Build.FragShaderId) && bCompiled;
+
+	// Verificar resultado do link
+	GLint Result = GL_TRUE;
+	glGetProgramiv(Build.ProgramId, GL_LINK_STATUS, &Result); // Armazena o status de inicializao em Result
+	
+	if (Result == GL_FALSE && bCompiled) // Obter o log para compreenso do problema
+	{
+		GLint InfoLogLength = 0;
+		glGetProgramiv(Build.ProgramId, GL_INFO_LOG_LENGTH, &InfoLogLength); // Quantidade em bytes a ser alocado na string
+
+		std::cout << "Erro ao linkar programa " << Build.Label << std::endl;
+		if (InfoLogLength > 0) // Se gerou log de erro, o recupera e exibe em tela
+		{
+			std::string ProgramInfoLog(InfoLogLength, '\0');
+			glGetProgramInfoLog(Build.ProgramId, InfoLogLength, nullptr, &ProgramInfoLog[0]);
+
+			std::cout << ProgramInfoLog << std::endl;
+		}
+	}
+
+	// Como boa prtica, uma vez que utilizamos recursos  bom ilber-los na sequncia
+	// (isso no desfaz o link com o programa aps a compilao, apenas libera o uso dos Ids e pilhas de memria para 
+	//  evitar comportamentos indesejados e sujeiras de memria)
+	glDetachShader(Build.ProgramId, Build.VertShaderId);
+	glDetachShader(Build.ProgramId, Build.FragShaderId);
+
+	glDeleteShader(Build.VertShaderId);
+	glDeleteShader(Build.FragShaderId);
+
+	if (Result == GL_FALSE)
+	{
+		glDeleteProgram(Build.ProgramId);
+		Build.ProgramId = 0;
+		return 0;
+	}
+
+	std::cout << "Programa associado, shaders carregados com sucesso" << std::endl;
+
+	GetShaderProgramCache().Store(Build.CacheKey, Build.ProgramId, Build.Label.c_str());
+
+	return Build.ProgramId;
+}
+
+// Funo para carregar os programas de shaders
+GLuint LoadShaders(const char* VertexShaderFile, const char* FragmentShaderFile, const std::string& Defines)
+{
+	PROFILE_SCOPE("LoadShaders");
+
+	ShaderProgramBuild Build;
+	if (!BeginShaderProgram(VertexShaderFile, FragmentShaderFile, Defines, Build))
+	{
+		return 0;
+	}
+
+	return FinishShaderProgram(Build);
+}
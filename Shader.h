@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <GL/glew.h>
+
+// Programa em construo: a compilao e o link so disparados em BeginShaderProgram e conferidos em
+//	FinishShaderProgram, permitindo ao driver compilar vrios programas ao mesmo tempo
+struct ShaderProgramBuild
+{
+	GLuint ProgramId = 0;
+	GLuint VertShaderId = 0;
+	GLuint FragShaderId = 0;
+	uint64_t CacheKey = 0;
+	std::string Label;
+	bool bFromCache = false;
+
+	// Construo em etapas (AdvanceShaderProgram): os fontes ficam guardados at a etapa que os compila
+	std::string VertexSource;
+	std::string FragmentSource;
+	int PendingStages = 0;
+};
+
+// Funo para leitura de arquivos
+std::string ReadFile(const char* FilePath);
+
+// Funo para verificao do log de compilao do shader (recebe o identificador de um shader compilado como parmetro)
+//	Retorna false (e imprime o log) se a compilao falhou
+bool CheckShader(GLuint ShaderId);
+
+// L o shader resolvendo os #include "arquivo" (relativos  pasta do shader) com o stb_include e substitui a linha
+//	#inject por Header. Os shaders comeam com #inject em vez de #version: a verso vem junto com os defines
+bool PreprocessShader(const char* ShaderFile, const std::string& Header, std::string& Source);
+
+// bStaged: a compilao e o link no so disparados aqui, e sim um por chamada de AdvanceShaderProgram. Sem
+//	KHR_parallel_shader_compile  o que evita compilar um programa inteiro dentro de um nico frame
+bool BeginShaderProgram(const char* VertexShaderFile, const char* FragmentShaderFile, const std::string& Defines, ShaderProgramBuild& Build,
+	bool bStaged = false);
+
+// Prxima etapa de uma construo em etapas: compila o vertex shader, depois o fragment shader e por ltimo dispara o
+//	link. Cada etapa espera o driver terminar (a consulta do status fora a compilao). Retorna false se no restava nenhuma
+bool AdvanceShaderProgram(ShaderProgramBuild& Build);
+
+// Indica se o driver j terminou a compilao e o link (KHR_parallel_shader_compile), ou seja, se FinishShaderProgram
+//	no vai bloquear. Sem a extenso retorna true assim que as etapas de AdvanceShaderProgram acabaram
+bool IsShaderProgramReady(const ShaderProgramBuild& Build);
+
+// Abandona uma construo ainda no concluda (ex.: o arquivo mudou de novo durante a compilao)
+void DiscardShaderProgram(ShaderProgramBuild& Build);
+
+// Confere a compilao e o link e grava o programa no cache. Em caso de erro imprime o log, libera os objetos e retorna 0
+GLuint FinishShaderProgram(ShaderProgramBuild& Build);
+
+// Funo para carregar os programas de shaders (do cache de binrios, quando possvel).
+// Defines  uma sequncia de linhas "#define NOME VALOR" inseridas depois do #version. Retorna 0 se houver erro
+GLuint LoadShaders(const char* VertexShaderFile, const char* FragmentShaderFile, const std::string& Defines = "");
@@ -0,0 +1,218 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	// Cabealho de cada entrada do cache, seguido de BinaryLength bytes do binrio do programa
+	struct ProgramBinaryHeader
+	{
+		char Magic[4] = { 'B', 'M', 'P', 'B' };
+		uint32_t Version = 1;
+		uint32_t BinaryFormat = 0;
+		uint32_t BinaryLength = 0;
+	};
+
+	// FNV-1a de 64 bits: simples, rpido e suficiente para identificar as entradas do cache
+	void HashBytes(uint64_t& Hash, const void* Data, size_t Size)
+	{
+		const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+		for (size_t Index = 0; Index < Size; ++Index)
+		{
+			Hash ^= Bytes[Index];
+			Hash *= 1099511628211ull;
+		}
+	}
+
+	// Cada campo  seguido de um separador, assim ("ab", "c") e ("a", "bc") geram chaves diferentes
+	void HashString(uint64_t& Hash, const std::string& Value)
+	{
+		HashBytes(Hash, Value.data(), Value.size());
+		HashBytes(Hash, "", 1);
+	}
+
+	std::string GetGLString(GLenum Name)
+	{
+		const GLubyte* Value = glGetString(Name);
+		return Value ? reinterpret_cast<const char*>(Value) : "";
+	}
+}
+
+void ShaderProgramCache::SetDirectory(const std::string& InDirectory)
+{
+	Directory = InDirectory;
+}
+
+void ShaderProgramCache::SetEnabled(bool bInEnabled)
+{
+	bEnabled = bInEnabled;
+}
+
+bool ShaderProgramCache::IsEnabled() const
+{
+	return bEnabled && GLEW_ARB_get_program_binary && !GetBinaryFormats().empty();
+}
+
+std::vector<GLint> ShaderProgramCache::GetBinaryFormats() const
+{
+	GLint NumFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &NumFormats);
+
+	std::vector<GLint> Formats(std::max(0, NumFormats));
+	if (NumFormats > 0)
+	{
+		glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, Formats.data());
+	}
+	return Formats;
+}
+
+uint64_t ShaderProgramCache::ComputeKey(const std::string& VertexSource, const std::string& FragmentSource, const std::string& Defines) const
+{
+	uint64_t Hash = 14695981039346656037ull;
+
+	HashString(Hash, VertexSource);
+	HashString(Hash, FragmentSource);
+	HashString(Hash, Defines);
+
+	// Uma atualizao do driver invalida os binrios gravados: a chave muda e o programa  recompilado
+	HashString(Hash, GetGLString(GL_VENDOR));
+	HashString(Hash, GetGLString(GL_RENDERER));
+	HashString(Hash, GetGLString(GL_VERSION));
+
+	for (GLint Format : GetBinaryFormats())
+	{
+		HashBytes(Hash, &Format, sizeof(Format));
+	}
+
+	return Hash;
+}
+
+std::string ShaderProgramCache::GetEntryPath(uint64_t Key) const
+{
+	std::ostringstream Path;
+	Path << Directory << "/" << std::hex << std::setw(16) << std::setfill('0') << Key << ".bin";
+	return Path.str();
+}
+
+GLuint ShaderProgramCache::Load(uint64_t Key, const char* Label)
+{
+	if (!IsEnabled())
+	{
+		return 0;
+	}
+
+	const std::string EntryPath = GetEntryPath(Key);
+
+	ProgramBinaryHeader Header;
+	std::vector<char> Binary;
+	bool bValid = false;
+
+	if (std::ifstream Entry{ EntryPath, std::ios::in | std::ios::binary })
+	{
+		const ProgramBinaryHeader Expected;
+		if (Entry.read(reinterpret_cast<char*>(&Header), sizeof(Header)) &&
+			std::memcmp(Header.Magic, Expected.Magic, sizeof(Header.Magic)) == 0 && Header.Version == Expected.Version)
+		{
+			const std::vector<GLint> Formats = GetBinaryFormats();
+			Binary.resize(Header.BinaryLength);
+			bValid = std::find(Formats.begin(), Formats.end(), static_cast<GLint>(Header.BinaryFormat)) != Formats.end() &&
+				Entry.read(Binary.data(), Binary.size());
+		}
+	}
+
+	if (!bValid)
+	{
+		++Misses;
+		std::cout << "Cache de shaders: " << Label << " no est no cache, compilando" << std::endl;
+		return 0;
+	}
+
+	GLuint ProgramId = glCreateProgram();
+	glProgramBinary(ProgramId, Header.BinaryFormat, Binary.data(), static_cast<GLsizei>(Binary.size()));
+
+	// O driver pode rejeitar um binrio vlido (ex.: mudou algo que no aparece nas strings do driver)
+	GLint Result = GL_FALSE;
+	glGetProgramiv(ProgramId, GL_LINK_STATUS, &Result);
+
+	if (Result == GL_FALSE)
+	{
+		++Rejected;
+		std::cout << "Cache de shaders: binrio de " << Label << " rejeitado pelo driver, compilando" << std::endl;
+
+		glDeleteProgram(ProgramId);
+		std::error_code Error;
+		std::filesystem::remove(EntryPath, Error);
+		return 0;
+	}
+
+	++Hits;
+	std::cout << "Cache de shaders: " << Label << " carregado do cache (" << EntryPath << ")" << std::endl;
+	return ProgramId;
+}
+
+void ShaderProgramCache::Store(uint64_t Key, GLuint ProgramId, const char* Label)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	GLint BinaryLength = 0;
+	glGetProgramiv(ProgramId, GL_PROGRAM_BINARY_LENGTH, &BinaryLength);
+	if (BinaryLength <= 0)
+	{
+		return;
+	}
+
+	ProgramBinaryHeader Header;
+	std::vector<char> Binary(BinaryLength);
+	GLenum BinaryFormat = 0;
+	glGetProgramBinary(ProgramId, BinaryLength, nullptr, &BinaryFormat, Binary.data());
+	Header.BinaryFormat = BinaryFormat;
+	Header.BinaryLength = static_cast<uint32_t>(BinaryLength);
+
+	std::error_code Error;
+	std::filesystem::create_directories(Directory, Error);
+
+	// Escreve num arquivo temporrio e renomeia: uma execuo interrompida nunca deixa uma entrada pela metade
+	const std::string EntryPath = GetEntryPath(Key);
+	const std::string TemporaryPath = EntryPath + ".tmp";
+	{
+		std::ofstream Entry{ TemporaryPath, std::ios::out | std::ios::binary | std::ios::trunc };
+		Entry.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		Entry.write(Binary.data(), Binary.size());
+
+		if (!Entry)
+		{
+			std::cout << "Cache de shaders: erro ao gravar " << TemporaryPath << std::endl;
+			return;
+		}
+	}
+
+	std::filesystem::rename(TemporaryPath, EntryPath, Error);
+	if (Error)
+	{
+		std::cout << "Cache de shaders: erro ao gravar " << EntryPath << std::endl;
+		std::filesystem::remove(TemporaryPath, Error);
+		return;
+	}
+
+	std::cout << "Cache de shaders: " << Label << " gravado no cache (" << BinaryLength << " bytes)" << std::endl;
+}
+
+void ShaderProgramCache::PrintReport(std::ostream& Output) const
+{
+	Output << "Cache de shaders: " << Hits << " acertos, " << Misses << " falhas, " << Rejected << " binrios rejeitados" << std::endl;
+}
+
+ShaderProgramCache& GetShaderProgramCache()
+{
+	static ShaderProgramCache Cache;
+	return Cache;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Cache persistente dos programas linkados (glGetProgramBinary / glProgramBinary), em arquivos no diretrio do cache.
+// A chave combina os fontes j pr-processados, os defines, o driver (GL_VENDOR, GL_RENDERER, GL_VERSION) e os formatos
+//	binrios aceitos por ele: qualquer mudana em um deles gera outra chave e o programa  compilado normalmente
+class ShaderProgramCache
+{
+public:
+	void SetDirectory(const std::string& InDirectory);
+	void SetEnabled(bool bInEnabled);
+
+	// Falso se desabilitado ou se o driver no suporta ARB_get_program_binary (ou no oferece nenhum formato binrio)
+	bool IsEnabled() const;
+
+	uint64_t ComputeKey(const std::string& VertexSource, const std::string& FragmentSource, const std::string& Defines) const;
+
+	// Cria o programa a partir do binrio gravado, ou retorna 0 se no houver entrada ou se o driver rejeitar o binrio
+	GLuint Load(uint64_t Key, const char* Label);
+
+	// Grava o binrio de um programa recm-linkado (linkado com GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+	void Store(uint64_t Key, GLuint ProgramId, const char* Label);
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	std::string GetEntryPath(uint64_t Key) const;
+	std::vector<GLint> GetBinaryFormats() const;
+
+	std::string Directory = "shader_cache";
+	bool bEnabled = true;
+
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;
+	uint64_t Rejected = 0;
+};
+
+// Cache global dos programas (acessado apenas pela thread do contexto OpenGL)
+ShaderProgramCache& GetShaderProgramCache();
@@ -0,0 +1,375 @@
+#include "ShaderLibrary.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "GLStateCache.h"
+
+namespace
+{
+	struct ShaderFeatureInfo
+	{
+		uint32_t Feature;
+		const char* Define;
+		const char* Name;
+	};
+
+	const ShaderFeatureInfo ShaderFeatures[EShaderFeature::Count] =
+	{
+		{ EShaderFeature::Clouds, "FEATURE_CLOUDS", "clouds" },
+		{ EShaderFeature::Specular, "FEATURE_SPECULAR", "specular" },
+		{ EShaderFeature::NightLights, "FEATURE_NIGHT_LIGHTS", "night-lights" },
+		{ EShaderFeature::PackedVertices, "FEATURE_PACKED_VERTICES", "packed-vertices" },
+		{ EShaderFeature::CubeMap, "FEATURE_CUBEMAP", "cubemap" },
+		{ EShaderFeature::CloudsSeries, "FEATURE_CLOUDS_SERIES", "clouds-series" },
+		{ EShaderFeature::Instanced, "FEATURE_INSTANCED", "instanced" },
+		{ EShaderFeature::Patches, "FEATURE_PATCHES", "patches" },
+		{ EShaderFeature::MultiDrawIndirect, "FEATURE_MULTI_DRAW_INDIRECT", "multi-draw-indirect" },
+	};
+
+	// Sem KHR_parallel_shader_compile o driver compila cada programa na prpria chamada; com ela, usa quantas threads
+	//	quiser. O limite de threads  um estado do contexto, definido uma nica vez
+	bool EnableParallelShaderCompile()
+	{
+		if (!GLEW_KHR_parallel_shader_compile)
+		{
+			static bool bWarned = false;
+			if (!bWarned)
+			{
+				std::cout << "KHR_parallel_shader_compile indisponvel: a recarga de shaders compila em etapas, uma por frame, "
+						  << "e cada etapa (um shader ou o link) ainda pausa o frame em que acontece" << std::endl;
+				bWarned = true;
+			}
+			return false;
+		}
+
+		static bool bCompilerThreadsSet = false;
+		if (!bCompilerThreadsSet)
+		{
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+			bCompilerThreadsSet = true;
+		}
+		return true;
+	}
+}
+
+std::string GetShaderFeatureDefines(uint32_t Features)
+{
+	std::string Defines;
+	for (const ShaderFeatureInfo& Info : ShaderFeatures)
+	{
+		if (Features & Info.Feature)
+		{
+			Defines += std::string("#define ") + Info.Define + " 1\n";
+		}
+	}
+	return Defines;
+}
+
+std::string GetShaderFeatureName(uint32_t Features)
+{
+	std::string Name;
+	for (const ShaderFeatureInfo& Info : ShaderFeatures)
+	{
+		if (Features & Info.Feature)
+		{
+			if (!Name.empty())
+			{
+				Name += "+";
+			}
+			Name += Info.Name;
+		}
+	}
+	return Name.empty() ? "base" : Name;
+}
+
+ShaderLibrary::ShaderLibrary(const char* InVertexShaderFile, const char* InFragmentShaderFile)
+	: VertexShaderFile(InVertexShaderFile)
+	, FragmentShaderFile(InFragmentShaderFile)
+{
+}
+
+GLuint ShaderLibrary::GetProgram(uint32_t Features)
+{
+	auto Found = Programs.find(Features);
+	if (Found != Programs.end())
+	{
+		return Found->second;
+	}
+
+	Precompile({ Features });
+	return Programs[Features];
+}
+
+const ShaderReflection* ShaderLibrary::GetReflection(uint32_t Features) const
+{
+	auto Found = Reflections.find(Features);
+	return Found != Reflections.end() ? &Found->second : nullptr;
+}
+
+void ShaderLibrary::SetSamplerUnit(const char* Name, GLint Unit)
+{
+	SamplerUnits.emplace_back(Name, Unit);
+}
+
+void ShaderLibrary::SetUniformBlockBinding(const char* Name, GLuint Binding)
+{
+	BlockBindings.emplace_back(Name, Binding);
+}
+
+void ShaderLibrary::SetStorageBlockBinding(const char* Name, GLuint Binding)
+{
+	StorageBlockBindings.emplace_back(Name, Binding);
+}
+
+void ShaderLibrary::SetDefine(const char* Name, const std::string& Value)
+{
+	CommonDefines += std::string("#define ") + Name + " " + Value + "\n";
+}
+
+std::string ShaderLibrary::GetDefines(uint32_t Features) const
+{
+	return GetShaderFeatureDefines(Features) + CommonDefines;
+}
+
+void ShaderLibrary::ConfigureProgram(uint32_t Features, GLuint ProgramId)
+{
+	ShaderReflection& Reflection = Reflections[Features];
+	Reflection.Reflect(ProgramId);
+
+	for (const auto& BlockBinding : BlockBindings)
+	{
+		if (const ShaderUniformBlock* Block = Reflection.FindBlock(BlockBinding.first))
+		{
+			glUniformBlockBinding(ProgramId, Block->Index, BlockBinding.second);
+		}
+	}
+
+	// Blocos de shader storage no aparecem na reflexo dos uniforms: o ndice  consultado pela interface de recursos
+	if (GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_program_interface_query)
+	{
+		for (const auto& StorageBinding : StorageBlockBindings)
+		{
+			const GLuint BlockIndex = glGetProgramResourceIndex(ProgramId, GL_SHADER_STORAGE_BLOCK, StorageBinding.first.c_str());
+			if (BlockIndex != GL_INVALID_INDEX)
+			{
+				glShaderStorageBlockBinding(ProgramId, BlockIndex, StorageBinding.second);
+			}
+		}
+	}
+
+	// O OpenGL 3.3 no tem glProgramUniform: o programa  ativado s para gravar as unidades e o anterior  restaurado
+	GLStateCache& StateCache = GetGLStateCache();
+	const GLuint PreviousProgramId = StateCache.GetProgram();
+	StateCache.UseProgram(ProgramId);
+	for (const auto& SamplerUnit : SamplerUnits)
+	{
+		GLint Location = Reflection.GetLocation(SamplerUnit.first);
+		if (Location >= 0)
+		{
+			glUniform1i(Location, SamplerUnit.second);
+		}
+	}
+	StateCache.UseProgram(PreviousProgramId);
+}
+
+void ShaderLibrary::Precompile(const std::vector<uint32_t>& FeatureSets)
+{
+	auto StartTime = std::chrono::steady_clock::now();
+
+	EnableParallelShaderCompile();
+
+	std::vector<std::pair<uint32_t, ShaderProgramBuild>> Builds;
+	for (uint32_t Features : FeatureSets)
+	{
+		bool bAlreadyQueued = false;
+		for (const auto& Build : Builds)
+		{
+			bAlreadyQueued = bAlreadyQueued || Build.first == Features;
+		}
+		if (Programs.count(Features) > 0 || bAlreadyQueued)
+		{
+			continue;
+		}
+
+		std::cout << "Variante de shader: " << GetShaderFeatureName(Features) << std::endl;
+
+		ShaderProgramBuild Build;
+		if (BeginShaderProgram(VertexShaderFile.c_str(), FragmentShaderFile.c_str(), GetDefines(Features), Build))
+		{
+			Builds.emplace_back(Features, Build);
+		}
+		else
+		{
+			Programs[Features] = 0;
+			FailedVariants++;
+		}
+	}
+
+	if (Builds.empty())
+	{
+		return;
+	}
+
+	// S agora os resultados so consultados (a primeira consulta espera apenas pelo programa correspondente)
+	for (auto& Build : Builds)
+	{
+		GLuint ProgramId = FinishShaderProgram(Build.second);
+		Programs[Build.first] = ProgramId;
+
+		if (ProgramId != 0)
+		{
+			ConfigureProgram(Build.first, ProgramId);
+			CompiledVariants++;
+		}
+		else
+		{
+			FailedVariants++;
+		}
+	}
+
+	CompileSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+void ShaderLibrary::Reload()
+{
+	// Uma nova mudana durante a recompilao invalida as construes em andamento
+	for (PendingReload& Pending : PendingReloads)
+	{
+		if (Pending.bStarted)
+		{
+			DiscardShaderProgram(Pending.Build);
+		}
+	}
+	PendingReloads.clear();
+
+	// Variantes que falharam antes tambm so recompiladas: a edio pode ter corrigido o erro
+	for (const auto& Program : Programs)
+	{
+		PendingReload Pending;
+		Pending.Features = Program.first;
+		PendingReloads.push_back(Pending);
+	}
+}
+
+bool ShaderLibrary::Update()
+{
+	if (PendingReloads.empty())
+	{
+		return false;
+	}
+
+	// Com KHR_parallel_shader_compile todas as compilaes so disparadas de uma vez e apenas consultadas a cada frame.
+	//	Sem a extenso a compilao acontece dentro das chamadas do OpenGL: cada frame executa uma nica etapa (pr-processar,
+	//	compilar um dos shaders, linkar ou conferir o resultado), o que limita a pausa a uma frao de um programa
+	const bool bParallel = EnableParallelShaderCompile();
+
+	bool bSwapped = false;
+	bool bStepTaken = false;
+	for (auto It = PendingReloads.begin(); It != PendingReloads.end();)
+	{
+		PendingReload& Pending = *It;
+
+		if (!Pending.bStarted)
+		{
+			if (!bParallel && bStepTaken)
+			{
+				++It;
+				continue;
+			}
+
+			bStepTaken = true;
+			Pending.bStarted = true;
+			if (!BeginShaderProgram(VertexShaderFile.c_str(), FragmentShaderFile.c_str(), GetDefines(Pending.Features), Pending.Build, !bParallel))
+			{
+				std::cout << "Recarga de shaders: variante " << GetShaderFeatureName(Pending.Features) << " mantida (erro no pr-processamento)" << std::endl;
+				FailedReloads++;
+				It = PendingReloads.erase(It);
+				continue;
+			}
+		}
+
+		if (!IsShaderProgramReady(Pending.Build))
+		{
+			if (!bParallel && !bStepTaken)
+			{
+				AdvanceShaderProgram(Pending.Build);
+				bStepTaken = true;
+			}
+			++It;
+			continue;
+		}
+
+		// A conferncia do link tambm espera o driver: sem a extenso ela  a etapa de um frame
+		if (!bParallel)
+		{
+			if (bStepTaken)
+			{
+				++It;
+				continue;
+			}
+			bStepTaken = true;
+		}
+
+		GLuint ProgramId = FinishShaderProgram(Pending.Build);
+		if (ProgramId != 0)
+		{
+			GLuint& CurrentProgramId = Programs[Pending.Features];
+			if (CurrentProgramId != 0)
+			{
+				GetGLStateCache().OnProgramDeleted(CurrentProgramId);
+				glDeleteProgram(CurrentProgramId);
+			}
+			CurrentProgramId = ProgramId;
+			ConfigureProgram(Pending.Features, ProgramId);
+			ReloadedVariants++;
+			bSwapped = true;
+
+			std::cout << "Recarga de shaders: variante " << GetShaderFeatureName(Pending.Features) << " atualizada" << std::endl;
+		}
+		else
+		{
+			FailedReloads++;
+			std::cout << "Recarga de shaders: variante " << GetShaderFeatureName(Pending.Features) << " mantida (erro de compilao)" << std::endl;
+		}
+
+		It = PendingReloads.erase(It);
+	}
+
+	return bSwapped;
+}
+
+bool ShaderLibrary::IsReloading() const
+{
+	return !PendingReloads.empty();
+}
+
+void ShaderLibrary::Release()
+{
+	for (PendingReload& Pending : PendingReloads)
+	{
+		if (Pending.bStarted)
+		{
+			DiscardShaderProgram(Pending.Build);
+		}
+	}
+	PendingReloads.clear();
+
+	for (const auto& Program : Programs)
+	{
+		if (Program.second != 0)
+		{
+			GetGLStateCache().OnProgramDeleted(Program.second);
+			glDeleteProgram(Program.second);
+		}
+	}
+	Programs.clear();
+	Reflections.clear();
+}
+
+void ShaderLibrary::PrintReport(std::ostream& Output) const
+{
+	Output << "Variantes de shader: " << CompiledVariants << " prontas, " << FailedVariants << " com erro, "
+		   << CompileSeconds * 1000.0 << " ms compilando, " << ReloadedVariants << " recarregadas, " << FailedReloads
+		   << " recargas com erro" << std::endl;
+}
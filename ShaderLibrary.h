@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "Shader.h"
+#include "ShaderReflection.h"
+
+// Recursos opcionais dos shaders. Cada bit vira um "#define FEATURE_X 1" na variante compilada: um recurso desligado
+//	no gera cdigo no programa (nem amostragens, nem uniforms, nem desvios dinmicos)
+namespace EShaderFeature
+{
+	enum Type : uint32_t
+	{
+		Clouds = 1 << 0,
+		Specular = 1 << 1,
+		NightLights = 1 << 2,
+		PackedVertices = 1 << 3,
+		CubeMap = 1 << 4,
+		CloudsSeries = 1 << 5,
+		Instanced = 1 << 6,
+		Patches = 1 << 7,
+		MultiDrawIndirect = 1 << 8,
+
+		Count = 9
+	};
+}
+
+// Linhas "#define FEATURE_X 1" correspondentes aos bits ligados em Features
+std::string GetShaderFeatureDefines(uint32_t Features);
+
+// Descrio legvel da mscara (ex.: "clouds+specular"), usada nos logs
+std::string GetShaderFeatureName(uint32_t Features);
+
+// Variantes de um par vertex/fragment shader indexadas pela mscara de recursos.
+// As variantes so compiladas sob demanda (GetProgram) ou em lote (Precompile); os programas linkados passam pelo cache de
+//	binrios, ento uma variante j usada em outra execuo no  compilada novamente
+class ShaderLibrary
+{
+public:
+	ShaderLibrary(const char* InVertexShaderFile, const char* InFragmentShaderFile);
+
+	// Retorna o programa da variante, compilando-o na primeira chamada (0 se falhar)
+	GLuint GetProgram(uint32_t Features);
+
+	// Tabela de uniforms da variante (nullptr se ela ainda no foi compilada ou falhou)
+	const ShaderReflection* GetReflection(uint32_t Features) const;
+
+	// Unidade de textura de um sampler e ponto de ligao de um bloco de uniforms. Valem para todas as variantes e so
+	//	aplicados uma nica vez a cada programa, logo aps o link, em vez de a cada frame
+	void SetSamplerUnit(const char* Name, GLint Unit);
+	void SetUniformBlockBinding(const char* Name, GLuint Binding);
+
+	// Ponto de ligao de um bloco de shader storage (s tem efeito com ARB_shader_storage_buffer_object)
+	void SetStorageBlockBinding(const char* Name, GLuint Binding);
+
+	// "#define Name Value" em todas as variantes, para constantes que o cdigo C++ tambm usa. Deve ser chamado antes da
+	//	primeira compilao; o valor faz parte da chave do cache de binrios
+	void SetDefine(const char* Name, const std::string& Value);
+
+	// Compila as variantes ainda inexistentes de uma vez: todas as compilaes e links so disparados antes de qualquer
+	//	consulta de status, o que permite ao driver compil-las em paralelo (KHR_parallel_shader_compile)
+	void Precompile(const std::vector<uint32_t>& FeatureSets);
+
+	// Recompila todas as variantes existentes (ex.: um arquivo de shaders mudou) sem bloquear o frame. Os programas
+	//	atuais continuam em uso at que os novos terminem de linkar; se algum falhar o erro  impresso e o anterior fica
+	void Reload();
+
+	// Chamada a cada frame: dispara as recompilaes pendentes e troca os programas que j ficaram prontos.
+	//	Retorna true se algum programa foi trocado (quem guarda o identificador deve chamar GetProgram novamente)
+	bool Update();
+
+	bool IsReloading() const;
+
+	void Release();
+
+	void PrintReport(std::ostream& Output) const;
+
+private:
+	// Monta a tabela de uniforms do programa recm-linkado e aplica as unidades dos samplers e as ligaes dos blocos
+	void ConfigureProgram(uint32_t Features, GLuint ProgramId);
+
+	// Defines dos recursos da variante seguidos dos de SetDefine
+	std::string GetDefines(uint32_t Features) const;
+
+	std::string VertexShaderFile;
+	std::string FragmentShaderFile;
+
+	std::unordered_map<uint32_t, GLuint> Programs;
+	std::unordered_map<uint32_t, ShaderReflection> Reflections;
+
+	std::vector<std::pair<std::string, GLint>> SamplerUnits;
+	std::vector<std::pair<std::string, GLuint>> BlockBindings;
+	std::vector<std::pair<std::string, GLuint>> StorageBlockBindings;
+	std::string CommonDefines;
+
+	struct PendingReload
+	{
+		uint32_t Features = 0;
+		ShaderProgramBuild Build;
+		bool bStarted = false;
+	};
+	std::vector<PendingReload> PendingReloads;
+
+	uint64_t CompiledVariants = 0;
+	uint64_t FailedVariants = 0;
+	double CompileSeconds = 0.0;
+	uint64_t ReloadedVariants = 0;
+	uint64_t FailedReloads = 0;
+};
@@ -0,0 +1,128 @@
+#include "ShaderReflection.h"
+
+#include <ostream>
+
+void ShaderReflection::Reflect(GLuint ProgramId)
+{
+	Uniforms.clear();
+	Blocks.clear();
+
+	if (ProgramId == 0)
+	{
+		return;
+	}
+
+	GLint NumUniforms = 0;
+	GLint MaxNameLength = 0;
+	glGetProgramiv(ProgramId, GL_ACTIVE_UNIFORMS, &NumUniforms);
+	glGetProgramiv(ProgramId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &MaxNameLength);
+
+	std::string NameBuffer(static_cast<size_t>(MaxNameLength) + 1, '\0');
+	for (GLint UniformIndex = 0; UniformIndex < NumUniforms; ++UniformIndex)
+	{
+		ShaderUniform Uniform;
+		GLsizei NameLength = 0;
+		glGetActiveUniform(ProgramId, UniformIndex, static_cast<GLsizei>(NameBuffer.size()), &NameLength, &Uniform.Size, &Uniform.Type, &NameBuffer[0]);
+		Uniform.Name.assign(NameBuffer.data(), NameLength);
+
+		// Arrays so reportados como "Nome[0]"
+		const size_t ArraySuffix = Uniform.Name.find('[');
+		if (ArraySuffix != std::string::npos)
+		{
+			Uniform.Name.resize(ArraySuffix);
+		}
+
+		const GLuint Index = static_cast<GLuint>(UniformIndex);
+		glGetActiveUniformsiv(ProgramId, 1, &Index, GL_UNIFORM_BLOCK_INDEX, &Uniform.BlockIndex);
+		if (Uniform.BlockIndex >= 0)
+		{
+			glGetActiveUniformsiv(ProgramId, 1, &Index, GL_UNIFORM_OFFSET, &Uniform.Offset);
+		}
+		else
+		{
+			Uniform.Location = glGetUniformLocation(ProgramId, NameBuffer.c_str());
+		}
+
+		Uniforms.push_back(Uniform);
+	}
+
+	GLint NumBlocks = 0;
+	glGetProgramiv(ProgramId, GL_ACTIVE_UNIFORM_BLOCKS, &NumBlocks);
+	for (GLint BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+	{
+		ShaderUniformBlock Block;
+		Block.Index = static_cast<GLuint>(BlockIndex);
+
+		GLint NameLength = 0;
+		glGetActiveUniformBlockiv(ProgramId, Block.Index, GL_UNIFORM_BLOCK_NAME_LENGTH, &NameLength);
+		glGetActiveUniformBlockiv(ProgramId, Block.Index, GL_UNIFORM_BLOCK_DATA_SIZE, &Block.DataSize);
+
+		std::string BlockName(static_cast<size_t>(NameLength) + 1, '\0');
+		GLsizei Written = 0;
+		glGetActiveUniformBlockName(ProgramId, Block.Index, static_cast<GLsizei>(BlockName.size()), &Written, &BlockName[0]);
+		Block.Name.assign(BlockName.data(), Written);
+
+		Blocks.push_back(Block);
+	}
+}
+
+const ShaderUniform* ShaderReflection::FindUniform(const std::string& Name) const
+{
+	for (const ShaderUniform& Uniform : Uniforms)
+	{
+		if (Uniform.Name == Name)
+		{
+			return &Uniform;
+		}
+	}
+	return nullptr;
+}
+
+const ShaderUniformBlock* ShaderReflection::FindBlock(const std::string& Name) const
+{
+	for (const ShaderUniformBlock& Block : Blocks)
+	{
+		if (Block.Name == Name)
+		{
+			return &Block;
+		}
+	}
+	return nullptr;
+}
+
+GLint ShaderReflection::GetLocation(const std::string& Name) const
+{
+	const ShaderUniform* Uniform = FindUniform(Name);
+	return Uniform ? Uniform->Location : -1;
+}
+
+const std::vector<ShaderUniform>& ShaderReflection::GetUniforms() const
+{
+	return Uniforms;
+}
+
+const std::vector<ShaderUniformBlock>& ShaderReflection::GetBlocks() const
+{
+	return Blocks;
+}
+
+void ShaderReflection::Print(std::ostream& Output) const
+{
+	for (const ShaderUniformBlock& Block : Blocks)
+	{
+		Output << "  bloco " << Block.Name << " (" << Block.DataSize << " bytes)" << std::endl;
+	}
+	for (const ShaderUniform& Uniform : Uniforms)
+	{
+		Output << "  " << Uniform.Name << " tipo 0x" << std::hex << Uniform.Type << std::dec;
+		if (Uniform.BlockIndex >= 0)
+		{
+			Output << " bloco " << Uniform.BlockIndex << " offset " << Uniform.Offset;
+		}
+		else
+		{
+			Output << " location " << Uniform.Location;
+		}
+		Output << std::endl;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Uniform ativo de um programa linkado. Uniforms dentro de blocos tm Location -1, BlockIndex e Offset (std140)
+struct ShaderUniform
+{
+	std::string Name;
+	GLint Location = -1;
+	GLenum Type = 0;
+	GLint Size = 0; // Elementos (1 para uniforms que no so arrays)
+	GLint BlockIndex = -1;
+	GLint Offset = -1;
+};
+
+struct ShaderUniformBlock
+{
+	std::string Name;
+	GLuint Index = GL_INVALID_INDEX;
+	GLint DataSize = 0;
+};
+
+// Tabela dos uniforms e blocos ativos de um programa, montada uma vez depois do link (glGetActiveUniform /
+//	glGetActiveUniformBlockiv). As buscas por nome acontecem s aqui: o lao de renderizao guarda as localizaes
+class ShaderReflection
+{
+public:
+	void Reflect(GLuint ProgramId);
+
+	const ShaderUniform* FindUniform(const std::string& Name) const;
+	const ShaderUniformBlock* FindBlock(const std::string& Name) const;
+
+	// Localizao do uniform (-1 se ele no existe nesta variante ou foi eliminado pelo compilador)
+	GLint GetLocation(const std::string& Name) const;
+
+	const std::vector<ShaderUniform>& GetUniforms() const;
+	const std::vector<ShaderUniformBlock>& GetBlocks() const;
+
+	void Print(std::ostream& Output) const;
+
+private:
+	std::vector<ShaderUniform> Uniforms;
+	std::vector<ShaderUniformBlock> Blocks;
+};
@@ -0,0 +1,121 @@
+#include "ShaderWatcher.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher(const char* InDirectory)
+	: Directory(InDirectory)
+{
+#ifdef __linux__
+	InotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (InotifyDescriptor >= 0)
+	{
+		// IN_CLOSE_WRITE cobre a gravao direta e IN_MOVED_TO os editores que gravam em um temporrio e renomeiam
+		const uint32_t Mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+		if (inotify_add_watch(InotifyDescriptor, Directory.c_str(), Mask) < 0)
+		{
+			close(InotifyDescriptor);
+			InotifyDescriptor = -1;
+		}
+	}
+#endif
+
+	if (InotifyDescriptor < 0)
+	{
+		// Sem inotify: a primeira varredura apenas registra as datas atuais
+		ScanDirectory();
+		LastScanTime = Clock::now();
+	}
+
+	std::cout << "Observando " << Directory << (IsUsingInotify() ? " (inotify)" : " (varredura peridica)") << std::endl;
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+	if (InotifyDescriptor >= 0)
+	{
+		close(InotifyDescriptor);
+	}
+#endif
+}
+
+bool ShaderWatcher::IsUsingInotify() const
+{
+	return InotifyDescriptor >= 0;
+}
+
+bool ShaderWatcher::ReadInotifyEvents()
+{
+	bool bChanged = false;
+
+#ifdef __linux__
+	// Os eventos tm tamanho varivel (nome do arquivo); basta saber se chegou algum
+	alignas(inotify_event) char Buffer[4096];
+	for (;;)
+	{
+		ssize_t Length = read(InotifyDescriptor, Buffer, sizeof(Buffer));
+		if (Length <= 0)
+		{
+			break;
+		}
+		bChanged = true;
+	}
+#endif
+
+	return bChanged;
+}
+
+bool ShaderWatcher::ScanDirectory()
+{
+	std::map<std::string, std::filesystem::file_time_type> CurrentTimes;
+
+	std::error_code Error;
+	for (std::filesystem::directory_iterator Entry{ Directory, Error }, End; !Error && Entry != End; Entry.increment(Error))
+	{
+		std::error_code TimeError;
+		std::filesystem::file_time_type WriteTime = Entry->last_write_time(TimeError);
+		if (!TimeError)
+		{
+			CurrentTimes[Entry->path().string()] = WriteTime;
+		}
+	}
+
+	bool bChanged = CurrentTimes != FileTimes;
+	FileTimes.swap(CurrentTimes);
+	return bChanged;
+}
+
+bool ShaderWatcher::Update()
+{
+	const Clock::time_point Now = Clock::now();
+
+	bool bChanged = false;
+	if (IsUsingInotify())
+	{
+		bChanged = ReadInotifyEvents();
+	}
+	else if (std::chrono::duration<float>(Now - LastScanTime).count() >= PollInterval)
+	{
+		bChanged = ScanDirectory();
+		LastScanTime = Now;
+	}
+
+	if (bChanged)
+	{
+		bChangePending = true;
+		LastChangeTime = Now;
+	}
+
+	if (bChangePending && std::chrono::duration<float>(Now - LastChangeTime).count() >= SettleSeconds)
+	{
+		bChangePending = false;
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+
+// Observa os arquivos de um diretrio de shaders e avisa quando eles mudam.
+// No Linux usa inotify (descritor no bloqueante, lido uma vez por frame); nos demais sistemas compara as datas de
+//	modificao dos arquivos a cada PollInterval segundos.
+// Editores costumam gravar um arquivo em vrias etapas (truncar, escrever, renomear): a mudana s  informada depois
+//	de SettleSeconds sem novos eventos, para no compilar um arquivo pela metade
+class ShaderWatcher
+{
+public:
+	explicit ShaderWatcher(const char* InDirectory);
+	~ShaderWatcher();
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// Retorna true uma nica vez para cada lote de mudanas j estabilizado. No bloqueia
+	bool Update();
+
+	bool IsUsingInotify() const;
+
+	float PollInterval = 0.25f;
+	float SettleSeconds = 0.1f;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	bool ReadInotifyEvents();
+	bool ScanDirectory();
+
+	std::string Directory;
+	int InotifyDescriptor = -1;
+
+	std::map<std::string, std::filesystem::file_time_type> FileTimes;
+	Clock::time_point LastScanTime;
+
+	bool bChangePending = false;
+	Clock::time_point LastChangeTime;
+};
@@ -0,0 +1,260 @@
+#include "Texture.h"
+
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+#define STB_IMAGE_IMPLEMENTATION // Macro necessria para ativar o header STB
+#include <stb_image.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace
+{
+	// Memria de vdeo de cada textura alocada e quanto ela ocuparia no formato RGB8 anterior
+	struct TextureMemory
+	{
+		size_t Bytes = 0;
+		size_t BaselineBytes = 0;
+	};
+
+	// Acessada apenas pela thread do contexto OpenGL
+	std::unordered_map<GLuint, TextureMemory> AllocatedTextures;
+
+	double ToMegabytes(size_t Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+}
+
+bool QueryTextureSize(const char* TextureFile, int& Width, int& Height)
+{
+	int NumberOfComponents = 0;
+	return stbi_info(TextureFile, &Width, &Height, &NumberOfComponents) != 0;
+}
+
+bool DecodeTexture(const char* TextureFile, const TextureFormatOptions& Options, TextureImage& Image)
+{
+	// Recebe por parmetro um ponteiro para um arquivo, endereos de trs variveis para armazenar os tamanhos da largura
+	//	e da altura da imagem carregada, o nmero de componentes disponvel e por fim a quantidade de componentes que
+	//	desejamos retornar (0 = os que existirem no arquivo; a anlise abaixo decide quantos vo para a GPU)
+	int NumberOfComponents = 0;
+	unsigned char* TextureData = stbi_load(TextureFile, &Image.Width, &Image.Height, &NumberOfComponents, 0);
+
+	if (!TextureData)
+	{
+		return false;
+	}
+
+	Image.Name = TextureFile;
+	Image.NumberOfComponents = NumberOfComponents;
+	Image.Pixels.assign(TextureData, TextureData + static_cast<size_t>(Image.Width) * Image.Height * NumberOfComponents);
+
+	stbi_image_free(TextureData); // A cpia fica em Image.Pixels, pode liberar a RAM alocada pelo STB
+
+	// Escolhe o formato mais compacto a partir do contedo dos canais (ex.: nuvens em tons de cinza -> um canal)
+	if (Options.bForceFormat)
+	{
+		ConvertTextureImage(Image, Options.ForcedFormat, Options.Usage);
+		return true;
+	}
+
+	TextureChannelInfo Info = AnalyzeTextureChannels(Image);
+	ConvertTextureImage(Image, SelectTextureFormat(Info, Options), Options.Usage);
+	return true;
+}
+
+GLuint CreateTextureStorage(const TextureImage& Image)
+{
+	// Gerar o Identifador da Textura + procedimento para lev-la para a memria de vdeo
+	GLuint TextureId;
+	glGenTextures(1, &TextureId);
+
+	// Habilita a textura para ser modificada (bind)
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D, TextureId); // 2D por ser uma imagem
+
+	// Reserva a memria de vdeo do nvel 0 (ponteiro nulo: os pixels so copiados depois, por faixas de linhas)
+	// 	   Recebe por parmetro um alvo ou tipo de textura;
+	//	   Um level de texturizao;
+	// 	   Um formato interno de armazenamento da estrutura de dados;
+	// 	   Largura;
+	// 	   Altura;
+	// 	   Uso de bordas;
+	// 	   Formato novamente - para encapsulamento;
+	// 	   Tipo de referncia para os dados carregados - tipo de TextureData (char* = bytes)
+	//	   Ponteiro para os dados (pixels) a serem transferidos para a GPU
+	GLint Level = 0;
+	GLint Border = 0;
+	const TextureFormat& Format = Image.Format;
+
+	if (Format.bCompressed)
+	{
+		// Os blocos comprimidos so pequenos: todos os nveis j gerados na CPU so copiados de uma vez
+		int LevelWidth = Image.Width;
+		int LevelHeight = Image.Height;
+		for (const std::vector<unsigned char>& Blocks : Image.CompressedLevels)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, Level, Format.InternalFormat, LevelWidth, LevelHeight, Border,
+								   static_cast<GLsizei>(Blocks.size()), Blocks.data());
+			LevelWidth = std::max(1, LevelWidth / 2);
+			LevelHeight = std::max(1, LevelHeight / 2);
+			++Level;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Level - 1);
+	}
+	else
+	{
+		glTexImage2D(GL_TEXTURE_2D, Level, Format.InternalFormat, Image.Width, Image.Height, Border, Format.PixelFormat,
+					 GL_UNSIGNED_BYTE, nullptr);
+
+		// Enquanto as mipmaps no existirem, a amostragem usa apenas o nvel 0
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	}
+
+	TrackTextureMemory(TextureId, Format.Name, Image.Width, Image.Height, ComputeTextureMemory(Format, Image.Width, Image.Height),
+					   ComputeTextureMemory(TextureFormat{}, Image.Width, Image.Height));
+
+	return TextureId;
+}
+
+void TrackTextureMemory(GLuint TextureId, const char* Description, int Width, int Height, size_t Bytes, size_t BaselineBytes)
+{
+	TextureMemory& Memory = AllocatedTextures[TextureId];
+	Memory.Bytes = Bytes;
+	Memory.BaselineBytes = BaselineBytes;
+
+	std::cout << std::fixed << std::setprecision(1)
+			  << "Formato " << Description << " (" << Width << "x" << Height << "): "
+			  << ToMegabytes(Memory.Bytes) << " MB na GPU, RGB8 ocuparia " << ToMegabytes(Memory.BaselineBytes) << " MB"
+			  << std::defaultfloat << std::endl;
+}
+
+void UploadTextureRows(GLuint TextureId, const TextureImage& Image, int FirstRow, int NumRows)
+{
+	assert(FirstRow >= 0 && FirstRow + NumRows <= Image.Height);
+
+	// Texturas comprimidas j foram copiadas por inteiro em CreateTextureStorage
+	if (Image.Format.bCompressed)
+	{
+		return;
+	}
+
+	const size_t RowSize = static_cast<size_t>(Image.Width) * Image.NumberOfComponents;
+
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D, TextureId);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Linhas com 1 ou 3 componentes no so necessariamente mltiplas de 4 bytes
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, FirstRow, Image.Width, NumRows, Image.Format.PixelFormat, GL_UNSIGNED_BYTE,
+					Image.Pixels.data() + RowSize * FirstRow);
+}
+
+void FinalizeTexture(GLuint TextureId, const TextureImage& Image)
+{
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D, TextureId);
+
+	// Aplicao de filtro de magnificao e minificao
+	// Parametrizao linear para suavizar granulao com aumento de zoom
+	// Mipmap para contornar aliasing da distncia
+	// Configurar o Texture Wrapping - extrapolaes das coordenadas normalizadas da img texturizada nas coordenadas S e T
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// Formatos comprimidos trazem as mipmaps prontas da CPU
+	if (!Image.Format.bCompressed)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	// S texturas completas entram no oramento de memria de vdeo (durante a cpia incremental elas no so usadas)
+	GetTextureResidency().Register(TextureId, Image.Name, Image.Width, Image.Height, Image.Format);
+}
+
+GLuint LoadTexture(const char* TextureFile, const TextureFormatOptions& Options)
+{
+	PROFILE_SCOPE("LoadTexture");
+
+	std::cout << "Carregando Textura " << TextureFile << std::endl;
+
+	// Textura em RAM
+	TextureImage Image;
+	bool bLoaded = DecodeTexture(TextureFile, Options, Image);
+
+	assert(bLoaded); // Caso algo d errado durante o carregamento da textura, interrompe o processamento
+
+	std::cout << "Textura carregada com sucesso" << std::endl;
+
+	// Copiar a textura para a memria de vdeo (GPU)
+	GLuint TextureId = CreateTextureStorage(Image);
+	UploadTextureRows(TextureId, Image, 0, Image.Height);
+	FinalizeTexture(TextureId, Image);
+
+	return TextureId; // Image sai de escopo e libera a RAM utilizada
+}
+
+void ReleaseTexture(GLuint& TextureId)
+{
+	if (TextureId == 0)
+	{
+		return;
+	}
+
+	AllocatedTextures.erase(TextureId);
+	GetTextureResidency().Unregister(TextureId);
+	GetGLStateCache().OnTextureDeleted(TextureId);
+	glDeleteTextures(1, &TextureId);
+	TextureId = 0;
+}
+
+bool SaveTexturePng(GLuint TextureId, const char* File, int Width, int Height)
+{
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D, TextureId);
+
+	GLint TextureWidth = 0;
+	GLint TextureHeight = 0;
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &TextureWidth);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &TextureHeight);
+	if (TextureWidth <= 0 || TextureHeight <= 0)
+	{
+		return false;
+	}
+
+	// Texturas sRGB so lidas sem converso: os bytes j esto codificados como o PNG espera
+	std::vector<unsigned char> Pixels(static_cast<size_t>(TextureWidth) * TextureHeight * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, Pixels.data());
+
+	const int SavedWidth = Width > 0 ? std::min(Width, static_cast<int>(TextureWidth)) : TextureWidth;
+	const int SavedHeight = Height > 0 ? std::min(Height, static_cast<int>(TextureHeight)) : TextureHeight;
+
+	// A primeira linha do OpenGL  a de baixo
+	stbi_flip_vertically_on_write(1);
+	const bool bSaved = stbi_write_png(File, SavedWidth, SavedHeight, 4, Pixels.data(), TextureWidth * 4) != 0;
+
+	std::cout << (bSaved ? "Captura gravada em " : "Erro ao gravar a captura ") << File << std::endl;
+	return bSaved;
+}
+
+void PrintTextureMemoryReport(std::ostream& Output)
+{
+	size_t TotalBytes = 0;
+	size_t TotalBaselineBytes = 0;
+	for (const auto& Entry : AllocatedTextures)
+	{
+		TotalBytes += Entry.second.Bytes;
+		TotalBaselineBytes += Entry.second.BaselineBytes;
+	}
+
+	Output << std::fixed << std::setprecision(1)
+		   << "Memria de vdeo das texturas: " << ToMegabytes(TotalBytes) << " MB em " << AllocatedTextures.size()
+		   << " texturas (RGB8: " << ToMegabytes(TotalBaselineBytes) << " MB, economia de "
+		   << ToMegabytes(TotalBaselineBytes) - ToMegabytes(TotalBytes) << " MB)" << std::defaultfloat << std::endl;
+}
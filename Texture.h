@@ -0,0 +1,59 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "TextureFormat.h"
+
+// Imagem decodificada em RAM, pronta para ser copiada para a GPU
+struct TextureImage
+{
+	int Width = 0;
+	int Height = 0;
+	int NumberOfComponents = 0;
+	std::vector<unsigned char> Pixels;
+	std::string Name; // Arquivo de origem, usado nos logs de memria
+
+	// Formato escolhido para a GPU; nos formatos comprimidos os blocos de cada nvel de mipmap ficam em CompressedLevels
+	TextureFormat Format;
+	std::vector<std::vector<unsigned char>> CompressedLevels;
+
+	// Nveis 1..n das mipmaps no comprimidas, quando gerados na CPU (GenerateMipmapLevels)
+	std::vector<std::vector<unsigned char>> MipmapLevels;
+};
+
+// L apenas o cabealho do arquivo para obter as dimenses da imagem (no decodifica os pixels)
+bool QueryTextureSize(const char* TextureFile, int& Width, int& Height);
+
+// Decodifica o arquivo de imagem para a RAM, analisa os canais e converte os pixels para o formato mais compacto.
+// No utiliza o OpenGL, podendo ser chamada de qualquer thread
+bool DecodeTexture(const char* TextureFile, const TextureFormatOptions& Options, TextureImage& Image);
+
+// Cria o identificador da textura e reserva a memria de vdeo do nvel 0, sem copiar os pixels
+GLuint CreateTextureStorage(const TextureImage& Image);
+
+// Copia as linhas [FirstRow, FirstRow + NumRows) da imagem para o nvel 0 da textura
+void UploadTextureRows(GLuint TextureId, const TextureImage& Image, int FirstRow, int NumRows);
+
+// Aplica filtros e wrapping e gera as mipmaps, aps todas as linhas terem sido copiadas
+void FinalizeTexture(GLuint TextureId, const TextureImage& Image);
+
+// Carrega a textura inteira de uma s vez (decodificao + cpia para a GPU)
+GLuint LoadTexture(const char* TextureFile, const TextureFormatOptions& Options);
+
+// Registra a memria de vdeo de uma textura recm-criada para o relatrio, junto do custo que ela teria no formato
+//	RGB8 equiretangular usado anteriormente
+void TrackTextureMemory(GLuint TextureId, const char* Description, int Width, int Height, size_t Bytes, size_t BaselineBytes);
+
+// Apaga a textura da GPU e remove sua memria da contabilidade
+void ReleaseTexture(GLuint& TextureId);
+
+// L o nvel 0 de uma textura 2D de cor de 8 bits por canal e o grava em PNG (ex.: a captura da tela). Com Width e
+//	Height maiores que 0 grava s esse retngulo, a partir do canto inferior esquerdo (ex.: a rea usada com escala dinmica)
+bool SaveTexturePng(GLuint TextureId, const char* File, int Width = 0, int Height = 0);
+
+// Imprime a memria de vdeo das texturas alocadas e a economia em relao ao formato RGB8 usado anteriormente
+void PrintTextureMemoryReport(std::ostream& Output);
@@ -0,0 +1,392 @@
+#include "TextureFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring> // memcpy, utilizado pelo stb_dxt
+#include <vector>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+#include "Texture.h"
+
+namespace
+{
+	const TextureFormat FormatR8{ GL_R8, GL_RED, 1, false, 0, "R8" };
+	const TextureFormat FormatRG8{ GL_RG8, GL_RG, 2, false, 0, "RG8" };
+	const TextureFormat FormatRGB8{ GL_RGB8, GL_RGB, 3, false, 0, "RGB8" };
+	const TextureFormat FormatRGBA8{ GL_RGBA8, GL_RGBA, 4, false, 0, "RGBA8" };
+	const TextureFormat FormatSRGB8{ GL_SRGB8, GL_RGB, 3, false, 0, "SRGB8" };
+	const TextureFormat FormatSRGB8Alpha8{ GL_SRGB8_ALPHA8, GL_RGBA, 4, false, 0, "SRGB8_ALPHA8" };
+	const TextureFormat FormatBC1{ GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_RGB, 3, true, 8, "BC1" };
+	const TextureFormat FormatBC1SRGB{ GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, GL_RGB, 3, true, 8, "BC1 sRGB" };
+	const TextureFormat FormatBC3{ GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_RGBA, 4, true, 16, "BC3" };
+	const TextureFormat FormatBC3SRGB{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, GL_RGBA, 4, true, 16, "BC3 sRGB" };
+	const TextureFormat FormatBC4{ GL_COMPRESSED_RED_RGTC1, GL_RED, 1, true, 8, "BC4" };
+	const TextureFormat FormatBC5{ GL_COMPRESSED_RG_RGTC2, GL_RG, 2, true, 16, "BC5" };
+
+	// Diferena mxima entre R, G e B para considerar um pixel cinza (o JPEG introduz rudo nos canais de cor)
+	constexpr int GrayscaleTolerance = 3;
+
+	// Tabelas de converso sRGB <-> linear usadas na gerao das mipmaps na CPU
+	const std::array<float, 256>& GetSRGBToLinearTable()
+	{
+		static const std::array<float, 256> Table = []
+		{
+			std::array<float, 256> Values;
+			for (int Index = 0; Index < 256; ++Index)
+			{
+				float Value = Index / 255.0f;
+				Values[Index] = Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+			}
+			return Values;
+		}();
+		return Table;
+	}
+
+	unsigned char LinearToSRGB(float Value)
+	{
+		static const std::array<unsigned char, 4096> Table = []
+		{
+			std::array<unsigned char, 4096> Values;
+			for (int Index = 0; Index < 4096; ++Index)
+			{
+				float Linear = Index / 4095.0f;
+				float Encoded = Linear <= 0.0031308f ? Linear * 12.92f : 1.055f * std::pow(Linear, 1.0f / 2.4f) - 0.055f;
+				Values[Index] = static_cast<unsigned char>(std::lround(std::min(1.0f, Encoded) * 255.0f));
+			}
+			return Values;
+		}();
+		int Index = static_cast<int>(std::clamp(Value, 0.0f, 1.0f) * 4095.0f + 0.5f);
+		return Table[Index];
+	}
+
+	// L um pixel de N componentes como RGBA
+	void ReadRGBA(const unsigned char* Texel, int NumberOfComponents, unsigned char* RGBA)
+	{
+		switch (NumberOfComponents)
+		{
+			case 1:
+				RGBA[0] = RGBA[1] = RGBA[2] = Texel[0];
+				RGBA[3] = 255;
+				break;
+
+			case 2:
+				RGBA[0] = RGBA[1] = RGBA[2] = Texel[0];
+				RGBA[3] = Texel[1];
+				break;
+
+			case 3:
+				RGBA[0] = Texel[0];
+				RGBA[1] = Texel[1];
+				RGBA[2] = Texel[2];
+				RGBA[3] = 255;
+				break;
+
+			default:
+				RGBA[0] = Texel[0];
+				RGBA[1] = Texel[1];
+				RGBA[2] = Texel[2];
+				RGBA[3] = Texel[3];
+				break;
+		}
+	}
+
+	void RepackComponents(TextureImage& Image, int NewComponents)
+	{
+		if (Image.NumberOfComponents == NewComponents)
+		{
+			return;
+		}
+
+		const size_t NumPixels = static_cast<size_t>(Image.Width) * Image.Height;
+		std::vector<unsigned char> Repacked(NumPixels * NewComponents);
+
+		for (size_t Pixel = 0; Pixel < NumPixels; ++Pixel)
+		{
+			unsigned char RGBA[4];
+			ReadRGBA(&Image.Pixels[Pixel * Image.NumberOfComponents], Image.NumberOfComponents, RGBA);
+
+			unsigned char* Texel = &Repacked[Pixel * NewComponents];
+			if (NewComponents <= 2)
+			{
+				// Mdia dos canais descarta o rudo de cor que o JPEG deixa em imagens cinzas
+				Texel[0] = static_cast<unsigned char>((RGBA[0] + RGBA[1] + RGBA[2] + 1) / 3);
+				if (NewComponents == 2)
+				{
+					Texel[1] = RGBA[3];
+				}
+			}
+			else
+			{
+				std::copy(RGBA, RGBA + NewComponents, Texel);
+			}
+		}
+
+		Image.Pixels.swap(Repacked);
+		Image.NumberOfComponents = NewComponents;
+	}
+
+	// Filtro box 2x2 para o prximo nvel de mipmap. Em texturas sRGB a mdia  feita no espao linear
+	std::vector<unsigned char> DownsampleLevel(const std::vector<unsigned char>& Pixels, int Width, int Height,
+											   int NumberOfComponents, bool bSRGB, int& OutWidth, int& OutHeight)
+	{
+		const std::array<float, 256>& ToLinear = GetSRGBToLinearTable();
+
+		OutWidth = std::max(1, Width / 2);
+		OutHeight = std::max(1, Height / 2);
+
+		std::vector<unsigned char> Result(static_cast<size_t>(OutWidth) * OutHeight * NumberOfComponents);
+
+		for (int Y = 0; Y < OutHeight; ++Y)
+		{
+			const int Y0 = std::min(Y * 2, Height - 1);
+			const int Y1 = std::min(Y * 2 + 1, Height - 1);
+
+			for (int X = 0; X < OutWidth; ++X)
+			{
+				const int X0 = std::min(X * 2, Width - 1);
+				const int X1 = std::min(X * 2 + 1, Width - 1);
+
+				const unsigned char* Samples[4] =
+				{
+					&Pixels[(static_cast<size_t>(Y0) * Width + X0) * NumberOfComponents],
+					&Pixels[(static_cast<size_t>(Y0) * Width + X1) * NumberOfComponents],
+					&Pixels[(static_cast<size_t>(Y1) * Width + X0) * NumberOfComponents],
+					&Pixels[(static_cast<size_t>(Y1) * Width + X1) * NumberOfComponents]
+				};
+
+				unsigned char* Texel = &Result[(static_cast<size_t>(Y) * OutWidth + X) * NumberOfComponents];
+				for (int Component = 0; Component < NumberOfComponents; ++Component)
+				{
+					// O alpha (quarto componente)  sempre linear
+					if (bSRGB && Component < 3)
+					{
+						float Sum = 0.0f;
+						for (const unsigned char* Sample : Samples)
+						{
+							Sum += ToLinear[Sample[Component]];
+						}
+						Texel[Component] = LinearToSRGB(Sum * 0.25f);
+					}
+					else
+					{
+						int Sum = 2;
+						for (const unsigned char* Sample : Samples)
+						{
+							Sum += Sample[Component];
+						}
+						Texel[Component] = static_cast<unsigned char>(Sum / 4);
+					}
+				}
+			}
+		}
+
+		return Result;
+	}
+
+	// Comprime um nvel inteiro em blocos 4x4 (as bordas que no completam um bloco repetem o ltimo pixel)
+	std::vector<unsigned char> CompressLevel(const std::vector<unsigned char>& Pixels, int Width, int Height,
+											 int NumberOfComponents, const TextureFormat& Format)
+	{
+		const int BlocksX = (Width + 3) / 4;
+		const int BlocksY = (Height + 3) / 4;
+
+		std::vector<unsigned char> Blocks(static_cast<size_t>(BlocksX) * BlocksY * Format.BlockBytes);
+
+		for (int BlockY = 0; BlockY < BlocksY; ++BlockY)
+		{
+			for (int BlockX = 0; BlockX < BlocksX; ++BlockX)
+			{
+				unsigned char Source[16 * 4];
+				for (int Y = 0; Y < 4; ++Y)
+				{
+					const int SourceY = std::min(BlockY * 4 + Y, Height - 1);
+					for (int X = 0; X < 4; ++X)
+					{
+						const int SourceX = std::min(BlockX * 4 + X, Width - 1);
+						const unsigned char* Texel = &Pixels[(static_cast<size_t>(SourceY) * Width + SourceX) * NumberOfComponents];
+
+						if (NumberOfComponents <= 2)
+						{
+							std::copy(Texel, Texel + NumberOfComponents, &Source[(Y * 4 + X) * NumberOfComponents]);
+						}
+						else
+						{
+							ReadRGBA(Texel, NumberOfComponents, &Source[(Y * 4 + X) * 4]);
+						}
+					}
+				}
+
+				unsigned char* Block = &Blocks[(static_cast<size_t>(BlockY) * BlocksX + BlockX) * Format.BlockBytes];
+				switch (NumberOfComponents)
+				{
+					case 1:
+						stb_compress_bc4_block(Block, Source);
+						break;
+
+					case 2:
+						stb_compress_bc5_block(Block, Source);
+						break;
+
+					default:
+						stb_compress_dxt_block(Block, Source, NumberOfComponents == 4, STB_DXT_HIGHQUAL);
+						break;
+				}
+			}
+		}
+
+		return Blocks;
+	}
+}
+
+TextureChannelInfo AnalyzeTextureChannels(const TextureImage& Image)
+{
+	TextureChannelInfo Info;
+	Info.NumberOfComponents = Image.NumberOfComponents;
+	Info.bGrayscale = true;
+
+	const int NumberOfComponents = Image.NumberOfComponents;
+	const size_t NumPixels = static_cast<size_t>(Image.Width) * Image.Height;
+
+	for (size_t Pixel = 0; Pixel < NumPixels; ++Pixel)
+	{
+		const unsigned char* Texel = &Image.Pixels[Pixel * NumberOfComponents];
+
+		for (int Component = 0; Component < NumberOfComponents; ++Component)
+		{
+			Info.MinValue[Component] = std::min(Info.MinValue[Component], Texel[Component]);
+			Info.MaxValue[Component] = std::max(Info.MaxValue[Component], Texel[Component]);
+		}
+
+		if (NumberOfComponents >= 3 && Info.bGrayscale)
+		{
+			if (std::abs(Texel[0] - Texel[1]) > GrayscaleTolerance || std::abs(Texel[0] - Texel[2]) > GrayscaleTolerance)
+			{
+				Info.bGrayscale = false;
+			}
+		}
+	}
+
+	// Alpha s  considerado em uso se algum pixel no for totalmente opaco
+	if (NumberOfComponents == 2 || NumberOfComponents == 4)
+	{
+		Info.bUsesAlpha = Info.MinValue[NumberOfComponents - 1] < 255;
+	}
+
+	return Info;
+}
+
+TextureFormat SelectTextureFormat(const TextureChannelInfo& Info, const TextureFormatOptions& Options)
+{
+	const bool bCompress = Options.bAllowCompression;
+
+	if (Options.Usage == ETextureUsage::Mask)
+	{
+		if (Info.bGrayscale)
+		{
+			if (Info.bUsesAlpha)
+			{
+				return bCompress ? FormatBC5 : FormatRG8;
+			}
+			return bCompress ? FormatBC4 : FormatR8;
+		}
+
+		if (Info.bUsesAlpha)
+		{
+			return bCompress ? FormatBC3 : FormatRGBA8;
+		}
+		return bCompress ? FormatBC1 : FormatRGB8;
+	}
+
+	// Cores ficam em sRGB mesmo quando cinzas: no h formato sRGB de um canal no OpenGL 3.3
+	if (Info.bUsesAlpha)
+	{
+		return bCompress ? FormatBC3SRGB : FormatSRGB8Alpha8;
+	}
+	return bCompress ? FormatBC1SRGB : FormatSRGB8;
+}
+
+void ConvertTextureImage(TextureImage& Image, const TextureFormat& Format, ETextureUsage Usage)
+{
+	RepackComponents(Image, Format.NumberOfComponents);
+	Image.Format = Format;
+	Image.CompressedLevels.clear();
+
+	if (!Format.bCompressed)
+	{
+		return;
+	}
+
+	const bool bSRGB = Usage == ETextureUsage::Color;
+
+	std::vector<unsigned char> Level = std::move(Image.Pixels);
+	int LevelWidth = Image.Width;
+	int LevelHeight = Image.Height;
+
+	while (true)
+	{
+		Image.CompressedLevels.push_back(CompressLevel(Level, LevelWidth, LevelHeight, Format.NumberOfComponents, Format));
+
+		if (LevelWidth == 1 && LevelHeight == 1)
+		{
+			break;
+		}
+
+		Level = DownsampleLevel(Level, LevelWidth, LevelHeight, Format.NumberOfComponents, bSRGB, LevelWidth, LevelHeight);
+	}
+
+	// Os pixels descomprimidos no so mais necessrios, apenas os blocos de cada nvel
+	Image.Pixels.clear();
+	Image.Pixels.shrink_to_fit();
+}
+
+void GenerateMipmapLevels(TextureImage& Image, ETextureUsage Usage)
+{
+	assert(!Image.Format.bCompressed);
+
+	Image.MipmapLevels.clear();
+
+	const bool bSRGB = Usage == ETextureUsage::Color;
+	const std::vector<unsigned char>* Level = &Image.Pixels;
+	int LevelWidth = Image.Width;
+	int LevelHeight = Image.Height;
+
+	while (LevelWidth > 1 || LevelHeight > 1)
+	{
+		std::vector<unsigned char> NextLevel = DownsampleLevel(*Level, LevelWidth, LevelHeight, Image.NumberOfComponents, bSRGB,
+															   LevelWidth, LevelHeight);
+		Image.MipmapLevels.push_back(std::move(NextLevel));
+		Level = &Image.MipmapLevels.back();
+	}
+}
+
+size_t ComputeTextureMemory(const TextureFormat& Format, int Width, int Height, bool bMipmaps)
+{
+	size_t Total = 0;
+
+	while (true)
+	{
+		if (Format.bCompressed)
+		{
+			Total += static_cast<size_t>((Width + 3) / 4) * ((Height + 3) / 4) * Format.BlockBytes;
+		}
+		else
+		{
+			Total += static_cast<size_t>(Width) * Height * Format.NumberOfComponents;
+		}
+
+		if (!bMipmaps || (Width == 1 && Height == 1))
+		{
+			break;
+		}
+
+		Width = std::max(1, Width / 2);
+		Height = std::max(1, Height / 2);
+	}
+
+	return Total;
+}
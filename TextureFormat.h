@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+struct TextureImage;
+
+// Como o shader utiliza a textura: cores (albedo) so armazenadas em sRGB e convertidas para linear na amostragem,
+//	mscaras e dados (ex.: cobertura de nuvens) permanecem lineares
+enum class ETextureUsage
+{
+	Color,
+	Mask
+};
+
+// Formato da textura na GPU e o formato dos pixels em RAM que o alimenta
+struct TextureFormat
+{
+	GLenum InternalFormat = GL_RGB8;
+	GLenum PixelFormat = GL_RGB;
+	int NumberOfComponents = 3;
+	bool bCompressed = false;
+	int BlockBytes = 0; // Bytes por bloco 4x4 nos formatos comprimidos (BC1/BC4 = 8, BC3/BC5 = 16)
+	const char* Name = "RGB8";
+};
+
+// Resultado da anlise dos canais da imagem decodificada
+struct TextureChannelInfo
+{
+	int NumberOfComponents = 0; // Componentes presentes no arquivo
+	bool bGrayscale = false; // R, G e B iguais (dentro da tolerncia do JPEG)
+	bool bUsesAlpha = false; // Algum pixel com alpha diferente de 255
+	unsigned char MinValue[4] = { 255, 255, 255, 255 };
+	unsigned char MaxValue[4] = { 0, 0, 0, 0 };
+};
+
+struct TextureFormatOptions
+{
+	ETextureUsage Usage = ETextureUsage::Color;
+	bool bAllowCompression = false; // BC1/BC3/BC4/BC5, comprimidos na CPU com o stb_dxt
+
+	// Ignora a anlise dos canais e converte para ForcedFormat (ex.: todos os quadros de uma srie no mesmo formato)
+	bool bForceFormat = false;
+	TextureFormat ForcedFormat;
+};
+
+// Percorre os pixels para descobrir se a imagem  cinza, se usa alpha e qual a faixa dinmica de cada canal
+TextureChannelInfo AnalyzeTextureChannels(const TextureImage& Image);
+
+// Escolhe o menor formato que preserva a informao da imagem
+TextureFormat SelectTextureFormat(const TextureChannelInfo& Info, const TextureFormatOptions& Options);
+
+// Reorganiza os pixels para a quantidade de componentes do formato escolhido.
+// Nos formatos comprimidos tambm gera as mipmaps na CPU (o glGenerateMipmap no funciona com eles) e os blocos BC
+void ConvertTextureImage(TextureImage& Image, const TextureFormat& Format, ETextureUsage Usage);
+
+// Gera na CPU os nveis 1..n das mipmaps de uma imagem no comprimida (em Image.MipmapLevels), para quando o
+//	glGenerateMipmap seria caro demais (ex.: uma camada de um GL_TEXTURE_2D_ARRAY atualizada a cada quadro)
+void GenerateMipmapLevels(TextureImage& Image, ETextureUsage Usage);
+
+// Memria de vdeo ocupada pela textura, incluindo a cadeia de mipmaps
+size_t ComputeTextureMemory(const TextureFormat& Format, int Width, int Height, bool bMipmaps = true);
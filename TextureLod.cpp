@@ -0,0 +1,473 @@
+#include "TextureLod.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+#include <glm/ext.hpp>
+
+#include "Camera.h"
+#include "TextureResidency.h"
+
+TextureStreamer::TextureStreamer(int NumThreads)
+{
+	for (int ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+	{
+		Workers.emplace_back(&TextureStreamer::WorkerLoop, this);
+	}
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStop = true;
+	}
+	Condition.notify_all();
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+}
+
+void TextureStreamer::Request(const std::shared_ptr<TextureStreamRequest>& StreamRequest, EStreamPriority Priority)
+{
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		(Priority == EStreamPriority::High ? Queue : LowPriorityQueue).push_back(StreamRequest);
+	}
+	Condition.notify_one();
+}
+
+void TextureStreamer::Promote(const std::shared_ptr<TextureStreamRequest>& StreamRequest)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+
+	// Se a decodificao j comeou o pedido no est mais em nenhuma fila
+	auto Found = std::find(LowPriorityQueue.begin(), LowPriorityQueue.end(), StreamRequest);
+	if (Found != LowPriorityQueue.end())
+	{
+		LowPriorityQueue.erase(Found);
+		Queue.push_back(StreamRequest);
+	}
+}
+
+int TextureStreamer::GetThreadCount() const
+{
+	return static_cast<int>(Workers.size());
+}
+
+void TextureStreamer::SetCompletionCallback(std::function<void()> Callback)
+{
+	std::lock_guard<std::mutex> Lock(Mutex);
+	CompletionCallback = std::move(Callback);
+}
+
+void TextureStreamer::WorkerLoop()
+{
+	while (true)
+	{
+		std::shared_ptr<TextureStreamRequest> StreamRequest;
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			Condition.wait(Lock, [this] { return bStop || !Queue.empty() || !LowPriorityQueue.empty(); });
+
+			if (bStop)
+			{
+				return;
+			}
+
+			std::deque<std::shared_ptr<TextureStreamRequest>>& Source = !Queue.empty() ? Queue : LowPriorityQueue;
+			StreamRequest = Source.front();
+			Source.pop_front();
+		}
+
+		// Pedidos cancelados antes de comear no precisam ser decodificados
+		if (StreamRequest->bCancelled)
+		{
+			continue;
+		}
+
+		const auto DecodeStart = std::chrono::steady_clock::now();
+
+		bool bDecoded = StreamRequest->bCubeMap
+			? DecodeCubeMap(StreamRequest->File.c_str(), StreamRequest->Options, StreamRequest->CubeMapFilter, StreamRequest->Cube)
+			: DecodeTexture(StreamRequest->File.c_str(), StreamRequest->Options, StreamRequest->Image);
+
+		if (bDecoded && StreamRequest->bBuildMipmaps && !StreamRequest->bCubeMap && !StreamRequest->Image.Format.bCompressed)
+		{
+			GenerateMipmapLevels(StreamRequest->Image, StreamRequest->Options.Usage);
+		}
+
+		StreamRequest->DecodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - DecodeStart).count();
+
+		if (bDecoded)
+		{
+			StreamRequest->bReady = true;
+		}
+		else
+		{
+			StreamRequest->bFailed = true;
+		}
+
+		// Chamada com o lock: depois de SetCompletionCallback a funo anterior (e o que ela usa) no  mais chamada
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (CompletionCallback)
+		{
+			CompletionCallback();
+		}
+	}
+}
+
+StreamedTexture::StreamedTexture(const char* InName, const std::vector<std::string>& TierFiles, const TextureFormatOptions& InOptions)
+	: Name(InName)
+	, Options(InOptions)
+{
+	assert(!TierFiles.empty());
+
+	for (const std::string& File : TierFiles)
+	{
+		Tier NewTier;
+		NewTier.File = File;
+
+		// Apenas o cabealho  lido aqui: as dimenses so necessrias para escolher o nvel antes de carreg-lo
+		bool bHasSize = QueryTextureSize(File.c_str(), NewTier.Width, NewTier.Height);
+		assert(bHasSize);
+
+		Tiers.push_back(NewTier);
+	}
+
+	// Garante a ordem crescente de resoluo, independente da ordem recebida
+	std::stable_sort(Tiers.begin(), Tiers.end(), [](const Tier& A, const Tier& B) { return A.Width < B.Width; });
+}
+
+void StreamedTexture::LoadBaseTier()
+{
+	Tier& BaseTier = Tiers[0];
+	BaseTier.TextureId = bCubeMap ? LoadCubeMap(BaseTier.File.c_str(), Options, CubeMapFilter) : LoadTexture(BaseTier.File.c_str(), Options);
+	BaseTier.UploadedRows = BaseTier.Height;
+	BaseTier.bResident = true;
+	ActiveTier = 0;
+}
+
+int StreamedTexture::SelectTier(float RequiredWidth) const
+{
+	// Menor nvel que atende a largura exigida; se nenhum atender, o maior disponvel
+	int Desired = static_cast<int>(Tiers.size()) - 1;
+	for (int TierIndex = 0; TierIndex < static_cast<int>(Tiers.size()); ++TierIndex)
+	{
+		if (static_cast<float>(Tiers[TierIndex].Width) >= RequiredWidth)
+		{
+			Desired = TierIndex;
+			break;
+		}
+	}
+
+	// Histerese: evita ficar alternando entre dois nveis quando o zoom est prximo do limite
+	if (Desired < ActiveTier && RequiredWidth > Tiers[Desired].Width * DowngradeFactor)
+	{
+		Desired = ActiveTier;
+	}
+
+	return Desired;
+}
+
+void StreamedTexture::StreamTier(TextureStreamer& Streamer, int TierIndex, EStreamPriority Priority)
+{
+	Tier& Target = Tiers[TierIndex];
+
+	// Um prefetch ainda em andamento passou a ser necessrio para o frame atual
+	if (Priority == EStreamPriority::High && Target.bPrefetched && !Target.bPromoted && Target.Pending)
+	{
+		Target.bPromoted = true;
+		++Stats.PrefetchLate;
+		Streamer.Promote(Target.Pending);
+	}
+
+	if (!Target.Pending)
+	{
+		// O formato do nvel 0 serve de estimativa: s carrega se o nvel couber no oramento de memria de vdeo
+		int BaseWidth = 0;
+		int BaseHeight = 0;
+		TextureFormat BaseFormat;
+		GetTextureResidency().GetTextureInfo(Tiers[0].TextureId, BaseWidth, BaseHeight, BaseFormat);
+
+		if (!GetTextureResidency().HasHeadroom(EstimateTierMemory(Target, BaseFormat)))
+		{
+			if (!Target.bOverBudget)
+			{
+				std::cout << "Textura " << Name << ": " << Target.File << " no cabe no oramento de memria de vdeo" << std::endl;
+				Target.bOverBudget = true;
+			}
+			return;
+		}
+
+		Target.bOverBudget = false;
+		Target.bPrefetched = Priority == EStreamPriority::Low;
+		std::cout << "Textura " << Name << ": carregando em segundo plano " << Target.File
+				  << (Target.bPrefetched ? " (prefetch)" : "") << std::endl;
+
+		if (Target.bPrefetched)
+		{
+			++Stats.PrefetchRequests;
+		}
+
+		Target.Pending = std::make_shared<TextureStreamRequest>();
+		Target.Pending->File = Target.File;
+		Target.Pending->Options = Options;
+		Target.Pending->bCubeMap = bCubeMap;
+		Target.Pending->CubeMapFilter = CubeMapFilter;
+		Streamer.Request(Target.Pending, Priority);
+		return;
+	}
+
+	if (Target.Pending->bFailed)
+	{
+		std::cout << "Textura " << Name << ": erro ao carregar " << Target.File << std::endl;
+		Target.Pending.reset();
+		Target.File.clear(); // No tenta novamente a cada frame
+		return;
+	}
+
+	if (!Target.Pending->bReady)
+	{
+		return;
+	}
+
+	if (bCubeMap)
+	{
+		// Cube maps so copiados uma face por frame
+		const CubeMapImage& Cube = Target.Pending->Cube;
+		if (Target.TextureId == 0)
+		{
+			Target.TextureId = CreateCubeMapStorage(Cube);
+			Target.UploadedFaces = 0;
+		}
+
+		UploadCubeMapFace(Target.TextureId, Cube, Target.UploadedFaces);
+		++Target.UploadedFaces;
+
+		if (Target.UploadedFaces == 6)
+		{
+			FinalizeCubeMap(Target.TextureId, Cube);
+			Target.bResident = true;
+			Target.Pending.reset();
+		}
+		return;
+	}
+
+	// Cpia incremental para a GPU: RowsPerFrame linhas por frame para no travar o loop
+	const TextureImage& Image = Target.Pending->Image;
+	if (Target.TextureId == 0)
+	{
+		Target.TextureId = CreateTextureStorage(Image);
+		Target.UploadedRows = 0;
+	}
+
+	int NumRows = std::min(RowsPerFrame, Image.Height - Target.UploadedRows);
+	UploadTextureRows(Target.TextureId, Image, Target.UploadedRows, NumRows);
+	Target.UploadedRows += NumRows;
+
+	if (Target.UploadedRows == Image.Height)
+	{
+		FinalizeTexture(Target.TextureId, Image);
+		Target.bResident = true;
+		Target.Pending.reset(); // Libera a RAM da imagem decodificada
+	}
+}
+
+void StreamedTexture::EvictTier(int TierIndex)
+{
+	Tier& Target = Tiers[TierIndex];
+
+	// Prefetch que nunca chegou a ser usado: conta o que j foi decodificado ou copiado para a GPU
+	if (Target.bPrefetched && !Target.bUsed && (Target.TextureId != 0 || (Target.Pending && Target.Pending->bReady)))
+	{
+		TextureFormat BaseFormat;
+		int BaseWidth = 0;
+		int BaseHeight = 0;
+		GetTextureResidency().GetTextureInfo(Tiers[0].TextureId, BaseWidth, BaseHeight, BaseFormat);
+		Stats.WastedBytes += EstimateTierMemory(Target, BaseFormat);
+	}
+	Target.bPrefetched = false;
+	Target.bPromoted = false;
+	Target.bUsed = false;
+
+	if (Target.Pending)
+	{
+		Target.Pending->bCancelled = true;
+		Target.Pending.reset();
+	}
+
+	if (Target.TextureId != 0)
+	{
+		if (Target.bResident)
+		{
+			std::cout << "Textura " << Name << ": descartando " << Target.Width << "x" << Target.Height << std::endl;
+		}
+
+		ReleaseTexture(Target.TextureId);
+	}
+
+	Target.UploadedRows = 0;
+	Target.UploadedFaces = 0;
+	Target.bResident = false;
+}
+
+size_t StreamedTexture::EstimateTierMemory(const Tier& Target, const TextureFormat& Format) const
+{
+	if (bCubeMap)
+	{
+		int FaceSize = ComputeCubeFaceSize(Target.Width, Target.Height);
+		return 6 * ComputeTextureMemory(Format, FaceSize, FaceSize);
+	}
+
+	return ComputeTextureMemory(Format, Target.Width, Target.Height);
+}
+
+void StreamedTexture::ActivateTier(int TierIndex)
+{
+	Tier& Target = Tiers[TierIndex];
+	std::cout << "Textura " << Name << ": usando " << Target.Width << "x" << Target.Height << std::endl;
+
+	if (Target.bPrefetched && !Target.bPromoted && !Target.bUsed)
+	{
+		++Stats.PrefetchHits;
+	}
+	Target.bUsed = true;
+	ActiveTier = TierIndex;
+}
+
+void StreamedTexture::Update(TextureStreamer& Streamer, float RequiredWidth, float PredictedWidth)
+{
+	// Se o gerenciador de residncia reduziu o nvel ativo e agora h espao para ele completo, volta para o nvel 0
+	//	enquanto o nvel  carregado novamente
+	if (ActiveTier > 0 && GetTextureResidency().GetTopLevel(Tiers[ActiveTier].TextureId) > 0)
+	{
+		int Width = 0;
+		int Height = 0;
+		TextureFormat Format;
+		GetTextureResidency().GetTextureInfo(Tiers[ActiveTier].TextureId, Width, Height, Format);
+
+		size_t FullBytes = GetTextureResidency().GetFaceCount(Tiers[ActiveTier].TextureId) * ComputeTextureMemory(Format, Width, Height);
+		if (GetTextureResidency().HasHeadroom(FullBytes))
+		{
+			EvictTier(ActiveTier);
+			ActiveTier = 0;
+		}
+	}
+
+	int Desired = SelectTier(RequiredWidth);
+
+	// Nvel que a cmera vai precisar em breve, se for maior que o atual
+	int Prefetch = -1;
+	if (PredictedWidth > RequiredWidth)
+	{
+		int Predicted = SelectTier(PredictedWidth);
+		if (Predicted > Desired)
+		{
+			Prefetch = Predicted;
+		}
+	}
+
+	// S um nvel  transmitido por vez: primeiro o que falta para o frame atual, depois o prefetch
+	if (!Tiers[Desired].bResident && !Tiers[Desired].File.empty())
+	{
+		StreamTier(Streamer, Desired, EStreamPriority::High);
+	}
+	else if (Prefetch >= 0 && !Tiers[Prefetch].bResident && !Tiers[Prefetch].File.empty())
+	{
+		StreamTier(Streamer, Prefetch, EStreamPriority::Low);
+	}
+
+	if (Tiers[Desired].bResident && Desired != ActiveTier)
+	{
+		ActivateTier(Desired);
+	}
+
+	if (Desired > ActiveTier)
+	{
+		++Stats.MissFrames;
+	}
+
+	// O nvel 0, o ativo e o do prefetch permanecem; os demais (inclusive carregamentos que perderam o sentido) so
+	//	descartados, assim a memria de vdeo acompanha o que est (ou logo estar) na tela
+	for (int TierIndex = 1; TierIndex < static_cast<int>(Tiers.size()); ++TierIndex)
+	{
+		if (TierIndex != ActiveTier && TierIndex != Desired && TierIndex != Prefetch)
+		{
+			EvictTier(TierIndex);
+		}
+	}
+}
+
+void StreamedTexture::Release()
+{
+	for (int TierIndex = 0; TierIndex < static_cast<int>(Tiers.size()); ++TierIndex)
+	{
+		EvictTier(TierIndex);
+	}
+}
+
+GLuint StreamedTexture::GetTextureId() const
+{
+	return Tiers[ActiveTier].TextureId;
+}
+
+const std::string& StreamedTexture::GetName() const
+{
+	return Name;
+}
+
+const TextureStreamStats& StreamedTexture::GetStats() const
+{
+	return Stats;
+}
+
+bool StreamedTexture::IsStreaming() const
+{
+	for (const Tier& CurrentTier : Tiers)
+	{
+		if (CurrentTier.Pending)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool StreamedTexture::HasPendingUpload() const
+{
+	for (const Tier& CurrentTier : Tiers)
+	{
+		if (CurrentTier.Pending && (CurrentTier.Pending->bReady || CurrentTier.Pending->bFailed))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+float ComputeProjectedDiameter(const SimpleCamera& Camera, const glm::vec3& Center, float Radius, int ViewportHeight)
+{
+	float Distance = glm::length(Camera.Location - Center);
+
+	// Com a cmera dentro da esfera qualquer resoluo  pouca
+	if (Distance <= Radius)
+	{
+		return std::numeric_limits<float>::max();
+	}
+
+	// Raio angular da esfera vista da cmera, convertido para pixels pela projeo perspectiva
+	float AngularRadius = glm::asin(Radius / Distance);
+	float PixelsPerUnit = (ViewportHeight * 0.5f) / glm::tan(Camera.FieldOfView * 0.5f);
+	return 2.0f * glm::tan(AngularRadius) * PixelsPerUnit;
+}
+
+float ComputeRequiredTextureWidth(float ProjectedDiameter)
+{
+	return glm::pi<float>() * ProjectedDiameter;
+}
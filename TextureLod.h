@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "CubeMap.h"
+#include "Texture.h"
+
+class SimpleCamera;
+
+// Pedido de decodificao de um nvel de textura, compartilhado entre a thread principal e a de streaming
+struct TextureStreamRequest
+{
+	std::string File;
+	TextureFormatOptions Options;
+	TextureImage Image;
+	bool bCubeMap = false; // Reprojeta a imagem em Cube, em vez de Image
+	ECubeMapFilter CubeMapFilter = ECubeMapFilter::Bilinear;
+	CubeMapImage Cube;
+	bool bBuildMipmaps = false; // Gera as mipmaps na CPU (Image.MipmapLevels) nas imagens no comprimidas
+	double DecodeSeconds = 0.0; // Tempo gasto pela thread de streaming, vlido quando bReady
+	std::atomic<bool> bReady{ false };
+	std::atomic<bool> bFailed{ false };
+	std::atomic<bool> bCancelled{ false };
+};
+
+// Pedidos de alta prioridade (o que falta para o frame atual) passam na frente dos de baixa (prefetch)
+enum class EStreamPriority
+{
+	High,
+	Low
+};
+
+// Threads de fundo que decodificam as imagens dos nveis mais altos sem bloquear o loop de renderizao
+// (a cpia para a GPU continua na thread do contexto OpenGL, em StreamedTexture::Update)
+class TextureStreamer
+{
+public:
+	explicit TextureStreamer(int NumThreads = 1);
+	~TextureStreamer();
+
+	void Request(const std::shared_ptr<TextureStreamRequest>& StreamRequest, EStreamPriority Priority = EStreamPriority::High);
+
+	// Move para a fila de alta prioridade um pedido de prefetch que passou a ser necessrio no frame atual
+	void Promote(const std::shared_ptr<TextureStreamRequest>& StreamRequest);
+
+	int GetThreadCount() const;
+
+	// Chamada na thread de streaming a cada pedido que termina (decodificado ou com erro), para acordar quem espera a
+	//	imagem sem consultar a cada frame (ex.: WakeSignal::Notify, glfwPostEmptyEvent). Uma funo vazia deixa de avisar
+	void SetCompletionCallback(std::function<void()> Callback);
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> Workers;
+	std::mutex Mutex;
+	std::condition_variable Condition;
+	std::deque<std::shared_ptr<TextureStreamRequest>> Queue;
+	std::deque<std::shared_ptr<TextureStreamRequest>> LowPriorityQueue;
+	std::function<void()> CompletionCallback;
+	bool bStop = false;
+};
+
+// Contadores do streaming de uma textura, para avaliar o prefetch
+struct TextureStreamStats
+{
+	uint64_t MissFrames = 0; // Frames exibidos com um nvel de resoluo abaixo do necessrio
+	uint64_t PrefetchRequests = 0;
+	uint64_t PrefetchHits = 0; // Nveis pedidos por prefetch que j estavam na GPU quando passaram a ser necessrios
+	uint64_t PrefetchLate = 0; // Ainda carregando quando passaram a ser necessrios (promovidos para alta prioridade)
+	size_t WastedBytes = 0; // Nveis pedidos por prefetch e descartados sem nunca terem sido usados
+};
+
+// Textura com vrios nveis de resoluo (do menor para o maior)
+// O nvel 0 fica sempre residente; os demais so carregados sob demanda e descartados quando deixam de ser necessrios
+class StreamedTexture
+{
+public:
+	StreamedTexture(const char* InName, const std::vector<std::string>& TierFiles, const TextureFormatOptions& InOptions);
+
+	// Carrega o nvel de menor resoluo de forma sncrona, garantindo um primeiro frame rpido
+	void LoadBaseTier();
+
+	// Escolhe o nvel adequado para a largura de textura exigida pela tela, dispara o streaming,
+	//	copia para a GPU uma faixa de linhas por frame e descarta os nveis que no so mais usados.
+	// PredictedWidth  a largura exigida num futuro prximo (PrefetchScheduler): se pedir um nvel maior, ele 
+	//	carregado com baixa prioridade, depois do que falta para o frame atual
+	void Update(TextureStreamer& Streamer, float RequiredWidth, float PredictedWidth = 0.0f);
+
+	void Release();
+
+	GLuint GetTextureId() const;
+	const std::string& GetName() const;
+	const TextureStreamStats& GetStats() const;
+
+	// Algum nvel est sendo decodificado ou copiado para a GPU: os prximos Update ainda mudam a textura
+	bool IsStreaming() const;
+
+	// Algum nvel j decodificado espera a cpia para a GPU (ou o erro ainda no foi tratado): o prximo Update muda a
+	//	textura. Enquanto a decodificao no termina, nada muda e no h motivo para desenhar de novo
+	bool HasPendingUpload() const;
+
+	// Linhas copiadas para a GPU por frame durante a troca de nvel (limita o custo de cada frame)
+	int RowsPerFrame = 256;
+
+	// S desce de nvel quando a largura exigida for menor que essa frao do nvel inferior (histerese)
+	float DowngradeFactor = 0.8f;
+
+	// Carrega cada nvel como cube map (GL_TEXTURE_CUBE_MAP), copiando uma face por frame. Deve ser definido antes de LoadBaseTier
+	bool bCubeMap = false;
+	ECubeMapFilter CubeMapFilter = ECubeMapFilter::Bilinear;
+
+private:
+	struct Tier
+	{
+		std::string File;
+		int Width = 0;
+		int Height = 0;
+		GLuint TextureId = 0;
+		int UploadedRows = 0;
+		int UploadedFaces = 0;
+		bool bResident = false;
+		bool bOverBudget = false;
+		bool bPrefetched = false; // Pedido por prefetch (baixa prioridade)
+		bool bPromoted = false; // Pedido por prefetch que virou alta prioridade antes de ficar pronto
+		bool bUsed = false;
+		std::shared_ptr<TextureStreamRequest> Pending;
+	};
+
+	int SelectTier(float RequiredWidth) const;
+	void StreamTier(TextureStreamer& Streamer, int TierIndex, EStreamPriority Priority);
+	void ActivateTier(int TierIndex);
+	void EvictTier(int TierIndex);
+	size_t EstimateTierMemory(const Tier& Target, const TextureFormat& Format) const;
+
+	std::string Name;
+	TextureFormatOptions Options;
+	std::vector<Tier> Tiers;
+	int ActiveTier = 0;
+	TextureStreamStats Stats;
+};
+
+// Dimetro, em pixels, da projeo de uma esfera na tela
+float ComputeProjectedDiameter(const SimpleCamera& Camera, const glm::vec3& Center, float Radius, int ViewportHeight);
+
+// Largura mnima de uma textura equiretangular para manter ao menos um texel por pixel no centro do globo
+// (o equador visvel cobre metade da textura ao longo do dimetro projetado, logo Largura = Pi * Dimetro)
+float ComputeRequiredTextureWidth(float ProjectedDiameter);
@@ -0,0 +1,471 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "GLStateCache.h"
+
+namespace
+{
+	int GetLevelSize(int Size, int Level)
+	{
+		return std::max(1, Size >> Level);
+	}
+
+	int ComputeLevelCount(int Width, int Height)
+	{
+		int LevelCount = 1;
+		while (Width > 1 || Height > 1)
+		{
+			Width = std::max(1, Width / 2);
+			Height = std::max(1, Height / 2);
+			++LevelCount;
+		}
+		return LevelCount;
+	}
+
+	double ToMegabytes(size_t Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+
+	const char* GetActionName(EResidencyAction Action)
+	{
+		return Action == EResidencyAction::DropLevels ? "drop" : "evict";
+	}
+
+	void WriteDecision(std::ostream& Output, const ResidencyDecision& Decision)
+	{
+		Output << GetActionName(Decision.Action) << " " << Decision.TextureId << " " << Decision.PreviousTopLevel << " "
+			   << Decision.TopLevel << " " << Decision.BytesBefore << " " << Decision.BytesAfter << "\n";
+	}
+}
+
+bool operator==(const ResidencyDecision& A, const ResidencyDecision& B)
+{
+	return A.Action == B.Action && A.TextureId == B.TextureId && A.PreviousTopLevel == B.PreviousTopLevel &&
+		   A.TopLevel == B.TopLevel && A.BytesBefore == B.BytesBefore && A.BytesAfter == B.BytesAfter;
+}
+
+void TextureResidencyManager::SetBudget(size_t Bytes)
+{
+	Budget = Bytes;
+
+	if (Log)
+	{
+		*Log << "budget " << Budget << "\n";
+	}
+}
+
+size_t TextureResidencyManager::GetBudget() const
+{
+	return Budget;
+}
+
+void TextureResidencyManager::BeginFrame(uint64_t Frame)
+{
+	CurrentFrame = Frame;
+
+	if (Log)
+	{
+		*Log << "frame " << Frame << "\n";
+	}
+}
+
+void TextureResidencyManager::Register(GLuint TextureId, const std::string& Name, int Width, int Height, const TextureFormat& Format, int Faces)
+{
+	Unregister(TextureId);
+
+	Entry& Texture = Entries[TextureId];
+	Texture.Name = Name;
+	Texture.Width = Width;
+	Texture.Height = Height;
+	Texture.Format = Format;
+	Texture.Faces = Faces;
+	Texture.LevelCount = ComputeLevelCount(Width, Height);
+	Texture.TopLevel = 0;
+	Texture.LastUsedFrame = CurrentFrame;
+	Texture.Bytes = ComputeBytes(Texture, 0);
+
+	ResidentBytes += Texture.Bytes;
+
+	if (Log)
+	{
+		// Espaos no nome quebrariam o parser do replay
+		std::string LogName = Name.empty() ? std::string("-") : Name;
+		std::replace(LogName.begin(), LogName.end(), ' ', '_');
+
+		*Log << "register " << TextureId << " " << LogName << " " << Width << " " << Height << " "
+			 << Format.NumberOfComponents << " " << Format.bCompressed << " " << Format.BlockBytes << " " << Faces << "\n";
+	}
+}
+
+void TextureResidencyManager::Unregister(GLuint TextureId)
+{
+	auto Found = Entries.find(TextureId);
+	if (Found == Entries.end())
+	{
+		return;
+	}
+
+	ResidentBytes -= Found->second.Bytes;
+	Entries.erase(Found);
+
+	if (Log)
+	{
+		*Log << "unregister " << TextureId << "\n";
+	}
+}
+
+void TextureResidencyManager::Touch(GLuint TextureId)
+{
+	auto Found = Entries.find(TextureId);
+	if (Found == Entries.end() || Found->second.LastUsedFrame == CurrentFrame)
+	{
+		return;
+	}
+
+	Found->second.LastUsedFrame = CurrentFrame;
+
+	if (Log)
+	{
+		*Log << "touch " << TextureId << "\n";
+	}
+}
+
+size_t TextureResidencyManager::ComputeBytes(const Entry& Texture, int TopLevel) const
+{
+	return Texture.Faces * ComputeTextureMemory(Texture.Format, GetLevelSize(Texture.Width, TopLevel), GetLevelSize(Texture.Height, TopLevel));
+}
+
+ResidencyDecision TextureResidencyManager::Apply(GLuint TextureId, Entry& Texture, EResidencyAction Action, int TopLevel)
+{
+	ResidencyDecision Decision;
+	Decision.Action = Action;
+	Decision.TextureId = TextureId;
+	Decision.PreviousTopLevel = Texture.TopLevel;
+	Decision.TopLevel = TopLevel;
+	Decision.BytesBefore = Texture.Bytes;
+	Decision.BytesAfter = ComputeBytes(Texture, TopLevel);
+
+	ResidentBytes = ResidentBytes - Decision.BytesBefore + Decision.BytesAfter;
+	Texture.TopLevel = TopLevel;
+	Texture.Bytes = Decision.BytesAfter;
+
+	if (Log)
+	{
+		WriteDecision(*Log, Decision);
+	}
+
+	return Decision;
+}
+
+std::vector<ResidencyDecision> TextureResidencyManager::Update()
+{
+	if (Log)
+	{
+		*Log << "update\n";
+	}
+
+	std::vector<ResidencyDecision> Decisions;
+	if (ResidentBytes <= Budget)
+	{
+		return Decisions;
+	}
+
+	// Ordem LRU: as texturas usadas h mais tempo primeiro (empate resolvido pelo identificador)
+	std::vector<std::pair<GLuint, Entry*>> Candidates;
+	for (auto& Item : Entries)
+	{
+		Candidates.emplace_back(Item.first, &Item.second);
+	}
+	std::stable_sort(Candidates.begin(), Candidates.end(), [](const auto& A, const auto& B)
+	{
+		return A.second->LastUsedFrame < B.second->LastUsedFrame;
+	});
+
+	// 1 etapa: descarta um nvel superior por textura, mantendo verses reduzidas at FallbackSize
+	for (auto& Candidate : Candidates)
+	{
+		if (ResidentBytes <= Budget || static_cast<int>(Decisions.size()) >= MaxActionsPerFrame)
+		{
+			return Decisions;
+		}
+
+		Entry& Texture = *Candidate.second;
+		int NextLevel = Texture.TopLevel + 1;
+		if (NextLevel < Texture.LevelCount &&
+			std::max(GetLevelSize(Texture.Width, NextLevel), GetLevelSize(Texture.Height, NextLevel)) >= FallbackSize)
+		{
+			Decisions.push_back(Apply(Candidate.first, Texture, EResidencyAction::DropLevels, NextLevel));
+		}
+	}
+
+	// 2 etapa: sem mais nveis para descartar, despeja texturas inteiras que no foram usadas neste frame
+	for (auto& Candidate : Candidates)
+	{
+		if (ResidentBytes <= Budget || static_cast<int>(Decisions.size()) >= MaxActionsPerFrame)
+		{
+			return Decisions;
+		}
+
+		Entry& Texture = *Candidate.second;
+		if (Texture.LastUsedFrame != CurrentFrame && Texture.TopLevel < Texture.LevelCount - 1)
+		{
+			Decisions.push_back(Apply(Candidate.first, Texture, EResidencyAction::Evict, Texture.LevelCount - 1));
+		}
+	}
+
+	return Decisions;
+}
+
+size_t TextureResidencyManager::GetResidentBytes() const
+{
+	return ResidentBytes;
+}
+
+bool TextureResidencyManager::HasHeadroom(size_t Bytes) const
+{
+	return ResidentBytes + Bytes <= Budget;
+}
+
+int TextureResidencyManager::GetTopLevel(GLuint TextureId) const
+{
+	auto Found = Entries.find(TextureId);
+	return Found != Entries.end() ? Found->second.TopLevel : -1;
+}
+
+bool TextureResidencyManager::GetTextureInfo(GLuint TextureId, int& Width, int& Height, TextureFormat& Format) const
+{
+	auto Found = Entries.find(TextureId);
+	if (Found == Entries.end())
+	{
+		return false;
+	}
+
+	Width = Found->second.Width;
+	Height = Found->second.Height;
+	Format = Found->second.Format;
+	return true;
+}
+
+int TextureResidencyManager::GetFaceCount(GLuint TextureId) const
+{
+	auto Found = Entries.find(TextureId);
+	return Found != Entries.end() ? Found->second.Faces : 0;
+}
+
+void TextureResidencyManager::PrintReport(std::ostream& Output) const
+{
+	Output << std::fixed << std::setprecision(1)
+		   << "Residncia de texturas: " << ToMegabytes(ResidentBytes) << " MB de " << ToMegabytes(Budget) << " MB" << std::endl;
+
+	for (const auto& Item : Entries)
+	{
+		const Entry& Texture = Item.second;
+		Output << "  " << Texture.Name << " (" << Texture.Width << "x" << Texture.Height << (Texture.Faces == 6 ? " x6, " : ", ")
+			   << Texture.Format.Name << "): " << ToMegabytes(Texture.Bytes) << " MB";
+
+		if (Texture.TopLevel > 0)
+		{
+			Output << ", reduzida para " << GetLevelSize(Texture.Width, Texture.TopLevel) << "x"
+				   << GetLevelSize(Texture.Height, Texture.TopLevel);
+		}
+		Output << std::endl;
+	}
+
+	Output << std::defaultfloat;
+}
+
+void TextureResidencyManager::SetLog(std::ostream* InLog)
+{
+	Log = InLog;
+}
+
+TextureResidencyManager& GetTextureResidency()
+{
+	static TextureResidencyManager Manager;
+	return Manager;
+}
+
+void ApplyResidencyDecision(const ResidencyDecision& Decision)
+{
+	int Width = 0;
+	int Height = 0;
+	TextureFormat Format;
+	if (!GetTextureResidency().GetTextureInfo(Decision.TextureId, Width, Height, Format))
+	{
+		return;
+	}
+
+	static const bool bCanCopyImages = GLEW_ARB_copy_image && GLEW_ARB_texture_storage;
+
+	// Nos cube maps as seis faces so tratadas como camadas pelo glCopyImageSubData
+	const int Faces = GetTextureResidency().GetFaceCount(Decision.TextureId);
+	const GLenum Target = Faces == 6 ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+
+	GetGLStateCache().BindTextureForUpdate(Target, Decision.TextureId);
+
+	if (!bCanCopyImages)
+	{
+		// Sem cpia na GPU os nveis continuam alocados; o nvel base apenas deixa de ser amostrado
+		glTexParameteri(Target, GL_TEXTURE_BASE_LEVEL, Decision.TopLevel);
+		return;
+	}
+
+	// Os nveis j descartados no existem mais na textura: o nvel 0 atual corresponde a PreviousTopLevel
+	const int Offset = Decision.TopLevel - Decision.PreviousTopLevel;
+	const int PreviousLevelCount = ComputeLevelCount(GetLevelSize(Width, Decision.PreviousTopLevel), GetLevelSize(Height, Decision.PreviousTopLevel));
+	const int LevelCount = PreviousLevelCount - Offset;
+
+	// 1) Copia os nveis mantidos para uma textura temporria (cpia GPU -> GPU, sem sincronizar com a CPU)
+	GLuint TemporaryId;
+	glGenTextures(1, &TemporaryId);
+	GetGLStateCache().BindTextureForUpdate(Target, TemporaryId);
+	glTexStorage2D(Target, LevelCount, Format.InternalFormat, GetLevelSize(Width, Decision.TopLevel), GetLevelSize(Height, Decision.TopLevel));
+
+	for (int Level = 0; Level < LevelCount; ++Level)
+	{
+		int LevelWidth = GetLevelSize(Width, Decision.TopLevel + Level);
+		int LevelHeight = GetLevelSize(Height, Decision.TopLevel + Level);
+		glCopyImageSubData(Decision.TextureId, Target, Level + Offset, 0, 0, 0,
+						   TemporaryId, Target, Level, 0, 0, 0, LevelWidth, LevelHeight, Faces);
+	}
+
+	// 2) Redefine a textura original com as dimenses reduzidas (o identificador continua o mesmo para quem o usa)
+	GetGLStateCache().BindTextureForUpdate(Target, Decision.TextureId);
+	for (int Level = 0; Level < PreviousLevelCount; ++Level)
+	{
+		// Os nveis que sobram no fim da cadeia so redefinidos como 0x0, liberando a memria
+		int LevelWidth = Level < LevelCount ? GetLevelSize(Width, Decision.TopLevel + Level) : 0;
+		int LevelHeight = Level < LevelCount ? GetLevelSize(Height, Decision.TopLevel + Level) : 0;
+
+		for (int Face = 0; Face < Faces; ++Face)
+		{
+			GLenum ImageTarget = Faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face : GL_TEXTURE_2D;
+
+			if (Format.bCompressed)
+			{
+				GLsizei ImageSize = ((LevelWidth + 3) / 4) * ((LevelHeight + 3) / 4) * Format.BlockBytes;
+				glCompressedTexImage2D(ImageTarget, Level, Format.InternalFormat, LevelWidth, LevelHeight, 0, ImageSize, nullptr);
+			}
+			else
+			{
+				glTexImage2D(ImageTarget, Level, Format.InternalFormat, LevelWidth, LevelHeight, 0, Format.PixelFormat,
+							 GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+	}
+	glTexParameteri(Target, GL_TEXTURE_MAX_LEVEL, LevelCount - 1);
+
+	// 3) Copia de volta e libera a temporria
+	for (int Level = 0; Level < LevelCount; ++Level)
+	{
+		int LevelWidth = GetLevelSize(Width, Decision.TopLevel + Level);
+		int LevelHeight = GetLevelSize(Height, Decision.TopLevel + Level);
+		glCopyImageSubData(TemporaryId, Target, Level, 0, 0, 0,
+						   Decision.TextureId, Target, Level, 0, 0, 0, LevelWidth, LevelHeight, Faces);
+	}
+
+	GetGLStateCache().OnTextureDeleted(TemporaryId);
+	glDeleteTextures(1, &TemporaryId);
+}
+
+bool ReplayResidencyLog(std::istream& Log, std::ostream& Report)
+{
+	TextureResidencyManager Manager;
+
+	std::vector<std::string> Lines;
+	for (std::string Line; std::getline(Log, Line);)
+	{
+		if (!Line.empty())
+		{
+			Lines.push_back(Line);
+		}
+	}
+
+	size_t NumUpdates = 0;
+	size_t NumDecisions = 0;
+	size_t NumMismatches = 0;
+
+	for (size_t LineIndex = 0; LineIndex < Lines.size(); ++LineIndex)
+	{
+		std::istringstream Stream(Lines[LineIndex]);
+		std::string Command;
+		Stream >> Command;
+
+		if (Command == "budget")
+		{
+			size_t Bytes = 0;
+			Stream >> Bytes;
+			Manager.SetBudget(Bytes);
+		}
+		else if (Command == "frame")
+		{
+			uint64_t Frame = 0;
+			Stream >> Frame;
+			Manager.BeginFrame(Frame);
+		}
+		else if (Command == "register")
+		{
+			GLuint TextureId = 0;
+			std::string Name;
+			int Width = 0;
+			int Height = 0;
+			TextureFormat Format;
+			int Faces = 1;
+			Stream >> TextureId >> Name >> Width >> Height >> Format.NumberOfComponents >> Format.bCompressed >> Format.BlockBytes >> Faces;
+			Manager.Register(TextureId, Name, Width, Height, Format, Faces);
+		}
+		else if (Command == "unregister" || Command == "touch")
+		{
+			GLuint TextureId = 0;
+			Stream >> TextureId;
+			Command == "touch" ? Manager.Touch(TextureId) : Manager.Unregister(TextureId);
+		}
+		else if (Command == "update")
+		{
+			++NumUpdates;
+
+			// As decises gravadas so as linhas drop/evict que seguem o update
+			std::vector<ResidencyDecision> Recorded;
+			while (LineIndex + 1 < Lines.size() && (Lines[LineIndex + 1].rfind("drop ", 0) == 0 || Lines[LineIndex + 1].rfind("evict ", 0) == 0))
+			{
+				std::istringstream DecisionStream(Lines[++LineIndex]);
+				std::string Action;
+				ResidencyDecision Decision;
+				DecisionStream >> Action >> Decision.TextureId >> Decision.PreviousTopLevel >> Decision.TopLevel
+							   >> Decision.BytesBefore >> Decision.BytesAfter;
+				Decision.Action = Action == "drop" ? EResidencyAction::DropLevels : EResidencyAction::Evict;
+				Recorded.push_back(Decision);
+			}
+
+			std::vector<ResidencyDecision> Replayed = Manager.Update();
+			NumDecisions += Replayed.size();
+
+			if (Replayed != Recorded)
+			{
+				++NumMismatches;
+				Report << "Divergncia no update " << NumUpdates << " (linha " << LineIndex + 1 << "): gravadas "
+					   << Recorded.size() << " decises, reproduzidas " << Replayed.size() << std::endl;
+				for (const ResidencyDecision& Decision : Replayed)
+				{
+					Report << "  reproduzida: ";
+					WriteDecision(Report, Decision);
+				}
+			}
+		}
+		else
+		{
+			Report << "Linha ignorada: " << Lines[LineIndex] << std::endl;
+		}
+	}
+
+	Report << "Replay de residncia: " << NumUpdates << " updates, " << NumDecisions << " decises, "
+		   << NumMismatches << " divergncias" << std::endl;
+	Manager.PrintReport(Report);
+
+	return NumMismatches == 0;
+}
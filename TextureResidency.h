@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "TextureFormat.h"
+
+enum class EResidencyAction
+{
+	DropLevels, // Descarta os nveis superiores da mipmap, mantendo uma verso reduzida (a partir de TopLevel)
+	Evict // Descarta a textura inteira, restando apenas o ltimo nvel (1x1, a cor mdia) como fallback
+};
+
+// Deciso do gerenciador: a textura passa a conter apenas os nveis [TopLevel, ltimo]
+struct ResidencyDecision
+{
+	EResidencyAction Action = EResidencyAction::DropLevels;
+	GLuint TextureId = 0;
+	int PreviousTopLevel = 0;
+	int TopLevel = 0;
+	size_t BytesBefore = 0;
+	size_t BytesAfter = 0;
+};
+
+bool operator==(const ResidencyDecision& A, const ResidencyDecision& B);
+
+// Contabiliza a memria de vdeo de todas as texturas (com a cadeia de mipmaps) e decide o que descartar quando o
+//	oramento  ultrapassado: primeiro os nveis superiores das texturas usadas h mais tempo (LRU), depois texturas
+//	inteiras. No usa o OpenGL, de modo que o log gerado pode ser reproduzido sem GPU (ReplayResidencyLog)
+class TextureResidencyManager
+{
+public:
+	void SetBudget(size_t Bytes);
+	size_t GetBudget() const;
+
+	void BeginFrame(uint64_t Frame);
+
+	// Faces = 6 para cube maps (Width e Height so as dimenses de cada face)
+	void Register(GLuint TextureId, const std::string& Name, int Width, int Height, const TextureFormat& Format, int Faces = 1);
+	void Unregister(GLuint TextureId);
+
+	// Marca a textura como utilizada no frame atual
+	void Touch(GLuint TextureId);
+
+	// Decide o que descartar neste frame. No mximo MaxActionsPerFrame decises, para que aplic-las nunca trave o frame
+	std::vector<ResidencyDecision> Update();
+
+	size_t GetResidentBytes() const;
+
+	// Verdadeiro se Bytes adicionais cabem no oramento (usado antes de carregar nveis de resoluo maiores)
+	bool HasHeadroom(size_t Bytes) const;
+
+	// Primeiro nvel residente da textura (0 = completa), ou -1 se ela no  gerenciada
+	int GetTopLevel(GLuint TextureId) const;
+
+	bool GetTextureInfo(GLuint TextureId, int& Width, int& Height, TextureFormat& Format) const;
+	int GetFaceCount(GLuint TextureId) const;
+
+	void PrintReport(std::ostream& Output) const;
+
+	// Todas as entradas e decises so escritas no log, uma por linha
+	void SetLog(std::ostream* InLog);
+
+	int MaxActionsPerFrame = 2;
+
+	// Maior lado mnimo mantido ao descartar nveis superiores; abaixo disso a textura s sai por despejo completo
+	int FallbackSize = 256;
+
+private:
+	struct Entry
+	{
+		std::string Name;
+		int Width = 0;
+		int Height = 0;
+		TextureFormat Format;
+		int Faces = 1;
+		int LevelCount = 1;
+		int TopLevel = 0;
+		uint64_t LastUsedFrame = 0;
+		size_t Bytes = 0;
+	};
+
+	size_t ComputeBytes(const Entry& Texture, int TopLevel) const;
+	ResidencyDecision Apply(GLuint TextureId, Entry& Texture, EResidencyAction Action, int TopLevel);
+
+	// Mapa ordenado pelo identificador: mesma ordem de iterao em qualquer execuo, o que torna o log reproduzvel
+	std::map<GLuint, Entry> Entries;
+	size_t Budget = 512u * 1024u * 1024u;
+	size_t ResidentBytes = 0;
+	uint64_t CurrentFrame = 0;
+	std::ostream* Log = nullptr;
+};
+
+// Gerenciador global das texturas carregadas (acessado apenas pela thread do contexto OpenGL)
+TextureResidencyManager& GetTextureResidency();
+
+// Aplica a deciso na GPU. Com ARB_copy_image os nveis mantidos so copiados na prpria GPU e a memria  realmente
+//	liberada; sem a extenso, apenas o GL_TEXTURE_BASE_LEVEL  ajustado (o driver decide se libera a memria)
+void ApplyResidencyDecision(const ResidencyDecision& Decision);
+
+// Reexecuta um log do gerenciador sem GPU, conferindo se as decises reproduzidas so as mesmas que foram gravadas
+bool ReplayResidencyLog(std::istream& Log, std::ostream& Report);
@@ -0,0 +1,487 @@
+#include "TimeSeriesLayer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "GLStateCache.h"
+
+namespace
+{
+	double ToMegabytes(size_t Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+
+	size_t ComputeLevelBytes(const TextureFormat& Format, int Width, int Height)
+	{
+		return ComputeTextureMemory(Format, Width, Height, false);
+	}
+}
+
+bool LoadTimeSeriesManifest(const char* ManifestFile, std::vector<TimeSeriesFrame>& Frames)
+{
+	std::ifstream Manifest{ ManifestFile };
+	if (!Manifest)
+	{
+		std::cout << "Erro ao abrir o manifesto da srie " << ManifestFile << std::endl;
+		return false;
+	}
+
+	const std::filesystem::path ManifestFolder = std::filesystem::path{ ManifestFile }.parent_path();
+
+	std::string Line;
+	while (std::getline(Manifest, Line))
+	{
+		std::istringstream Fields{ Line };
+
+		TimeSeriesFrame Frame;
+		if (Line.empty() || Line[0] == '#' || !(Fields >> Frame.Time >> Frame.File))
+		{
+			continue;
+		}
+
+		if (!Frames.empty() && Frame.Time <= Frames.back().Time)
+		{
+			std::cout << "Manifesto " << ManifestFile << ": os instantes devem ser crescentes (" << Frame.File << ")" << std::endl;
+			return false;
+		}
+
+		std::filesystem::path FramePath{ Frame.File };
+		if (FramePath.is_relative())
+		{
+			Frame.File = (ManifestFolder / FramePath).string();
+		}
+
+		Frames.push_back(Frame);
+	}
+
+	return !Frames.empty();
+}
+
+TimeSeriesLayer::TimeSeriesLayer(const char* InName, const std::vector<TimeSeriesFrame>& InFrames, const TextureFormatOptions& InOptions, int NumSlots)
+	: Name(InName)
+	, Frames(InFrames)
+	, Options(InOptions)
+	, Slots(std::max(2, NumSlots))
+{
+	assert(!Frames.empty());
+
+	// A ltima volta termina um intervalo depois do ltimo quadro, assim o loop mantm o ritmo da srie
+	if (Frames.size() > 1)
+	{
+		const double LastInterval = Frames.back().Time - Frames[Frames.size() - 2].Time;
+		Period = Frames.back().Time - Frames.front().Time + LastInterval;
+	}
+
+	PlaybackTime = Frames.front().Time;
+}
+
+bool TimeSeriesLayer::Load()
+{
+	std::cout << "Carregando srie " << Name << " (" << Frames.size() << " quadros, " << Slots.size() << " camadas)" << std::endl;
+
+	TextureImage Image;
+	if (!DecodeTexture(Frames.front().File.c_str(), Options, Image))
+	{
+		std::cout << "Srie " << Name << ": erro ao carregar " << Frames.front().File << std::endl;
+		return false;
+	}
+
+	if (!Image.Format.bCompressed)
+	{
+		GenerateMipmapLevels(Image, Options.Usage);
+	}
+
+	// Os demais quadros so convertidos na thread de streaming para o formato escolhido aqui
+	Width = Image.Width;
+	Height = Image.Height;
+	Format = Image.Format;
+	Options.bForceFormat = true;
+	Options.ForcedFormat = Format;
+
+	LevelCount = 1;
+	for (int LevelWidth = Width, LevelHeight = Height; LevelWidth > 1 || LevelHeight > 1; ++LevelCount)
+	{
+		LevelWidth = std::max(1, LevelWidth / 2);
+		LevelHeight = std::max(1, LevelHeight / 2);
+	}
+
+	const GLsizei NumLayers = static_cast<GLsizei>(Slots.size());
+
+	glGenTextures(1, &TextureId);
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D_ARRAY, TextureId);
+
+	if (GLEW_ARB_texture_storage)
+	{
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, LevelCount, Format.InternalFormat, Width, Height, NumLayers);
+	}
+	else
+	{
+		for (int Level = 0, LevelWidth = Width, LevelHeight = Height; Level < LevelCount; ++Level)
+		{
+			if (Format.bCompressed)
+			{
+				GLsizei LevelBytes = static_cast<GLsizei>(ComputeLevelBytes(Format, LevelWidth, LevelHeight) * NumLayers);
+				glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, Level, Format.InternalFormat, LevelWidth, LevelHeight, NumLayers, 0,
+									   LevelBytes, nullptr);
+			}
+			else
+			{
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, Level, Format.InternalFormat, LevelWidth, LevelHeight, NumLayers, 0,
+							 Format.PixelFormat, GL_UNSIGNED_BYTE, nullptr);
+			}
+			LevelWidth = std::max(1, LevelWidth / 2);
+			LevelHeight = std::max(1, LevelHeight / 2);
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, LevelCount - 1);
+
+	// Mscaras de um canal (R8/BC4) so lidas como cinza: o shader pode usar .rgb em qualquer camada da srie
+	if (Format.NumberOfComponents == 1)
+	{
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_G, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_B, GL_RED);
+	}
+
+	std::string Description = std::string(Format.Name) + " 2D array";
+	TrackTextureMemory(TextureId, Description.c_str(), Width, Height, NumLayers * ComputeTextureMemory(Format, Width, Height),
+					   NumLayers * ComputeTextureMemory(TextureFormat{}, Width, Height));
+
+	UploadFrame(0, Image);
+	Slots[0].Frame = 0;
+	Slots[0].bResident = true;
+	SelectLayers(0);
+
+	return true;
+}
+
+double TimeSeriesLayer::GetFrameTime(int64_t Frame) const
+{
+	const int64_t NumFrames = static_cast<int64_t>(Frames.size());
+	return Frames[Frame % NumFrames].Time + (Frame / NumFrames) * Period;
+}
+
+int64_t TimeSeriesLayer::FindFrame(double Time) const
+{
+	const int64_t NumFrames = static_cast<int64_t>(Frames.size());
+	const int64_t Loop = std::max<int64_t>(0, static_cast<int64_t>(std::floor((Time - Frames.front().Time) / Period)));
+	const double LoopTime = Time - Loop * Period;
+
+	// ltimo quadro com instante <= LoopTime
+	auto Next = std::upper_bound(Frames.begin(), Frames.end(), LoopTime,
+								 [](double Value, const TimeSeriesFrame& Frame) { return Value < Frame.Time; });
+	const int64_t Index = std::max<int64_t>(0, static_cast<int64_t>(Next - Frames.begin()) - 1);
+
+	return Loop * NumFrames + Index;
+}
+
+const std::string& TimeSeriesLayer::GetFrameFile(int64_t Frame) const
+{
+	return Frames[Frame % static_cast<int64_t>(Frames.size())].File;
+}
+
+int TimeSeriesLayer::FindSlot(int64_t Frame) const
+{
+	for (int SlotIndex = 0; SlotIndex < static_cast<int>(Slots.size()); ++SlotIndex)
+	{
+		if (Slots[SlotIndex].Frame == Frame)
+		{
+			return SlotIndex;
+		}
+	}
+	return -1;
+}
+
+bool TimeSeriesLayer::IsAvailable(int64_t Frame) const
+{
+	// Quadros que falharam no seguram a reproduo: o quadro anterior continua na tela no lugar deles
+	int SlotIndex = FindSlot(Frame);
+	return SlotIndex >= 0 && (Slots[SlotIndex].bResident || Slots[SlotIndex].bFailed);
+}
+
+void TimeSeriesLayer::UploadFrame(int SlotIndex, const TextureImage& Image)
+{
+	GetGLStateCache().BindTextureForUpdate(GL_TEXTURE_2D_ARRAY, TextureId);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// A camada inteira  reescrita, incluindo todos os nveis de mipmap gerados na CPU
+	for (int Level = 0, LevelWidth = Width, LevelHeight = Height; Level < LevelCount; ++Level)
+	{
+		if (Format.bCompressed)
+		{
+			const std::vector<unsigned char>& Blocks = Image.CompressedLevels[Level];
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, Level, 0, 0, SlotIndex, LevelWidth, LevelHeight, 1, Format.InternalFormat,
+									  static_cast<GLsizei>(Blocks.size()), Blocks.data());
+		}
+		else
+		{
+			const std::vector<unsigned char>& Pixels = Level == 0 ? Image.Pixels : Image.MipmapLevels[Level - 1];
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, Level, 0, 0, SlotIndex, LevelWidth, LevelHeight, 1, Format.PixelFormat,
+							GL_UNSIGNED_BYTE, Pixels.data());
+		}
+		LevelWidth = std::max(1, LevelWidth / 2);
+		LevelHeight = std::max(1, LevelHeight / 2);
+	}
+
+}
+
+void TimeSeriesLayer::UploadReadyFrames()
+{
+	int Uploads = 0;
+	while (Uploads < UploadsPerUpdate)
+	{
+		// O quadro pronto mais antigo  copiado primeiro:  o prximo a aparecer na tela
+		int Ready = -1;
+		for (int SlotIndex = 0; SlotIndex < static_cast<int>(Slots.size()); ++SlotIndex)
+		{
+			const Slot& Candidate = Slots[SlotIndex];
+			if (Candidate.Pending && (Candidate.Pending->bReady || Candidate.Pending->bFailed) &&
+				(Ready < 0 || Candidate.Frame < Slots[Ready].Frame))
+			{
+				Ready = SlotIndex;
+			}
+		}
+
+		if (Ready < 0)
+		{
+			return;
+		}
+
+		Slot& Target = Slots[Ready];
+		const TextureImage& Image = Target.Pending->Image;
+
+		if (Target.Pending->bFailed || Image.Width != Width || Image.Height != Height)
+		{
+			std::cout << "Srie " << Name << ": quadro ignorado, erro ao carregar ou tamanho diferente do primeiro ("
+					  << GetFrameFile(Target.Frame) << ")" << std::endl;
+			Target.bFailed = true;
+			++FailedFrames;
+		}
+		else
+		{
+			UploadFrame(Ready, Image);
+			Target.bResident = true;
+			++Uploads;
+			++UploadedFrames;
+
+			const double DecodeSeconds = Target.Pending->DecodeSeconds;
+			AverageDecodeSeconds = AverageDecodeSeconds > 0.0 ? AverageDecodeSeconds * 0.8 + DecodeSeconds * 0.2 : DecodeSeconds;
+		}
+
+		Target.Pending.reset(); // Libera a RAM do quadro decodificado
+	}
+}
+
+void TimeSeriesLayer::RefillWindow(TextureStreamer& Streamer, int64_t CurrentFrame)
+{
+	DecodeThreads = Streamer.GetThreadCount();
+
+	// Hold pede todos os quadros em sequncia. Skip compara a velocidade de reproduo com a vazo das threads de
+	//	decodificao: pede um quadro a cada Stride (mltiplos de Stride, para o conjunto pedido no mudar a cada frame)
+	//	e comea Lead quadros  frente, para que o quadro fique pronto quando o relgio chegar nele
+	int64_t Lead = 0;
+	int64_t Stride = 1;
+	if (Policy == ETimeSeriesPolicy::Skip)
+	{
+		const double FramesPerSecond = PlaybackSpeed * Frames.size() / Period;
+		const double FramesPerDecode = AverageDecodeSeconds * FramesPerSecond;
+		Lead = static_cast<int64_t>(std::ceil(FramesPerDecode));
+		Stride = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(FramesPerDecode / DecodeThreads - 0.1)));
+	}
+
+	const int64_t FirstFrame = (CurrentFrame + Lead + Stride - 1) / Stride * Stride;
+	const int64_t WindowEnd = FirstFrame + static_cast<int64_t>(Slots.size()) * Stride;
+
+	// Libera as camadas que saram da janela [CurrentFrame, WindowEnd), exceto a que est na tela
+	for (Slot& Candidate : Slots)
+	{
+		if (Candidate.Frame < 0 || Candidate.Frame == ShownFrame || (Candidate.Frame >= CurrentFrame && Candidate.Frame < WindowEnd))
+		{
+			continue;
+		}
+
+		if (Candidate.Pending)
+		{
+			++DroppedFrames; // O relgio passou do quadro antes de ele ficar pronto
+
+			// Enquanto nenhum quadro fica pronto a tempo no h medida: a idade do pedido descartado (que inclui a
+			//	espera na fila) serve de estimativa inicial, seno a antecedncia nunca cresceria
+			if (UploadedFrames == 0)
+			{
+				const double Age = std::chrono::duration<double>(std::chrono::steady_clock::now() - Candidate.RequestTime).count();
+				AverageDecodeSeconds = std::max(AverageDecodeSeconds, Age);
+			}
+
+			Candidate.Pending->bCancelled = true;
+		}
+		Candidate = Slot{};
+	}
+
+	// Pede os prximos quadros em ordem, enquanto houver camadas livres
+	for (int64_t Frame = FirstFrame; Frame < WindowEnd; Frame += Stride)
+	{
+		if (FindSlot(Frame) >= 0)
+		{
+			continue;
+		}
+
+		int FreeSlot = FindSlot(-1);
+		if (FreeSlot < 0)
+		{
+			break;
+		}
+
+		Slot& Target = Slots[FreeSlot];
+		Target.Frame = Frame;
+		Target.Pending = std::make_shared<TextureStreamRequest>();
+		Target.Pending->File = GetFrameFile(Frame);
+		Target.Pending->Options = Options;
+		Target.Pending->bBuildMipmaps = true;
+		Target.RequestTime = std::chrono::steady_clock::now();
+		Streamer.Request(Target.Pending);
+	}
+}
+
+void TimeSeriesLayer::SelectLayers(int64_t CurrentFrame)
+{
+	// Quadro residente mais recente at o instante atual (com a poltica Skip pode ser anterior ao CurrentFrame)
+	int SlotA = -1;
+	for (int SlotIndex = 0; SlotIndex < static_cast<int>(Slots.size()); ++SlotIndex)
+	{
+		const Slot& Candidate = Slots[SlotIndex];
+		if (Candidate.bResident && Candidate.Frame <= CurrentFrame && (SlotA < 0 || Candidate.Frame > Slots[SlotA].Frame))
+		{
+			SlotA = SlotIndex;
+		}
+	}
+
+	if (SlotA < 0)
+	{
+		return; // Mantm as camadas anteriores
+	}
+
+	LayerA = SlotA;
+	LayerB = SlotA;
+	Blend = 0.0f;
+
+	// S interpola entre quadros consecutivos que estejam os dois na GPU
+	int SlotB = FindSlot(Slots[SlotA].Frame + 1);
+	if (Slots[SlotA].Frame == CurrentFrame && SlotB >= 0 && Slots[SlotB].bResident)
+	{
+		const double TimeA = GetFrameTime(CurrentFrame);
+		const double TimeB = GetFrameTime(CurrentFrame + 1);
+		LayerB = SlotB;
+		Blend = static_cast<float>(std::clamp((PlaybackTime - TimeA) / (TimeB - TimeA), 0.0, 1.0));
+	}
+
+	if (Slots[SlotA].Frame != ShownFrame)
+	{
+		if (ShownFrame >= 0 && Slots[SlotA].Frame > ShownFrame + 1)
+		{
+			SkippedFrames += Slots[SlotA].Frame - ShownFrame - 1;
+		}
+		ShownFrame = Slots[SlotA].Frame;
+		++ShownFrames;
+	}
+}
+
+void TimeSeriesLayer::Update(TextureStreamer& Streamer, float DeltaSeconds)
+{
+	if (TextureId == 0)
+	{
+		return;
+	}
+
+	UploadReadyFrames();
+
+	double Advance = static_cast<double>(DeltaSeconds) * PlaybackSpeed;
+
+	if (Policy == ETimeSeriesPolicy::Hold)
+	{
+		// S entra no intervalo de um quadro se o quadro seguinte j puder ser exibido; caso contrrio o relgio espera
+		while (Advance > 0.0)
+		{
+			const int64_t Frame = FindFrame(PlaybackTime);
+			if (!IsAvailable(Frame + 1))
+			{
+				++StalledUpdates;
+				break;
+			}
+
+			const double NextFrameTime = GetFrameTime(Frame + 1);
+			if (PlaybackTime + Advance < NextFrameTime)
+			{
+				PlaybackTime += Advance;
+				break;
+			}
+
+			Advance -= NextFrameTime - PlaybackTime;
+			PlaybackTime = NextFrameTime;
+		}
+	}
+	else
+	{
+		PlaybackTime += Advance;
+	}
+
+	const int64_t CurrentFrame = FindFrame(PlaybackTime);
+	RefillWindow(Streamer, CurrentFrame);
+	SelectLayers(CurrentFrame);
+}
+
+void TimeSeriesLayer::Release()
+{
+	for (Slot& Candidate : Slots)
+	{
+		if (Candidate.Pending)
+		{
+			Candidate.Pending->bCancelled = true;
+		}
+		Candidate = Slot{};
+	}
+
+	ReleaseTexture(TextureId);
+}
+
+GLuint TimeSeriesLayer::GetTextureId() const
+{
+	return TextureId;
+}
+
+int TimeSeriesLayer::GetLayerA() const
+{
+	return LayerA;
+}
+
+int TimeSeriesLayer::GetLayerB() const
+{
+	return LayerB;
+}
+
+float TimeSeriesLayer::GetBlend() const
+{
+	return Blend;
+}
+
+void TimeSeriesLayer::PrintReport(std::ostream& Output) const
+{
+	const size_t Bytes = Slots.size() * ComputeTextureMemory(Format, Width, Height);
+
+	Output << std::fixed << std::setprecision(1)
+		   << "Srie " << Name << ": " << UploadedFrames << " quadros copiados, " << ShownFrames << " exibidos, " << SkippedFrames << " pulados, " << DroppedFrames
+		   << " decodificaes descartadas, "
+		   << StalledUpdates << " frames em espera, " << FailedFrames << " com erro ("
+		   << (Policy == ETimeSeriesPolicy::Hold ? "hold" : "skip") << ", " << PlaybackSpeed << " h/s, "
+		   << Slots.size() << " camadas, " << ToMegabytes(Bytes) << " MB)" << std::defaultfloat << std::endl;
+}
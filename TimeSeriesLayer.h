@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "TextureLod.h"
+
+// O que fazer quando a decodificao no acompanha a velocidade de reproduo
+enum class ETimeSeriesPolicy
+{
+	Hold, // O relgio da srie espera o prximo quadro chegar  GPU: nenhum quadro  pulado, a reproduo desacelera
+	Skip // O relgio segue o tempo real: quando a decodificao no acompanha, pede s um a cada N quadros, com
+		 //	antecedncia igual ao tempo de decodificao medido, e os quadros que no ficarem prontos a tempo so descartados
+};
+
+// Um raster da srie (ex.: cobertura de nuvens de uma hora), com o instante em horas
+struct TimeSeriesFrame
+{
+	double Time = 0.0;
+	std::string File;
+};
+
+// L o manifesto da srie: uma linha "<horas> <arquivo>" por quadro, em ordem crescente de tempo ('#' inicia comentrio).
+//	Caminhos relativos so resolvidos a partir da pasta do manifesto
+bool LoadTimeSeriesManifest(const char* ManifestFile, std::vector<TimeSeriesFrame>& Frames);
+
+// Camada animada reproduzida a partir de uma sequncia de rasters de qualquer tamanho, em loop.
+// Apenas NumSlots quadros ficam residentes, nas camadas de um GL_TEXTURE_2D_ARRAY usado como anel: a memria de vdeo
+//	(e a RAM dos quadros decodificados)  constante, independente do comprimento da sequncia.
+// Os quadros seguintes so decodificados pelas threads do TextureStreamer (com as mipmaps geradas na CPU) e a
+//	interpolao entre os dois quadros em torno do instante atual  feita no shader (GetLayerA, GetLayerB e GetBlend)
+class TimeSeriesLayer
+{
+public:
+	TimeSeriesLayer(const char* InName, const std::vector<TimeSeriesFrame>& InFrames, const TextureFormatOptions& InOptions, int NumSlots = 8);
+
+	// Decodifica o primeiro quadro de forma sncrona: ele define o tamanho e o formato de todas as camadas
+	bool Load();
+
+	// Avana o relgio da srie, copia para a GPU os quadros j decodificados e pede a decodificao dos prximos
+	void Update(TextureStreamer& Streamer, float DeltaSeconds);
+
+	void Release();
+
+	GLuint GetTextureId() const;
+	int GetLayerA() const;
+	int GetLayerB() const;
+	float GetBlend() const;
+
+	void PrintReport(std::ostream& Output) const;
+
+	// Horas da srie reproduzidas por segundo (ex.: 24 = um dia de rasters horrios por segundo)
+	float PlaybackSpeed = 1.0f;
+
+	ETimeSeriesPolicy Policy = ETimeSeriesPolicy::Hold;
+
+	// Quadros copiados para a GPU por frame (limita o custo de cada frame, como StreamedTexture::RowsPerFrame)
+	int UploadsPerUpdate = 1;
+
+private:
+	struct Slot
+	{
+		int64_t Frame = -1; // ndice absoluto do quadro (cresce a cada volta do loop), -1 = camada livre
+		std::shared_ptr<TextureStreamRequest> Pending;
+		bool bResident = false;
+		bool bFailed = false;
+		std::chrono::steady_clock::time_point RequestTime;
+	};
+
+	double GetFrameTime(int64_t Frame) const;
+	int64_t FindFrame(double Time) const;
+	const std::string& GetFrameFile(int64_t Frame) const;
+	int FindSlot(int64_t Frame) const;
+	bool IsAvailable(int64_t Frame) const;
+
+	void UploadFrame(int SlotIndex, const TextureImage& Image);
+	void UploadReadyFrames();
+	void RefillWindow(TextureStreamer& Streamer, int64_t CurrentFrame);
+	void SelectLayers(int64_t CurrentFrame);
+
+	std::string Name;
+	std::vector<TimeSeriesFrame> Frames;
+	TextureFormatOptions Options;
+	double Period = 1.0; // Durao de uma volta completa da sequncia, em horas
+
+	std::vector<Slot> Slots;
+	GLuint TextureId = 0;
+	int Width = 0;
+	int Height = 0;
+	int LevelCount = 1;
+	TextureFormat Format;
+
+	double PlaybackTime = 0.0;
+	int LayerA = 0;
+	int LayerB = 0;
+	float Blend = 0.0f;
+	int64_t ShownFrame = -1;
+
+	// Mdia mvel do tempo de decodificao de um quadro (segundos) e quantas threads decodificam em paralelo
+	double AverageDecodeSeconds = 0.0;
+	int DecodeThreads = 1;
+
+	uint64_t UploadedFrames = 0;
+	uint64_t ShownFrames = 0;
+	uint64_t SkippedFrames = 0; // Quadros da sequncia que passaram sem aparecer na tela
+	uint64_t DroppedFrames = 0; // Decodificaes descartadas porque o relgio passou do quadro
+	uint64_t StalledUpdates = 0;
+	uint64_t FailedFrames = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Troca de dados entre uma thread produtora e uma consumidora sem locks e sem espera: a produtora sempre tem um buffer
+//	livre para escrever e a consumidora l o ltimo publicado, sem que uma bloqueie a outra. Publicaes que a
+//	consumidora no chegou a ler so substitudas pela mais recente
+template <typename T>
+class TripleBuffer
+{
+public:
+	// Buffer exclusivo da produtora at o prximo Publish
+	T& GetWriteBuffer()
+	{
+		return Buffers[WriteIndex];
+	}
+
+	// Entrega o buffer escrito e recebe em troca o buffer intermedirio para o prximo frame
+	void Publish()
+	{
+		const uint8_t Previous = Middle.exchange(static_cast<uint8_t>(WriteIndex | NewDataBit), std::memory_order_acq_rel);
+		WriteIndex = Previous & IndexMask;
+	}
+
+	// Troca o buffer de leitura pelo ltimo publicado. Retorna false (mantendo o anterior) se nada novo foi publicado
+	bool Acquire()
+	{
+		if ((Middle.load(std::memory_order_acquire) & NewDataBit) == 0)
+		{
+			return false;
+		}
+
+		const uint8_t Previous = Middle.exchange(ReadIndex, std::memory_order_acq_rel);
+		ReadIndex = Previous & IndexMask;
+		return true;
+	}
+
+	// Buffer exclusivo da consumidora at o prximo Acquire
+	const T& GetReadBuffer() const
+	{
+		return Buffers[ReadIndex];
+	}
+
+private:
+	static constexpr uint8_t IndexMask = 0x3;
+	static constexpr uint8_t NewDataBit = 0x4;
+
+	T Buffers[3] = {};
+	uint8_t WriteIndex = 0;
+	uint8_t ReadIndex = 2;
+	std::atomic<uint8_t> Middle{ 1 }; // ndice do buffer intermedirio e o bit de dado novo
+};
@@ -0,0 +1,207 @@
+#include "UniformBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "GLStateCache.h"
+#include "ShaderReflection.h"
+
+void UniformBuffer::Create(GLuint InBinding, size_t InSize, bool bInMapped, int NumRegions)
+{
+	Binding = InBinding;
+	BufferSize = InSize;
+	bMapped = bInMapped;
+
+	glGenBuffers(1, &BufferId);
+	GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, BufferId);
+
+	if (!bMapped)
+	{
+		glBufferData(GL_UNIFORM_BUFFER, BufferSize, nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, Binding, BufferId);
+		return;
+	}
+
+	// Cada regio comea em um mltiplo do alinhamento exigido por glBindBufferRange
+	GLint Alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+	Alignment = std::max(Alignment, 1);
+	RegionStride = (BufferSize + Alignment - 1) / Alignment * Alignment;
+	Fences.assign(std::max(NumRegions, 1), nullptr);
+
+	const GLsizeiptr TotalSize = static_cast<GLsizeiptr>(RegionStride * Fences.size());
+	bPersistent = GLEW_ARB_buffer_storage != 0;
+	if (bPersistent)
+	{
+		const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, TotalSize, nullptr, Flags);
+		PersistentData = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, TotalSize, Flags));
+		bPersistent = PersistentData != nullptr;
+	}
+	if (!bPersistent)
+	{
+		glBufferData(GL_UNIFORM_BUFFER, TotalSize, nullptr, GL_DYNAMIC_DRAW);
+	}
+	glBindBufferRange(GL_UNIFORM_BUFFER, Binding, BufferId, 0, BufferSize);
+}
+
+void UniformBuffer::Upload(const void* Data, size_t Size)
+{
+	if (BufferId == 0 || Size > BufferSize)
+	{
+		return;
+	}
+
+	if (bMapped)
+	{
+		if (void* Destination = BeginWrite())
+		{
+			std::memcpy(Destination, Data, Size);
+		}
+		EndWrite();
+		return;
+	}
+
+	GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, BufferId);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, Size, Data);
+}
+
+void* UniformBuffer::BeginWrite()
+{
+	if (BufferId == 0 || !bMapped)
+	{
+		return nullptr;
+	}
+
+	// Os comandos emitidos desde a escrita anterior leem a regio atual: o fence marca quando a GPU termina com eles
+	if (bHasWritten)
+	{
+		if (Fences[CurrentRegion])
+		{
+			glDeleteSync(Fences[CurrentRegion]);
+		}
+		Fences[CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		CurrentRegion = (CurrentRegion + 1) % Fences.size();
+	}
+	bHasWritten = true;
+
+	if (GLsync& Fence = Fences[CurrentRegion])
+	{
+		if (glClientWaitSync(Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+		{
+			FenceWaits++;
+			glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 s
+		}
+		glDeleteSync(Fence);
+		Fence = nullptr;
+	}
+
+	const size_t Offset = CurrentRegion * RegionStride;
+	if (bPersistent)
+	{
+		return PersistentData + Offset;
+	}
+
+	GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, BufferId);
+	return glMapBufferRange(GL_UNIFORM_BUFFER, Offset, BufferSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void UniformBuffer::EndWrite()
+{
+	if (BufferId == 0 || !bMapped)
+	{
+		return;
+	}
+
+	// glBindBufferRange tambm troca o GL_UNIFORM_BUFFER genrico: passar pelo cache mantm o estado conhecido
+	GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, BufferId);
+	if (!bPersistent)
+	{
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+	}
+	glBindBufferRange(GL_UNIFORM_BUFFER, Binding, BufferId, CurrentRegion * RegionStride, BufferSize);
+}
+
+void UniformBuffer::Release()
+{
+	for (GLsync& Fence : Fences)
+	{
+		if (Fence)
+		{
+			glDeleteSync(Fence);
+			Fence = nullptr;
+		}
+	}
+
+	if (BufferId != 0 && bPersistent)
+	{
+		GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, BufferId);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		PersistentData = nullptr;
+	}
+
+	if (BufferId != 0)
+	{
+		GetGLStateCache().OnBufferDeleted(BufferId);
+		glDeleteBuffers(1, &BufferId);
+		BufferId = 0;
+	}
+}
+
+GLuint UniformBuffer::GetBufferId() const
+{
+	return BufferId;
+}
+
+bool UniformBuffer::IsPersistentlyMapped() const
+{
+	return bPersistent;
+}
+
+uint64_t UniformBuffer::GetFenceWaits() const
+{
+	return FenceWaits;
+}
+
+bool ValidateFrameUniformLayout(const ShaderReflection& Reflection)
+{
+	struct ExpectedMember
+	{
+		const char* Name;
+		size_t Offset;
+	};
+
+	const ExpectedMember Members[] =
+	{
+		{ "ModelViewProjection", offsetof(FrameUniformData, ModelViewProjection) },
+		{ "ModelViewMatrix", offsetof(FrameUniformData, ModelViewMatrix) },
+		{ "NormalMatrix", offsetof(FrameUniformData, NormalMatrix) },
+		{ "LightDirection", offsetof(FrameUniformData, LightDirection) },
+		{ "LightIntensity", offsetof(FrameUniformData, LightIntensity) },
+		{ "Time", offsetof(FrameUniformData, Time) },
+		{ "ViewMatrix", offsetof(FrameUniformData, ViewMatrix) },
+		{ "ViewProjection", offsetof(FrameUniformData, ViewProjection) },
+	};
+
+	bool bValid = true;
+	for (const ExpectedMember& Member : Members)
+	{
+		// Membros no usados pela variante podem ter sido eliminados pelo compilador
+		const ShaderUniform* Uniform = Reflection.FindUniform(Member.Name);
+		if (Uniform && Uniform->Offset != static_cast<GLint>(Member.Offset))
+		{
+			std::cout << "FrameUniforms: " << Member.Name << " no offset " << Uniform->Offset << ", esperado " << Member.Offset << std::endl;
+			bValid = false;
+		}
+	}
+
+	const ShaderUniformBlock* Block = Reflection.FindBlock("FrameUniforms");
+	if (Block && Block->DataSize > static_cast<GLint>(sizeof(FrameUniformData)))
+	{
+		std::cout << "FrameUniforms: bloco com " << Block->DataSize << " bytes, esperado " << sizeof(FrameUniformData) << std::endl;
+		bValid = false;
+	}
+
+	return bValid;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+class ShaderReflection;
+
+// Ponto de ligao do bloco FrameUniforms, o mesmo para todos os programas
+constexpr GLuint FrameUniformsBinding = 0;
+
+// Dados da cmera e da iluminao de um frame, no layout std140 do bloco FrameUniforms (shaders/frame_uniforms.glsl)
+struct FrameUniformData
+{
+	glm::mat4 ModelViewProjection;
+	glm::mat4 ModelViewMatrix;
+	glm::mat4 NormalMatrix;
+	glm::vec3 LightDirection;
+	float LightIntensity;
+	float Time;
+	float Padding[3]; // Alinha a prxima matriz em 16 bytes, como no std140
+	glm::mat4 ViewMatrix;
+	glm::mat4 ViewProjection;
+};
+
+static_assert(sizeof(FrameUniformData) == 352, "FrameUniformData deve seguir o layout std140 do bloco FrameUniforms");
+static_assert(offsetof(FrameUniformData, LightDirection) == 192, "LightDirection fora do offset std140");
+static_assert(offsetof(FrameUniformData, Time) == 208, "Time fora do offset std140");
+static_assert(offsetof(FrameUniformData, ViewMatrix) == 224, "ViewMatrix fora do offset std140");
+
+// Buffer de uniforms ligado a um ponto de ligao fixo (glBindBufferBase). Todos os programas que declaram o bloco
+//	leem os mesmos dados: uma nica cpia por frame, em vez de um glUniform por valor e por programa
+//	Com bMapped o buffer  dividido em NumRegions regies (uma por frame em voo) escritas diretamente pela CPU: mapeado
+//	uma nica vez (persistente) com ARB_buffer_storage ou mapeado a cada escrita sem sincronizao implcita. Uma
+//	regio s  reescrita depois que o fence dos comandos que a leram foi sinalizado, ento escrever no bloqueia o
+//	driver e pode ficar para o ltimo momento antes dos draws
+class UniformBuffer
+{
+public:
+	void Create(GLuint InBinding, size_t InSize, bool bMapped = false, int NumRegions = 3);
+
+	// Substitui todo o contedo do buffer (o tamanho deve ser o mesmo informado em Create)
+	void Upload(const void* Data, size_t Size);
+
+	// S no modo mapeado: ponteiro para os BufferSize bytes da prxima regio, que passa a ser a do ponto de ligao
+	//	em EndWrite. Os draws emitidos at a prxima BeginWrite leem essa regio
+	void* BeginWrite();
+	void EndWrite();
+
+	void Release();
+
+	GLuint GetBufferId() const;
+	bool IsPersistentlyMapped() const;
+
+	// Escritas que tiveram de esperar a GPU liberar a regio (mais frames em voo do que regies)
+	uint64_t GetFenceWaits() const;
+
+private:
+	GLuint BufferId = 0;
+	GLuint Binding = 0;
+	size_t BufferSize = 0;
+
+	bool bMapped = false;
+	bool bPersistent = false;
+	size_t RegionStride = 0;
+	uint8_t* PersistentData = nullptr;
+	std::vector<GLsync> Fences;
+	size_t CurrentRegion = 0;
+	bool bHasWritten = false;
+	uint64_t FenceWaits = 0;
+};
+
+// Confere os offsets do bloco FrameUniforms de um programa com os de FrameUniformData (imprime as diferenas)
+bool ValidateFrameUniformLayout(const ShaderReflection& Reflection);
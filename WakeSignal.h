@@ -0,0 +1,32 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+// Sinal para acordar uma thread parada sem que ela precise consultar nada periodicamente. Um Notify sem ningum
+//	esperando no se perde: o prximo Wait retorna na hora. Vrios Notify antes de um Wait valem por um s
+class WakeSignal
+{
+public:
+	void Notify()
+	{
+		{
+			std::lock_guard<std::mutex> Lock{ Mutex };
+			bSignaled = true;
+		}
+		Condition.notify_one();
+	}
+
+	// Bloqueia at o prximo Notify (ou retorna se j houve um) e consome o sinal
+	void Wait()
+	{
+		std::unique_lock<std::mutex> Lock{ Mutex };
+		Condition.wait(Lock, [this]() { return bSignaled; });
+		bSignaled = false;
+	}
+
+private:
+	std::mutex Mutex;
+	std::condition_variable Condition;
+	bool bSignaled = false;
+};
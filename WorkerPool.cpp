@@ -0,0 +1,118 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+WorkerPool::WorkerPool(int InNumThreads)
+{
+	const int NumThreads = InNumThreads > 0 ? InNumThreads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	for (int Worker = 1; Worker < NumThreads; ++Worker)
+	{
+		Workers.emplace_back([this]() { WorkerLoop(); });
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> Lock{ Mutex };
+		bStopping = true;
+	}
+	WakeCondition.notify_all();
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+}
+
+int WorkerPool::GetNumThreads() const
+{
+	return static_cast<int>(Workers.size()) + 1;
+}
+
+void WorkerPool::ParallelFor(size_t Count, const std::function<void(size_t)>& InTask)
+{
+	if (Count == 0)
+	{
+		return;
+	}
+
+	if (Count == 1 || Workers.empty())
+	{
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			InTask(Index);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> CallLock{ CallMutex };
+	{
+		// Uma thread que acordou atrasada para o lote anterior ainda pode estar em RunTasks (sem tarefas para pegar)
+		std::unique_lock<std::mutex> Lock{ Mutex };
+		DoneCondition.wait(Lock, [this]() { return ActiveWorkers == 0; });
+
+		Task = &InTask;
+		TaskCount = Count;
+		NextTask.store(0, std::memory_order_relaxed);
+		++Batch;
+	}
+	WakeCondition.notify_all();
+
+	RunTasks();
+
+	// Todas as tarefas j foram pegas; falta esperar as que ainda esto rodando nas outras threads
+	std::unique_lock<std::mutex> Lock{ Mutex };
+	DoneCondition.wait(Lock, [this]() { return ActiveWorkers == 0; });
+	Task = nullptr;
+}
+
+void WorkerPool::RunTasks()
+{
+	for (size_t Index = NextTask.fetch_add(1); Index < TaskCount; Index = NextTask.fetch_add(1))
+	{
+		(*Task)(Index);
+	}
+}
+
+void WorkerPool::WorkerLoop()
+{
+	uint64_t LastBatch = 0;
+	bool bNamed = false;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> Lock{ Mutex };
+			WakeCondition.wait(Lock, [this, LastBatch]() { return bStopping || Batch != LastBatch; });
+			if (bStopping)
+			{
+				return;
+			}
+			LastBatch = Batch;
+			++ActiveWorkers;
+		}
+
+		// A thread existe antes do profiler comear a gravar: o nome  dado na primeira tarefa com a gravao ativa
+		if (!bNamed && GetProfiler().IsRecording())
+		{
+			GetProfiler().SetThreadName("Worker");
+			bNamed = true;
+		}
+
+		RunTasks();
+
+		{
+			std::lock_guard<std::mutex> Lock{ Mutex };
+			--ActiveWorkers;
+		}
+		DoneCondition.notify_all();
+	}
+}
+
+WorkerPool& GetWorkerPool()
+{
+	static WorkerPool Pool;
+	return Pool;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads criadas uma nica vez e acordadas a cada lote de tarefas: distribuir o trabalho de um frame custa acordar as
+//	threads (alguns microssegundos), e no cri-las e esper-las terminar (dezenas de microssegundos por thread).
+// A thread que chama ParallelFor tambm executa tarefas e s retorna quando todas terminaram. Uma chamada por vez:
+//	chamadas de threads diferentes esperam a anterior terminar, e uma tarefa no pode chamar ParallelFor no mesmo pool
+class WorkerPool
+{
+public:
+	// NumThreads conta a thread que chama ParallelFor (0 = uma por ncleo); so criadas NumThreads - 1 threads
+	explicit WorkerPool(int InNumThreads = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// Executa Task(Index) para cada Index em [0, Count), em qualquer ordem e em qualquer uma das threads
+	void ParallelFor(size_t Count, const std::function<void(size_t)>& Task);
+
+	int GetNumThreads() const;
+
+private:
+	void WorkerLoop();
+
+	// Executa tarefas do lote atual at acabarem
+	void RunTasks();
+
+	std::vector<std::thread> Workers;
+	std::mutex CallMutex;
+
+	std::mutex Mutex;
+	std::condition_variable WakeCondition;
+	std::condition_variable DoneCondition;
+	uint64_t Batch = 0; // Incrementado a cada ParallelFor: acorda as threads
+	int ActiveWorkers = 0; // Threads dentro de RunTasks; o lote s  trocado com zero
+	bool bStopping = false;
+
+	const std::function<void(size_t)>* Task = nullptr;
+	size_t TaskCount = 0;
+	std::atomic<size_t> NextTask{ 0 };
+};
+
+// Pool compartilhado pela montagem dos comandos de desenho e pela gravao das listas de comandos
+WorkerPool& GetWorkerPool();
@@ -1,7 +1,19 @@
+#include <algorithm>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 // No inclumos o GL.h pois nele constam apenas as funes do OpenGL 1.0 ou 1.1
@@ -14,10 +26,36 @@
 #include <glm/ext.hpp>
 #include <glm/gtx/string_cast.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION // Macro necessria para ativar o header STB
-#include <stb_image.h>
-
 #include "Camera.h"
+#include "CommandList.h"
+#include "DrawBatcher.h"
+#include "DrawStatistics.h"
+#include "DynamicResolution.h"
+#include "FrameBenchmark.h"
+#include "FlightRecorder.h"
+#include "FrameGraph.h"
+#include "FramePacing.h"
+#include "GLStateCache.h"
+#include "GlobePatches.h"
+#include "HudOverlay.h"
+#include "InputQueue.h"
+#include "InstancedBodies.h"
+#include "LatencyHistogram.h"
+#include "PrefetchScheduler.h"
+#include "Profiler.h"
+#include "RedrawScheduler.h"
+#include "Shader.h"
+#include "ShaderCache.h"
+#include "ShaderLibrary.h"
+#include "ShaderReflection.h"
+#include "ShaderWatcher.h"
+#include "Texture.h"
+#include "TextureLod.h"
+#include "TextureResidency.h"
+#include "TimeSeriesLayer.h"
+#include "TripleBuffer.h"
+#include "UniformBuffer.h"
+#include "WakeSignal.h"
 
 const int Width = 800; // Constantes que determinam o tamanho da janela de contexto do GLFW
 const int Height = 600;
@@ -30,6 +68,14 @@ struct Vertex
 	glm::vec2 UV;
 };
 
+// Vrtice compactado (--packed-vertices): 12 bytes em vez dos 44 do Vertex. A posio usa 4 x int16 normalizados
+//	(o quarto componente s alinha a estrutura) e o UV, 2 x uint16 normalizados. A normal e a cor so derivadas no shader
+struct PackedVertex
+{
+	int16_t Position[4];
+	uint16_t UV[2];
+};
+
 struct Triangle
 {
 	GLuint V0;
@@ -45,6 +91,66 @@ struct DirectionalLight
 
 SimpleCamera Camera;
 
+// F12 pede a captura do prximo frame (passe Capture do grafo de renderizao).  um contador para que nenhum pedido se
+//	perca quando a thread de renderizao pula snapshots
+uint32_t CaptureRequests = 0;
+
+// Instante (glfwGetTime) e nmero do ltimo evento de teclado ou mouse, usados na medida de latncia da entrada.
+//	AppliedInputEvent  o ltimo que j passou pela fila e foi aplicado  cmera
+double LastInputTime = -1.0;
+uint64_t LastInputEvent = 0;
+uint64_t AppliedInputEvent = 0;
+
+// Os callbacks s enfileiram os eventos; ProcessInput os aplica uma vez por frame
+InputQueue PendingInput;
+
+// --record-input grava os eventos que chegam pelos callbacks. Com --replay-input os eventos vm da gravao e, como
+//	no --benchmark, os da janela so ignorados
+InputRecorder InputRecording;
+bool bReplayingInput = false;
+bool bIgnoreWindowInput = false;
+
+// Latncia de cada evento de entrada, do callback at a volta do glfwSwapBuffers que o mostra na tela
+InputLatencyTracker InputEvents;
+
+// Orientao da cmera publicada a cada processamento da entrada que a gira.  lida pelo desenho imediatamente antes dos draws (late
+//	latching), ento um movimento que chega depois do snapshot do frame ainda entra nele
+struct CameraOrientation
+{
+	glm::vec3 Direction{ 0.0f };
+	glm::vec3 Up{ 0.0f };
+	uint64_t InputEvent = 0; // 0 = nada publicado
+};
+
+TripleBuffer<CameraOrientation> LatestOrientation;
+
+// Todo callback de entrada termina aqui: o instante  o da chegada do evento  aplicao
+void QueueInputEvent(InputEvent Event)
+{
+	LastInputTime = glfwGetTime();
+	LastInputEvent = InputEvents.RecordEvent(LastInputTime);
+
+	Event.Time = LastInputTime;
+	Event.Number = LastInputEvent;
+	PendingInput.Push(Event);
+	InputRecording.Record(Event);
+}
+
+// Estado da simulao consumido pelo desenho de um frame. Produzido na thread principal (entrada e cmera) e, com
+//	--render-thread, entregue  thread de renderizao por um triple buffer
+struct FrameSnapshot
+{
+	SimpleCamera Camera;
+	glm::mat4 ViewMatrix{ 1.0f };
+	glm::mat4 ViewProjection{ 1.0f };
+	double Time = 0.0; // As rbitas dos corpos instanciados e as nuvens so derivadas deste instante
+	int FramebufferWidth = 0;
+	int FramebufferHeight = 0;
+	uint32_t CaptureRequests = 0;
+	double InputTime = -1.0; // ltimo evento de entrada j aplicado  cmera deste snapshot
+	uint64_t InputEvent = 0; // Nmero desse evento (InputLatencyTracker)
+};
+
 // Funo para gerar vrtices e a malha triangular da geometria da esfera
 // A equao para clculo dos vrtices  expressa por:
 // x = x_0 + r sinPhi cosTheta
@@ -54,6 +160,8 @@ SimpleCamera Camera;
 //  gerando esfera com origem em (0,0,0) e utilizando raio = 1
 void GenerateSphere(GLuint Resolution, std::vector<Vertex>& Vertices, std::vector<Triangle>& Indices)
 {
+	PROFILE_SCOPE("GenerateSphere");
+
 	Vertices.clear(); // Apenas garantindo a inicializao correta
 	Indices.clear();
 
@@ -113,185 +221,15 @@ void GenerateSphere(GLuint Resolution, std::vector<Vertex>& Vertices, std::vecto
 	}
 }
 
-// Funo para leitura de arquivos
-std::string ReadFile(const char* FilePath)
+// Tratamento de eventos com clique do mouse. X, Y  a posio do cursor no momento do clique
+void ApplyMouseButton(GLFWwindow* Window, int Button, int Action, double X, double Y)
 {
-	std::string FileContents;
-	if (std::ifstream FileStream{ FilePath, std::ios::in }) // Se entrar no if, foi possvel criar a stream de leitura
-	{
-		FileContents.assign((std::istreambuf_iterator<char>(FileStream)), std::istreambuf_iterator<char>());
-	}
-	return FileContents;
-}
-
-// Funo para verificao do log de compilao do shader (recebe o identificador de um shader compilado como parmetro)
-void CheckShader(GLuint ShaderId)
-{
-	// Verificar se o shader foi compilado
-	GLint Result = GL_TRUE;
-	glGetShaderiv(ShaderId, GL_COMPILE_STATUS, &Result);
-
-	if (Result == GL_FALSE)
-	{
-		// Erro ao compilar o shader, imprimir o log para saber o que est errado
-		GLint InfoLogLength = 0; // Obter tamanho do log
-		glGetShaderiv(ShaderId, GL_INFO_LOG_LENGTH, &InfoLogLength); // Quantidade em bytes a ser alocado na string
-
-		std::string ShaderInfoLog(InfoLogLength, '\0'); // Inicializar string de tamanho InfoLogLength com todos 
-													    // os char = '0'
-		glGetShaderInfoLog(ShaderId, InfoLogLength, nullptr, &ShaderInfoLog[0]); // Recupera o log armazenando em 
-																				 // ShaderInfoLog
-		if (InfoLogLength > 0)
-		{
-			std::cout << "Erro no Vertex Shader: " << std::endl;
-			std::cout << ShaderInfoLog << std::endl;
-
-			assert(false); // Erro no shader, interrompe o programa
-		}
-	}
-}
-
-// Funo para carregar os programas de shaders
-GLuint LoadShaders(const char* VertexShaderFile, const char* FragmentShaderFile)
-{
-	// Criar os identificadores do Vertex e do Fragment Shaders
-	GLuint VertShaderId = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragShaderId = glCreateShader(GL_FRAGMENT_SHADER);
-
-	std::string VertexShaderSource = ReadFile(VertexShaderFile);
-	std::string FragmentShaderSource = ReadFile(FragmentShaderFile);
-
-	assert(!VertexShaderSource.empty());
-	assert(!FragmentShaderSource.empty());
-
-	// Utilizar o OpenGL para compilar os shaders
-	std::cout << "Compilando " << VertexShaderFile << std::endl;
-	const char* VertexShaderSourcePtr = VertexShaderSource.c_str(); // Ponteiro para o fonte do Vertex Shader
-	glShaderSource(VertShaderId, 1, &VertexShaderSourcePtr, nullptr); // Chamada a funo que determina os parmetros
-		// dos fontes que sero compilados, recebendo o Id, a quantidade de fontes a serem compilados (neste exemplo apenas 1),
-		// os endereos dos ponteiros e o comprimento da leitura (como utilizamos a funes c_str() ser uma string com 
-		// ponteiro nulo de terminao)
-	glCompileShader(VertShaderId); // Compila todos os Vertex Shaders parametrizados acima
-	CheckShader(VertShaderId);
-
-	std::cout << "Compilando " << FragmentShaderFile << std::endl;
-	const char* FragmentShaderSourcePtr = FragmentShaderSource.c_str();
-	glShaderSource(FragShaderId, 1, &FragmentShaderSourcePtr, nullptr);
-	glCompileShader(FragShaderId);
-	CheckShader(FragShaderId);
-
-	// Feita a compilao dos shaders,  necessrio confeccionar o programa a ser carregado na pipeline.
-	std::cout << "Linkando Programa" << std::endl;
-	GLuint ProgramId = glCreateProgram(); // Elencar abaixo todos os shaders que fazem parte desse programa
-	glAttachShader(ProgramId, VertShaderId);
-	glAttachShader(ProgramId, FragShaderId);
-	glLinkProgram(ProgramId); // Conclui o link entre os shaders compilados acima relacionados
-
-	// Verificar resultado do link
-	GLint Result = GL_TRUE;
-	glGetProgramiv(ProgramId, GL_LINK_STATUS, &Result); // Armazena o status de inicializao em Result
-	
-	if (Result == GL_FALSE) // Obter o log para compreenso do problema
-	{
-		GLint InfoLogLength = 0;
-		glGetProgramiv(ProgramId, GL_INFO_LOG_LENGTH, &InfoLogLength); // Quantidade em bytes a ser alocado na string
-
-		if (InfoLogLength > 0) // Se gerou log de erro, o recupera e exibe em tela
-		{
-			std::string ProgramInfoLog(InfoLogLength, '\0');
-			glGetProgramInfoLog(ProgramId, InfoLogLength, nullptr, &ProgramInfoLog[0]);
-
-			std::cout << "Erro ao linkar programa" << std::endl;
-			std::cout << ProgramInfoLog << std::endl;
-
-			assert(false);
-		}
-	}
-
-	// Como boa prtica, uma vez que utilizamos recursos  bom ilber-los na sequncia
-	// (isso no desfaz o link com o programa aps a compilao, apenas libera o uso dos Ids e pilhas de memria para 
-	//  evitar comportamentos indesejados e sujeiras de memria)
-	glDetachShader(ProgramId, VertShaderId);
-	glDetachShader(ProgramId, FragShaderId);
-
-	glDeleteShader(VertShaderId);
-	glDeleteShader(FragShaderId);
-
-	std::cout << "Programa associado, shaders carregados com sucesso" << std::endl;
-
-	return ProgramId;
-}
-
-// Funo para carregar texturas a partir de arquivos com imagens
-GLuint LoadTexture(const char* TextureFile)
-{
-	std::cout << "Carregando Textura " << TextureFile << std::endl;
-
-	int TextureWidth = 0;
-	int TextureHeight = 0;
-	int NumberOfComponents = 0;
-
-	// Recebe por parmetro um ponteiro para um arquivo, endereos de trs variveis para armazenar os tamanhos da largura
-	//	e da altura da imagem carregada, o nmero de componentes disponvel e por fim  necessrio especificar a quantidade
-	//	de componentes que desejamos retornar (3 = RGB)
-	// Textura em RAM
-	unsigned char* TextureData = stbi_load(TextureFile, &TextureWidth, &TextureHeight, &NumberOfComponents, 3);
-	
-	assert(TextureData); // Caso algo d errado durante o carregamento da textura, interrompe o processamento
-
-	std::cout << "Textura carregada com sucesso" << std::endl;
-
-	// Gerar o Identifador da Textura + procedimento para lev-la para a memria de vdeo
-	GLuint TextureId;
-	glGenTextures(1, &TextureId);
-
-	// Habilita a textura para ser modificada (bind)
-	glBindTexture(GL_TEXTURE_2D, TextureId); // 2D por ser uma imagem
-
-	// Copiar a textura para a memria de vdeo (GPU)
-	// 	   Recebe por parmetro um alvo ou tipo de textura;
-	//	   Um level de texturizao;
-	// 	   Um formato interno de armazenamento da estrutura de dados;
-	// 	   Largura;
-	// 	   Altura;
-	// 	   Uso de bordas;
-	// 	   Formato novamente - para encapsulamento;
-	// 	   Tipo de referncia para os dados carregados - tipo de TextureData (char* = bytes)
-	//	   Ponteiro para os dados (pixels) a serem transferidos para a GPU
-	GLint Level = 0;
-	GLint Border = 0;
-	glTexImage2D(GL_TEXTURE_2D, Level, GL_RGB, TextureWidth, TextureHeight, Border, GL_RGB, GL_UNSIGNED_BYTE, TextureData);
-
-	// Aplicao de filtro de magnificao e minificao
-	// Parametrizao linear para suavizar granulao com aumento de zoom
-	// Mipmap para contornar aliasing da distncia
-	// Configurar o Texture Wrapping - extrapolaes das coordenadas normalizadas da img texturizada nas coordenadas S e T
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glGenerateMipmap(GL_TEXTURE_2D);
-
-	glBindTexture(GL_TEXTURE_2D, 0); // Desligar a textura pois j foi copiada para a GPU
-
-	stbi_image_free(TextureData); // Pode liberar a RAM utilizada
-	return TextureId;
-}
-
-// Funo callback para tratamento de eventos com clique do mouse
-void MouseButtonCallback(GLFWwindow* Window, int Button, int Action, int Modifiers)
-{
-	// std::cout << "Button: " << Button << " Action: " << Action << " Modifiers: " << Modifiers << std::endl;
-
 	if (Button == GLFW_MOUSE_BUTTON_LEFT)
 	{
 		if (Action == GLFW_PRESS) // Ativa a ao do cursor do mouse com clique do boto esquerdo do mouse
 		{
 			glfwSetInputMode(Window, GLFW_CURSOR, GLFW_CURSOR_DISABLED); // Cursor desaparece durante o clique
 
-			double X, Y;
-			glfwGetCursorPos(Window, &X, &Y);
-			
 			Camera.PreviousCursor = glm::vec2{ X, Y };
 			Camera.bEnableMouseMovement = true;
 		}
@@ -304,21 +242,11 @@ void MouseButtonCallback(GLFWwindow* Window, int Button, int Action, int Modifie
 	}
 }
 
-// Funo callback para tratamento de eventos com o movimento do cursor do mouse
-// Essencialmente transmite  cmera as coordenadas X, Y do monitor no ponto em que o cursor se encontra
-void MouseMotionCallback(GLFWwindow* Window, double X, double Y)
-{
-	// std::cout << "X: " << X << " Y: " << Y << std::endl;
-	Camera.MouseMove(X, Y);
-}
-
-// Funo callback para tratamento do movimento da cmera utilizando teclado
+// Tratamento do movimento da cmera utilizando teclado
 // Escape para fechar a janela
 // W,A,S,D para movimentar a cmera para frente, esquerda, trs e direita, respectivamente 
-void KeyCallback(GLFWwindow* Window, int Key, int ScanCode, int Action, int Modifers)
+void ApplyKey(GLFWwindow* Window, int Key, int Action)
 {
-	// std::cout << "Key: " << Key << " ScanCode: " << ScanCode << " Action: " << Action << " Modifiers: " << Modifers << std::endl;	
-
 	if (Action == GLFW_PRESS)
 	{
 		switch (Key)
@@ -343,6 +271,10 @@ void KeyCallback(GLFWwindow* Window, int Key, int ScanCode, int Action, int Modi
 				Camera.MoveRight(1.0f);
 				break;
 
+			case GLFW_KEY_F12:
+				CaptureRequests++;
+				break;
+
 			default:
 				break;
 		}
@@ -377,8 +309,292 @@ void KeyCallback(GLFWwindow* Window, int Key, int ScanCode, int Action, int Modi
 	}
 }
 
-int main()
+// Funes callback dos eventos do mouse e do teclado: s enfileiram o evento, sem tocar na cmera
+void MouseButtonCallback(GLFWwindow* Window, int Button, int Action, int Modifiers)
+{
+	if (bIgnoreWindowInput)
+	{
+		return;
+	}
+
+	InputEvent Event;
+	Event.Type = EInputEventType::MouseButton;
+	Event.Code = Button;
+	Event.Action = Action;
+	glfwGetCursorPos(Window, &Event.X, &Event.Y);
+	QueueInputEvent(Event);
+}
+
+void MouseMotionCallback(GLFWwindow* Window, double X, double Y)
+{
+	if (bIgnoreWindowInput)
+	{
+		return;
+	}
+
+	InputEvent Event;
+	Event.Type = EInputEventType::CursorMove;
+	Event.X = X;
+	Event.Y = Y;
+	QueueInputEvent(Event);
+}
+
+void KeyCallback(GLFWwindow* Window, int Key, int ScanCode, int Action, int Modifers)
+{
+	if (bIgnoreWindowInput)
+	{
+		return;
+	}
+
+	InputEvent Event;
+	Event.Type = EInputEventType::Key;
+	Event.Code = Key;
+	Event.Action = Action;
+	QueueInputEvent(Event);
+}
+
+// Aplica os eventos enfileirados desde a chamada anterior, em ordem. Os movimentos do cursor no giram a cmera um a
+//	um: os deslocamentos so somados e viram uma nica rotao, publicada para o late latching
+void ProcessInput(GLFWwindow* Window)
+{
+	PROFILE_SCOPE("ProcessInput");
+
+	glm::vec2 Rotation{ 0.0f };
+	uint64_t LastCursorEvent = 0;
+
+	PendingInput.Drain([&](const InputEvent& Event)
+	{
+		switch (Event.Type)
+		{
+			case EInputEventType::CursorMove:
+				Rotation += Camera.ConsumeCursor(static_cast<float>(Event.X), static_cast<float>(Event.Y));
+				LastCursorEvent = Event.Number;
+				break;
+
+			case EInputEventType::MouseButton:
+				ApplyMouseButton(Window, Event.Code, Event.Action, Event.X, Event.Y);
+				break;
+
+			case EInputEventType::Key:
+				ApplyKey(Window, Event.Code, Event.Action);
+				break;
+
+			default:
+				break;
+		}
+		AppliedInputEvent = Event.Number;
+	});
+
+	if (LastCursorEvent != 0)
+	{
+		Camera.Rotate(Rotation);
+
+		CameraOrientation& Orientation = LatestOrientation.GetWriteBuffer();
+		Orientation.Direction = Camera.Direction;
+		Orientation.Up = Camera.Up;
+		Orientation.InputEvent = AppliedInputEvent;
+		LatestOrientation.Publish();
+	}
+}
+
+// Converte os vrtices da esfera para o formato compactado (a esfera tem raio 1, dentro do intervalo dos normalizados)
+std::vector<PackedVertex> PackVertices(const std::vector<Vertex>& Vertices)
+{
+	std::vector<PackedVertex> Packed;
+	Packed.reserve(Vertices.size());
+
+	for (const Vertex& Source : Vertices)
+	{
+		PackedVertex Target;
+		for (int Component = 0; Component < 3; ++Component)
+		{
+			Target.Position[Component] = static_cast<int16_t>(glm::round(glm::clamp(Source.Position[Component], -1.0f, 1.0f) * 32767.0f));
+		}
+		Target.Position[3] = 0;
+		Target.UV[0] = static_cast<uint16_t>(glm::round(glm::clamp(Source.UV.x, 0.0f, 1.0f) * 65535.0f));
+		Target.UV[1] = static_cast<uint16_t>(glm::round(glm::clamp(Source.UV.y, 0.0f, 1.0f) * 65535.0f));
+		Packed.push_back(Target);
+	}
+
+	return Packed;
+}
+
+// Localizaes dos uniforms atualizados a cada frame fora do bloco FrameUniforms. So lidas da tabela de reflexo
+//	quando o programa muda, nunca por nome dentro do lao de renderizao
+struct FrameUniformLocations
+{
+	GLint CloudsSeriesLayers = -1;
+	GLint CloudsSeriesBlend = -1;
+	GLint DrawTint = -1;
+};
+
+FrameUniformLocations GetFrameUniformLocations(const ShaderReflection* Reflection)
+{
+	FrameUniformLocations Locations;
+	if (Reflection)
+	{
+		Locations.CloudsSeriesLayers = Reflection->GetLocation("CloudsSeriesLayers");
+		Locations.CloudsSeriesBlend = Reflection->GetLocation("CloudsSeriesBlend");
+		Locations.DrawTint = Reflection->GetLocation("DrawTint");
+		ValidateFrameUniformLayout(*Reflection);
+	}
+	return Locations;
+}
+
+// Verifica se uma opo foi passada na linha de comando (ex.: --compress-textures)
+bool HasArgument(int argc, char** argv, const char* Option)
+{
+	for (int ArgIndex = 1; ArgIndex < argc; ++ArgIndex)
+	{
+		if (std::strcmp(argv[ArgIndex], Option) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Retorna o valor que segue uma opo da linha de comando (ex.: --vram-budget 256), ou nullptr se ela no foi passada
+const char* GetArgumentValue(int argc, char** argv, const char* Option)
+{
+	for (int ArgIndex = 1; ArgIndex + 1 < argc; ++ArgIndex)
+	{
+		if (std::strcmp(argv[ArgIndex], Option) == 0)
+		{
+			return argv[ArgIndex + 1];
+		}
+	}
+	return nullptr;
+}
+
+int main(int argc, char** argv)
 {	
+	// Reproduo de um log do gerenciador de memria de vdeo: no precisa de janela nem de GPU
+	if (const char* ReplayFile = GetArgumentValue(argc, argv, "--replay-residency"))
+	{
+		std::ifstream ReplayStream{ ReplayFile };
+		if (!ReplayStream)
+		{
+			std::cout << "Erro ao abrir " << ReplayFile << std::endl;
+			return 1;
+		}
+		return ReplayResidencyLog(ReplayStream, std::cout) ? 0 : 1;
+	}
+
+	// Trace sinttico de tempos de GPU reproduzido no controlador da resoluo dinmica (ex.: para ajustar a histerese)
+	if (const char* TraceFile = GetArgumentValue(argc, argv, "--replay-resolution"))
+	{
+		std::ifstream TraceStream{ TraceFile };
+		if (!TraceStream)
+		{
+			std::cout << "Erro ao abrir " << TraceFile << std::endl;
+			return 1;
+		}
+		return ReplayResolutionTrace(TraceStream, DynamicResolutionSettings{}, std::cout) ? 0 : 1;
+	}
+
+	// Gravao e reproduo de listas de comandos no backend nulo: tambm dispensa janela e GPU
+	if (HasArgument(argc, argv, "--command-list-benchmark"))
+	{
+		const char* DrawArgument = GetArgumentValue(argc, argv, "--command-list-benchmark");
+		const int DrawCount = DrawArgument ? std::atoi(DrawArgument) : 0;
+		RunCommandListBenchmark(DrawCount > 0 ? DrawCount : 20000, std::cout);
+		return 0;
+	}
+
+	// --replay-input <arquivo>: reproduz uma gravao de --record-input sem ningum na frente da janela. O relgio da
+	//	simulao deixa de ser o tempo real e avana --replay-step segundos (1/60 por padro) a cada frame, ento toda
+	//	reproduo aplica os mesmos eventos nos mesmos passos e percorre a mesma trajetria da cmera
+	InputPlayback Playback;
+	if (const char* ReplayInputFile = GetArgumentValue(argc, argv, "--replay-input"))
+	{
+		if (!Playback.Open(ReplayInputFile))
+		{
+			return 1;
+		}
+		bReplayingInput = true;
+	}
+
+	// --benchmark [caminho]: a cmera segue o caminho (keyframes de CameraPath; sem arquivo, uma volta em torno do globo)
+	//	por --benchmark-warmup frames parada no incio e --benchmark-frames frames medidos, sem V-Sync. Os percentis vo
+	//	para <--benchmark-output>.csv e .json ("benchmark" por padro); com --benchmark-baseline <csv>, o programa termina
+	//	com cdigo 2 se o p50 ou o p95 de alguma mtrica passar do baseline mais --benchmark-threshold (0.1 = 10%)
+	std::unique_ptr<FrameBenchmark> PathBenchmark;
+	if (HasArgument(argc, argv, "--benchmark"))
+	{
+		CameraPath Path = CameraPath::MakeDefaultOrbit();
+		const char* PathFile = GetArgumentValue(argc, argv, "--benchmark");
+		if (PathFile && std::strncmp(PathFile, "--", 2) != 0)
+		{
+			std::ifstream PathStream{ PathFile };
+			if (!PathStream)
+			{
+				std::cout << "Erro ao abrir " << PathFile << std::endl;
+				return 1;
+			}
+			if (!Path.Load(PathStream))
+			{
+				return 1;
+			}
+		}
+
+		FrameBenchmarkSettings Settings;
+		if (const char* FramesArgument = GetArgumentValue(argc, argv, "--benchmark-frames"))
+		{
+			Settings.MeasuredFrames = std::atoi(FramesArgument);
+		}
+		if (const char* WarmupArgument = GetArgumentValue(argc, argv, "--benchmark-warmup"))
+		{
+			Settings.WarmupFrames = std::atoi(WarmupArgument);
+		}
+		if (const char* ThresholdArgument = GetArgumentValue(argc, argv, "--benchmark-threshold"))
+		{
+			Settings.RegressionThreshold = std::max(0.0, std::atof(ThresholdArgument));
+		}
+		PathBenchmark = std::make_unique<FrameBenchmark>(Path, Settings);
+	}
+	bIgnoreWindowInput = bReplayingInput || PathBenchmark;
+
+	// --profile <arquivo.json>: grava os marcadores de CPU (por thread) e de GPU desde a inicializao e, ao fechar,
+	//	exporta um trace para o about:tracing do Chrome ou o ui.perfetto.dev
+	const char* ProfileFile = GetArgumentValue(argc, argv, "--profile");
+
+	// --flight-recorder [ms]: o profiler grava sempre e os ltimos --flight-window segundos (5) de eventos e contadores
+	//	ficam em memria. Um frame acima do limite (50 ms por padro) grava hitch_<frame>.json e .txt, com a memria e a
+	//	residncia das texturas; depois disso, --flight-cooldown segundos (30) sem novas gravaes
+	std::unique_ptr<FlightRecorder> Flight;
+	if (HasArgument(argc, argv, "--flight-recorder"))
+	{
+		FlightRecorderSettings Settings;
+		const char* HitchArgument = GetArgumentValue(argc, argv, "--flight-recorder");
+		if (HitchArgument && std::atof(HitchArgument) > 0.0)
+		{
+			Settings.HitchSeconds = std::atof(HitchArgument) / 1000.0;
+		}
+		if (const char* WindowArgument = GetArgumentValue(argc, argv, "--flight-window"))
+		{
+			Settings.WindowSeconds = std::max(0.1, std::atof(WindowArgument));
+		}
+		if (const char* CooldownArgument = GetArgumentValue(argc, argv, "--flight-cooldown"))
+		{
+			Settings.CooldownSeconds = std::max(0.0, std::atof(CooldownArgument));
+		}
+		Flight = std::make_unique<FlightRecorder>(Settings);
+
+		// O gravador consome os eventos do profiler  medida que eles saem da janela: no sobra nada para exportar
+		if (ProfileFile)
+		{
+			std::cout << "--profile ignorado com --flight-recorder" << std::endl;
+			ProfileFile = nullptr;
+		}
+	}
+
+	if (ProfileFile || Flight)
+	{
+		GetProfiler().Start();
+		GetProfiler().SetThreadName("Main");
+	}
+
 	if (!glfwInit())
 	{
 		std::cout << "Erro ao inicializar o GLFW" << std::endl;
@@ -386,6 +602,14 @@ int main()
 	}
 
 	glfwWindowHint(GLFW_DEPTH_BITS, 32);
+	glfwWindowHint(GLFW_SRGB_CAPABLE, GLFW_TRUE); // As texturas de cor so sRGB: o framebuffer converte o resultado linear
+
+	// --hidden: janela invisvel, para reprodues e benchmarks. A cena continua sendo desenhada nas texturas do grafo
+	//	de renderizao, ento as capturas (F12 gravado ou Capture) funcionam normalmente
+	if (HasArgument(argc, argv, "--hidden"))
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
 
 	// Criar uma janela:
 	// Recebe como parmetros a largura e altura da janela, um ttulo, um monitor (caso haja mais de um) e um 
@@ -407,7 +631,7 @@ int main()
 	// Ativa o contexto criado na janela Window:
 	//	Associa um objeto GLFW a um contexto, para que o GLEW possa inicializar com referncia para esse contexto
 	glfwMakeContextCurrent(Window);
-	glfwSwapInterval(1); // Habilita ou desabilita o V-Sync
+	glfwSwapInterval(bReplayingInput || PathBenchmark ? 0 : 1); // Habilita ou desabilita o V-Sync (desligado nas reprodues e no benchmark, que medem o tempo de frame)
 
 	// Inicializar a biblioteca GLEW (deve ser criada aps a janela, pois  necessrio um contexto de 
 	//	OpenGL para que a API do OpenGL possa apontar)
@@ -418,6 +642,11 @@ int main()
 		return 1;
 	}
 
+	if (GetProfiler().IsRecording())
+	{
+		GetGpuProfiler().Create();
+	}
+
 	// Verificar a verso do OpenGL
 	GLint GLMajorVersion = 0;
 	GLint GLMinorVersion = 0;
@@ -429,30 +658,79 @@ int main()
 	std::cout << "OpenGL Version  : " << glGetString(GL_VERSION) << std::endl;
 	std::cout << "GLSL Version    : " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
 
+	// Os estados do OpenGL passam pelo cache de estados, que no repete chamadas sem efeito
+	GLStateCache& StateCache = GetGLStateCache();
+
 	// Habilita o Buffer de Profundidade (Z-buffer)
-	glEnable(GL_DEPTH_TEST);
+	StateCache.SetCapability(GL_DEPTH_TEST, true);
 
 	// Escolhe a funo de teste de profundidade.
-	glDepthFunc(GL_ALWAYS);
+	StateCache.SetDepthFunc(GL_ALWAYS);
 
 	// Otimizao de processamento: habilitar o Back Face Culling - no renderiza a face traseira dos objetos
-	glDisable(GL_CULL_FACE);
-	glEnable(GL_CULL_FACE);
-
-	// Compilar o vertex e o fragment shader
-	GLuint ProgramId = LoadShaders("shaders/triangle_vert.glsl", "shaders/triangle_frag.glsl");
+	StateCache.SetCapability(GL_CULL_FACE, true);
+
+	// A iluminao  calculada em espao linear; a converso para sRGB acontece na escrita do framebuffer
+	StateCache.SetCapability(GL_FRAMEBUFFER_SRGB, true);
+
+	// Os programas so variantes compiladas por mscara de recursos (ou carregadas do cache de binrios;
+	//	--no-shader-cache desliga). A variante usada  escolhida depois que as texturas definem os recursos disponveis
+	GetShaderProgramCache().SetEnabled(!HasArgument(argc, argv, "--no-shader-cache"));
+	// Os shaders so lidos da pasta do cdigo-fonte quando ela existe: a cpia na pasta da build s  atualizada ao
+	//	compilar, ento a recarga no veria as edies
+	std::string ShaderDirectory = "shaders";
+#ifdef BLUEMARBLE_SHADER_SOURCE_DIR
+	if (std::filesystem::is_directory(BLUEMARBLE_SHADER_SOURCE_DIR))
+	{
+		ShaderDirectory = BLUEMARBLE_SHADER_SOURCE_DIR;
+	}
+#endif
+	ShaderLibrary Shaders{ (ShaderDirectory + "/triangle_vert.glsl").c_str(), (ShaderDirectory + "/triangle_frag.glsl").c_str() };
+
+	// Rotao das nuvens em voltas por segundo: o shader desloca a textura e o redesenho sob demanda estima quando o
+	//	deslocamento chega a um pixel, os dois a partir desta constante
+	constexpr double CloudsRotationSpeed = 0.008;
+	Shaders.SetDefine("CLOUDS_ROTATION_SPEED", "vec2(" + std::to_string(CloudsRotationSpeed) + ", 0.0)");
+
+	// Unidades de textura fixas, gravadas em cada programa logo aps o link. Samplers de tipos diferentes (sampler2D,
+	//	samplerCube e sampler2DArray) precisam de unidades diferentes
+	Shaders.SetSamplerUnit("EarthTexture", 0);
+	Shaders.SetSamplerUnit("CloudsTexture", 1);
+	Shaders.SetSamplerUnit("EarthCubeMap", 2);
+	Shaders.SetSamplerUnit("CloudsCubeMap", 3);
+	Shaders.SetSamplerUnit("CloudsSeries", 4);
+	Shaders.SetSamplerUnit("NightLightsTexture", 5);
+	Shaders.SetUniformBlockBinding("FrameUniforms", FrameUniformsBinding);
+	Shaders.SetUniformBlockBinding("MaterialPalette", MaterialPaletteBinding);
+	Shaders.SetStorageBlockBinding("PatchDrawBuffer", PatchDrawDataBinding);
+
+	// Bloco de uniforms da cmera e da iluminao, enviado uma vez por frame
+	// Mapeado: as matrizes da cmera so escritas direto na memria do buffer, no ltimo momento antes dos draws
+	UniformBuffer FrameUniforms;
+	FrameUniforms.Create(FrameUniformsBinding, sizeof(FrameUniformData), true);
 
 	// Gera a Geometria da esfera e copia os dados para a GPU (memria da placa de vdeo)
+	//	Com --packed-vertices o VBO recebe os vrtices compactados (PackedVertex)
+	const bool bPackedVertices = HasArgument(argc, argv, "--packed-vertices");
 	std::vector<Vertex> SphereVertices;
 	std::vector<Triangle> SphereIndices;
-	GenerateSphere(100, SphereVertices, SphereIndices);
+	const GLuint SphereResolution = 100;
+	GenerateSphere(SphereResolution, SphereVertices, SphereIndices);
 	GLuint SphereVertexBuffer, SphereElementBuffer; // VBO e EBO (Vertex e Element Buffer Objects)
 	glGenBuffers(1, &SphereVertexBuffer); // Pedir para o OpenGL gerar o identificador do VBO e do EBO
 	glGenBuffers(1, &SphereElementBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, SphereVertexBuffer); // Linkar/ativar o buffer ao seu tipo para o OpenGL
+	StateCache.BindBuffer(GL_ARRAY_BUFFER, SphereVertexBuffer); // Linkar/ativar o buffer ao seu tipo para o OpenGL
 	// Copia efetivamente do buffer (memria RAM) para a GPU (memria de vdeo)
-	glBufferData(GL_ARRAY_BUFFER, SphereVertices.size() * sizeof(Vertex), SphereVertices.data(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, SphereElementBuffer);	
+	if (bPackedVertices)
+	{
+		std::vector<PackedVertex> PackedSphereVertices = PackVertices(SphereVertices);
+		glBufferData(GL_ARRAY_BUFFER, PackedSphereVertices.size() * sizeof(PackedVertex), PackedSphereVertices.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, SphereVertices.size() * sizeof(Vertex), SphereVertices.data(), GL_STATIC_DRAW);
+	}
+	StateCache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, SphereElementBuffer);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, SphereIndices.size() * sizeof(Triangle), SphereIndices.data(), GL_STATIC_DRAW);
 
 	// Criar uma fonte de luz direcional
@@ -464,9 +742,199 @@ int main()
 	glm::mat4 ModelMatrix = glm::rotate(glm::identity<glm::mat4>(), glm::radians(90.0f), glm::vec3{ 1.0f, 0.0f, 0.0f });
 
 	// Carregar as texturas para a memria de vdeo
-	//GLuint EarthTextureId = LoadTexture("textures/earth_2k.jpg");
-	GLuint EarthTextureId = LoadTexture("textures/earth5400x2700.jpg");
-	GLuint CloudsTextureId = LoadTexture("textures/earth_clouds_2k.jpg");
+	// Cada textura possui nveis de resoluo: o menor  carregado agora, para um primeiro frame rpido, e os maiores
+	//	so decodificados em segundo plano e trocados conforme o tamanho do globo projetado na tela
+	// O formato na GPU  escolhido pela anlise dos canais: a Terra  cor (sRGB) e as nuvens, uma mscara cinza (R8).
+	//	Com --compress-textures os formatos comprimidos (BC1/BC4) so usados quando o driver suporta S3TC
+	TextureFormatOptions EarthFormat;
+	EarthFormat.Usage = ETextureUsage::Color;
+	EarthFormat.bAllowCompression = HasArgument(argc, argv, "--compress-textures") && GLEW_EXT_texture_compression_s3tc;
+
+	TextureFormatOptions CloudsFormat = EarthFormat;
+	CloudsFormat.Usage = ETextureUsage::Mask;
+
+	// Oramento de memria de vdeo das texturas (em MB) e log opcional das decises de residncia
+	TextureResidencyManager& Residency = GetTextureResidency();
+	std::ofstream ResidencyLog;
+	if (const char* LogFile = GetArgumentValue(argc, argv, "--residency-log"))
+	{
+		ResidencyLog.open(LogFile);
+		Residency.SetLog(&ResidencyLog);
+	}
+	size_t BudgetMegabytes = 512;
+	if (const char* BudgetArgument = GetArgumentValue(argc, argv, "--vram-budget"))
+	{
+		BudgetMegabytes = std::strtoull(BudgetArgument, nullptr, 10);
+	}
+	Residency.SetBudget(BudgetMegabytes * 1024u * 1024u);
+
+	// --cubemap: as texturas equiretangulares so reprojetadas em cube maps, com densidade de texels uniforme no globo
+	const bool bUseCubeMaps = HasArgument(argc, argv, "--cubemap");
+	if (bUseCubeMaps)
+	{
+		// Filtragem entre faces vizinhas, evitando costuras nas arestas do cubo
+		StateCache.SetCapability(GL_TEXTURE_CUBE_MAP_SEAMLESS, true);
+	}
+
+	TextureStreamer Streamer;
+	StreamedTexture EarthTexture{ "Terra", { "textures/earth_2k.jpg", "textures/earth5400x2700.jpg" }, EarthFormat };
+	StreamedTexture CloudsTexture{ "Nuvens", { "textures/earth_clouds_2k.jpg" }, CloudsFormat };
+	EarthTexture.bCubeMap = bUseCubeMaps;
+	CloudsTexture.bCubeMap = bUseCubeMaps;
+	EarthTexture.LoadBaseTier();
+	CloudsTexture.LoadBaseTier();
+
+	// Prefetch dos nveis de resoluo a partir da trajetria prevista da cmera (--prefetch-horizon 0 desliga)
+	PrefetchScheduler Prefetcher;
+	Prefetcher.Register(EarthTexture);
+	Prefetcher.Register(CloudsTexture);
+	if (const char* HorizonArgument = GetArgumentValue(argc, argv, "--prefetch-horizon"))
+	{
+		Prefetcher.Horizon = static_cast<float>(std::atof(HorizonArgument));
+	}
+
+	// --clouds-series <manifesto>: nuvens animadas a partir de uma sequncia de rasters (ex.: um por hora)
+	//	--series-speed <horas por segundo> e --series-policy hold|skip controlam a reproduo
+	std::unique_ptr<TextureStreamer> SeriesStreamer;
+	std::unique_ptr<TimeSeriesLayer> CloudsSeries;
+	if (const char* SeriesManifest = GetArgumentValue(argc, argv, "--clouds-series"))
+	{
+		std::vector<TimeSeriesFrame> SeriesFrames;
+		if (LoadTimeSeriesManifest(SeriesManifest, SeriesFrames))
+		{
+			CloudsSeries = std::make_unique<TimeSeriesLayer>("Nuvens", SeriesFrames, CloudsFormat);
+
+			if (const char* SpeedArgument = GetArgumentValue(argc, argv, "--series-speed"))
+			{
+				CloudsSeries->PlaybackSpeed = static_cast<float>(std::atof(SpeedArgument));
+			}
+
+			const char* PolicyArgument = GetArgumentValue(argc, argv, "--series-policy");
+			if (PolicyArgument && std::strcmp(PolicyArgument, "skip") == 0)
+			{
+				CloudsSeries->Policy = ETimeSeriesPolicy::Skip;
+			}
+
+			if (CloudsSeries->Load())
+			{
+				// Threads prprias: a srie no disputa a fila com o streaming dos nveis de resoluo
+				SeriesStreamer = std::make_unique<TextureStreamer>(2);
+			}
+			else
+			{
+				CloudsSeries.reset();
+			}
+		}
+	}
+	// --night-lights <arquivo>: luzes das cidades no lado escuro do globo
+	GLuint NightLightsTextureId = 0;
+	if (const char* NightLightsFile = GetArgumentValue(argc, argv, "--night-lights"))
+	{
+		NightLightsTextureId = LoadTexture(NightLightsFile, EarthFormat);
+	}
+	PrintTextureMemoryReport(std::cout);
+
+	// Recursos do shader: --no-clouds e --no-specular desligam as nuvens e o brilho especular; os demais seguem as opes
+	//	acima. Cada combinao  um programa prprio, sem custo algum para os recursos desligados
+	uint32_t ShaderFeatures = 0;
+	ShaderFeatures |= HasArgument(argc, argv, "--no-clouds") ? 0u : static_cast<uint32_t>(EShaderFeature::Clouds);
+	ShaderFeatures |= HasArgument(argc, argv, "--no-specular") ? 0u : static_cast<uint32_t>(EShaderFeature::Specular);
+	ShaderFeatures |= NightLightsTextureId != 0 ? static_cast<uint32_t>(EShaderFeature::NightLights) : 0u;
+	ShaderFeatures |= bPackedVertices ? static_cast<uint32_t>(EShaderFeature::PackedVertices) : 0u;
+	ShaderFeatures |= bUseCubeMaps ? static_cast<uint32_t>(EShaderFeature::CubeMap) : 0u;
+	ShaderFeatures |= CloudsSeries ? static_cast<uint32_t>(EShaderFeature::CloudsSeries) : 0u;
+
+	// --instances <n>: o globo e mais n - 1 corpos orbitando, todos com a mesma malha em um nico draw instanciado.
+	//	--instance-benchmark varre quantidades crescentes de instncias (sem V-Sync), imprime o tempo de envio e encerra
+	std::unique_ptr<InstanceBenchmark> Benchmark;
+	int InstanceCount = 0;
+	if (const char* InstancesArgument = GetArgumentValue(argc, argv, "--instances"))
+	{
+		InstanceCount = std::atoi(InstancesArgument);
+	}
+	if (HasArgument(argc, argv, "--instance-benchmark"))
+	{
+		// Cada instncia tem os ~20 mil tringulos da esfera: acima de 10 mil o custo da GPU domina qualquer medida
+		Benchmark = std::make_unique<InstanceBenchmark>(std::vector<int>{ 1, 10, 100, 1000, 5000, 10000 }, 60);
+		InstanceCount = 10000;
+		glfwSwapInterval(0);
+	}
+
+	InstancedBodies Bodies;
+	if (InstanceCount > 0)
+	{
+		Bodies.Create(InstanceCount);
+		ShaderFeatures |= EShaderFeature::Instanced;
+
+		// Com vrios corpos na cena o teste de profundidade passa a ser necessrio
+		StateCache.SetDepthFunc(GL_LESS);
+	}
+
+	// --patches <n>: o globo  dividido em n x n patches; os visveis (frustum e lado voltado para a cmera) so montados
+	//	em comandos de desenho a cada frame e enviados em um nico glMultiDrawElementsIndirect quando o driver suporta.
+	//	--no-multi-draw fora o lao de glDrawElementsBaseVertex e --show-patches pinta cada patch de uma cor.
+	//	Os corpos instanciados usam a esfera inteira, ento --instances desliga os patches
+	int PatchesPerSide = 0;
+	if (const char* PatchesArgument = GetArgumentValue(argc, argv, "--patches"))
+	{
+		PatchesPerSide = InstanceCount > 0 ? 0 : std::atoi(PatchesArgument);
+	}
+
+	std::vector<GLuint> PatchIndices;
+	std::vector<DrawBatchItem> Patches;
+	DrawCommandBuilder PatchCommandBuilder;
+	std::vector<DrawElementsIndirectCommand> PatchCommands;
+	DrawBatcher PatchBatcher;
+	if (PatchesPerSide > 0)
+	{
+		std::vector<glm::vec3> SpherePositions;
+		SpherePositions.reserve(SphereVertices.size());
+		for (const Vertex& SphereVertex : SphereVertices)
+		{
+			SpherePositions.push_back(SphereVertex.Position);
+		}
+		BuildSpherePatches(SpherePositions, SphereResolution, PatchesPerSide, PatchIndices, Patches);
+
+		PatchBatcher.Create(MakePatchDrawData(Patches.size(), HasArgument(argc, argv, "--show-patches")), !HasArgument(argc, argv, "--no-multi-draw"));
+		ShaderFeatures |= EShaderFeature::Patches;
+		ShaderFeatures |= PatchBatcher.IsUsingMultiDrawIndirect() ? static_cast<uint32_t>(EShaderFeature::MultiDrawIndirect) : 0u;
+
+		std::cout << "Globo dividido em " << Patches.size() << " patches, comandos montados em at "
+				  << PatchCommandBuilder.GetNumThreads() << " threads" << std::endl;
+	}
+
+	// --precompile-shaders: compila (ou aquece o cache com) de uma vez, em paralelo quando possvel, a variante desta
+	//	execuo e as que --no-clouds e --no-specular selecionariam com os mesmos recursos. Os demais bits dependem das
+	//	texturas e da malha carregadas, ento nenhuma outra combinao seria pedida
+	if (HasArgument(argc, argv, "--precompile-shaders"))
+	{
+		const uint32_t OptionalFeatures = EShaderFeature::Clouds | EShaderFeature::Specular;
+		std::vector<uint32_t> FeatureSets;
+		for (uint32_t Subset = OptionalFeatures;; Subset = (Subset - 1) & OptionalFeatures)
+		{
+			FeatureSets.push_back((ShaderFeatures & ~OptionalFeatures) | Subset);
+			if (Subset == 0)
+			{
+				break;
+			}
+		}
+		Shaders.Precompile(FeatureSets);
+	}
+
+	// Um erro nos shaders no encerra a aplicao: o globo no  desenhado at que a recarga encontre um programa vlido
+	GLuint ProgramId = Shaders.GetProgram(ShaderFeatures);
+	if (ProgramId == 0)
+	{
+		std::cout << "Erro ao compilar a variante " << GetShaderFeatureName(ShaderFeatures) << " dos shaders" << std::endl;
+	}
+	FrameUniformLocations UniformLocations = GetFrameUniformLocations(Shaders.GetReflection(ShaderFeatures));
+
+	// Recarga dos shaders ao salvar qualquer arquivo da pasta de onde eles so lidos (--no-shader-watch desliga)
+	std::unique_ptr<ShaderWatcher> ShaderWatch;
+	if (!HasArgument(argc, argv, "--no-shader-watch"))
+	{
+		ShaderWatch = std::make_unique<ShaderWatcher>(ShaderDirectory.c_str());
+	}
 
 	// Configura a cor de fundo
 	// **Ter em mente que o OpenGL  uma mquina de estados (quando ativarmos algo, essa coisa permanecer ativa por padro)
@@ -481,129 +949,898 @@ int main()
 	glGenVertexArrays(1, &SphereVAO);
 
 	// Habilita o VAO
-	glBindVertexArray(SphereVAO);
-
-	// Ativa o atributo de vrtice para o array. O parmetro representa o ndice (location) do layout do shader ativo
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
+	StateCache.BindVertexArray(SphereVAO);
 
 	// Ativa os buffers de vrtice e de elemento para serem utilizados no contexto OpenGL 
-	glBindBuffer(GL_ARRAY_BUFFER, SphereVertexBuffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, SphereElementBuffer);
-
-	// Informa ao OpenGL onde os vrtices se encontram dentro do VertexBuffer. 
-	//  [0;3] so os ndices habilitados, coincidindo com os especificados em glEnableVertexAttribArray() / location nos shaders
-	//	[2;3] so as dimenses (qtd) de vrtices das estruturas de dados utilizadas (vec2 e vec3)
-	//	GL_FLOAT  o tipo primitivo
-	//  GL_FALSE / GL_TRUE para informar se os atributos esto normalizados ou no 
-	//	stride - tamanho do Vertex (struct) que definimos
-	//	offset - para position  nulo, para color e os demais  calculado. O cast  necessrio para compatibilizar o retorno
-	//		     do mtodo offsetof com o parmetro recebido pela funo glVertexAttribPointer
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Normal)));
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Color)));
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, UV)));	
+	StateCache.BindBuffer(GL_ARRAY_BUFFER, SphereVertexBuffer);
+	StateCache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, SphereElementBuffer);
+
+	if (bPackedVertices)
+	{
+		// Apenas posio e UV: inteiros normalizados (GL_TRUE) so convertidos para float em [-1;1] e [0;1] na leitura
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), nullptr);
+		glVertexAttribPointer(3, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, UV)));
+	}
+	else
+	{
+		// Ativa o atributo de vrtice para o array. O parmetro representa o ndice (location) do layout do shader ativo
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+		glEnableVertexAttribArray(3);
+
+		// Informa ao OpenGL onde os vrtices se encontram dentro do VertexBuffer. 
+		//  [0;3] so os ndices habilitados, coincidindo com os especificados em glEnableVertexAttribArray() / location nos shaders
+		//	[2;3] so as dimenses (qtd) de vrtices das estruturas de dados utilizadas (vec2 e vec3)
+		//	GL_FLOAT  o tipo primitivo
+		//  GL_FALSE / GL_TRUE para informar se os atributos esto normalizados ou no 
+		//	stride - tamanho do Vertex (struct) que definimos
+		//	offset - para position  nulo, para color e os demais  calculado. O cast  necessrio para compatibilizar o retorno
+		//		     do mtodo offsetof com o parmetro recebido pela funo glVertexAttribPointer
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Normal)));
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, Color)));
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, UV)));	
+	}
+
+	// Os atributos por instncia leem o buffer de instncias, no mesmo VAO da malha
+	if (InstanceCount > 0)
+	{
+		Bodies.SetupInstanceAttributes();
+	}
+
+	// Com patches os mesmos tringulos so reordenados no index buffer, um intervalo contguo por patch
+	if (PatchesPerSide > 0)
+	{
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, PatchIndices.size() * sizeof(GLuint), PatchIndices.data());
+		PatchBatcher.SetupDrawIndexAttribute();
+	}
 
 	// Disabilitar o VAO
-	glBindVertexArray(0);
+	StateCache.BindVertexArray(0);
 
-	double PreviousTime = glfwGetTime(); // Tempo do frame anterior
+	double PreviousTime = glfwGetTime(); // Incio da simulao
+	uint64_t FrameIndex = 0;
 
-	// Entra no loop de eventos da aplicao tendo a janela fechada como condio de parada
-	while (!glfwWindowShouldClose(Window))
-	{	
-		// Calcula o Delta Time para suavizao da movimentao da cmera
-		double CurrentTime = glfwGetTime();
-		double DeltaTime = CurrentTime - PreviousTime;
-		if (DeltaTime > 0.0)
-		{
-			Camera.Update(static_cast<float>(DeltaTime));
-			PreviousTime = CurrentTime;
-		}		
+	// --sim-rate <hz>: frequncia dos passos fixos da simulao (120 por padro). O frame desenha a cmera interpolada
+	//	entre os dois ltimos passos, ento a variao do tempo de frame no vira tremor no movimento
+	double SimulationRate = 120.0;
+	if (const char* RateArgument = GetArgumentValue(argc, argv, "--sim-rate"))
+	{
+		SimulationRate = std::max(1.0, std::atof(RateArgument));
+	}
+	FixedStepClock SimulationClock{ 1.0 / SimulationRate };
+	SimulationClock.Reset(bReplayingInput ? 0.0 : PreviousTime);
 
-		// Ativa o bit do buffer que realiza a limpeza dos buffers de cor e de profundidade
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
+	double ReplayStep = 1.0 / 60.0;
+	if (const char* StepArgument = GetArgumentValue(argc, argv, "--replay-step"))
+	{
+		ReplayStep = std::max(1e-4, std::atof(StepArgument));
+	}
+	uint64_t ReplayFrames = 0;
+	uint64_t TrajectoryHash = 14695981039346656037ull; // FNV-1a das cmeras de todos os frames da reproduo
 
-		glUseProgram(ProgramId); // Ativa o programa de shaders
-		
-		// Clculos matriciais para determinao da Matriz Normal (utilizada para a iluminao) e para a Model View Projection
-		// MVP (utilizada para transladar, rotacionar e escalar os objetos no espao euclidiano)
-		glm::mat4 ViewMatrix = Camera.GetView();
-		glm::mat4 NormalMatrix = glm::transpose(glm::inverse(ViewMatrix * ModelMatrix));
-		glm::mat4 ModelViewMatrix = ViewMatrix * ModelMatrix;
-		glm::mat4 ModelViewProjectionMatrix = Camera.GetViewProjection() * ModelMatrix;
+	const char* RecordInputFile = GetArgumentValue(argc, argv, "--record-input");
+	if (RecordInputFile && !bReplayingInput)
+	{
+		InputRecording.Open(RecordInputFile, PreviousTime);
+	}
+	glm::vec3 PreviousCameraLocation = Camera.Location; // Posio no passo anterior ao ltimo
 
-		// Abaixo recuperao dos uniformes calculados pelos shaders
-		GLint TimeLoc = glGetUniformLocation(ProgramId, "Time");
-		glUniform1f(TimeLoc, CurrentTime);
+	// --fps <n>: limita a apresentao a n frames por segundo, abaixo da taxa do V-Sync
+	FramePacer Pacer;
+	if (const char* FpsArgument = GetArgumentValue(argc, argv, "--fps"))
+	{
+		Pacer.SetTargetFrameRate(std::atof(FpsArgument));
+	}
 
-		GLint NormalMatrixLoc = glGetUniformLocation(ProgramId, "NormalMatrix");
-		glUniformMatrix4fv(NormalMatrixLoc, 1, GL_FALSE, glm::value_ptr(NormalMatrix));
+	// Valores do frame atual, lidos pelos passes do grafo de renderizao
+	double CurrentTime = PreviousTime;
+	double DeltaTime = 0.0;
+	double PreviousFrameTime = SimulationClock.GetInterpolatedTime();
+	glm::mat4 ModelViewMatrix = glm::identity<glm::mat4>();
+	glm::mat4 ModelViewProjectionMatrix = glm::identity<glm::mat4>();
+	uint32_t CapturedRequests = 0;
+
+	// Grafo de renderizao: o globo  desenhado em texturas transientes do tamanho da janela e copiado para ela no passe
+	//	Present. O passe Capture s  mantido no frame em que o F12 pede a captura; nos demais ele  descartado na
+	//	compilao, e as texturas continuam as mesmas porque voltam ao pool com a mesma descrio
+	FrameGraph Graph;
+	TransientTexturePool RenderTargetPool;
+
+	// --dynamic-resolution: a cena  desenhada em uma frao das texturas transientes, escolhida a cada frame pelo tempo
+	//	de GPU do passe Globe (consultas GL_TIME_ELAPSED) para caber em --gpu-budget ms (14 por padro). O passe Present
+	//	amplia o resultado para a janela e desenha o HUD (tambm com --hud) na resoluo nativa
+	const bool bDynamicResolution = HasArgument(argc, argv, "--dynamic-resolution") && !PathBenchmark; // O benchmark mede sempre a mesma carga
+	DynamicResolutionSettings ResolutionSettings;
+	if (const char* BudgetArgument = GetArgumentValue(argc, argv, "--gpu-budget"))
+	{
+		ResolutionSettings.TargetSeconds = std::max(0.1, std::atof(BudgetArgument)) / 1000.0;
+	}
+	DynamicResolutionController ResolutionController{ ResolutionSettings };
+	GpuTimer SceneTimer;
+	double SceneGpuSeconds = 0.0;
+	if (bDynamicResolution)
+	{
+		SceneTimer.Create();
+	}
 
-		GLint ModelViewMatrixLoc = glGetUniformLocation(ProgramId, "ModelViewMatrix");
-		glUniformMatrix4fv(ModelViewMatrixLoc, 1, GL_FALSE, glm::value_ptr(ModelViewMatrix));
+	// Tempo de GPU do frame inteiro no benchmark (o SceneTimer no  usado junto: consultas GL_TIME_ELAPSED no se aninham)
+	GpuTimer FrameTimer;
+	if (PathBenchmark)
+	{
+		FrameTimer.Create();
+	}
 
-		GLint ModelViewProjectionLoc = glGetUniformLocation(ProgramId, "ModelViewProjection");
-		glUniformMatrix4fv(ModelViewProjectionLoc, 1, GL_FALSE, glm::value_ptr(ModelViewProjectionMatrix));
+	HudOverlay Hud;
+	const bool bShowHud = (bDynamicResolution || HasArgument(argc, argv, "--hud")) && Hud.Create();
+
+	FrameGraphTextureDesc SceneColorDesc;
+	SceneColorDesc.InternalFormat = GL_SRGB8_ALPHA8;
+	SceneColorDesc.bDynamicScale = bDynamicResolution;
+	FrameGraphTextureDesc SceneDepthDesc;
+	SceneDepthDesc.InternalFormat = GL_DEPTH_COMPONENT24;
+	SceneDepthDesc.bDynamicScale = bDynamicResolution;
+
+	const FrameGraphResource SceneColor = Graph.CreateTexture("SceneColor", SceneColorDesc);
+	const FrameGraphResource SceneDepth = Graph.CreateTexture("SceneDepth", SceneDepthDesc);
+	const FrameGraphResource Backbuffer = Graph.ImportBackbuffer("Backbuffer");
+	const FrameGraphResource CaptureFile = Graph.ImportExternal("CaptureFile");
+
+	// --no-late-latch: as matrizes usam s a cmera do snapshot, para comparar a latncia da entrada
+	const bool bLateLatch = !HasArgument(argc, argv, "--no-late-latch");
+	const bool bRenderThread = HasArgument(argc, argv, "--render-thread") && !PathBenchmark; // O benchmark conta os frames no loop serial
+	FrameUniformData LatchedUniforms = {}; // Escrito por LatchCamera antes de executar o grafo e lido pelo passe Globe
+	uint64_t RenderedInputEvent = 0; // ltimo evento de entrada includo no frame sendo desenhado
+	uint64_t LateLatchedFrames = 0;
+	double InstanceSubmitSeconds = 0.0; // Registrado no benchmark de instncias junto com o intervalo da apresentao
+
+	// Late latch: passo explcito logo antes de executar o grafo. Calcula as matrizes da cmera com a orientao do
+	//	movimento de mouse mais recente, mesmo que ele tenha chegado depois do snapshot; os passes s leem o resultado
+	auto LatchCamera = [&](const FrameSnapshot& Frame)
+	{
+		PROFILE_SCOPE("LatchCamera");
 
-		GLint LightIntensityLoc = glGetUniformLocation(ProgramId, "LightIntensity");
-		glUniform1f(LightIntensityLoc, Light.Intensity);
+		SimpleCamera View = Frame.Camera;
+		glm::mat4 ViewMatrix = Frame.ViewMatrix;
+		glm::mat4 ViewProjection = Frame.ViewProjection;
+		RenderedInputEvent = Frame.InputEvent;
 
-		// Determinao 
-		glm::vec4 LightDirectionViewSpace = ViewMatrix * glm::vec4{ Light.Direction, 0.0f };
+		if (bLateLatch)
+		{
+			// Sem a thread de renderizao os eventos s chegam quando so processados: esta  a nica leitura dos
+			//	eventos do frame no loop serial
+			if (!bRenderThread)
+			{
+				{
+					PROFILE_SCOPE("glfwPollEvents");
+					glfwPollEvents();
+				}
+				ProcessInput(Window);
+			}
+
+			LatestOrientation.Acquire();
+			const CameraOrientation& Orientation = LatestOrientation.GetReadBuffer();
+			if (Orientation.InputEvent > Frame.InputEvent)
+			{
+				View.Direction = Orientation.Direction;
+				View.Up = Orientation.Up;
+				ViewMatrix = View.GetView();
+				ViewProjection = View.GetViewProjection();
+				RenderedInputEvent = Orientation.InputEvent;
+				LateLatchedFrames++;
+			}
+		}
 
-		GLint LightDirectionLoc = glGetUniformLocation(ProgramId, "LightDirection");
-		glUniform3fv(LightDirectionLoc, 1, glm::value_ptr(LightDirectionViewSpace));
+		// Clculos matriciais para determinao da Matriz Normal (utilizada para a iluminao) e para a Model View Projection
+		// MVP (utilizada para transladar, rotacionar e escalar os objetos no espao euclidiano)
+		glm::mat4 NormalMatrix = glm::transpose(glm::inverse(ViewMatrix * ModelMatrix));
+		ModelViewMatrix = ViewMatrix * ModelMatrix;
+		ModelViewProjectionMatrix = ViewProjection * ModelMatrix;
 
-		// Ativao e endereamento da textura para os shaders
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, EarthTextureId);
+		// Determinao da direo da luz no espao da cmera
+		glm::vec4 LightDirectionViewSpace = ViewMatrix * glm::vec4{ Light.Direction, 0.0f };
 
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, CloudsTextureId);
+		LatchedUniforms = {};
+		LatchedUniforms.ModelViewProjection = ModelViewProjectionMatrix;
+		LatchedUniforms.ModelViewMatrix = ModelViewMatrix;
+		LatchedUniforms.NormalMatrix = NormalMatrix;
+		LatchedUniforms.LightDirection = glm::vec3{ LightDirectionViewSpace };
+		LatchedUniforms.LightIntensity = Light.Intensity;
+		LatchedUniforms.Time = static_cast<float>(CurrentTime);
+		LatchedUniforms.ViewMatrix = ViewMatrix;
+		LatchedUniforms.ViewProjection = ViewProjection;
+	};
+
+	Graph.AddPass("Globe", {}, { SceneColor, SceneDepth }, [&](const FrameGraphPassContext&)
+	{
+		// Os uniforms da cmera (com o late latch) e da iluminao vo para o bloco FrameUniforms em uma nica cpia, na regio
+		//	do buffer mapeado que a GPU j terminou de ler
+		if (ProgramId != 0)
+		{
+			FrameUniforms.Upload(&LatchedUniforms, sizeof(LatchedUniforms));
+		}
 
-		GLint TextureSamplerLoc = glGetUniformLocation(ProgramId, "EarthTexture");
-		glUniform1i(TextureSamplerLoc, 0);
+		if (bDynamicResolution)
+		{
+			SceneTimer.Begin();
+		}
 
-		GLint CloudsTextureSamplerLoc = glGetUniformLocation(ProgramId, "CloudsTexture");
-		glUniform1i(CloudsTextureSamplerLoc, 1);
+		// Ativa o bit do buffer que realiza a limpeza dos buffers de cor e de profundidade
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// Para testes de geometrias:
 		//glPointSize(3.0f);
 		//glLineWidth(3.0f);
 		//glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 		//glDrawArrays(GL_POINTS, 0, SphereNumVertices);
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		glBindVertexArray(SphereVAO);
-		// Utiliza o EBO para desenhar na tela de acordo com os ndices
-		glDrawElements(GL_TRIANGLES, SphereIndices.size() * 3, GL_UNSIGNED_INT, nullptr);
-		glBindVertexArray(0);
 
-		// Processa todos os eventos da fila de eventos do GLFW podem ser estmulos do teclado, mouse, gamepad, etc
-		glfwPollEvents();
+		// Sem um programa vlido (erro nos shaders) a cena fica s com a limpeza at a recarga corrigir o erro: desenhar
+		//	com o programa 0 no  definido no perfil core
+		if (ProgramId != 0)
+		{
+			StateCache.SetPolygonMode(GL_FILL);
+			StateCache.BindVertexArray(SphereVAO);
+			// Utiliza o EBO para desenhar na tela de acordo com os ndices
+			const GLsizei SphereIndexCount = static_cast<GLsizei>(SphereIndices.size() * 3);
+			if (InstanceCount > 0)
+			{
+				if (Benchmark)
+				{
+					Bodies.SetCount(Benchmark->GetInstanceCount());
+				}
+
+				// Tempo de CPU para montar as matrizes, copiar o buffer de instncias e emitir o draw
+				const double SubmitStartTime = glfwGetTime();
+				Bodies.Update(static_cast<float>(CurrentTime), ModelMatrix);
+				Bodies.Draw(SphereIndexCount);
+				InstanceSubmitSeconds = glfwGetTime() - SubmitStartTime;
+			}
+			else if (PatchesPerSide > 0)
+			{
+				const DrawBatchView PatchView = DrawBatchView::FromMatrices(ModelViewProjectionMatrix, ModelViewMatrix);
+				PatchCommandBuilder.Build(Patches, PatchView, PatchCommands);
+				PatchBatcher.Submit(PatchCommands, UniformLocations.DrawTint);
+			}
+			else
+			{
+				glDrawElements(GL_TRIANGLES, SphereIndexCount, GL_UNSIGNED_INT, nullptr);
+			}
+		}
+
+		if (bDynamicResolution)
+		{
+			SceneTimer.End();
+		}
+	});
+
+	Graph.AddPass("Present", { SceneColor }, { Backbuffer }, [&](const FrameGraphPassContext& Context)
+	{
+		Context.Blit(SceneColor);
+
+		if (bShowHud)
+		{
+			Hud.Draw(Context.Width, Context.Height);
+		}
+	});
+
+	Graph.AddPass("Capture", { SceneColor }, { CaptureFile }, [&](const FrameGraphPassContext& Context)
+	{
+		const std::string CaptureName = "BlueMarble_" + std::to_string(FrameIndex) + ".png";
+		int CaptureWidth = 0;
+		int CaptureHeight = 0;
+		Context.GetRenderArea(SceneColor, CaptureWidth, CaptureHeight);
+		SaveTexturePng(Context.GetTexture(SceneColor), CaptureName.c_str(), CaptureWidth, CaptureHeight);
+	});
+
+	Graph.SetOutput(Backbuffer, true);
+
+	// Simulao (thread principal): aplica a entrada  cmera e monta o snapshot que o desenho do frame vai usar
+	auto Simulate = [&](FrameSnapshot& Frame)
+	{
+		PROFILE_SCOPE("Simulate");
+
+		// Na reproduo da entrada o tempo  o do frame, no o do relgio: os eventos gravados at esse instante entram
+		//	na fila como se tivessem chegado pelos callbacks
+		double Now = glfwGetTime();
+		if (bReplayingInput)
+		{
+			Now = static_cast<double>(++ReplayFrames) * ReplayStep;
+			Playback.Feed(Now, QueueInputEvent);
+			if (Playback.IsFinished(Now))
+			{
+				glfwSetWindowShouldClose(Window, true);
+			}
+		}
+
+		ProcessInput(Window);
+
+		// A cmera avana em passos de tamanho fixo: quantos couberem no tempo decorrido desde o frame anterior
+		const int NumSteps = SimulationClock.Advance(Now);
+		for (int Step = 0; Step < NumSteps; ++Step)
+		{
+			PreviousCameraLocation = Camera.Location;
+			Camera.Update(static_cast<float>(SimulationClock.GetStepSeconds()));
+		}
+
+		// No benchmark a cmera  a do caminho no frame atual, sem interpolao
+		if (PathBenchmark)
+		{
+			PathBenchmark->GetPath().Evaluate(PathBenchmark->GetPathTime(), Camera);
+			PreviousCameraLocation = Camera.Location;
+		}
+
+		// O frame mostra o estado entre os dois ltimos passos, na frao j decorrida do passo seguinte. A direo vem
+		//	da entrada processada acima, fora dos passos, e  usada como est
+		Frame.Camera = Camera;
+		Frame.Camera.Location = glm::mix(PreviousCameraLocation, Camera.Location, static_cast<float>(SimulationClock.GetAlpha()));
+		Frame.ViewMatrix = Frame.Camera.GetView();
+		Frame.ViewProjection = Frame.Camera.GetViewProjection();
+		Frame.Time = PathBenchmark ? PathBenchmark->GetPathTime() : SimulationClock.GetInterpolatedTime();
+		glfwGetFramebufferSize(Window, &Frame.FramebufferWidth, &Frame.FramebufferHeight);
+		Frame.CaptureRequests = CaptureRequests;
+		Frame.InputTime = LastInputTime;
+		Frame.InputEvent = AppliedInputEvent;
+
+		if (bReplayingInput)
+		{
+			const glm::vec3 CameraState[] = { Frame.Camera.Location, Frame.Camera.Direction, Frame.Camera.Up };
+			const unsigned char* Bytes = reinterpret_cast<const unsigned char*>(CameraState);
+			for (size_t Index = 0; Index < sizeof(CameraState); ++Index)
+			{
+				TrajectoryHash ^= Bytes[Index];
+				TrajectoryHash *= 1099511628211ull;
+			}
+		}
+	};
+
+	// Tempo de CPU do ltimo RenderFrame, do incio at o envio dos passes do grafo (sem o glfwSwapBuffers)
+	double RenderCpuSeconds = 0.0;
+	double RenderStartSeconds = 0.0;
+
+	// Desenho de um frame a partir de um snapshot: todas as chamadas ao OpenGL acontecem aqui, na thread dona do contexto
+	auto RenderFrame = [&](const FrameSnapshot& Frame)
+	{
+		PROFILE_SCOPE("RenderFrame");
+
+		// Intervalos de GPU de frames anteriores que j terminaram
+		GetGpuProfiler().Collect();
+		PROFILE_GPU_SCOPE("Frame");
+
+		const double RenderStartTime = glfwGetTime();
+		RenderStartSeconds = RenderStartTime;
+		if (PathBenchmark)
+		{
+			FrameTimer.Begin();
+		}
+
+		Residency.BeginFrame(++FrameIndex);
+
+		CurrentTime = Frame.Time;
+		DeltaTime = CurrentTime - PreviousFrameTime;
+		PreviousFrameTime = CurrentTime;
+
+		// As variantes alteradas so recompiladas em segundo plano e s substituem o programa atual depois do link
+		if (ShaderWatch && ShaderWatch->Update())
+		{
+			Shaders.Reload();
+		}
+		if (Shaders.Update())
+		{
+			ProgramId = Shaders.GetProgram(ShaderFeatures);
+			UniformLocations = GetFrameUniformLocations(Shaders.GetReflection(ShaderFeatures));
+		}
+
+		if (ProgramId != 0)
+		{
+			StateCache.UseProgram(ProgramId); // Ativa o programa de shaders
+		}
+
+		// Escolha do nvel de resoluo das texturas a partir do tamanho do globo (raio 1, na origem) em pixels
+		Prefetcher.Update(Streamer, Frame.Camera, glm::vec3{ 0.0f }, 1.0f, Frame.FramebufferHeight);
+
+		if (CloudsSeries)
+		{
+			CloudsSeries->Update(*SeriesStreamer, static_cast<float>(DeltaTime));
+		}
+
+		// Texturas usadas neste frame ficam no fim da fila LRU do gerenciador de residncia
+		Residency.Touch(EarthTexture.GetTextureId());
+		Residency.Touch(CloudsTexture.GetTextureId());
+
+		// Ativao das texturas nas unidades definidas em SetSamplerUnit: cube maps usam 2 e 3
+		const GLenum TextureTarget = bUseCubeMaps ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+		const GLuint FirstTextureUnit = bUseCubeMaps ? 2 : 0;
+
+		StateCache.BindTexture(FirstTextureUnit, TextureTarget, EarthTexture.GetTextureId());
+		StateCache.BindTexture(FirstTextureUnit + 1, TextureTarget, CloudsTexture.GetTextureId());
+
+		if (NightLightsTextureId != 0)
+		{
+			StateCache.BindTexture(5, GL_TEXTURE_2D, NightLightsTextureId);
+		}
+
+		if (CloudsSeries)
+		{
+			StateCache.BindTexture(4, GL_TEXTURE_2D_ARRAY, CloudsSeries->GetTextureId());
+		}
+
+		if (CloudsSeries && ProgramId != 0)
+		{
+			glUniform2f(UniformLocations.CloudsSeriesLayers, static_cast<float>(CloudsSeries->GetLayerA()), static_cast<float>(CloudsSeries->GetLayerB()));
+			glUniform1f(UniformLocations.CloudsSeriesBlend, CloudsSeries->GetBlend());
+		}
+
+		// A escala deste frame vem das medidas de GPU que j chegaram (de alguns frames atrs)
+		if (bDynamicResolution && SceneTimer.ReadResult(SceneGpuSeconds))
+		{
+			Graph.SetRenderScale(ResolutionController.Update(SceneGpuSeconds));
+		}
+
+		if (bShowHud)
+		{
+			const float RenderScale = Graph.GetRenderScale();
+			std::ostringstream Line;
+			Line << std::fixed << std::setprecision(1) << (DeltaTime > 0.0 ? 1.0 / DeltaTime : 0.0) << " fps ("
+				 << std::setprecision(2) << DeltaTime * 1000.0 << " ms)";
+			Hud.AddLine(Line.str());
+
+			if (bDynamicResolution)
+			{
+				Line.str("");
+				Line << "GPU da cena " << SceneGpuSeconds * 1000.0 << " ms de " << ResolutionSettings.TargetSeconds * 1000.0
+					 << " ms, escala " << RenderScale << " (" << std::lround(Frame.FramebufferWidth * RenderScale) << "x"
+					 << std::lround(Frame.FramebufferHeight * RenderScale) << " de " << Frame.FramebufferWidth << "x"
+					 << Frame.FramebufferHeight << ")";
+				Hud.AddLine(Line.str());
+			}
+		}
+
+		// Desenha os passes do grafo: o globo na textura da cena e a cena na janela (e, aps um F12, em um PNG)
+		Graph.SetBackbufferSize(Frame.FramebufferWidth, Frame.FramebufferHeight);
+		Graph.SetOutput(CaptureFile, Frame.CaptureRequests != CapturedRequests);
+
+		// As matrizes da cmera so calculadas o mais tarde possvel, imediatamente antes dos draws
+		LatchCamera(Frame);
+		Graph.Execute(RenderTargetPool);
+		CapturedRequests = Frame.CaptureRequests;
+
+		// Se o oramento de memria de vdeo foi ultrapassado, aplica as poucas decises deste frame (cpias na GPU)
+		for (const ResidencyDecision& Decision : Residency.Update())
+		{
+			ApplyResidencyDecision(Decision);
+		}
+
+		if (PathBenchmark)
+		{
+			FrameTimer.End();
+		}
+		RenderCpuSeconds = glfwGetTime() - RenderStartTime;
+	};
+
+	// Varincia do intervalo entre apresentaes (o que o usurio percebe como ritmo) e do tempo bloqueado na troca
+	FrameTimeStats FrameIntervals;
+	FrameTimeStats PresentTimes;
+	double PreviousPresentTime = -1.0;
+	uint64_t PreviousStateCalls = StateCache.GetIssuedCalls();
+	auto PresentFrame = [&]()
+	{
+		PROFILE_SCOPE("PresentFrame");
+		const double PacerStartTime = glfwGetTime();
+		{
+			PROFILE_SCOPE("FramePacer::Wait");
+			Pacer.Wait();
+		}
+		const double PacerSeconds = glfwGetTime() - PacerStartTime;
 
 		// Envia o contedo do framebuffer da janela para ser desenhado na tela
 		// A memria alocada para aplicao  trocada (swap) para a memria de vdeo que se encarregar pela
 		//	renderizao em tela dos pixels da janela
 		//	Vale mencionar, portanto, que o tamanho da janela que estipulamos (valor das variveis Width e Height)
 		//	influencia na quantidade de memria RAM e de vdeo que nossa aplicao utilizar
-		glfwSwapBuffers(Window);		
+		const double SwapStartTime = glfwGetTime();
+		{
+			PROFILE_SCOPE("glfwSwapBuffers");
+			glfwSwapBuffers(Window);
+		}
+		const double PresentTime = glfwGetTime();
+
+		PresentTimes.Record(PresentTime - SwapStartTime);
+		const double FrameSeconds = PreviousPresentTime >= 0.0 ? PresentTime - PreviousPresentTime : 0.0;
+		if (PreviousPresentTime >= 0.0)
+		{
+			FrameIntervals.Record(FrameSeconds);
+		}
+		PreviousPresentTime = PresentTime;
+
+		// Os eventos includos no frame (at o lido no late latching) chegaram  tela
+		InputEvents.OnFramePresented(RenderedInputEvent, PresentTime);
+
+		// O tempo do frame do benchmark de instncias  o intervalo medido entre apresentaes, no o passo da simulao
+		if (Benchmark)
+		{
+			Benchmark->RecordFrame(InstanceSubmitSeconds, FrameSeconds);
+			if (Benchmark->IsFinished())
+			{
+				Benchmark->PrintReport(std::cout);
+				glfwSetWindowShouldClose(Window, true);
+			}
+		}
+
+		const DrawStatistics Draws = TakeDrawStatistics();
+		if (PathBenchmark)
+		{
+			FrameBenchmarkSample Sample;
+			Sample.CpuSeconds = RenderCpuSeconds;
+			Sample.FrameSeconds = FrameSeconds;
+			Sample.DrawCalls = Draws.DrawCalls;
+			Sample.Triangles = Draws.Triangles;
+
+			// A medida de GPU que chegou agora  de alguns frames atrs, mas entra na mesma distribuio
+			double GpuSeconds = 0.0;
+			if (FrameTimer.ReadResult(GpuSeconds))
+			{
+				Sample.GpuSeconds = GpuSeconds;
+			}
+
+			PathBenchmark->RecordFrame(Sample);
+			if (PathBenchmark->IsFinished())
+			{
+				glfwSetWindowShouldClose(Window, true);
+			}
+		}
+
+		// O tempo do engasgo vai do incio do desenho at a apresentao, sem a espera do --fps: o intervalo entre
+		//	apresentaes incluiria as esperas ociosas do --on-demand
+		const uint64_t StateCalls = StateCache.GetIssuedCalls();
+		if (Flight)
+		{
+			FlightRecorderFrame Record;
+			Record.Index = FrameIndex;
+			Record.FrameSeconds = PresentTime - RenderStartSeconds - PacerSeconds;
+			Record.CpuSeconds = RenderCpuSeconds;
+			Record.DrawCalls = Draws.DrawCalls;
+			Record.Triangles = Draws.Triangles;
+			Record.GLStateCalls = StateCalls - PreviousStateCalls;
+			Record.ResidentBytes = Residency.GetResidentBytes();
+			Flight->EndFrame(Record);
+		}
+		PreviousStateCalls = StateCalls;
+	};
+
+	// --on-demand: s desenha quando algo visvel mudou (entrada, cmera, tamanho da janela, streaming de texturas) ou
+	//	quando as nuvens andaram --redraw-pixels pixels (1 por padro) no centro do globo. Entre um frame e outro o loop
+	//	dorme em glfwWaitEventsTimeout; sem foco, no mximo 4 frames por segundo, e minimizada, nenhum. Na reproduo da
+	//	entrada e no benchmark todo frame  desenhado
+	const bool bOnDemand = HasArgument(argc, argv, "--on-demand") && !bReplayingInput && !PathBenchmark;
+	double RedrawPixels = 1.0;
+	if (const char* PixelsArgument = GetArgumentValue(argc, argv, "--redraw-pixels"))
+	{
+		RedrawPixels = std::max(0.0, std::atof(PixelsArgument));
+	}
+	RedrawScheduler Redraws;
+
+	// Monta o estado que decide o redesenho e atualiza o que o RedrawScheduler sabe da janela e das animaes
+	auto PrepareRedrawState = [&](const FrameSnapshot& Frame, bool bPendingWork)
+	{
+		Redraws.SetWindowState(glfwGetWindowAttrib(Window, GLFW_FOCUSED) == GLFW_TRUE, glfwGetWindowAttrib(Window, GLFW_ICONIFIED) == GLFW_TRUE);
+
+		// rbitas dos corpos instanciados e sries temporais mudam a cada frame. As nuvens giram CloudsRotationSpeed
+		//	voltas por segundo: no centro do globo isso  pi * dimetro em pixels * velocidade. Sem nuvens nada se move
+		if (InstanceCount > 0 || CloudsSeries)
+		{
+			Redraws.SetAnimationInterval(0.0);
+		}
+		else if ((ShaderFeatures & EShaderFeature::Clouds) == 0)
+		{
+			Redraws.SetAnimationInterval(std::numeric_limits<double>::infinity());
+		}
+		else
+		{
+			const double Diameter = ComputeProjectedDiameter(Frame.Camera, glm::vec3{ 0.0f }, 1.0f, Frame.FramebufferHeight);
+			const double PixelsPerSecond = glm::pi<double>() * Diameter * CloudsRotationSpeed;
+			Redraws.SetAnimationInterval(PixelsPerSecond > 0.0 ? RedrawPixels / PixelsPerSecond : Redraws.MaxWaitTimeout);
+		}
+
+		RedrawState State;
+		State.InputTime = Frame.InputTime;
+		State.CameraLocation = Frame.Camera.Location;
+		State.CameraDirection = Frame.Camera.Direction;
+		State.CameraUp = Frame.Camera.Up;
+		State.FramebufferWidth = Frame.FramebufferWidth;
+		State.FramebufferHeight = Frame.FramebufferHeight;
+		State.CaptureRequests = Frame.CaptureRequests;
+		State.bPendingWork = bPendingWork;
+		return State;
+	};
+
+	auto WaitForRedraw = [&]()
+	{
+		PROFILE_SCOPE("WaitForRedraw");
+		Redraws.BeginIdle();
+		glfwWaitEventsTimeout(Redraws.GetWaitTimeout(glfwGetTime()));
+		Redraws.EndIdle();
+	};
+
+	// Estado da memria no frame de um engasgo, escrito pelo FlightRecorder na thread que apresenta os frames
+	if (Flight)
+	{
+		Flight->SetSnapshotWriter([&](std::ostream& Output)
+		{
+			PrintTextureMemoryReport(Output);
+			Residency.PrintReport(Output);
+			RenderTargetPool.PrintReport(Output);
+			Graph.PrintReport(Output);
+			StateCache.PrintReport(Output);
+
+			// Memria livre informada pelo driver, quando ele expe a extenso da NVIDIA
+			if (GLEW_NVX_gpu_memory_info)
+			{
+				GLint TotalKilobytes = 0;
+				GLint AvailableKilobytes = 0;
+				GLint EvictedKilobytes = 0;
+				glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &TotalKilobytes);
+				glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &AvailableKilobytes);
+				glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &EvictedKilobytes);
+				Output << "Memria de vdeo do driver: " << AvailableKilobytes / 1024 << " MB livres de " << TotalKilobytes / 1024
+					   << " MB, " << EvictedKilobytes / 1024 << " MB despejados" << std::endl;
+			}
+		});
+	}
+
+	// --render-thread: o contexto passa para uma thread de renderizao e a thread principal fica s com os eventos e a
+	//	simulao. O V-Sync (glfwSwapBuffers) e as esperas da GPU bloqueiam apenas a renderizao; a entrada continua
+	//	sendo lida e aplicada  cmera, e o frame seguinte usa sempre o snapshot mais recente
+	if (bRenderThread)
+	{
+		// Intervalo mximo entre passos da simulao quando no chega nenhum evento
+		constexpr double SimulationInterval = 1.0 / 240.0;
+
+		TripleBuffer<FrameSnapshot> Snapshots;
+		std::atomic<bool> bStopRendering{ false };
+
+		// Acorda a thread de renderizao parada: um snapshot publicado, um nvel de textura decodificado ou o fim
+		WakeSignal RenderWake;
+		Streamer.SetCompletionCallback([&RenderWake]() { RenderWake.Notify(); });
+
+		// Um contexto s pode estar ativo em uma thread por vez
+		glfwMakeContextCurrent(nullptr);
+
+		std::thread RenderThread([&]()
+		{
+			GetProfiler().SetThreadName("Render");
+			glfwMakeContextCurrent(Window);
+			bool bHasSnapshot = false;
+			while (!bStopRendering.load(std::memory_order_acquire))
+			{
+				// Nada novo da simulao: desenhar de novo o mesmo snapshot produziria o mesmo frame, a menos que uma
+				//	textura decodificada esteja sendo copiada para a GPU (a cpia avana uma faixa por frame). Sem nada
+				//	para fazer a thread dorme at o prximo Publish ou at o streaming terminar de decodificar um nvel
+				const bool bNewSnapshot = Snapshots.Acquire();
+				bHasSnapshot = bHasSnapshot || bNewSnapshot;
+				if (!bHasSnapshot || (!bNewSnapshot && !EarthTexture.HasPendingUpload() && !CloudsTexture.HasPendingUpload()))
+				{
+					RenderWake.Wait();
+					continue;
+				}
+
+				const FrameSnapshot& Frame = Snapshots.GetReadBuffer();
+				RenderFrame(Frame);
+				PresentFrame();
+			}
+			glfwMakeContextCurrent(nullptr);
+		});
+
+		while (!glfwWindowShouldClose(Window))
+		{
+			if (!bOnDemand || glm::length(Camera.GetVelocity()) > 0.0f)
+			{
+				// Sob demanda, a cmera em movimento muda o frame a cada passo, sem nenhum evento para acordar a espera
+				PROFILE_SCOPE("glfwWaitEventsTimeout");
+				glfwWaitEventsTimeout(SimulationInterval);
+			}
+			else
+			{
+				WaitForRedraw();
+			}
+
+			FrameSnapshot& Frame = Snapshots.GetWriteBuffer();
+			Simulate(Frame);
+
+			// O streaming de texturas  acompanhado pela thread de renderizao, que redesenha sozinha enquanto ele durar
+			if (bOnDemand)
+			{
+				const RedrawState State = PrepareRedrawState(Frame, false);
+				const ERedrawReason Reason = Redraws.ShouldRedraw(State, glfwGetTime());
+				if (Reason == ERedrawReason::None)
+				{
+					continue;
+				}
+				Redraws.OnFrameRendered(State, glfwGetTime(), Reason);
+			}
+			Snapshots.Publish();
+			RenderWake.Notify();
+		}
+
+		bStopRendering.store(true, std::memory_order_release);
+		RenderWake.Notify();
+		RenderThread.join();
+		Streamer.SetCompletionCallback(nullptr);
+
+		// A liberao dos recursos abaixo volta a acontecer na thread principal
+		glfwMakeContextCurrent(Window);
+	}
+	else
+	{
+		// Sob demanda, s a cpia para a GPU de um nvel j decodificado exige redesenhar; a decodificao termina em
+		//	segundo plano e acorda a espera por eventos (glfwPostEmptyEvent pode ser chamado de qualquer thread)
+		if (bOnDemand)
+		{
+			Streamer.SetCompletionCallback([]() { glfwPostEmptyEvent(); });
+		}
+
+		// Entra no loop de eventos da aplicao tendo a janela fechada como condio de parada
+		while (!glfwWindowShouldClose(Window))
+		{
+			PROFILE_SCOPE("Frame");
+
+			FrameSnapshot Frame;
+			Simulate(Frame);
+
+			RedrawState State;
+			ERedrawReason Reason = ERedrawReason::None;
+			if (bOnDemand)
+			{
+				State = PrepareRedrawState(Frame, EarthTexture.HasPendingUpload() || CloudsTexture.HasPendingUpload());
+				Reason = Redraws.ShouldRedraw(State, glfwGetTime());
+				if (Reason == ERedrawReason::None)
+				{
+					WaitForRedraw();
+					continue;
+				}
+			}
+
+			RenderFrame(Frame);
+
+			// Processa todos os eventos da fila de eventos do GLFW podem ser estmulos do teclado, mouse, gamepad, etc
+			//	Com o late latch eles j foram lidos por LatchCamera, imediatamente antes dos draws deste frame
+			if (!bLateLatch)
+			{
+				PROFILE_SCOPE("glfwPollEvents");
+				glfwPollEvents();
+			}
+
+			PresentFrame();
+			if (bOnDemand)
+			{
+				Redraws.OnFrameRendered(State, glfwGetTime(), Reason);
+			}
+		}
+		Streamer.SetCompletionCallback(nullptr);
 	}
 
 	// Boa prtica em OpenGL: como ele se comporta como uma mquina de estados, aps habilitar o buffer, 
 	//	definir um contexto e desenhar coisas em tela, reverter o que foi criado para que as prximas construes
 	//	em tela sejam organizadas, novos binds rastreveis e, em suma, o comportamento sistmico seja controlado e 
 	//	previsvel. 
+	InputEvents.PrintReport(std::cout, "Latncia da entrada at a apresentao");
+	PendingInput.PrintReport(std::cout);
+	if (InputRecording.IsOpen())
+	{
+		InputRecording.Close(glfwGetTime());
+		std::cout << "Entrada gravada: " << InputRecording.GetRecordedEvents() << " eventos em " << RecordInputFile << std::endl;
+	}
+	if (bReplayingInput)
+	{
+		std::cout << "Reproduo da entrada: " << Playback.GetNumEvents() << " eventos, " << Playback.GetDuration() << " s em "
+				  << ReplayFrames << " frames de " << ReplayStep * 1000.0 << " ms, trajetria da cmera " << std::hex
+				  << std::setw(16) << std::setfill('0') << TrajectoryHash << std::dec << std::setfill(' ') << std::endl;
+	}
+	std::cout << "Late latching: " << LateLatchedFrames << " de " << FrameIndex << " frames com uma orientao da cmera mais nova que a do snapshot"
+			  << (FrameUniforms.IsPersistentlyMapped() ? " (buffer mapeado persistente, " : " (buffer mapeado a cada frame, ")
+			  << FrameUniforms.GetFenceWaits() << " esperas pela GPU)" << std::endl;
+	FrameIntervals.PrintReport(std::cout, "Intervalo entre frames");
+	PresentTimes.PrintReport(std::cout, "Tempo de apresentao (glfwSwapBuffers)");
+	SimulationClock.PrintReport(std::cout);
+	Pacer.PrintReport(std::cout);
+	if (bOnDemand)
+	{
+		Redraws.PrintReport(std::cout);
+	}
+	Graph.PrintReport(std::cout);
+	if (bDynamicResolution)
+	{
+		ResolutionController.PrintReport(std::cout);
+	}
+
+	// Exportado antes da liberao dos recursos: os nomes dos passes do grafo so usados pelos eventos
+	if (ProfileFile)
+	{
+		GetProfiler().Stop();
+		GetProfiler().PrintReport(std::cout);
+		if (GetProfiler().ExportChromeTrace(ProfileFile))
+		{
+			std::cout << "Trace do profiler gravado em " << ProfileFile << std::endl;
+		}
+	}
+
+	if (Flight)
+	{
+		GetProfiler().Stop();
+		Flight->PrintReport(std::cout);
+	}
+
+	// O baseline  lido antes da gravao dos resultados: pode ser o prprio CSV da execuo anterior
+	int ExitCode = 0;
+	if (PathBenchmark)
+	{
+		PathBenchmark->PrintReport(std::cout);
+		if (!PathBenchmark->IsFinished())
+		{
+			std::cout << "Benchmark interrompido antes do ltimo frame: resultados no gravados" << std::endl;
+			ExitCode = 1;
+		}
+		else
+		{
+			if (const char* BaselineFile = GetArgumentValue(argc, argv, "--benchmark-baseline"))
+			{
+				std::ifstream BaselineStream{ BaselineFile };
+				if (!BaselineStream)
+				{
+					std::cout << "Erro ao abrir o baseline " << BaselineFile << std::endl;
+					ExitCode = 1;
+				}
+				else if (!PathBenchmark->CompareWithBaseline(BaselineStream, std::cout))
+				{
+					ExitCode = 2;
+				}
+			}
+
+			const char* OutputArgument = GetArgumentValue(argc, argv, "--benchmark-output");
+			const std::string OutputPrefix = OutputArgument ? OutputArgument : "benchmark";
+			if (!PathBenchmark->WriteCsv(OutputPrefix + ".csv") || !PathBenchmark->WriteJson(OutputPrefix + ".json"))
+			{
+				ExitCode = ExitCode != 0 ? ExitCode : 1;
+			}
+		}
+	}
+	SceneTimer.Release();
+	FrameTimer.Release();
+	GetGpuProfiler().Release();
+	Hud.Release();
+	Graph.Release(RenderTargetPool);
+	RenderTargetPool.Trim();
+	RenderTargetPool.PrintReport(std::cout);
 	glDeleteBuffers(1, &SphereElementBuffer);
 	glDeleteBuffers(1, &SphereVertexBuffer);
 	glDeleteVertexArrays(1, &SphereVAO);
-	glDeleteProgram(ProgramId);
-	glDeleteTextures(1, &EarthTextureId);
+	Shaders.PrintReport(std::cout);
+	Shaders.Release();
+	FrameUniforms.Release();
+	Bodies.Release();
+	if (PatchesPerSide > 0)
+	{
+		PatchBatcher.PrintReport(std::cout);
+	}
+	PatchBatcher.Release();
+	ReleaseTexture(NightLightsTextureId);
+	PrintTextureMemoryReport(std::cout);
+	Residency.PrintReport(std::cout);
+	Prefetcher.PrintReport(std::cout);
+	GetShaderProgramCache().PrintReport(std::cout);
+	StateCache.PrintReport(std::cout);
+	EarthTexture.Release();
+	CloudsTexture.Release();
+	if (CloudsSeries)
+	{
+		CloudsSeries->PrintReport(std::cout);
+		CloudsSeries->Release();
+	}
 
 	glfwDestroyWindow(Window);
 	glfwTerminate();
 
-	return 0;
+	return ExitCode;
 }
@@ -0,0 +1,13 @@
+// Dados da cmera e da iluminao, enviados uma vez por frame e compartilhados por todos os programas.
+//	O layout std140 deve coincidir com a struct FrameUniformData (UniformBuffer.h)
+layout (std140) uniform FrameUniforms
+{
+	mat4 ModelViewProjection;
+	mat4 ModelViewMatrix;
+	mat4 NormalMatrix;
+	vec3 LightDirection;
+	float LightIntensity;
+	float Time;
+	mat4 ViewMatrix; // Usadas pelas instncias, que trazem a prpria Model Matrix
+	mat4 ViewProjection;
+};
@@ -0,0 +1,10 @@
+#inject
+
+in vec4 Color;
+
+out vec4 OutColor;
+
+void main()
+{
+	OutColor = Color;
+}
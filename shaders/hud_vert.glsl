@@ -0,0 +1,19 @@
+#inject
+
+// Texto do HUD: posies em pixels da fonte a partir do canto superior esquerdo da janela (stb_easy_font)
+layout (location = 0) in vec2 InPosition;
+layout (location = 1) in vec4 InColor;
+
+uniform vec2 ViewportSize;
+uniform float TextScale;
+uniform vec2 Offset; // Em pixels da janela (a sombra  o mesmo texto deslocado)
+uniform vec4 Tint;
+
+out vec4 Color;
+
+void main()
+{
+	vec2 Pixel = InPosition * TextScale + Offset;
+	gl_Position = vec4(Pixel.x / ViewportSize.x * 2.0 - 1.0, 1.0 - Pixel.y / ViewportSize.y * 2.0, 0.0, 1.0);
+	Color = InColor * Tint;
+}
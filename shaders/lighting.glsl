@@ -0,0 +1,24 @@
+// Funes de iluminao compartilhadas pelos shaders (includas com #include "lighting.glsl")
+
+// Termo difuso de Lambert: cosseno entre a normal e a direo da luz, limitado entre 0 e 1
+//	(valores negativos indicam que estamos virados pro lado oposto a direo da luz)
+float ComputeLambertian(vec3 N, vec3 L)
+{
+	return clamp(dot(N, L), 0.0, 1.0);
+}
+
+// Termo especular de Phong: (R . V) ^ Shininess
+float ComputeSpecular(vec3 N, vec3 L, vec3 ViewDirection, float Shininess)
+{
+	// Vetor R que determina a direo da reflexo
+	vec3 ReflectionDirection = reflect(-L, N);
+
+	// Limita o valor da reflexo especular a nmeros positivos
+	return pow(max(0.0, dot(ReflectionDirection, ViewDirection)), Shininess);
+}
+
+// Peso das luzes noturnas: 1 no lado escuro, 0 no lado iluminado, com uma transio suave no terminador
+float ComputeNightWeight(vec3 N, vec3 L)
+{
+	return 1.0 - smoothstep(-0.1, 0.1, dot(N, L));
+}
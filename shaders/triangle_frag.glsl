@@ -1,19 +1,54 @@
-#version 330 core
+#inject
+
+// O #inject acima  substitudo por "#version 330 core" e pelos defines FEATURE_* da variante (ShaderLibrary).
+//	Recursos desligados no entram no programa compilado: sem amostragens, uniforms ou desvios no fragment shader
+
+#include "frame_uniforms.glsl"
+#include "lighting.glsl"
 
 in vec3 Position;
 in vec3 Normal;
 in vec3 Color;
 in vec2 UV;
+in vec3 ObjectDirection;
 
-uniform vec3 LightDirection;
-uniform float LightIntensity;
-
-uniform float Time;
-
+#ifdef FEATURE_CUBEMAP
+// Com cube maps a amostragem usa a direo do fragmento, sem a distoro da projeo equiretangular nos polos
+uniform samplerCube EarthCubeMap;
+uniform samplerCube CloudsCubeMap;
+#else
 uniform sampler2D EarthTexture;
 uniform sampler2D CloudsTexture;
+#endif
 
-uniform vec2 CloudsRotationSpeed = vec2(0.008, 0.00);
+#ifdef FEATURE_CLOUDS_SERIES
+// Srie temporal de nuvens (--clouds-series): dois quadros do anel de camadas, interpolados por CloudsSeriesBlend.
+//	Os prprios rasters trazem o movimento das nuvens, ento no h rotao
+uniform sampler2DArray CloudsSeries;
+uniform vec2 CloudsSeriesLayers;
+uniform float CloudsSeriesBlend;
+#endif
+
+#ifdef FEATURE_NIGHT_LIGHTS
+uniform sampler2D NightLightsTexture;
+#endif
+
+#ifdef FEATURE_PATCHES
+flat in vec4 PatchTint;
+#endif
+
+#ifdef FEATURE_INSTANCED
+flat in uint MaterialIndex;
+
+// Cores dos materiais dos corpos instanciados (MaterialPaletteData em InstancedBodies.h)
+layout (std140) uniform MaterialPalette
+{
+	vec4 MaterialTints[16];
+};
+#endif
+
+// CLOUDS_ROTATION_SPEED (vec2, em voltas por segundo) vem de ShaderLibrary::SetDefine, com o mesmo valor que o
+//	redesenho sob demanda usa para saber quando a rotao das nuvens aparece na tela (CloudsRotationSpeed no main.cpp)
 
 out vec4 OutColor;
 
@@ -25,40 +60,66 @@ void main()
 	// Inverter a direo da luz para calcular o vetor L (Lambertiano)
 	vec3 L = -normalize(LightDirection);
 	
-	// Dot - produto escalar entre dois vetores unitrios  equivalente ao cosseno entre esses vetores
-	// Quanto maior o ngulo entre os vetores, menor  o cosseno entre eles
-	float Lambertian = dot(N, L);
-
-	// O clamp vai manter o valor do Lambertiano entre 0 e 1
-	// Se o valor for negativa isso quer dizer que estamos virados pro lado
-	// oposto a direo da luz.
-	Lambertian = clamp(Lambertian, 0.0, 1.0);
+	float Lambertian = ComputeLambertian(N, L);
 
 	float SpecularReflection = 0.0;
+#ifdef FEATURE_SPECULAR
 	if (Lambertian > 0.0)
 	{
 	    // Vetor V
 		// Cmera olhando constantemente para o ponto (0,0) com z negativo (para dentro da tela)
 		vec3 ViewDirection = -normalize(Position);
 
-		// Vetor R que determina a direo da reflexo
-		vec3 ReflectionDirection = reflect(-L, N);
-
-		// Termo especular: (R . V) ^ alpha - produto escalar dos vetores R e V
-		SpecularReflection = pow(dot(ReflectionDirection, ViewDirection), 50.0);
-
-		// Limita o valor da reflexo especular a nmeros positivos
-		SpecularReflection = max(0.0, SpecularReflection);
+		SpecularReflection = ComputeSpecular(N, L, ViewDirection, 50.0);
 	}
-
-	vec3 EarthSurfaceColor = texture(EarthTexture, UV).rgb;
-	vec3 CloudColor = texture(CloudsTexture, UV + Time * CloudsRotationSpeed).rgb;
+#endif
+
+	vec3 EarthSurfaceColor;
+	vec3 CloudColor = vec3(0.0);
+#ifdef FEATURE_CUBEMAP
+	EarthSurfaceColor = texture(EarthCubeMap, ObjectDirection).rgb;
+#if defined(FEATURE_CLOUDS) && !defined(FEATURE_CLOUDS_SERIES)
+	// Deslocar U na textura equiretangular equivale a girar a direo em torno do eixo z do objeto
+	float CloudsAngle = -6.28318530718 * Time * CLOUDS_ROTATION_SPEED.x;
+	float CosAngle = cos(CloudsAngle);
+	float SinAngle = sin(CloudsAngle);
+	vec3 CloudsDirection = vec3(CosAngle * ObjectDirection.x - SinAngle * ObjectDirection.y,
+								SinAngle * ObjectDirection.x + CosAngle * ObjectDirection.y,
+								ObjectDirection.z);
+
+	CloudColor = vec3(texture(CloudsCubeMap, CloudsDirection).r);
+#endif
+#else
+	EarthSurfaceColor = texture(EarthTexture, UV).rgb;
+#if defined(FEATURE_CLOUDS) && !defined(FEATURE_CLOUDS_SERIES)
+	// As nuvens so uma mscara de um canal (R8): o mesmo valor para R, G e B
+	CloudColor = vec3(texture(CloudsTexture, UV + Time * CLOUDS_ROTATION_SPEED).r);
+#endif
+#endif
+
+#if defined(FEATURE_CLOUDS) && defined(FEATURE_CLOUDS_SERIES)
+	vec3 CloudColorA = texture(CloudsSeries, vec3(UV, CloudsSeriesLayers.x)).rgb;
+	vec3 CloudColorB = texture(CloudsSeries, vec3(UV, CloudsSeriesLayers.y)).rgb;
+	CloudColor = mix(CloudColorA, CloudColorB, CloudsSeriesBlend);
+#endif
 
 	vec3 SurfaceColor = EarthSurfaceColor + CloudColor;
+#ifdef FEATURE_INSTANCED
+	SurfaceColor *= MaterialTints[MaterialIndex].rgb;
+#endif
+#ifdef FEATURE_PATCHES
+	SurfaceColor *= PatchTint.rgb;
+#endif
 
 	// A reflexo difusa  o produto do lambertiano com a intensidade da luz e a cor da textura
 	// Simplificao da Equao de Phong
 	vec3 DiffuseReflection = Lambertian * LightIntensity * SurfaceColor + SpecularReflection;
 
+#ifdef FEATURE_NIGHT_LIGHTS
+	// As luzes das cidades aparecem apenas no lado escuro, atenuadas pelas nuvens
+	vec3 NightLights = texture(NightLightsTexture, UV).rgb * (1.0 - CloudColor.r);
+	DiffuseReflection += ComputeNightWeight(N, L) * NightLights;
+#endif
+
 	OutColor = vec4(DiffuseReflection, 1.0);
-}
\ No newline at end of file
+}
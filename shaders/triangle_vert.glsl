@@ -1,26 +1,97 @@
-#version 330 core
+#inject
 
+// O #inject acima  substitudo por "#version 330 core" e pelos defines FEATURE_* da variante (ShaderLibrary)
+
+#ifdef FEATURE_MULTI_DRAW_INDIRECT
+// Precisa vir antes de qualquer declarao: habilita o bloco de shader storage com os dados por draw
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+#ifdef FEATURE_PACKED_VERTICES
+// Vrtices compactados (12 bytes): posio em 4 x int16 normalizados e UV em 2 x uint16 normalizados.
+//	A esfera tem raio 1, ento a normal  a prpria posio e a cor  branca
+layout (location = 0) in vec3 InPosition;
+layout (location = 3) in vec2 InUV;
+#else
 layout (location = 0) in vec3 InPosition; // Vetor de posies j normalizadas recebidas pelo programa
 layout (location = 1) in vec3 InNormal; // Vetor normal
 layout (location = 2) in vec3 InColor; // Vetor de cores
 layout (location = 3) in vec2 InUV; // Vetor de coordenadas de textura
+#endif
+
+#ifdef FEATURE_INSTANCED
+// Atributos por instncia (divisor 1): a Model Matrix ocupa as localizaes 4 a 7 e o ndice do material, a 8
+layout (location = 4) in mat4 InModelMatrix;
+layout (location = 8) in uint InMaterialIndex;
+
+flat out uint MaterialIndex;
+#endif
+
+#ifdef FEATURE_PATCHES
+#ifdef FEATURE_MULTI_DRAW_INDIRECT
+// ndice do draw no lote (BaseInstance do comando indireto) e os dados de cada draw (BatchDrawData em DrawBatcher.h)
+layout (location = 9) in uint InDrawIndex;
+
+struct PatchDrawData
+{
+	vec4 Tint;
+};
+
+layout (std430) readonly buffer PatchDrawBuffer
+{
+	PatchDrawData PatchDraws[];
+};
+#else
+// Sem draw indireto cada patch  um draw prprio e recebe seus dados por uniform
+uniform vec4 DrawTint;
+#endif
+
+flat out vec4 PatchTint;
+#endif
 
-uniform mat4 NormalMatrix;
-uniform mat4 ModelViewMatrix;
-uniform mat4 ModelViewProjection;
+#include "frame_uniforms.glsl"
 
 out vec3 Position;
 out vec3 Normal;
 out vec3 Color;
 out vec2 UV;
+out vec3 ObjectDirection; // Direo no espao do objeto, usada para amostrar os cube maps
 
 void main()
 {  
+#ifdef FEATURE_PACKED_VERTICES
+	vec3 VertexNormal = InPosition;
+	Color = vec3(1.0);
+#else
+	vec3 VertexNormal = InNormal;
+	Color = InColor;
+#endif
+
+#ifdef FEATURE_INSTANCED
+	// A matriz normal de cada instncia  derivada aqui (inversa transposta da parte 3x3 da ModelView), sem ocupar
+	//	espao no buffer de instncias
+	mat4 InstanceModelViewMatrix = ViewMatrix * InModelMatrix;
+	mat3 InstanceNormalMatrix = transpose(inverse(mat3(InstanceModelViewMatrix)));
+
+	vec4 ViewPosition = InstanceModelViewMatrix * vec4(InPosition, 1.0);
+	Normal = InstanceNormalMatrix * VertexNormal;
+	gl_Position = ViewProjection * InModelMatrix * vec4(InPosition, 1.0);
+	MaterialIndex = InMaterialIndex;
+#else
 	vec4 ViewPosition = ModelViewMatrix * vec4(InPosition, 1.0);
+	Normal = vec3(NormalMatrix * vec4(VertexNormal, 0.0));
+	gl_Position = ModelViewProjection * vec4(InPosition, 1.0);
+#endif
+
+#ifdef FEATURE_PATCHES
+#ifdef FEATURE_MULTI_DRAW_INDIRECT
+	PatchTint = PatchDraws[InDrawIndex].Tint;
+#else
+	PatchTint = DrawTint;
+#endif
+#endif
 
 	Position = ViewPosition.xyz / ViewPosition.w;
-	Normal = vec3(NormalMatrix * vec4(InNormal, 0.0));	
-	Color = InColor;
 	UV = InUV;
-	gl_Position = ModelViewProjection * vec4(InPosition, 1.0);
-}
\ No newline at end of file
+	ObjectDirection = InPosition;
+}
@@ -0,0 +1,156 @@
+#include "DrawBatcher.h"
+
+#include <cmath>
+
+#include <glm/ext.hpp>
+
+#include "TestCheck.h"
+
+namespace
+{
+	// Cmera em (0, 0, 5) olhando para a origem, com o objeto na origem (espao do objeto = espao do mundo)
+	DrawBatchView MakeView()
+	{
+		const glm::mat4 ModelView = glm::lookAt(glm::vec3{ 0.0f, 0.0f, 5.0f }, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+		const glm::mat4 Projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+		return DrawBatchView::FromMatrices(Projection * ModelView, ModelView);
+	}
+
+	DrawBatchItem MakeItem(const glm::vec3& Center, float Radius, const glm::vec3& ConeAxis, float ConeSin)
+	{
+		DrawBatchItem Item;
+		Item.Center = Center;
+		Item.Radius = Radius;
+		Item.ConeAxis = ConeAxis;
+		Item.ConeSin = ConeSin;
+		return Item;
+	}
+
+	// Patches espalhados sobre a esfera unitria (espiral de Fibonacci), com as normais em um cone em torno do centro
+	std::vector<DrawBatchItem> MakeSphereItems(size_t Count)
+	{
+		std::vector<DrawBatchItem> Items;
+		for (size_t Index = 0; Index < Count; ++Index)
+		{
+			const float Z = 1.0f - 2.0f * (Index + 0.5f) / Count;
+			const float Ring = std::sqrt(1.0f - Z * Z);
+			const float Angle = 2.39996323f * Index;
+			const glm::vec3 Center{ Ring * std::cos(Angle), Ring * std::sin(Angle), Z };
+
+			DrawBatchItem Item = MakeItem(Center, 0.05f, Center, 0.2f);
+			Item.FirstIndex = static_cast<GLuint>(Index * 96);
+			Item.IndexCount = 96;
+			Item.BaseVertex = static_cast<GLint>(Index % 3);
+			Items.push_back(Item);
+		}
+		return Items;
+	}
+
+	bool AreEqual(const DrawElementsIndirectCommand& A, const DrawElementsIndirectCommand& B)
+	{
+		return A.Count == B.Count && A.InstanceCount == B.InstanceCount && A.FirstIndex == B.FirstIndex && A.BaseVertex == B.BaseVertex &&
+			A.BaseInstance == B.BaseInstance;
+	}
+
+	void TestSameCommandsWithAnyNumberOfThreads()
+	{
+		const std::vector<DrawBatchItem> Items = MakeSphereItems(5000);
+		const DrawBatchView View = MakeView();
+
+		WorkerPool SingleThread{ 1 };
+		DrawCommandBuilder SerialBuilder{ SingleThread };
+		std::vector<DrawElementsIndirectCommand> SerialCommands;
+		SerialBuilder.Build(Items, View, SerialCommands);
+
+		// Cerca de metade da esfera est de costas para a cmera
+		CHECK(!SerialCommands.empty());
+		CHECK(SerialCommands.size() < Items.size());
+
+		WorkerPool FourThreads{ 4 };
+		CHECK_EQUAL(4, FourThreads.GetNumThreads());
+		DrawCommandBuilder ParallelBuilder{ FourThreads };
+		ParallelBuilder.MinItemsPerThread = 1;
+		CHECK_EQUAL(4, ParallelBuilder.GetNumThreads());
+
+		// Vrios frames seguidos no mesmo pool, com os blocos de comandos reaproveitados
+		for (int Frame = 0; Frame < 20; ++Frame)
+		{
+			std::vector<DrawElementsIndirectCommand> ParallelCommands;
+			ParallelBuilder.Build(Items, View, ParallelCommands);
+
+			CHECK_EQUAL(SerialCommands.size(), ParallelCommands.size());
+			bool bSameCommands = SerialCommands.size() == ParallelCommands.size();
+			for (size_t Index = 0; bSameCommands && Index < SerialCommands.size(); ++Index)
+			{
+				bSameCommands = AreEqual(SerialCommands[Index], ParallelCommands[Index]);
+			}
+			CHECK(bSameCommands);
+		}
+	}
+
+	void TestCulling()
+	{
+		const DrawBatchView View = MakeView();
+
+		std::vector<DrawBatchItem> Items;
+		Items.push_back(MakeItem({ 0.0f, 0.0f, 1.0f }, 0.1f, { 0.0f, 0.0f, 1.0f }, 0.3f)); // 0: de frente para a cmera
+		Items.push_back(MakeItem({ 0.0f, 0.0f, -1.0f }, 0.1f, { 0.0f, 0.0f, -1.0f }, 0.3f)); // 1: lado de trs do globo
+		Items.push_back(MakeItem({ 0.0f, 0.0f, -1.0f }, 0.1f, { 0.0f, 0.0f, -1.0f }, 1.0f)); // 2: normais em todas as direes
+		Items.push_back(MakeItem({ 20.0f, 0.0f, 0.0f }, 0.1f, { 0.0f, 0.0f, 1.0f }, 0.3f)); // 3:  direita do frustum
+		Items.push_back(MakeItem({ 0.0f, 0.0f, 10.0f }, 0.1f, { 0.0f, 0.0f, 1.0f }, 0.3f)); // 4: atrs da cmera
+		Items.push_back(MakeItem({ 0.0f, 0.0f, -200.0f }, 0.1f, { 0.0f, 0.0f, 1.0f }, 0.3f)); // 5: alm do plano distante
+		Items.push_back(MakeItem({ 2.3f, 0.0f, 0.0f }, 0.5f, { 0.0f, 0.0f, 1.0f }, 0.3f)); // 6: cruza a borda do frustum
+		Items.push_back(MakeItem({ 1.0f, 0.0f, 0.0f }, 0.1f, { 1.0f, 0.0f, 0.0f }, 0.3f)); // 7: silhueta, quase de perfil
+
+		CHECK(DrawCommandBuilder::IsVisible(Items[0], View));
+		CHECK(!DrawCommandBuilder::IsVisible(Items[1], View));
+		CHECK(DrawCommandBuilder::IsVisible(Items[2], View));
+		CHECK(!DrawCommandBuilder::IsVisible(Items[3], View));
+		CHECK(!DrawCommandBuilder::IsVisible(Items[4], View));
+		CHECK(!DrawCommandBuilder::IsVisible(Items[5], View));
+		CHECK(DrawCommandBuilder::IsVisible(Items[6], View));
+		CHECK(DrawCommandBuilder::IsVisible(Items[7], View));
+
+		WorkerPool SingleThread{ 1 };
+		DrawCommandBuilder Builder{ SingleThread };
+		std::vector<DrawElementsIndirectCommand> Commands;
+		Builder.Build(Items, View, Commands);
+
+		// O BaseInstance de cada comando  o ndice do item, na ordem dos itens
+		CHECK_EQUAL(size_t{ 4 }, Commands.size());
+		if (Commands.size() == 4)
+		{
+			CHECK_EQUAL(GLuint{ 0 }, Commands[0].BaseInstance);
+			CHECK_EQUAL(GLuint{ 2 }, Commands[1].BaseInstance);
+			CHECK_EQUAL(GLuint{ 6 }, Commands[2].BaseInstance);
+			CHECK_EQUAL(GLuint{ 7 }, Commands[3].BaseInstance);
+			CHECK_EQUAL(GLuint{ 1 }, Commands[0].InstanceCount);
+		}
+	}
+
+	void TestWorkerPoolRunsEveryTask()
+	{
+		WorkerPool Pool{ 4 };
+		for (size_t Count : { size_t{ 0 }, size_t{ 1 }, size_t{ 3 }, size_t{ 4 }, size_t{ 100 } })
+		{
+			std::vector<int> Runs(Count, 0);
+			Pool.ParallelFor(Count, [&Runs](size_t Index) { Runs[Index]++; });
+
+			bool bEachOnce = true;
+			for (int TaskRuns : Runs)
+			{
+				bEachOnce = bEachOnce && TaskRuns == 1;
+			}
+			CHECK(bEachOnce);
+		}
+	}
+}
+
+int main()
+{
+	TestSameCommandsWithAnyNumberOfThreads();
+	TestCulling();
+	TestWorkerPoolRunsEveryTask();
+
+	return TestCheck::FinishTest("DrawBatcherTest");
+}
@@ -0,0 +1,166 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "TestCheck.h"
+
+namespace
+{
+	// A escala  arredondada em passos de 1%: um passo pode passar do limite por meio ponto percentual
+	constexpr float RoundingTolerance = 0.0051f;
+
+	// Escala depois de cada frame de um trace sinttico. Como em ReplayResolutionTrace, o trace tem o tempo da cena na escala 1
+	//	e o tempo medido  proporcional  rea da escala atual
+	std::vector<float> Replay(DynamicResolutionController& Controller, const std::vector<double>& FullSeconds)
+	{
+		std::vector<float> Scales;
+		for (double Seconds : FullSeconds)
+		{
+			const float Scale = Controller.GetScale();
+			Scales.push_back(Controller.Update(Seconds * Scale * Scale));
+		}
+		return Scales;
+	}
+
+	std::vector<double> Constant(double Seconds, size_t Frames)
+	{
+		return std::vector<double>(Frames, Seconds);
+	}
+
+	// Tempos pseudoaleatrios (mas reproduzveis) em [MinSeconds, MaxSeconds]
+	std::vector<double> Noise(double MinSeconds, double MaxSeconds, size_t Frames)
+	{
+		std::vector<double> Seconds;
+		uint32_t State = 12345;
+		for (size_t Frame = 0; Frame < Frames; ++Frame)
+		{
+			State = State * 1664525u + 1013904223u;
+			Seconds.push_back(MinSeconds + (MaxSeconds - MinSeconds) * (State >> 8) / double(1u << 24));
+		}
+		return Seconds;
+	}
+
+	void TestNoChangeInsideBand()
+	{
+		const DynamicResolutionSettings Settings;
+		DynamicResolutionController Controller{ Settings };
+
+		// Rudo e alternncia entre as bordas da faixa [Lower, Upper] x oramento: nenhuma mudana, logo nenhuma oscilao
+		const double Lower = Settings.TargetSeconds * Settings.LowerThreshold;
+		const double Upper = Settings.TargetSeconds * Settings.UpperThreshold;
+		std::vector<double> Trace = Noise(Lower * 1.01, Upper * 0.99, 500);
+		for (size_t Frame = 0; Frame < 500; ++Frame)
+		{
+			Trace.push_back(Frame % 2 == 0 ? Lower * 1.01 : Upper * 0.99);
+		}
+
+		const std::vector<float> Scales = Replay(Controller, Trace);
+		CHECK(std::all_of(Scales.begin(), Scales.end(), [](float Scale) { return Scale == 1.0f; }));
+
+		// O mesmo a partir de uma escala reduzida: o trace na escala 1  maior, mas o tempo medido fica dentro da faixa
+		DynamicResolutionController Reduced{ Settings };
+		Replay(Reduced, Constant(Settings.TargetSeconds * 3.0, 200));
+		const float ReducedScale = Reduced.GetScale();
+		CHECK(ReducedScale < 1.0f);
+
+		const double Area = double(ReducedScale) * ReducedScale;
+		const std::vector<float> ReducedScales = Replay(Reduced, Noise(Lower * 1.02 / Area, Upper * 0.98 / Area, 500));
+		CHECK(std::all_of(ReducedScales.begin(), ReducedScales.end(), [ReducedScale](float Scale) { return Scale == ReducedScale; }));
+	}
+
+	void TestSpikeLowersScaleQuickly()
+	{
+		const DynamicResolutionSettings Settings;
+		DynamicResolutionController Controller{ Settings };
+		Replay(Controller, Constant(Settings.TargetSeconds * 0.9, 50));
+		CHECK_EQUAL(1.0f, Controller.GetScale());
+
+		// Um frame muito acima do oramento j reduz a escala, mas no mximo MaxStepDown de uma vez
+		const float Before = Controller.GetScale();
+		const float After = Controller.Update(Settings.TargetSeconds * 4.0);
+		CHECK(After < Before);
+		CHECK(Before - After <= Settings.MaxStepDown + RoundingTolerance);
+
+		// Com o pico sustentado, cada reduo respeita o passo e o intervalo entre ajustes
+		const std::vector<float> Scales = Replay(Controller, Constant(Settings.TargetSeconds * 4.0, 200));
+		float Previous = After;
+		int FramesSinceChange = 0;
+		for (float Scale : Scales)
+		{
+			++FramesSinceChange;
+			if (Scale != Previous)
+			{
+				CHECK(Scale < Previous);
+				CHECK(Previous - Scale <= Settings.MaxStepDown + RoundingTolerance);
+				CHECK(FramesSinceChange >= Settings.CooldownFrames);
+				FramesSinceChange = 0;
+			}
+			Previous = Scale;
+		}
+	}
+
+	void TestRecoveryIsGradual()
+	{
+		const DynamicResolutionSettings Settings;
+		DynamicResolutionController Controller{ Settings };
+		Replay(Controller, Constant(Settings.TargetSeconds * 3.0, 200));
+		const float Reduced = Controller.GetScale();
+		CHECK(Reduced < 0.7f);
+
+		// A carga volta a ser leve: a escala sobe no mximo MaxStepUp por ajuste, com CooldownFrames entre os ajustes
+		const std::vector<float> Scales = Replay(Controller, Constant(Settings.TargetSeconds * 0.3, 400));
+		float Previous = Reduced;
+		int FramesSinceChange = Settings.CooldownFrames; // A ltima reduo foi h muitos frames: o primeiro aumento  imediato
+		int Increases = 0;
+		for (float Scale : Scales)
+		{
+			++FramesSinceChange;
+			if (Scale != Previous)
+			{
+				CHECK(Scale > Previous);
+				CHECK(Scale - Previous <= Settings.MaxStepUp + RoundingTolerance);
+				CHECK(FramesSinceChange >= Settings.CooldownFrames);
+				FramesSinceChange = 0;
+				++Increases;
+			}
+			Previous = Scale;
+		}
+		CHECK_EQUAL(1.0f, Controller.GetScale());
+		CHECK(Increases >= static_cast<int>(std::floor((1.0f - Reduced) / Settings.MaxStepUp)));
+	}
+
+	void TestScaleIsClamped()
+	{
+		DynamicResolutionSettings Settings;
+		Settings.MinScale = 0.3f;
+		DynamicResolutionController Controller{ Settings };
+
+		// Nem uma cena 20x mais cara que o oramento leva a escala abaixo de MinScale
+		const std::vector<float> Heavy = Replay(Controller, Constant(Settings.TargetSeconds * 20.0, 300));
+		CHECK(std::all_of(Heavy.begin(), Heavy.end(), [&Settings](float Scale) { return Scale >= Settings.MinScale; }));
+		CHECK_EQUAL(Settings.MinScale, Controller.GetScale());
+
+		// E uma cena quase sem custo no passa da resoluo nativa
+		const std::vector<float> Light = Replay(Controller, Constant(Settings.TargetSeconds * 0.01, 500));
+		CHECK(std::all_of(Light.begin(), Light.end(), [](float Scale) { return Scale <= 1.0f; }));
+		CHECK_EQUAL(1.0f, Controller.GetScale());
+
+		// O trace pode comear de qualquer jeito: um tempo nulo no muda nada
+		DynamicResolutionController Idle{ Settings };
+		Replay(Idle, Constant(0.0, 50));
+		CHECK_EQUAL(1.0f, Idle.GetScale());
+	}
+}
+
+int main()
+{
+	TestNoChangeInsideBand();
+	TestSpikeLowersScaleQuickly();
+	TestRecoveryIsGradual();
+	TestScaleIsClamped();
+
+	return TestCheck::FinishTest("DynamicResolutionTest");
+}
@@ -0,0 +1,173 @@
+#include "FrameGraph.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+	// Os passes nunca executam: s a compilao (sem OpenGL)  testada
+	void NoOp(const FrameGraphPassContext&)
+	{
+	}
+
+	// O grafo do main: Globe desenha a cena, Present a copia para a janela e Capture a grava em um arquivo
+	void TestUnusedPassIsCulled()
+	{
+		FrameGraph Graph;
+		FrameGraphTextureDesc DepthDesc;
+		DepthDesc.InternalFormat = GL_DEPTH_COMPONENT24;
+
+		const FrameGraphResource SceneColor = Graph.CreateTexture("SceneColor", FrameGraphTextureDesc{});
+		const FrameGraphResource SceneDepth = Graph.CreateTexture("SceneDepth", DepthDesc);
+		const FrameGraphResource Backbuffer = Graph.ImportBackbuffer("Backbuffer");
+		const FrameGraphResource CaptureFile = Graph.ImportExternal("CaptureFile");
+
+		const int Globe = Graph.AddPass("Globe", {}, { SceneColor, SceneDepth }, NoOp);
+		const int Present = Graph.AddPass("Present", { SceneColor }, { Backbuffer }, NoOp);
+		const int Capture = Graph.AddPass("Capture", { SceneColor }, { CaptureFile }, NoOp);
+		Graph.SetOutput(Backbuffer, true);
+
+		CHECK(Graph.Compile());
+		const FrameGraphPlan& Plan = Graph.GetPlan();
+		CHECK_EQUAL(size_t{ 2 }, Plan.Passes.size());
+		if (Plan.Passes.size() == 2)
+		{
+			CHECK_EQUAL(Globe, Plan.Passes[0]);
+			CHECK_EQUAL(Present, Plan.Passes[1]);
+		}
+		CHECK_EQUAL(1, Plan.CulledPasses);
+		CHECK_EQUAL(-1, Plan.ResourceToPhysical[Backbuffer]);
+		CHECK_EQUAL(-1, Plan.ResourceToPhysical[CaptureFile]);
+
+		// Uma captura pedida torna o arquivo uma sada e o passe volta ao plano
+		Graph.SetOutput(CaptureFile, true);
+		CHECK(Graph.Compile());
+		CHECK_EQUAL(size_t{ 3 }, Graph.GetPlan().Passes.size());
+		CHECK_EQUAL(0, Graph.GetPlan().CulledPasses);
+		if (Graph.GetPlan().Passes.size() == 3)
+		{
+			CHECK_EQUAL(Capture, Graph.GetPlan().Passes[2]);
+		}
+
+		// Sem nenhuma sada nada executa, nem o passe que no l nada
+		Graph.SetOutput(CaptureFile, false);
+		Graph.SetOutput(Backbuffer, false);
+		CHECK(Graph.Compile());
+		CHECK(Graph.GetPlan().Passes.empty());
+		CHECK_EQUAL(3, Graph.GetPlan().CulledPasses);
+		CHECK(Graph.GetPlan().PhysicalTextures.empty());
+	}
+
+	// A -> B -> C -> D em cadeia: cada textura vive do passe que a escreve at o que a l
+	void TestDisjointLifetimesShareTexture()
+	{
+		FrameGraph Graph;
+		const FrameGraphResource First = Graph.CreateTexture("First", FrameGraphTextureDesc{});
+		const FrameGraphResource Second = Graph.CreateTexture("Second", FrameGraphTextureDesc{});
+		const FrameGraphResource Third = Graph.CreateTexture("Third", FrameGraphTextureDesc{});
+		const FrameGraphResource Backbuffer = Graph.ImportBackbuffer("Backbuffer");
+
+		Graph.AddPass("A", {}, { First }, NoOp);
+		Graph.AddPass("B", { First }, { Second }, NoOp);
+		Graph.AddPass("C", { Second }, { Third }, NoOp);
+		Graph.AddPass("D", { Third }, { Backbuffer }, NoOp);
+		Graph.SetOutput(Backbuffer, true);
+		Graph.SetBackbufferSize(640, 480);
+
+		CHECK(Graph.Compile());
+		const FrameGraphPlan& Plan = Graph.GetPlan();
+
+		// First (A..B) e Third (C..D) no se sobrepem; Second (B..C) se sobrepe s duas
+		CHECK_EQUAL(size_t{ 2 }, Plan.PhysicalTextures.size());
+		CHECK_EQUAL(Plan.ResourceToPhysical[First], Plan.ResourceToPhysical[Third]);
+		CHECK(Plan.ResourceToPhysical[First] != Plan.ResourceToPhysical[Second]);
+		CHECK(Plan.ResourceToPhysical[Second] >= 0);
+	}
+
+	void TestOverlappingLifetimesDoNotShare()
+	{
+		FrameGraph Graph;
+		FrameGraphTextureDesc HalfDesc;
+		HalfDesc.Scale = 0.5f;
+
+		const FrameGraphResource First = Graph.CreateTexture("First", FrameGraphTextureDesc{});
+		const FrameGraphResource Second = Graph.CreateTexture("Second", FrameGraphTextureDesc{});
+		const FrameGraphResource Half = Graph.CreateTexture("Half", HalfDesc);
+		const FrameGraphResource Final = Graph.CreateTexture("Final", FrameGraphTextureDesc{});
+		const FrameGraphResource Backbuffer = Graph.ImportBackbuffer("Backbuffer");
+
+		// First e Second so escritas juntas e lidas juntas: vivem ao mesmo tempo
+		Graph.AddPass("Both", {}, { First, Second }, NoOp);
+		Graph.AddPass("Combine", { First, Second }, { Half }, NoOp);
+		// Final comea depois do ltimo uso de First e Second, mas Half (outra descrio) no serve para ela
+		Graph.AddPass("Upscale", { Half }, { Final }, NoOp);
+		Graph.AddPass("Present", { Final }, { Backbuffer }, NoOp);
+		Graph.SetOutput(Backbuffer, true);
+
+		CHECK(Graph.Compile());
+		const FrameGraphPlan& Plan = Graph.GetPlan();
+
+		CHECK(Plan.ResourceToPhysical[First] != Plan.ResourceToPhysical[Second]);
+		CHECK(Plan.ResourceToPhysical[Half] != Plan.ResourceToPhysical[First]);
+		CHECK(Plan.ResourceToPhysical[Half] != Plan.ResourceToPhysical[Second]);
+		CHECK(Plan.ResourceToPhysical[Final] == Plan.ResourceToPhysical[First] || Plan.ResourceToPhysical[Final] == Plan.ResourceToPhysical[Second]);
+		CHECK_EQUAL(size_t{ 3 }, Plan.PhysicalTextures.size());
+	}
+
+	void TestBackbufferSizeResolvesDescs()
+	{
+		FrameGraph Graph;
+		FrameGraphTextureDesc HalfDesc;
+		HalfDesc.Scale = 0.5f;
+		FrameGraphTextureDesc FixedDesc;
+		FixedDesc.Width = 256;
+		FixedDesc.Height = 128;
+
+		const FrameGraphResource Full = Graph.CreateTexture("Full", FrameGraphTextureDesc{});
+		const FrameGraphResource Half = Graph.CreateTexture("Half", HalfDesc);
+		const FrameGraphResource Fixed = Graph.CreateTexture("Fixed", FixedDesc);
+		const FrameGraphResource Backbuffer = Graph.ImportBackbuffer("Backbuffer");
+		Graph.AddPass("Draw", {}, { Full, Half, Fixed }, NoOp);
+		Graph.AddPass("Present", { Full, Half, Fixed }, { Backbuffer }, NoOp);
+		Graph.SetOutput(Backbuffer, true);
+
+		Graph.SetBackbufferSize(800, 600);
+		CHECK(Graph.Compile());
+		CHECK(!Graph.Compile());
+
+		auto GetDesc = [&Graph](FrameGraphResource Resource) { return Graph.GetPlan().PhysicalTextures[Graph.GetPlan().ResourceToPhysical[Resource]]; };
+		CHECK_EQUAL(800, GetDesc(Full).Width);
+		CHECK_EQUAL(600, GetDesc(Full).Height);
+		CHECK_EQUAL(400, GetDesc(Half).Width);
+		CHECK_EQUAL(300, GetDesc(Half).Height);
+		CHECK_EQUAL(256, GetDesc(Fixed).Width);
+
+		// O mesmo tamanho no recompila; outro tamanho marca o grafo e as descries acompanham
+		Graph.SetBackbufferSize(800, 600);
+		CHECK(!Graph.Compile());
+
+		Graph.SetBackbufferSize(1024, 768);
+		CHECK(Graph.Compile());
+		CHECK_EQUAL(1024, GetDesc(Full).Width);
+		CHECK_EQUAL(768, GetDesc(Full).Height);
+		CHECK_EQUAL(512, GetDesc(Half).Width);
+		CHECK_EQUAL(384, GetDesc(Half).Height);
+		CHECK_EQUAL(256, GetDesc(Fixed).Width);
+		CHECK_EQUAL(128, GetDesc(Fixed).Height);
+
+		// Uma janela minimizada (0 x 0) no gera texturas vazias
+		Graph.SetBackbufferSize(0, 0);
+		CHECK(Graph.Compile());
+		CHECK_EQUAL(1, GetDesc(Half).Width);
+		CHECK_EQUAL(1, GetDesc(Half).Height);
+	}
+}
+
+int main()
+{
+	TestUnusedPassIsCulled();
+	TestDisjointLifetimesShareTexture();
+	TestOverlappingLifetimesDoNotShare();
+	TestBackbufferSizeResolvesDescs();
+
+	return TestCheck::FinishTest("FrameGraphTest");
+}
@@ -0,0 +1,170 @@
+#include "GLStateCache.h"
+
+#include "TestCheck.h"
+
+namespace
+{
+	// Chamadas que chegaram ao "driver": a tabela falsa s conta e guarda os ltimos argumentos
+	struct MockDriver
+	{
+		int UseProgram = 0;
+		int BindVertexArray = 0;
+		int ActiveTexture = 0;
+		int BindTexture = 0;
+		int BindBuffer = 0;
+		int Enable = 0;
+		int Disable = 0;
+		int Other = 0;
+
+		GLenum LastTextureUnit = 0;
+		GLuint LastTexture = 0;
+		GLuint LastBuffer = 0;
+	};
+
+	MockDriver Driver;
+
+	GLStateFunctions MakeMockFunctions()
+	{
+		GLStateFunctions Functions;
+		Functions.UseProgram = [](GLuint) { ++Driver.UseProgram; };
+		Functions.BindVertexArray = [](GLuint) { ++Driver.BindVertexArray; };
+		Functions.ActiveTexture = [](GLenum TextureUnit) { ++Driver.ActiveTexture; Driver.LastTextureUnit = TextureUnit; };
+		Functions.BindTexture = [](GLenum, GLuint TextureId) { ++Driver.BindTexture; Driver.LastTexture = TextureId; };
+		Functions.BindBuffer = [](GLenum, GLuint BufferId) { ++Driver.BindBuffer; Driver.LastBuffer = BufferId; };
+		Functions.Enable = [](GLenum) { ++Driver.Enable; };
+		Functions.Disable = [](GLenum) { ++Driver.Disable; };
+		Functions.BlendFunc = [](GLenum, GLenum) { ++Driver.Other; };
+		Functions.DepthFunc = [](GLenum) { ++Driver.Other; };
+		Functions.DepthMask = [](GLboolean) { ++Driver.Other; };
+		Functions.CullFace = [](GLenum) { ++Driver.Other; };
+		Functions.PolygonMode = [](GLenum, GLenum) { ++Driver.Other; };
+		return Functions;
+	}
+
+	void TestRedundantCallsAreElided()
+	{
+		Driver = MockDriver{};
+		GLStateCache Cache{ MakeMockFunctions() };
+
+		Cache.UseProgram(3);
+		Cache.UseProgram(3);
+		CHECK_EQUAL(1, Driver.UseProgram);
+
+		Cache.BindTexture(0, GL_TEXTURE_2D, 7);
+		Cache.BindTexture(0, GL_TEXTURE_2D, 7);
+		CHECK_EQUAL(1, Driver.BindTexture);
+		CHECK_EQUAL(1, Driver.ActiveTexture);
+
+		// Outro alvo na mesma unidade  outra ligao; a unidade j est ativa
+		Cache.BindTexture(0, GL_TEXTURE_CUBE_MAP, 7);
+		CHECK_EQUAL(2, Driver.BindTexture);
+		CHECK_EQUAL(1, Driver.ActiveTexture);
+
+		Cache.SetCapability(GL_BLEND, true);
+		Cache.SetCapability(GL_BLEND, true);
+		Cache.SetCapability(GL_BLEND, false);
+		CHECK_EQUAL(1, Driver.Enable);
+		CHECK_EQUAL(1, Driver.Disable);
+
+		// UseProgram + ActiveTexture + 2 BindTexture + Enable + Disable enviadas; UseProgram, BindTexture, ActiveTexture
+		//	(a unidade 0 j estava ativa para o cube map) e Enable evitadas
+		CHECK_EQUAL(6u, Cache.GetIssuedCalls());
+		CHECK_EQUAL(4u, Cache.GetElidedCalls());
+	}
+
+	void TestBindVertexArrayForgetsElementBuffer()
+	{
+		Driver = MockDriver{};
+		GLStateCache Cache{ MakeMockFunctions() };
+
+		Cache.BindVertexArray(1);
+		Cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+		Cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+		CHECK_EQUAL(1, Driver.BindBuffer);
+
+		// O buffer de ndices faz parte do VAO: depois de trocar o VAO o mesmo buffer precisa ser ligado de novo
+		Cache.BindVertexArray(2);
+		Cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 5);
+		CHECK_EQUAL(2, Driver.BindVertexArray);
+		CHECK_EQUAL(2, Driver.BindBuffer);
+
+		// Os demais alvos no pertencem ao VAO e continuam conhecidos
+		Cache.BindBuffer(GL_ARRAY_BUFFER, 9);
+		Cache.BindVertexArray(3);
+		Cache.BindBuffer(GL_ARRAY_BUFFER, 9);
+		CHECK_EQUAL(3, Driver.BindBuffer);
+
+		CHECK_EQUAL(6u, Cache.GetIssuedCalls());
+		CHECK_EQUAL(2u, Cache.GetElidedCalls());
+	}
+
+	void TestTextureDeletionResetsEveryUnit()
+	{
+		Driver = MockDriver{};
+		GLStateCache Cache{ MakeMockFunctions() };
+
+		Cache.BindTexture(0, GL_TEXTURE_2D, 4);
+		Cache.BindTexture(2, GL_TEXTURE_2D, 4);
+		Cache.BindTexture(1, GL_TEXTURE_2D, 6);
+		CHECK_EQUAL(3, Driver.BindTexture);
+
+		// O OpenGL liga de volta a textura 0 onde a textura apagada estava: ligar 0 nessas unidades no muda nada
+		Cache.OnTextureDeleted(4);
+		Cache.BindTexture(0, GL_TEXTURE_2D, 0);
+		Cache.BindTexture(2, GL_TEXTURE_2D, 0);
+		CHECK_EQUAL(3, Driver.BindTexture);
+
+		// O identificador pode ser reutilizado por uma textura nova, que precisa ser ligada
+		Cache.BindTexture(0, GL_TEXTURE_2D, 4);
+		CHECK_EQUAL(4, Driver.BindTexture);
+		CHECK_EQUAL(GLuint{ 4 }, Driver.LastTexture);
+		CHECK_EQUAL(GLenum{ GL_TEXTURE0 }, Driver.LastTextureUnit);
+
+		// A unidade 1 no tinha a textura apagada
+		Cache.BindTexture(1, GL_TEXTURE_2D, 6);
+		CHECK_EQUAL(4, Driver.BindTexture);
+	}
+
+	void TestInvalidateForcesNextCall()
+	{
+		Driver = MockDriver{};
+		GLStateCache Cache{ MakeMockFunctions() };
+
+		Cache.UseProgram(3);
+		Cache.BindVertexArray(1);
+		Cache.BindTexture(0, GL_TEXTURE_2D, 7);
+		Cache.BindBuffer(GL_UNIFORM_BUFFER, 2);
+		Cache.SetCapability(GL_DEPTH_TEST, true);
+		Cache.SetDepthMask(true);
+		Cache.ResetCounters();
+
+		// O estado foi alterado fora do cache (ex.: cdigo de terceiros): depois de Invalidate tudo  enviado de novo
+		Cache.Invalidate();
+		Cache.UseProgram(3);
+		Cache.BindVertexArray(1);
+		Cache.BindTexture(0, GL_TEXTURE_2D, 7);
+		Cache.BindBuffer(GL_UNIFORM_BUFFER, 2);
+		Cache.SetCapability(GL_DEPTH_TEST, true);
+		Cache.SetDepthMask(true);
+
+		CHECK_EQUAL(2, Driver.UseProgram);
+		CHECK_EQUAL(2, Driver.BindVertexArray);
+		CHECK_EQUAL(2, Driver.ActiveTexture);
+		CHECK_EQUAL(2, Driver.BindTexture);
+		CHECK_EQUAL(2, Driver.BindBuffer);
+		CHECK_EQUAL(2, Driver.Enable);
+		CHECK_EQUAL(2, Driver.Other);
+		CHECK_EQUAL(7u, Cache.GetIssuedCalls());
+		CHECK_EQUAL(0u, Cache.GetElidedCalls());
+	}
+}
+
+int main()
+{
+	TestRedundantCallsAreElided();
+	TestBindVertexArrayForgetsElementBuffer();
+	TestTextureDeletionResetsEveryUnit();
+	TestInvalidateForcesNextCall();
+
+	return TestCheck::FinishTest("GLStateCacheTest");
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <iostream>
+
+// Verificaes dos testes (sem framework): uma falha imprime a condio e a linha e o teste continua; no final,
+//	FinishTest retorna o cdigo de sada que o ctest usa para marcar o teste como falho
+namespace TestCheck
+{
+	inline int& GetFailures()
+	{
+		static int Failures = 0;
+		return Failures;
+	}
+
+	template <typename TExpected, typename TActual>
+	void CheckEqual(const TExpected& Expected, const TActual& Actual, const char* ExpectedText, const char* ActualText, const char* File, int Line)
+	{
+		if (!(Expected == Actual))
+		{
+			std::cout << File << ":" << Line << ": " << ActualText << " == " << ExpectedText << " falhou (" << Actual << " em vez de "
+					  << Expected << ")" << std::endl;
+			++GetFailures();
+		}
+	}
+
+	inline int FinishTest(const char* Name)
+	{
+		if (GetFailures() > 0)
+		{
+			std::cout << Name << ": " << GetFailures() << " verificaes falharam" << std::endl;
+			return 1;
+		}
+		std::cout << Name << ": ok" << std::endl;
+		return 0;
+	}
+}
+
+#define CHECK(Condition) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			std::cout << __FILE__ << ":" << __LINE__ << ": " << #Condition << " falhou" << std::endl; \
+			++TestCheck::GetFailures(); \
+		} \
+	} while (false)
+
+#define CHECK_EQUAL(Expected, Actual) TestCheck::CheckEqual((Expected), (Actual), #Expected, #Actual, __FILE__, __LINE__)